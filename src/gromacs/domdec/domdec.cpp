@@ -192,6 +192,11 @@ static const int c_checkTurnDlbOnInterval  = 100;
  */
 static const int c_checkTurnDlbOffInterval =  20;
 
+/* The weight of the last measurement in the running average of the force
+ * cycles per flop used for the flop based DLB load prediction.
+ */
+static const float c_dlbCyclesPerFlopSmoothing = 0.2;
+
 /* Forward declaration */
 static void dd_dlb_set_should_check_whether_to_turn_dlb_on(gmx_domdec_t *dd, gmx_bool bValue);
 
@@ -381,19 +386,177 @@ void dd_get_constraint_range(const gmx_domdec_t *dd, int *at_start, int *at_end)
     *at_end   = dd->comm->nat[ddnatCON];
 }
 
-void dd_move_x(gmx_domdec_t *dd, matrix box, rvec x[])
+/*! \brief Packs the coordinates to send in pulse \p p along dim index \p d into \p buf
+ *
+ * \p nzone is the number of zones communicated before dimension \p d.
+ */
+static void dd_move_x_pack(const gmx_domdec_t *dd, matrix box, const rvec x[],
+                           int d, int p, int nzone, rvec *buf)
 {
-    int                    nzone, nat_tot, n, d, p, i, j, at0, at1, zone;
-    int                   *index, *cgindex;
-    gmx_domdec_comm_t     *comm;
+    const int              *cgindex = dd->cgindex;
+    const gmx_domdec_ind_t *ind     = &dd->comm->cd[d].ind[p];
+    const int              *index   = ind->index;
+    rvec                    shift   = {0, 0, 0};
+    gmx_bool                bPBC, bScrew;
+    int                     n, i, j, at0, at1;
+
+    bPBC   = (dd->ci[dd->dim[d]] == 0);
+    bScrew = (bPBC && dd->bScrewPBC && dd->dim[d] == XX);
+    if (bPBC)
+    {
+        copy_rvec(box[dd->dim[d]], shift);
+    }
+
+    n = 0;
+    if (!bPBC)
+    {
+        for (i = 0; i < ind->nsend[nzone]; i++)
+        {
+            at0 = cgindex[index[i]];
+            at1 = cgindex[index[i]+1];
+            for (j = at0; j < at1; j++)
+            {
+                copy_rvec(x[j], buf[n]);
+                n++;
+            }
+        }
+    }
+    else if (!bScrew)
+    {
+        for (i = 0; i < ind->nsend[nzone]; i++)
+        {
+            at0 = cgindex[index[i]];
+            at1 = cgindex[index[i]+1];
+            for (j = at0; j < at1; j++)
+            {
+                /* We need to shift the coordinates */
+                rvec_add(x[j], shift, buf[n]);
+                n++;
+            }
+        }
+    }
+    else
+    {
+        for (i = 0; i < ind->nsend[nzone]; i++)
+        {
+            at0 = cgindex[index[i]];
+            at1 = cgindex[index[i]+1];
+            for (j = at0; j < at1; j++)
+            {
+                /* Shift x */
+                buf[n][XX] = x[j][XX] + shift[XX];
+                /* Rotate y and z.
+                 * This operation requires a special shift force
+                 * treatment, which is performed in calc_vir.
+                 */
+                buf[n][YY] = box[YY][YY] - x[j][YY];
+                buf[n][ZZ] = box[ZZ][ZZ] - x[j][ZZ];
+                n++;
+            }
+        }
+    }
+}
+
+/*! \brief Copies the coordinates received in pulse \p p along dim index \p d
+ * from \p rbuf to \p x, only needed when not communicating in place */
+static void dd_move_x_unpack(const gmx_domdec_t *dd, int d, int p, int nzone,
+                             const rvec *rbuf, rvec x[])
+{
+    const gmx_domdec_ind_t *ind = &dd->comm->cd[d].ind[p];
+    int                     i, j, zone;
+
+    j = 0;
+    for (zone = 0; zone < nzone; zone++)
+    {
+        for (i = ind->cell2at0[zone]; i < ind->cell2at1[zone]; i++)
+        {
+            copy_rvec(rbuf[j], x[i]);
+            j++;
+        }
+    }
+}
+
+void dd_move_x_start(gmx_domdec_t *dd, matrix box, rvec x[])
+{
+    gmx_domdec_comm_t      *comm = dd->comm;
+    gmx_domdec_comm_dim_t  *cd;
+    const gmx_domdec_ind_t *ind;
+    rvec                   *rbuf;
+
+    GMX_ASSERT(comm->nreq_move_x == 0, "dd_move_x_start called with communication pending");
+
+    if (!comm->bOverlapMoveX)
+    {
+        dd_move_x(dd, box, x);
+
+        return;
+    }
+
+    if (dd->ndim == 0)
+    {
+        /* Only with separate PME ranks; there are no halo atoms */
+        return;
+    }
+
+    /* The first pulse along the first dimension only sends home atoms,
+     * so it can be started right away. All later pulses also send
+     * atoms received in earlier pulses and are done in dd_move_x_finish.
+     */
+    cd  = &comm->cd[0];
+    ind = &cd->ind[0];
+
+    dd_move_x_pack(dd, box, x, 0, 0, 1, comm->vbuf.v);
+
+    if (cd->bInPlace)
+    {
+        rbuf = x + dd->nat_home;
+    }
+    else
+    {
+        rbuf = comm->vbuf2.v;
+    }
+
+#if GMX_MPI
+    /* The ranks are those used by dd_sendrecv_rvec for dddirBackward */
+    if (ind->nrecv[2] > 0)
+    {
+        MPI_Irecv(rbuf[0], ind->nrecv[2]*sizeof(rvec), MPI_BYTE,
+                  dd->neighbor[0][0], 0, dd->mpi_comm_all,
+                  &comm->req_move_x[comm->nreq_move_x++]);
+    }
+    if (ind->nsend[2] > 0)
+    {
+        MPI_Isend(comm->vbuf.v[0], ind->nsend[2]*sizeof(rvec), MPI_BYTE,
+                  dd->neighbor[0][1], 0, dd->mpi_comm_all,
+                  &comm->req_move_x[comm->nreq_move_x++]);
+    }
+#else
+    GMX_UNUSED_VALUE(ind);
+    GMX_UNUSED_VALUE(rbuf);
+#endif
+}
+
+void dd_move_x_finish(gmx_domdec_t *dd, matrix box, rvec x[])
+{
+    gmx_domdec_comm_t     *comm = dd->comm;
     gmx_domdec_comm_dim_t *cd;
     gmx_domdec_ind_t      *ind;
-    rvec                   shift = {0, 0, 0}, *buf, *rbuf;
-    gmx_bool               bPBC, bScrew;
+    rvec                  *buf, *rbuf;
+    int                    nzone, nat_tot, d, p;
 
-    comm = dd->comm;
+    if (!comm->bOverlapMoveX)
+    {
+        /* dd_move_x_start did all communication */
+        return;
+    }
 
-    cgindex = dd->cgindex;
+#if GMX_MPI
+    if (comm->nreq_move_x > 0)
+    {
+        MPI_Waitall(comm->nreq_move_x, comm->req_move_x, MPI_STATUSES_IGNORE);
+        comm->nreq_move_x = 0;
+    }
+#endif
 
     buf = comm->vbuf.v;
 
@@ -401,65 +564,60 @@ void dd_move_x(gmx_domdec_t *dd, matrix box, rvec x[])
     nat_tot = dd->nat_home;
     for (d = 0; d < dd->ndim; d++)
     {
-        bPBC   = (dd->ci[dd->dim[d]] == 0);
-        bScrew = (bPBC && dd->bScrewPBC && dd->dim[d] == XX);
-        if (bPBC)
-        {
-            copy_rvec(box[dd->dim[d]], shift);
-        }
         cd = &comm->cd[d];
         for (p = 0; p < cd->np; p++)
         {
-            ind   = &cd->ind[p];
-            index = ind->index;
-            n     = 0;
-            if (!bPBC)
+            ind = &cd->ind[p];
+
+            if (cd->bInPlace)
             {
-                for (i = 0; i < ind->nsend[nzone]; i++)
-                {
-                    at0 = cgindex[index[i]];
-                    at1 = cgindex[index[i]+1];
-                    for (j = at0; j < at1; j++)
-                    {
-                        copy_rvec(x[j], buf[n]);
-                        n++;
-                    }
-                }
+                rbuf = x + nat_tot;
             }
-            else if (!bScrew)
+            else
             {
-                for (i = 0; i < ind->nsend[nzone]; i++)
-                {
-                    at0 = cgindex[index[i]];
-                    at1 = cgindex[index[i]+1];
-                    for (j = at0; j < at1; j++)
-                    {
-                        /* We need to shift the coordinates */
-                        rvec_add(x[j], shift, buf[n]);
-                        n++;
-                    }
-                }
+                rbuf = comm->vbuf2.v;
             }
-            else
+            if (d > 0 || p > 0)
             {
-                for (i = 0; i < ind->nsend[nzone]; i++)
-                {
-                    at0 = cgindex[index[i]];
-                    at1 = cgindex[index[i]+1];
-                    for (j = at0; j < at1; j++)
-                    {
-                        /* Shift x */
-                        buf[n][XX] = x[j][XX] + shift[XX];
-                        /* Rotate y and z.
-                         * This operation requires a special shift force
-                         * treatment, which is performed in calc_vir.
-                         */
-                        buf[n][YY] = box[YY][YY] - x[j][YY];
-                        buf[n][ZZ] = box[ZZ][ZZ] - x[j][ZZ];
-                        n++;
-                    }
-                }
+                dd_move_x_pack(dd, box, x, d, p, nzone, buf);
+
+                /* Send and receive the coordinates */
+                dd_sendrecv_rvec(dd, d, dddirBackward,
+                                 buf,  ind->nsend[nzone+1],
+                                 rbuf, ind->nrecv[nzone+1]);
             }
+            if (!cd->bInPlace)
+            {
+                dd_move_x_unpack(dd, d, p, nzone, rbuf, x);
+            }
+            nat_tot += ind->nrecv[nzone+1];
+        }
+        nzone += nzone;
+    }
+}
+
+void dd_move_x(gmx_domdec_t *dd, matrix box, rvec x[])
+{
+    int                    nzone, nat_tot, d, p;
+    gmx_domdec_comm_t     *comm;
+    gmx_domdec_comm_dim_t *cd;
+    gmx_domdec_ind_t      *ind;
+    rvec                  *buf, *rbuf;
+
+    comm = dd->comm;
+
+    buf = comm->vbuf.v;
+
+    nzone   = 1;
+    nat_tot = dd->nat_home;
+    for (d = 0; d < dd->ndim; d++)
+    {
+        cd = &comm->cd[d];
+        for (p = 0; p < cd->np; p++)
+        {
+            ind = &cd->ind[p];
+
+            dd_move_x_pack(dd, box, x, d, p, nzone, buf);
 
             if (cd->bInPlace)
             {
@@ -475,15 +633,7 @@ void dd_move_x(gmx_domdec_t *dd, matrix box, rvec x[])
                              rbuf, ind->nrecv[nzone+1]);
             if (!cd->bInPlace)
             {
-                j = 0;
-                for (zone = 0; zone < nzone; zone++)
-                {
-                    for (i = ind->cell2at0[zone]; i < ind->cell2at1[zone]; i++)
-                    {
-                        copy_rvec(rbuf[j], x[i]);
-                        j++;
-                    }
-                }
+                dd_move_x_unpack(dd, d, p, nzone, rbuf, x);
             }
             nat_tot += ind->nrecv[nzone+1];
         }
@@ -2198,6 +2348,34 @@ static void make_dd_indices(gmx_domdec_t *dd,
         gmx_incons("dd->ncg_zone is not up to date");
     }
 
+    if (!bCGs && dd->ga2la->bDirectList)
+    {
+        /* Without charge groups the local atom and charge group indices
+         * are identical. With a direct list ga2la_set only sets the entry
+         * of the atom itself, so we can set all indices in parallel.
+         */
+        int nthread = gmx_omp_nthreads_get(emntDomdec);
+
+        for (zone = 0; zone < nzone; zone++)
+        {
+            cg0    = (zone == 0 ? cg_start : zone2cg[zone]);
+            cg1    = zone2cg[zone+1];
+            cg1_p1 = cg0 + zone_ncg1[zone];
+
+#pragma omp parallel for num_threads(nthread) schedule(static)
+            for (int cg = cg0; cg < cg1; cg++)
+            {
+                /* Signal with zone+nzone that this atom is from more than one pulse away */
+                int zone1 = (cg < cg1_p1 ? zone : zone + nzone);
+
+                gatindex[cg] = index_gl[cg];
+                ga2la_set(dd->ga2la, index_gl[cg], cg, zone1);
+            }
+        }
+
+        return;
+    }
+
     /* Make the local to global and global to local atom index */
     a = dd->cgindex[cg_start];
     for (zone = 0; zone < nzone; zone++)
@@ -2492,6 +2670,22 @@ static int dd_load_count(gmx_domdec_comm_t *comm)
     return (comm->eFlop ? comm->flop_n : comm->cycl_n[ddCyclF]);
 }
 
+/*! \brief Return the flop count of the force calculation
+ *
+ * As with the cycle count, the flops of one step are removed.
+ */
+static float dd_force_flop(const gmx_domdec_comm_t *comm)
+{
+    float flop = comm->flop;
+
+    if (comm->flop_n > 1)
+    {
+        flop *= (comm->flop_n - 1)/(float)comm->flop_n;
+    }
+
+    return flop;
+}
+
 static float dd_force_load(gmx_domdec_comm_t *comm)
 {
     float load;
@@ -2544,11 +2738,70 @@ static float dd_force_load(gmx_domdec_comm_t *comm)
             load += -gpu_wait + gpu_wait_sum/comm->nrank_gpu_shared;
         }
 #endif
+
+        if (comm->dlbFlopWeight > 0 && comm->cyclesPerFlop > 0)
+        {
+            /* Blend the cycle count with a prediction from the flop count,
+             * i.e. the pair and bonded interaction counts weighted by cost.
+             * The flops are converted to cycles using the cycle/flop ratio
+             * of all PP ranks, see dd_update_cycles_per_flop. As the flop
+             * count is not affected by noise in the timings of this rank,
+             * the DLB can react faster and more accurately to changes
+             * in the load distribution.
+             */
+            load = (1 - comm->dlbFlopWeight)*load +
+                comm->dlbFlopWeight*comm->cyclesPerFlop*dd_force_flop(comm);
+        }
     }
 
     return load;
 }
 
+/*! \brief Update the running average of the force cycles per flop
+ *
+ * The cycles and flops are summed over all PP ranks, so the ratio
+ * is the same on all ranks and timing noise on single ranks averages out.
+ * Should be called by all PP ranks.
+ */
+static void dd_update_cycles_per_flop(gmx_domdec_t *dd)
+{
+    gmx_domdec_comm_t *comm = dd->comm;
+    double             sum[2];
+
+    sum[0] = comm->cycl[ddCyclF];
+    if (comm->cycl_n[ddCyclF] > 1)
+    {
+        /* As in dd_force_load */
+        sum[0] -= comm->cycl_max[ddCyclF];
+    }
+    sum[1] = dd_force_flop(comm);
+#if GMX_MPI
+    if (dd->nnodes > 1)
+    {
+        double buf[2];
+
+        MPI_Allreduce(sum, buf, 2, MPI_DOUBLE, MPI_SUM, dd->mpi_comm_all);
+        sum[0] = buf[0];
+        sum[1] = buf[1];
+    }
+#endif
+
+    if (sum[0] > 0 && sum[1] > 0)
+    {
+        float cyclesPerFlop = sum[0]/sum[1];
+
+        if (comm->cyclesPerFlop == 0)
+        {
+            comm->cyclesPerFlop = cyclesPerFlop;
+        }
+        else
+        {
+            comm->cyclesPerFlop = (1 - c_dlbCyclesPerFlopSmoothing)*comm->cyclesPerFlop +
+                c_dlbCyclesPerFlopSmoothing*cyclesPerFlop;
+        }
+    }
+}
+
 static void set_slb_pme_dim_f(gmx_domdec_t *dd, int dim, real **dim_f)
 {
     gmx_domdec_comm_t *comm;
@@ -4304,6 +4557,7 @@ static void dd_redistribute_cg(FILE *fplog, gmx_int64_t step,
     real               pos_d;
     matrix             tcm;
     rvec              *cg_cm = nullptr, cell_x0, cell_x1, limitd, limit0, limit1;
+    rvec              *state_vec[3];
     int               *cgindex;
     cginfo_mb_t       *cginfo_mb;
     gmx_domdec_comm_t *comm;
@@ -4477,22 +4731,32 @@ static void dd_redistribute_cg(FILE *fplog, gmx_int64_t step,
             home_pos_cg = 0;
     }
 
-    vec         = 0;
-    home_pos_at =
-        compact_and_copy_vec_at(dd->ncg_home, move, cgindex,
-                                nvec, vec++, as_rvec_array(state->x.data()),
-                                comm, bCompact);
+    vec              = 0;
+    state_vec[vec++] = as_rvec_array(state->x.data());
     if (bV)
     {
-        compact_and_copy_vec_at(dd->ncg_home, move, cgindex,
-                                nvec, vec++, as_rvec_array(state->v.data()),
-                                comm, bCompact);
+        state_vec[vec++] = as_rvec_array(state->v.data());
     }
     if (bCGP)
     {
-        compact_and_copy_vec_at(dd->ncg_home, move, cgindex,
-                                nvec, vec++, as_rvec_array(state->cg_p.data()),
-                                comm, bCompact);
+        state_vec[vec++] = as_rvec_array(state->cg_p.data());
+    }
+
+    /* The state vectors go to separate parts of the communication buffers,
+     * so we can compact and copy them in parallel.
+     */
+    home_pos_at = 0;
+#pragma omp parallel for num_threads(std::min(nthread, nvec)) schedule(static)
+    for (int v = 0; v < nvec; v++)
+    {
+        int home_pos =
+            compact_and_copy_vec_at(dd->ncg_home, move, cgindex,
+                                    nvec, v, state_vec[v],
+                                    comm, bCompact);
+        if (v == 0)
+        {
+            home_pos_at = home_pos;
+        }
     }
 
     if (bCompact)
@@ -4835,6 +5099,11 @@ static double force_flop_count(t_nrnb *nrnb)
             sum += nrnb->n[i]*cost_nrnb(i);
         }
     }
+    /* The cluster pair kernels of the Verlet scheme */
+    for (i = eNR_NBNXN_LJ_RF; i <= eNR_NBNXN_ADD_LJ_EWALD_E; i++)
+    {
+        sum += nrnb->n[i]*cost_nrnb(i);
+    }
     for (i = eNR_BONDS; i <= eNR_WALLS; i++)
     {
         sum += nrnb->n[i]*cost_nrnb(i);
@@ -4845,14 +5114,14 @@ static double force_flop_count(t_nrnb *nrnb)
 
 void dd_force_flop_start(gmx_domdec_t *dd, t_nrnb *nrnb)
 {
-    if (dd->comm->eFlop)
+    if (dd->comm->eFlop || dd->comm->dlbFlopWeight > 0)
     {
         dd->comm->flop -= force_flop_count(nrnb);
     }
 }
 void dd_force_flop_stop(gmx_domdec_t *dd, t_nrnb *nrnb)
 {
-    if (dd->comm->eFlop)
+    if (dd->comm->eFlop || dd->comm->dlbFlopWeight > 0)
     {
         dd->comm->flop += force_flop_count(nrnb);
         dd->comm->flop_n++;
@@ -4893,6 +5162,11 @@ static void get_load_distribution(gmx_domdec_t *dd, gmx_wallcycle_t wcycle)
 
     bSepPME = (dd->pme_nodeid >= 0);
 
+    if (comm->dlbFlopWeight > 0)
+    {
+        dd_update_cycles_per_flop(dd);
+    }
+
     if (dd->ndim == 0 && bSepPME)
     {
         /* Without decomposition, but with PME nodes, we need the load */
@@ -6068,6 +6342,23 @@ static int dd_getenv(FILE *fplog, const char *env_var, int def)
     return nst;
 }
 
+/*! \brief Returns the number of constraint couplings to walk out over from the home atoms */
+static int dd_constraint_nrec(const gmx_domdec_t *dd, const t_inputrec *ir)
+{
+    int nrec = ir->nProjOrder;
+
+    if (dd->bRedundantConstrIter)
+    {
+        /* Each LINCS iteration needs the exactly projected coordinates
+         * of all atoms within the matrix expansion of the border
+         * constraints, which requires nProjOrder+1 extra couplings.
+         */
+        nrec += ir->nLincsIter*(ir->nProjOrder + 1);
+    }
+
+    return nrec;
+}
+
 static void dd_warning(t_commrec *cr, FILE *fplog, const char *warn_string)
 {
     if (MASTER(cr))
@@ -6315,6 +6606,20 @@ static void set_dd_limits_and_grid(FILE *fplog, t_commrec *cr, gmx_domdec_t *dd,
     dd->bInterCGcons    = inter_charge_group_constraints(mtop);
     dd->bInterCGsettles = inter_charge_group_settles(mtop);
 
+    /* Instead of communicating before each P-LINCS iteration, we can
+     * compute the iterations of the border constraints redundantly
+     * using a deeper constraint halo. This avoids latency-bound
+     * communication, but increases the minimum cell size.
+     */
+    dd->bRedundantConstrIter =
+        (dd->bInterCGcons && ir->eConstrAlg == econtLINCS &&
+         dd_getenv(fplog, "GMX_DD_REDUNDANT_CONSTR_ITER", 0) != 0);
+    if (dd->bRedundantConstrIter && fplog)
+    {
+        fprintf(fplog, "Will compute the LINCS iterations of the border constraints redundantly, using %d coupled constraints instead of %d\n",
+                dd_constraint_nrec(dd, ir), ir->nProjOrder);
+    }
+
     if (ir->rlist == 0)
     {
         /* Set the cut-off to some very large value,
@@ -6413,7 +6718,7 @@ static void set_dd_limits_and_grid(FILE *fplog, t_commrec *cr, gmx_domdec_t *dd,
     if (dd->bInterCGcons && rconstr <= 0)
     {
         /* There is a cell size limit due to the constraints (P-LINCS) */
-        rconstr = constr_r_max(fplog, mtop, ir);
+        rconstr = constr_r_max(fplog, mtop, ir, dd_constraint_nrec(dd, ir));
         if (fplog)
         {
             fprintf(fplog,
@@ -6901,7 +7206,7 @@ static void print_dd_settings(FILE *fplog, gmx_domdec_t *dd,
         if (dd->bInterCGcons || dd->bInterCGsettles)
         {
             sprintf(buf, "atoms separated by up to %d constraints",
-                    1+ir->nProjOrder);
+                    1+dd_constraint_nrec(dd, ir));
             fprintf(fplog, "%40s  %-7s %6.3f nm\n",
                     buf, "(-rcon)", limit);
         }
@@ -7102,10 +7407,12 @@ static void set_dd_envvar_options(FILE *fplog, gmx_domdec_t *dd, int rank_mysim)
     dd->bSendRecv2      = dd_getenv(fplog, "GMX_DD_USE_SENDRECV2", 0);
     comm->dlb_scale_lim = dd_getenv(fplog, "GMX_DLB_MAX_BOX_SCALING", 10);
     comm->eFlop         = dd_getenv(fplog, "GMX_DLB_BASED_ON_FLOPS", 0);
+    int flopWeight      = dd_getenv(fplog, "GMX_DLB_FLOP_WEIGHT", 0);
     int recload         = dd_getenv(fplog, "GMX_DD_RECORD_LOAD", 1);
     comm->nstDDDump     = dd_getenv(fplog, "GMX_DD_NST_DUMP", 0);
     comm->nstDDDumpGrid = dd_getenv(fplog, "GMX_DD_NST_DUMP_GRID", 0);
     comm->DD_debug      = dd_getenv(fplog, "GMX_DD_DEBUG", 0);
+    comm->bOverlapMoveX = (dd_getenv(fplog, "GMX_DD_NO_MOVEX_OVERLAP", 0) == 0);
 
     if (dd->bSendRecv2 && fplog)
     {
@@ -7127,6 +7434,17 @@ static void set_dd_envvar_options(FILE *fplog, gmx_domdec_t *dd, int rank_mysim)
     else
     {
         comm->bRecordLoad = (wallcycle_have_counter() && recload > 0);
+
+        if (flopWeight > 0)
+        {
+            comm->dlbFlopWeight = std::min(flopWeight, 100)*0.01;
+            if (fplog)
+            {
+                fprintf(fplog, "Will load balance based on %d%% FLOP count and %d%% cycle count\n",
+                        static_cast<int>(comm->dlbFlopWeight*100 + 0.5),
+                        static_cast<int>((1 - comm->dlbFlopWeight)*100 + 0.5));
+            }
+        }
     }
 }
 
@@ -8633,50 +8951,55 @@ static int comp_cgsort(const void *a, const void *b)
 }
 
 static void order_int_cg(int n, const gmx_cgsort_t *sort,
-                         int *a, int *buf)
+                         int *a, int *buf, int nthread)
 {
-    int i;
-
     /* Order the data */
-    for (i = 0; i < n; i++)
+#pragma omp parallel for num_threads(nthread) schedule(static)
+    for (int i = 0; i < n; i++)
     {
         buf[i] = a[sort[i].ind];
     }
 
     /* Copy back to the original array */
-    for (i = 0; i < n; i++)
+#pragma omp parallel for num_threads(nthread) schedule(static)
+    for (int i = 0; i < n; i++)
     {
         a[i] = buf[i];
     }
 }
 
 static void order_vec_cg(int n, const gmx_cgsort_t *sort,
-                         rvec *v, rvec *buf)
+                         rvec *v, rvec *buf, int nthread)
 {
-    int i;
-
     /* Order the data */
-    for (i = 0; i < n; i++)
+#pragma omp parallel for num_threads(nthread) schedule(static)
+    for (int i = 0; i < n; i++)
     {
         copy_rvec(v[sort[i].ind], buf[i]);
     }
 
     /* Copy back to the original array */
-    for (i = 0; i < n; i++)
+#pragma omp parallel for num_threads(nthread) schedule(static)
+    for (int i = 0; i < n; i++)
     {
         copy_rvec(buf[i], v[i]);
     }
 }
 
+/*! \brief Reorders \p v using \p sort
+ *
+ * Only the reordering without charge groups (cgindex=nullptr)
+ * uses \p nthread threads.
+ */
 static void order_vec_atom(int ncg, const int *cgindex, const gmx_cgsort_t *sort,
-                           rvec *v, rvec *buf)
+                           rvec *v, rvec *buf, int nthread)
 {
     int a, atot, cg, cg0, cg1, i;
 
     if (cgindex == nullptr)
     {
         /* Avoid the useless loop of the atoms within a cg */
-        order_vec_cg(ncg, sort, v, buf);
+        order_vec_cg(ncg, sort, v, buf, nthread);
 
         return;
     }
@@ -8858,9 +9181,12 @@ static void dd_sort_state(gmx_domdec_t *dd, rvec *cgcm, t_forcerec *fr, t_state
     int               *cgindex;
     int                ncg_new, i, *ibuf, cgsize;
     rvec              *vbuf;
+    int                nthread;
 
     sort = dd->comm->sort;
 
+    nthread = gmx_omp_nthreads_get(emntDomdec);
+
     if (dd->ncg_home > sort->sort_nalloc)
     {
         sort->sort_nalloc = over_alloc_dd(dd->ncg_home);
@@ -8906,21 +9232,21 @@ static void dd_sort_state(gmx_domdec_t *dd, rvec *cgcm, t_forcerec *fr, t_state
     /* Reorder the state */
     if (state->flags & (1 << estX))
     {
-        order_vec_atom(dd->ncg_home, cgindex, cgsort, as_rvec_array(state->x.data()), vbuf);
+        order_vec_atom(dd->ncg_home, cgindex, cgsort, as_rvec_array(state->x.data()), vbuf, nthread);
     }
     if (state->flags & (1 << estV))
     {
-        order_vec_atom(dd->ncg_home, cgindex, cgsort, as_rvec_array(state->v.data()), vbuf);
+        order_vec_atom(dd->ncg_home, cgindex, cgsort, as_rvec_array(state->v.data()), vbuf, nthread);
     }
     if (state->flags & (1 << estCGP))
     {
-        order_vec_atom(dd->ncg_home, cgindex, cgsort, as_rvec_array(state->cg_p.data()), vbuf);
+        order_vec_atom(dd->ncg_home, cgindex, cgsort, as_rvec_array(state->cg_p.data()), vbuf, nthread);
     }
 
     if (fr->cutoff_scheme == ecutsGROUP)
     {
         /* Reorder cgcm */
-        order_vec_cg(dd->ncg_home, cgsort, cgcm, vbuf);
+        order_vec_cg(dd->ncg_home, cgsort, cgcm, vbuf, nthread);
     }
 
     if (dd->ncg_home+1 > sort->ibuf_nalloc)
@@ -8930,9 +9256,9 @@ static void dd_sort_state(gmx_domdec_t *dd, rvec *cgcm, t_forcerec *fr, t_state
     }
     ibuf = sort->ibuf;
     /* Reorder the global cg index */
-    order_int_cg(dd->ncg_home, cgsort, dd->index_gl, ibuf);
+    order_int_cg(dd->ncg_home, cgsort, dd->index_gl, ibuf, nthread);
     /* Reorder the cginfo */
-    order_int_cg(dd->ncg_home, cgsort, fr->cginfo, ibuf);
+    order_int_cg(dd->ncg_home, cgsort, fr->cginfo, ibuf, nthread);
     /* Rebuild the local cg index */
     if (dd->comm->bCGs)
     {
@@ -8949,9 +9275,10 @@ static void dd_sort_state(gmx_domdec_t *dd, rvec *cgcm, t_forcerec *fr, t_state
     }
     else
     {
-        for (i = 0; i < dd->ncg_home+1; i++)
+#pragma omp parallel for num_threads(nthread) schedule(static)
+        for (int cg = 0; cg < dd->ncg_home+1; cg++)
         {
-            dd->cgindex[i] = i;
+            dd->cgindex[cg] = cg;
         }
     }
     /* Set the home atom number */
@@ -9573,7 +9900,7 @@ void dd_partition_system(FILE                *fplog,
                 {
                     /* Only for inter-cg constraints we need special code */
                     n = dd_make_local_constraints(dd, n, top_global, fr->cginfo,
-                                                  constr, ir->nProjOrder,
+                                                  constr, dd_constraint_nrec(dd, ir),
                                                   top_local->idef.il);
                 }
                 break;
@@ -240,6 +240,19 @@ float dd_pme_f_ratio(struct gmx_domdec_t *dd);
 /*! \brief Communicate the coordinates to the neighboring cells and do pbc. */
 void dd_move_x(struct gmx_domdec_t *dd, matrix box, rvec x[]);
 
+/*! \brief Start communicating the coordinates to the neighboring cells.
+ *
+ * Starts a non-blocking communication of the first pulse, which only
+ * involves home atoms, so work on local atoms can overlap with it.
+ * The halo coordinates are only set after dd_move_x_finish has been called,
+ * no other DD communication should occur in between.
+ * With env.var. GMX_DD_NO_MOVEX_OVERLAP set, all communication is done here.
+ */
+void dd_move_x_start(struct gmx_domdec_t *dd, matrix box, rvec x[]);
+
+/*! \brief Complete the coordinate communication started by dd_move_x_start. */
+void dd_move_x_finish(struct gmx_domdec_t *dd, matrix box, rvec x[]);
+
 /*! \brief Sum the forces over the neighboring cells.
  *
  * When fshift!=NULL the shift forces are updated to obtain
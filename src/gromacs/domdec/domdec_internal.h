@@ -1,7 +1,7 @@
 /*
  * This file is part of the GROMACS molecular simulation package.
  *
- * Copyright (c) 2014,2015,2016, by the GROMACS development team, led by
+ * Copyright (c) 2014,2015,2016,2017, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -322,6 +322,13 @@ struct gmx_domdec_comm_t
     int        nalloc_int2;            /**< Allocation size of \p buf_int2 */
     vec_rvec_t vbuf2;                  /**< Another rvec comm. buffer */
 
+    /* Non-blocking communication of the first coordinate pulse */
+    gmx_bool    bOverlapMoveX;         /**< Overlap the first pulse of dd_move_x with local work */
+    int         nreq_move_x;           /**< The number of pending requests, 0 when nothing is pending */
+#if GMX_MPI
+    MPI_Request req_move_x[2];         /**< The requests for the pending send and receive */
+#endif
+
     /* Communication buffers for local redistribution */
     int  **cggl_flag;                  /**< Charge group flag comm. buffers */
     int    cggl_flag_nalloc[DIM*2];    /**< Allocation sizes of \p *cggl_flag */
@@ -356,6 +363,10 @@ struct gmx_domdec_comm_t
     int    eFlop;
     double flop;                       /**< Total flops counted */
     int    flop_n;                     /**< The number of flop recordings */
+    /** Weight of the flop based prediction in the cycle based DLB load, 0: not used */
+    float  dlbFlopWeight;
+    /** Running average of the force cycles per flop over all PP ranks, used with \p dlbFlopWeight */
+    float  cyclesPerFlop;
     /** How many times did we have load measurements */
     int    n_load_have;
     /** How many times have we collected the load measurements */
@@ -117,6 +117,22 @@ static gmx_bool largest_divisor(int n)
     return ldiv;
 }
 
+/*! \brief Returns TRUE when \p n has a prime factor that is too large for an efficient Cartesian decomposition */
+static gmx_bool has_large_prime_factor(int n)
+{
+    gmx_int64_t ldiv;
+
+    if (n <= 12)
+    {
+        return FALSE;
+    }
+
+    ldiv = largest_divisor(n);
+
+    /* Check if the largest divisor is more than n^2/3 */
+    return (ldiv*ldiv*ldiv > static_cast<gmx_int64_t>(n)*n);
+}
+
 /*! \brief Compute largest common divisor of \p n1 and \b n2 */
 static int lcd(int n1, int n2)
 {
@@ -721,27 +737,18 @@ real dd_choose_grid(FILE *fplog,
                     real cellsize_limit, real cutoff_dd,
                     gmx_bool bInterCGBondeds)
 {
-    gmx_int64_t     nnodes_div, ldiv;
+    int             nnodes_div;
     real            limit;
 
     if (MASTER(cr))
     {
-        nnodes_div = cr->nnodes;
         if (EEL_PME(ir->coulombtype))
         {
-            if (nPmeRanks > 0)
+            if (nPmeRanks > 0 && nPmeRanks >= cr->nnodes)
             {
-                if (nPmeRanks >= cr->nnodes)
-                {
-                    gmx_fatal(FARGS,
-                              "Cannot have %d separate PME ranks with just %d total ranks",
-                              nPmeRanks, cr->nnodes);
-                }
-
-                /* If the user purposely selected the number of PME nodes,
-                 * only check for large primes in the PP node count.
-                 */
-                nnodes_div -= nPmeRanks;
+                gmx_fatal(FARGS,
+                          "Cannot have %d separate PME ranks with just %d total ranks",
+                          nPmeRanks, cr->nnodes);
             }
         }
         else
@@ -749,23 +756,15 @@ real dd_choose_grid(FILE *fplog,
             cr->npmenodes = 0;
         }
 
-        if (nnodes_div > 12)
-        {
-            ldiv = largest_divisor(nnodes_div);
-            /* Check if the largest divisor is more than nnodes^2/3 */
-            if (ldiv*ldiv*ldiv > nnodes_div*nnodes_div)
-            {
-                gmx_fatal(FARGS, "The number of ranks you selected (%d) contains a large prime factor %d. In most cases this will lead to bad performance. Choose a number with smaller prime factors or set the decomposition (option -dd) manually.",
-                          nnodes_div, ldiv);
-            }
-        }
-
         if (EEL_PME(ir->coulombtype))
         {
             if (nPmeRanks < 0)
             {
-                /* Use PME nodes when the number of nodes is more than 16 */
-                if (cr->nnodes <= 18)
+                /* Use PME nodes when the number of nodes is more than 16,
+                 * or when that gives a PP rank count that can be decomposed
+                 * while the total rank count can not.
+                 */
+                if (cr->nnodes <= 18 && !has_large_prime_factor(cr->nnodes))
                 {
                     cr->npmenodes = 0;
                     if (fplog)
@@ -793,6 +792,14 @@ real dd_choose_grid(FILE *fplog,
             }
         }
 
+        /* Only the PP ranks are decomposed, so only check those for large primes */
+        nnodes_div = cr->nnodes - cr->npmenodes;
+        if (has_large_prime_factor(nnodes_div))
+        {
+            gmx_fatal(FARGS, "The number of particle-particle ranks (%d) contains a large prime factor %d. In most cases this will lead to bad performance. Choose a number with smaller prime factors, set the number of separate PME ranks (option -npme) or set the decomposition (option -dd) manually.",
+                      nnodes_div, largest_divisor(nnodes_div));
+        }
+
         limit = optimize_ncells(fplog, cr->nnodes, cr->npmenodes,
                                 bDynLoadBal, dlb_scale,
                                 mtop, box, ddbox, ir, dd,
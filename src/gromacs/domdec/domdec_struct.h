@@ -3,7 +3,7 @@
  *
  * Copyright (c) 1991-2000, University of Groningen, The Netherlands.
  * Copyright (c) 2001-2004, The GROMACS development team.
- * Copyright (c) 2013,2014,2015, by the GROMACS development team, led by
+ * Copyright (c) 2013,2014,2015,2017, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -65,6 +65,7 @@ struct gmx_domdec_specat_comm_t;
 struct gmx_ga2la_t;
 struct gmx_hash_t;
 struct gmx_pme_comm_n_box_t;
+struct gmx_pme_f_recv_t;
 struct gmx_reverse_top_t;
 
 typedef struct {
@@ -136,6 +137,8 @@ struct gmx_domdec_t {
     gmx_pme_comm_n_box_t  *cnb;
     int                    nreq_pme;
     MPI_Request            req_pme[8];
+    /* Non-blocking receive of the PME forces, virial and energy */
+    gmx_pme_f_recv_t      *pme_f_recv;
 
 
     /* The communication setup, identical for each cell, cartesian index */
@@ -158,6 +161,10 @@ struct gmx_domdec_t {
     /* Are there inter charge group constraints */
     gmx_bool bInterCGcons;
     gmx_bool bInterCGsettles;
+    /* Compute the P-LINCS iterations of the border constraints redundantly,
+     * instead of communicating coordinates before each iteration
+     */
+    gmx_bool bRedundantConstrIter;
 
     /* Global atom number to interaction list */
     gmx_reverse_top_t  *reverse_top;
@@ -347,6 +347,14 @@ int copy_fftgrid_to_pmegrid(struct gmx_pme_t *pme, const real *fftgrid, real *pm
     ixy0 = ((thread  )*local_fft_ndata[XX]*local_fft_ndata[YY])/nthread;
     ixy1 = ((thread+1)*local_fft_ndata[XX]*local_fft_ndata[YY])/nthread;
 
+    /* With a single rank the periodic images of a line only depend
+     * on the line itself, so we can fill them here thread-locally,
+     * which saves a pass over the grid and a thread synchronization.
+     */
+    const bool bPeriodic = (pme->nnodes == 1);
+    const int  overlap   = pme->pme_order - 1;
+    const int  nz_copy   = local_fft_ndata[ZZ] + overlap;
+
     for (ixy = ixy0; ixy < ixy1; ixy++)
     {
         ix = ixy/local_fft_ndata[YY];
@@ -358,6 +366,31 @@ int copy_fftgrid_to_pmegrid(struct gmx_pme_t *pme, const real *fftgrid, real *pm
         {
             pmegrid[pmeidx+iz] = fftgrid[fftidx+iz];
         }
+
+        if (bPeriodic)
+        {
+            const real *line = pmegrid + pmeidx;
+
+            for (iz = 0; iz < overlap; iz++)
+            {
+                pmegrid[pmeidx+local_fft_ndata[ZZ]+iz] = line[iz];
+            }
+            for (int jx = 0; jx < (ix < overlap ? 2 : 1); jx++)
+            {
+                for (int jy = 0; jy < (iy < overlap ? 2 : 1); jy++)
+                {
+                    if (jx > 0 || jy > 0)
+                    {
+                        int imageidx = ((ix + jx*local_fft_ndata[XX])*local_pme_size[YY] +
+                                        iy + jy*local_fft_ndata[YY])*local_pme_size[ZZ];
+                        for (iz = 0; iz < nz_copy; iz++)
+                        {
+                            pmegrid[imageidx+iz] = line[iz];
+                        }
+                    }
+                }
+            }
+        }
     }
 
 #ifdef PME_TIME_THREADS
@@ -65,6 +65,12 @@ gmx_sum_qgrid_dd(struct gmx_pme_t *pme, real *grid, int direction);
 int
 copy_pmegrid_to_fftgrid(const gmx_pme_t *pme, real *pmegrid, real *fftgrid, int grid_index);
 
+/*! \brief Copy the part of \p thread of the FFT grid to the PME grid
+ *
+ * With a single PME rank this also fills the periodic overlap of
+ * the copied lines, so unwrap_periodic_pmegrid is not needed and
+ * threads can gather from the grid after a barrier.
+ */
 int
 copy_fftgrid_to_pmegrid(struct gmx_pme_t *pme, const real *fftgrid, real *pmegrid, int grid_index,
                         int nthread, int thread);
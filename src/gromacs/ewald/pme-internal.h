@@ -96,14 +96,15 @@ static const real lb_scale_factor_symm[] = { 2.0/64, 12.0/64, 30.0/64, 20.0/64 }
  */
 #define PME_ORDER_MAX 12
 
-/*! \brief As gmx_pme_init, but takes most settings, except the grid/Ewald coefficients, from pme_src.
- * This is only called when the PME cut-off/grid size changes.
+/*! \brief As gmx_pme_init, but takes most settings, except the grid/order/Ewald coefficients, from pme_src.
+ * This is only called when the PME cut-off/grid size/interpolation order changes.
  */
 int gmx_pme_reinit(struct gmx_pme_t **pmedata,
                    t_commrec *        cr,
                    struct gmx_pme_t * pme_src,
                    const t_inputrec * ir,
                    ivec               grid_size,
+                   int                pme_order,
                    real               ewaldcoeff_q,
                    real               ewaldcoeff_lj);
 
@@ -158,6 +159,9 @@ typedef real *splinevec[DIM];
 typedef struct {
     int       n;
     int      *ind;
+    int      *ind_sort;          /* Buffer for sorting ind, same size as ind */
+    int      *sort_count;        /* Atom counts per grid column for sorting */
+    int       sort_count_nalloc; /* Allocation size of sort_count */
     splinevec theta;
     real     *ptr_theta_z;
     splinevec dtheta;
@@ -348,8 +352,8 @@ void gmx_pme_check_restrictions(int pme_order,
 /*! \brief Initialize the PME-only side of the PME <-> PP communication */
 gmx_pme_pp_t gmx_pme_pp_init(t_commrec *cr);
 
-/*! \brief Tell our PME-only node to switch to a new grid size */
-void gmx_pme_send_switchgrid(t_commrec *cr, ivec grid_size, real ewaldcoeff_q, real ewaldcoeff_lj);
+/*! \brief Tell our PME-only node to switch to a new grid size and interpolation order */
+void gmx_pme_send_switchgrid(t_commrec *cr, ivec grid_size, int pme_order, real ewaldcoeff_q, real ewaldcoeff_lj);
 
 /*! \brief Return values for gmx_pme_recv_q_x */
 enum {
@@ -364,7 +368,7 @@ enum {
  * The return value is used to control further processing, with meanings:
  * pmerecvqxX:             all parameters set, chargeA and chargeB can be NULL
  * pmerecvqxFINISH:        no parameters set
- * pmerecvqxSWITCHGRID:    only grid_size and *ewaldcoeff are set
+ * pmerecvqxSWITCHGRID:    only grid_size, *pme_order and *ewaldcoeff are set
  * pmerecvqxRESETCOUNTERS: *step is set
  */
 int gmx_pme_recv_coeffs_coords(struct gmx_pme_pp *pme_pp,
@@ -377,7 +381,8 @@ int gmx_pme_recv_coeffs_coords(struct gmx_pme_pp *pme_pp,
                                real *lambda_q, real *lambda_lj,
                                gmx_bool *bEnerVir,
                                gmx_int64_t *step,
-                               ivec grid_size, real *ewaldcoeff_q, real *ewaldcoeff_lj);
+                               ivec grid_size, int *pme_order,
+                               real *ewaldcoeff_q, real *ewaldcoeff_lj);
 
 /*! \brief Send the PME mesh force, virial and energy to the PP-only nodes */
 void gmx_pme_send_force_vir_ener(struct gmx_pme_pp *pme_pp,
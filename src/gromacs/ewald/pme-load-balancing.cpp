@@ -50,8 +50,10 @@
 #include <assert.h>
 
 #include <cmath>
+#include <cstdlib>
 
 #include <algorithm>
+#include <vector>
 
 #include "gromacs/domdec/domdec.h"
 #include "gromacs/domdec/domdec_network.h"
@@ -60,8 +62,11 @@
 #include "gromacs/fft/calcgrid.h"
 #include "gromacs/gmxlib/network.h"
 #include "gromacs/math/functions.h"
+#include "gromacs/math/invertmatrix.h"
+#include "gromacs/math/utilities.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/mdlib/forcerec.h"
+#include "gromacs/mdlib/nb_verlet.h"
 #include "gromacs/mdlib/nbnxn_gpu_data_mgmt.h"
 #include "gromacs/mdlib/sim_util.h"
 #include "gromacs/mdtypes/commrec.h"
@@ -81,10 +86,12 @@
 /*! \brief Parameters and settings for one PP-PME setup */
 struct pme_setup_t {
     real              rcut_coulomb;    /**< Coulomb cut-off                              */
-    real              rlist;           /**< pair-list cut-off                            */
+    real              rlistOuter;      /**< cut-off for the outer pair-list              */
+    real              rlistInner;      /**< cut-off for the inner pair-list              */
     real              spacing;         /**< (largest) PME grid spacing                   */
     ivec              grid;            /**< the PME grid dimensions                      */
     real              grid_efficiency; /**< ineffiency factor for non-uniform grids <= 1 */
+    int               pme_order;       /**< the PME interpolation order                  */
     real              ewaldcoeff_q;    /**< Electrostatic Ewald coefficient            */
     real              ewaldcoeff_lj;   /**< LJ Ewald coefficient, only for the call to send_switchgrid */
     struct gmx_pme_t *pmedata;         /**< the data structure used in the PME code      */
@@ -109,6 +116,11 @@ const real maxRelativeSlowdownAccepted = 1.12;
  */
 const real maxFluctuationAccepted = 1.02;
 
+/*! \brief The highest pme-order tried when tuning the interpolation order */
+const int  maxTunedPmeOrder = 6;
+/*! \brief Ignore reciprocal-space error contributions with a Gaussian factor below exp(-60) */
+const real maxRecipErrorExponent = 60;
+
 /*! \brief Enumeration whose values describe the effect limiting the load balancing */
 enum epmelb {
     epmelblimNO, epmelblimBOX, epmelblimDD, epmelblimPMEGRID, epmelblimNR
@@ -129,8 +141,10 @@ struct pme_load_balancing_t {
     real         cut_spacing;        /**< the minimum cutoff / PME grid spacing ratio */
     real         rcut_vdw;           /**< Vdw cutoff (does not change) */
     real         rcut_coulomb_start; /**< Initial electrostatics cutoff */
-    real         rbuf_coulomb;       /**< the pairlist buffer size */
-    real         rbuf_vdw;           /**< the pairlist buffer size */
+    real         rbufOuter_coulomb;  /**< the outer pairlist buffer size */
+    real         rbufOuter_vdw;      /**< the outer pairlist buffer size */
+    real         rbufInner_coulomb;  /**< the inner pairlist buffer size */
+    real         rbufInner_vdw;      /**< the inner pairlist buffer size */
     matrix       box_start;          /**< the initial simulation box */
     int          n;                  /**< the count of setup as well as the allocation size */
     pme_setup_t *setup;              /**< the PME+cutoff setups */
@@ -142,6 +156,14 @@ struct pme_load_balancing_t {
     int          elimited;           /**< was the balancing limited, uses enum above */
     int          cutoff_scheme;      /**< Verlet or group cut-offs */
 
+    pme_setup_t  setup_start;        /**< the initial setup, setup[0] can get a higher pme-order */
+
+    gmx_bool     bTuneOrder;         /**< try higher pme-order after tuning the cut-off? */
+    real         orderErrorFactor;   /**< allowed increase of the estimated reciprocal error */
+    int          norder;             /**< the number of higher pme-order setups */
+    pme_setup_t *order_setup;        /**< higher pme-order setups with the cut-off of setup[fastest] */
+    int          order_cur;          /**< index in order_setup of the current setup, -1 when not in use */
+
     int          stage;              /**< the current stage */
 
     int          cycles_n;           /**< step cycle counter cummulative count */
@@ -161,6 +183,7 @@ void pme_loadbal_init(pme_load_balancing_t     **pme_lb_p,
                       const t_inputrec          *ir,
                       matrix                     box,
                       const interaction_const_t *ic,
+                      const NbnxnListParameters *listParams,
                       gmx_pme_t                 *pmedata,
                       gmx_bool                   bUseGPU,
                       gmx_bool                  *bPrinting)
@@ -187,8 +210,21 @@ void pme_loadbal_init(pme_load_balancing_t     **pme_lb_p,
 
     pme_lb->cutoff_scheme = ir->cutoff_scheme;
 
-    pme_lb->rbuf_coulomb  = ic->rlist - ic->rcoulomb;
-    pme_lb->rbuf_vdw      = ic->rlist - ic->rvdw;
+    if (pme_lb->cutoff_scheme == ecutsVERLET)
+    {
+        pme_lb->rbufOuter_coulomb = listParams->rlistOuter - ic->rcoulomb;
+        pme_lb->rbufOuter_vdw     = listParams->rlistOuter - ic->rvdw;
+        pme_lb->rbufInner_coulomb = listParams->rlistInner - ic->rcoulomb;
+        pme_lb->rbufInner_vdw     = listParams->rlistInner - ic->rvdw;
+    }
+    else
+    {
+        /* This is unused, but set it for consistency */
+        pme_lb->rbufOuter_coulomb = ic->rlist - ic->rcoulomb;
+        pme_lb->rbufOuter_vdw     = ic->rlist - ic->rvdw;
+        pme_lb->rbufInner_coulomb = pme_lb->rbufOuter_coulomb;
+        pme_lb->rbufInner_vdw     = pme_lb->rbufOuter_vdw;
+    }
 
     copy_mat(box, pme_lb->box_start);
     if (ir->ePBC == epbcXY && ir->nwall == 2)
@@ -204,10 +240,12 @@ void pme_loadbal_init(pme_load_balancing_t     **pme_lb_p,
 
     pme_lb->cur                      = 0;
     pme_lb->setup[0].rcut_coulomb    = ic->rcoulomb;
-    pme_lb->setup[0].rlist           = ic->rlist;
+    pme_lb->setup[0].rlistOuter      = ic->rlist;
+    pme_lb->setup[0].rlistInner      = (listParams != nullptr ? listParams->rlistInner : ic->rlist);
     pme_lb->setup[0].grid[XX]        = ir->nkx;
     pme_lb->setup[0].grid[YY]        = ir->nky;
     pme_lb->setup[0].grid[ZZ]        = ir->nkz;
+    pme_lb->setup[0].pme_order       = ir->pme_order;
     pme_lb->setup[0].ewaldcoeff_q    = ic->ewaldcoeff_q;
     pme_lb->setup[0].ewaldcoeff_lj   = ic->ewaldcoeff_lj;
 
@@ -224,6 +262,8 @@ void pme_loadbal_init(pme_load_balancing_t     **pme_lb_p,
     }
     pme_lb->setup[0].spacing = spm;
 
+    pme_lb->setup_start      = pme_lb->setup[0];
+
     if (ir->fourier_spacing > 0)
     {
         pme_lb->cut_spacing = ir->rcoulomb/ir->fourier_spacing;
@@ -244,6 +284,27 @@ void pme_loadbal_init(pme_load_balancing_t     **pme_lb_p,
     pme_lb->cycles_n = 0;
     pme_lb->cycles_c = 0;
 
+    /* After tuning the cut-off, we try higher interpolation orders with
+     * coarser grids at the same estimated reciprocal-space error.
+     * As the error estimate only covers Coulomb, we skip this with LJ-PME.
+     */
+    pme_lb->bTuneOrder       = (ir->pme_order < maxTunedPmeOrder &&
+                                !EVDW_PME(ir->vdwtype) &&
+                                getenv("GMX_DISABLE_PME_ORDER_TUNING") == nullptr);
+    pme_lb->orderErrorFactor = 1;
+    const char *env          = getenv("GMX_PME_TUNE_ERROR_FACTOR");
+    if (env != nullptr)
+    {
+        pme_lb->orderErrorFactor = strtod(env, nullptr);
+        if (pme_lb->orderErrorFactor < 1)
+        {
+            gmx_fatal(FARGS, "GMX_PME_TUNE_ERROR_FACTOR should be >= 1, not '%s'", env);
+        }
+    }
+    pme_lb->norder           = 0;
+    pme_lb->order_setup      = nullptr;
+    pme_lb->order_cur        = -1;
+
     if (!wallcycle_have_counter())
     {
         GMX_LOG(mdlog.warning).asParagraph().appendText("NOTE: Cycle counters unsupported or not enabled in kernel. Cannot use PME-PP balancing.");
@@ -357,17 +418,21 @@ static gmx_bool pme_loadbal_increase_cutoff(pme_load_balancing_t *pme_lb,
     if (pme_lb->cutoff_scheme == ecutsVERLET)
     {
         /* Never decrease the Coulomb and VdW list buffers */
-        set->rlist        = std::max(set->rcut_coulomb + pme_lb->rbuf_coulomb,
-                                     pme_lb->rcut_vdw + pme_lb->rbuf_vdw);
+        set->rlistOuter   = std::max(set->rcut_coulomb + pme_lb->rbufOuter_coulomb,
+                                     pme_lb->rcut_vdw + pme_lb->rbufOuter_vdw);
+        set->rlistInner   = std::max(set->rcut_coulomb + pme_lb->rbufInner_coulomb,
+                                     pme_lb->rcut_vdw + pme_lb->rbufInner_vdw);
     }
     else
     {
-        tmpr_coulomb          = set->rcut_coulomb + pme_lb->rbuf_coulomb;
-        tmpr_vdw              = pme_lb->rcut_vdw + pme_lb->rbuf_vdw;
-        set->rlist            = std::min(tmpr_coulomb, tmpr_vdw);
+        tmpr_coulomb          = set->rcut_coulomb + pme_lb->rbufOuter_coulomb;
+        tmpr_vdw              = pme_lb->rcut_vdw + pme_lb->rbufOuter_vdw;
+        set->rlistOuter       = std::min(tmpr_coulomb, tmpr_vdw);
+        set->rlistInner       = set->rlistOuter;
     }
 
     set->spacing      = sp;
+    set->pme_order    = pme_order;
     /* The grid efficiency is the size wrt a grid with uniform x/y/z spacing */
     set->grid_efficiency = 1;
     for (d = 0; d < DIM; d++)
@@ -392,14 +457,305 @@ static gmx_bool pme_loadbal_increase_cutoff(pme_load_balancing_t *pme_lb,
     return TRUE;
 }
 
+/*! \brief Return the B-spline aliasing sums eps_1 and eps_2 for grid index m
+ *
+ * These are the same polynomials as used in the reciprocal-space
+ * error estimate of gmx pme_error.
+ */
+static void pme_spline_alias_sums(int m, int K, int pme_order,
+                                  double *eps1, double *eps2)
+{
+    /* The number of aliases on each side included in the sums */
+    const int numAliases = 6;
+
+    if (m == 0)
+    {
+        *eps1 = 0;
+        *eps2 = 0;
+
+        return;
+    }
+
+    double sum1      = 0;
+    double sum2      = 0;
+    double sumAll    = 0;
+    for (int i = -numAliases; i <= numAliases; i++)
+    {
+        double t = std::pow(2*M_PI*(m/static_cast<double>(K) + i), -pme_order);
+        sumAll  += t;
+        if (i != 0)
+        {
+            sum1 += t;
+            sum2 += t*t;
+        }
+    }
+    *eps1 = -sum1/sumAll;
+    *eps2 = sum2/(sumAll*sumAll) + (*eps1)*(*eps1);
+}
+
+double pme_loadbal_recip_error_estimate(const matrix box, const ivec grid,
+                                        int pme_order, real ewaldcoeff_q)
+{
+    matrix                           recipbox;
+    std::vector<double>              eps1[DIM], eps2[DIM];
+
+    gmx::invertBoxMatrix(box, recipbox);
+
+    for (int d = 0; d < DIM; d++)
+    {
+        eps1[d].resize(grid[d] + 1);
+        eps2[d].resize(grid[d] + 1);
+        for (int m = -grid[d]/2; m <= grid[d]/2; m++)
+        {
+            pme_spline_alias_sums(m, grid[d], pme_order,
+                                  &eps1[d][m + grid[d]/2], &eps2[d][m + grid[d]/2]);
+        }
+    }
+
+    /* The summand is even in m, so we sum over half of the m-vectors:
+     * mx > 0, mx = 0 and my > 0, mx = my = 0 and mz > 0.
+     */
+    double volume  = det(box);
+    double beta2   = gmx::square(ewaldcoeff_q);
+    double sum     = 0;
+    for (int mx = 0; mx <= grid[XX]/2; mx++)
+    {
+        const int ix = mx + grid[XX]/2;
+
+        for (int my = (mx == 0 ? 0 : -grid[YY]/2); my <= grid[YY]/2; my++)
+        {
+            const int iy = my + grid[YY]/2;
+
+            /* The reciprocal vectors are the columns of recipbox */
+            rvec      kxy;
+            for (int d = 0; d < DIM; d++)
+            {
+                kxy[d] = mx*recipbox[d][XX] + my*recipbox[d][YY];
+            }
+
+            for (int mz = (mx == 0 && my == 0 ? 1 : -grid[ZZ]/2); mz <= grid[ZZ]/2; mz++)
+            {
+                double k2 = 0;
+                for (int d = 0; d < DIM; d++)
+                {
+                    k2 += gmx::square(kxy[d] + mz*recipbox[d][ZZ]);
+                }
+                double exponent = M_PI*M_PI*k2/beta2;
+                if (2*exponent > maxRecipErrorExponent)
+                {
+                    continue;
+                }
+                double coeff = std::exp(-exponent)/(2*M_PI*volume*k2);
+
+                int    iz    = mz + grid[ZZ]/2;
+                double e1sum = eps1[XX][ix] + eps1[YY][iy] + eps1[ZZ][iz];
+                double t     = (eps2[XX][ix] + eps2[YY][iy] + eps2[ZZ][iz] +
+                                2*(eps1[XX][ix]*eps1[YY][iy] +
+                                   eps1[ZZ][iz]*eps1[YY][iy] +
+                                   eps1[ZZ][iz]*eps1[XX][ix]) +
+                                e1sum*e1sum);
+
+                sum += coeff*coeff*k2*t;
+            }
+        }
+    }
+
+    return std::sqrt(2*sum);
+}
+
+/*! \brief Find the coarsest grid for pme_order with an error of at most maxError
+ *
+ * Returns in \p set a copy of \p base with the grid and spacing changed,
+ * returns FALSE when no grid with a small enough error was found.
+ * As the error increases with the spacing, we can bisect over the grids.
+ */
+static gmx_bool pme_loadbal_coarsest_order_grid(const pme_load_balancing_t *pme_lb,
+                                                const pme_setup_t          *base,
+                                                int                         pme_order,
+                                                double                      maxError,
+                                                int                         npmeranks_x,
+                                                pme_setup_t                *set)
+{
+    /* Collect the allowed grids, with increasing spacing */
+    std::vector<pme_setup_t> grids;
+    real                     sp_prev = 0;
+    for (real fac = 1; fac <= 2.1; fac *= 1.01)
+    {
+        pme_setup_t grid = *base;
+        gmx_bool    grid_ok;
+
+        clear_ivec(grid.grid);
+        grid.spacing = calcFftGrid(nullptr, pme_lb->box_start,
+                                   fac*base->spacing,
+                                   minimalPmeGridSize(pme_order),
+                                   &grid.grid[XX], &grid.grid[YY], &grid.grid[ZZ]);
+        if (grid.spacing <= 1.001*sp_prev)
+        {
+            continue;
+        }
+        sp_prev = grid.spacing;
+
+        gmx_pme_check_restrictions(pme_order,
+                                   grid.grid[XX], grid.grid[YY], grid.grid[ZZ],
+                                   npmeranks_x,
+                                   TRUE,
+                                   FALSE,
+                                   &grid_ok);
+        if (grid_ok)
+        {
+            grids.push_back(grid);
+        }
+    }
+
+    /* grids[ok] has a small enough error, grids[tooLarge] not */
+    int ok       = -1;
+    int tooLarge = static_cast<int>(grids.size());
+    while (tooLarge - ok > 1)
+    {
+        int mid = (ok + tooLarge)/2;
+        if (pme_loadbal_recip_error_estimate(pme_lb->box_start, grids[mid].grid,
+                                             pme_order, base->ewaldcoeff_q) <= maxError)
+        {
+            ok       = mid;
+        }
+        else
+        {
+            tooLarge = mid;
+        }
+    }
+    if (ok < 0)
+    {
+        return FALSE;
+    }
+
+    *set = grids[ok];
+
+    return TRUE;
+}
+
+/*! \brief Set up the higher pme-order setups with coarser grids for setup[fastest]
+ *
+ * For each order up to maxTunedPmeOrder, the coarsest grid is chosen for
+ * which the estimated reciprocal-space error is at most orderErrorFactor
+ * times that of the fastest setup. The cut-off and Ewald coefficients are
+ * not changed, so the real-space error is also unchanged.
+ * Setups that do not reduce the number of grid points are not used.
+ * The setups are stored separately from setup, so that stays sorted
+ * by increasing cut-off.
+ * As the error estimates are expensive, only the DD master computes them.
+ */
+static void pme_loadbal_init_order_setups(pme_load_balancing_t *pme_lb,
+                                          t_commrec            *cr)
+{
+    const pme_setup_t *base = &pme_lb->setup[pme_lb->fastest];
+
+    pme_lb->norder = 0;
+    srenew(pme_lb->order_setup, maxTunedPmeOrder - base->pme_order);
+
+    if (!DOMAINDECOMP(cr) || DDMASTER(cr->dd))
+    {
+        int npmeranks_x, npmeranks_y;
+
+        get_pme_nnodes(cr->dd, &npmeranks_x, &npmeranks_y);
+
+        const double maxError =
+            pme_lb->orderErrorFactor*pme_loadbal_recip_error_estimate(pme_lb->box_start, base->grid,
+                                                                      base->pme_order, base->ewaldcoeff_q);
+
+        for (int pme_order = base->pme_order + 1; pme_order <= maxTunedPmeOrder; pme_order++)
+        {
+            pme_setup_t set;
+
+            if (!pme_loadbal_coarsest_order_grid(pme_lb, base, pme_order, maxError,
+                                                 npmeranks_x, &set) ||
+                set.grid[XX]*set.grid[YY]*set.grid[ZZ] >=
+                base->grid[XX]*base->grid[YY]*base->grid[ZZ])
+            {
+                continue;
+            }
+
+            set.pme_order       = pme_order;
+            set.grid_efficiency = 1;
+            for (int d = 0; d < DIM; d++)
+            {
+                set.grid_efficiency *= (set.grid[d]*set.spacing)/norm(pme_lb->box_start[d]);
+            }
+            set.pmedata = nullptr;
+            set.count   = 0;
+            set.cycles  = 0;
+
+            pme_lb->order_setup[pme_lb->norder++] = set;
+
+            if (debug)
+            {
+                fprintf(debug, "PME loadbal: grid %d %d %d, pme-order %d, coulomb cutoff %f\n",
+                        set.grid[XX], set.grid[YY], set.grid[ZZ], set.pme_order, set.rcut_coulomb);
+            }
+        }
+    }
+
+    if (DOMAINDECOMP(cr))
+    {
+        dd_bcast(cr->dd, sizeof(pme_lb->norder), &pme_lb->norder);
+        if (pme_lb->norder > 0)
+        {
+            dd_bcast(cr->dd, pme_lb->norder*sizeof(*pme_lb->order_setup), pme_lb->order_setup);
+        }
+    }
+}
+
+/*! \brief Store the fastest higher pme-order setup in setup[fastest], when it is faster
+ *
+ * Only the grid and interpolation order of setup[fastest] change,
+ * so setup stays sorted by cut-off.
+ * The PME data structures are swapped, so each one stays owned
+ * by exactly one setup.
+ */
+static void pme_loadbal_select_order_setup(pme_load_balancing_t *pme_lb)
+{
+    pme_setup_t *base = &pme_lb->setup[pme_lb->fastest];
+
+    for (int o = 0; o < pme_lb->norder; o++)
+    {
+        pme_setup_t *set = &pme_lb->order_setup[o];
+
+        if (set->count >= 2 && set->cycles < base->cycles)
+        {
+            copy_ivec(set->grid, base->grid);
+            base->spacing         = set->spacing;
+            base->grid_efficiency = set->grid_efficiency;
+            base->pme_order       = set->pme_order;
+            std::swap(base->pmedata, set->pmedata);
+            base->cycles          = set->cycles;
+        }
+    }
+
+    pme_lb->order_cur = -1;
+    pme_lb->cur       = pme_lb->fastest;
+}
+
+/*! \brief Return the setup in use, which is a pme-order setup while timing those */
+static pme_setup_t *pme_loadbal_current_setup(pme_load_balancing_t *pme_lb)
+{
+    if (pme_lb->order_cur >= 0)
+    {
+        return &pme_lb->order_setup[pme_lb->order_cur];
+    }
+    else
+    {
+        return &pme_lb->setup[pme_lb->cur];
+    }
+}
+
 /*! \brief Print the PME grid */
 static void print_grid(FILE *fp_err, FILE *fp_log,
                        const char *pre,
                        const char *desc,
                        const pme_setup_t *set,
+                       int pme_order_start,
                        double cycles)
 {
-    char buf[STRLEN], buft[STRLEN];
+    char buf[STRLEN], buft[STRLEN], bufo[STRLEN];
 
     if (cycles >= 0)
     {
@@ -409,9 +765,17 @@ static void print_grid(FILE *fp_err, FILE *fp_log,
     {
         buft[0] = '\0';
     }
-    sprintf(buf, "%-11s%10s pme grid %d %d %d, coulomb cutoff %.3f%s",
+    if (set->pme_order != pme_order_start)
+    {
+        sprintf(bufo, ", order %d", set->pme_order);
+    }
+    else
+    {
+        bufo[0] = '\0';
+    }
+    sprintf(buf, "%-11s%10s pme grid %d %d %d%s, coulomb cutoff %.3f%s",
             pre,
-            desc, set->grid[XX], set->grid[YY], set->grid[ZZ], set->rcut_coulomb,
+            desc, set->grid[XX], set->grid[YY], set->grid[ZZ], bufo, set->rcut_coulomb,
             buft);
     if (fp_err != nullptr)
     {
@@ -542,7 +906,7 @@ pme_load_balance(pme_load_balancing_t      *pme_lb,
         cycles /= cr->nnodes;
     }
 
-    set = &pme_lb->setup[pme_lb->cur];
+    set = pme_loadbal_current_setup(pme_lb);
     set->count++;
 
     rtab = ir->rlist + ir->tabext;
@@ -556,7 +920,7 @@ pme_load_balance(pme_load_balancing_t      *pme_lb,
     }
 
     sprintf(buf, "step %4s: ", gmx_step_str(step, sbuf));
-    print_grid(fp_err, fp_log, buf, "timed with", set, cycles);
+    print_grid(fp_err, fp_log, buf, "timed with", set, pme_lb->setup_start.pme_order, cycles);
 
     if (set->count <= 2)
     {
@@ -565,7 +929,8 @@ pme_load_balance(pme_load_balancing_t      *pme_lb,
     else
     {
         if (cycles*maxFluctuationAccepted < set->cycles &&
-            pme_lb->stage == pme_lb->nstage - 1)
+            pme_lb->stage == pme_lb->nstage - 1 &&
+            pme_lb->order_cur < 0)
         {
             /* The performance went up a lot (due to e.g. DD load balancing).
              * Add a stage, keep the minima, but rescan all setups.
@@ -585,7 +950,8 @@ pme_load_balance(pme_load_balancing_t      *pme_lb,
         set->cycles = std::min(set->cycles, cycles);
     }
 
-    if (set->cycles < pme_lb->setup[pme_lb->fastest].cycles)
+    if (pme_lb->order_cur < 0 &&
+        set->cycles < pme_lb->setup[pme_lb->fastest].cycles)
     {
         pme_lb->fastest = pme_lb->cur;
 
@@ -603,7 +969,7 @@ pme_load_balance(pme_load_balancing_t      *pme_lb,
              * better overal performance can be obtained with a slightly
              * shorter cut-off and better DD load balancing.
              */
-            set_dd_dlb_max_cutoff(cr, pme_lb->setup[pme_lb->fastest].rlist);
+            set_dd_dlb_max_cutoff(cr, pme_lb->setup[pme_lb->fastest].rlistOuter);
         }
     }
     cycles_fast = pme_lb->setup[pme_lb->fastest].cycles;
@@ -645,7 +1011,7 @@ pme_load_balance(pme_load_balancing_t      *pme_lb,
 
             if (OK && ir->ePBC != epbcNONE)
             {
-                OK = (gmx::square(pme_lb->setup[pme_lb->cur+1].rlist)
+                OK = (gmx::square(pme_lb->setup[pme_lb->cur+1].rlistOuter)
                       <= max_cutoff2(ir->ePBC, state->box));
                 if (!OK)
                 {
@@ -660,7 +1026,7 @@ pme_load_balance(pme_load_balancing_t      *pme_lb,
                 if (DOMAINDECOMP(cr))
                 {
                     OK = change_dd_cutoff(cr, state, ir,
-                                          pme_lb->setup[pme_lb->cur].rlist);
+                                          pme_lb->setup[pme_lb->cur].rlistOuter);
                     if (!OK)
                     {
                         /* Failed: do not use this setup */
@@ -690,7 +1056,21 @@ pme_load_balance(pme_load_balancing_t      *pme_lb,
                  pme_lb->setup[pme_lb->cur-1].grid_efficiency*relativeEfficiencyFactor));
     }
 
-    if (pme_lb->stage > 0 && pme_lb->end == 1)
+    if (pme_lb->order_cur >= 0)
+    {
+        /* Time the higher pme-order setups one after the other */
+        if (pme_lb->order_cur + 1 < pme_lb->norder)
+        {
+            pme_lb->order_cur++;
+        }
+        else
+        {
+            /* We are done optimizing, use the fastest setup we found */
+            pme_loadbal_select_order_setup(pme_lb);
+            pme_lb->stage = pme_lb->nstage;
+        }
+    }
+    else if (pme_lb->stage > 0 && pme_lb->end == 1)
     {
         pme_lb->cur   = pme_lb->lower_limit;
         pme_lb->stage = pme_lb->nstage;
@@ -730,14 +1110,31 @@ pme_load_balance(pme_load_balancing_t      *pme_lb,
         }
     }
 
+    if (pme_lb->stage == pme_lb->nstage && pme_lb->bTuneOrder)
+    {
+        /* With the cut-off tuned, try higher pme-order with coarser grids.
+         * We do this only once, the DLB triggered rounds only scan cut-offs.
+         */
+        pme_lb->bTuneOrder = FALSE;
+        pme_loadbal_init_order_setups(pme_lb, cr);
+        if (pme_lb->norder > 0)
+        {
+            pme_lb->order_cur = 0;
+            pme_lb->stage     = pme_lb->nstage - 1;
+            pme_lb->cur       = pme_lb->fastest;
+        }
+    }
+
     if (DOMAINDECOMP(cr) && pme_lb->stage > 0)
     {
-        OK = change_dd_cutoff(cr, state, ir, pme_lb->setup[pme_lb->cur].rlist);
+        OK = change_dd_cutoff(cr, state, ir, pme_lb->setup[pme_lb->cur].rlistOuter);
         if (!OK)
         {
             /* For some reason the chosen cut-off is incompatible with DD.
              * We should continue scanning a more limited range of cut-off's.
+             * We no longer time the pme-order setups for this cut-off.
              */
+            pme_lb->order_cur   = -1;
             if (pme_lb->cur > 1 && pme_lb->stage == pme_lb->nstage)
             {
                 /* stage=nstage says we're finished, but we should continue
@@ -765,10 +1162,15 @@ pme_load_balance(pme_load_balancing_t      *pme_lb,
 
     /* Change the Coulomb cut-off and the PME grid */
 
-    set = &pme_lb->setup[pme_lb->cur];
+    set = pme_loadbal_current_setup(pme_lb);
 
     ic->rcoulomb     = set->rcut_coulomb;
-    ic->rlist        = set->rlist;
+    ic->rlist        = set->rlistOuter;
+    if (pme_lb->cutoff_scheme == ecutsVERLET && nbv != nullptr)
+    {
+        nbv->listParams.rlistOuter = set->rlistOuter;
+        nbv->listParams.rlistInner = set->rlistInner;
+    }
     ic->ewaldcoeff_q = set->ewaldcoeff_q;
     /* TODO: centralize the code that sets the potentials shifts */
     if (ic->coulomb_modifier == eintmodPOTSHIFT)
@@ -818,31 +1220,33 @@ pme_load_balance(pme_load_balancing_t      *pme_lb,
 
     if (!pme_lb->bSepPMERanks)
     {
-        if (pme_lb->setup[pme_lb->cur].pmedata == nullptr)
+        if (set->pmedata == nullptr)
         {
             /* Generate a new PME data structure,
              * copying part of the old pointers.
              */
             gmx_pme_reinit(&set->pmedata,
                            cr, pme_lb->setup[0].pmedata, ir,
-                           set->grid, set->ewaldcoeff_q, set->ewaldcoeff_lj);
+                           set->grid, set->pme_order,
+                           set->ewaldcoeff_q, set->ewaldcoeff_lj);
         }
         *pmedata = set->pmedata;
     }
     else
     {
         /* Tell our PME-only rank to switch grid */
-        gmx_pme_send_switchgrid(cr, set->grid, set->ewaldcoeff_q, set->ewaldcoeff_lj);
+        gmx_pme_send_switchgrid(cr, set->grid, set->pme_order,
+                                set->ewaldcoeff_q, set->ewaldcoeff_lj);
     }
 
     if (debug)
     {
-        print_grid(nullptr, debug, "", "switched to", set, -1);
+        print_grid(nullptr, debug, "", "switched to", set, pme_lb->setup_start.pme_order, -1);
     }
 
     if (pme_lb->stage == pme_lb->nstage)
     {
-        print_grid(fp_err, fp_log, "", "optimal", set, -1);
+        print_grid(fp_err, fp_log, "", "optimal", set, pme_lb->setup_start.pme_order, -1);
     }
 }
 
@@ -1039,11 +1443,11 @@ static void print_pme_loadbal_setting(FILE              *fplog,
                                       const pme_setup_t *setup)
 {
     fprintf(fplog,
-            "   %-7s %6.3f nm %6.3f nm     %3d %3d %3d   %5.3f nm  %5.3f nm\n",
+            "   %-7s %6.3f nm %6.3f nm     %3d %3d %3d   %5.3f nm  %5.3f nm   %2d\n",
             name,
-            setup->rcut_coulomb, setup->rlist,
+            setup->rcut_coulomb, setup->rlistOuter,
             setup->grid[XX], setup->grid[YY], setup->grid[ZZ],
-            setup->spacing, 1/setup->ewaldcoeff_q);
+            setup->spacing, 1/setup->ewaldcoeff_q, setup->pme_order);
 }
 
 /*! \brief Print all load-balancing settings */
@@ -1055,10 +1459,10 @@ static void print_pme_loadbal_settings(pme_load_balancing_t *pme_lb,
     double     pp_ratio, grid_ratio;
     real       pp_ratio_temporary;
 
-    pp_ratio_temporary = pme_lb->setup[pme_lb->cur].rlist / pme_lb->setup[0].rlist;
+    pp_ratio_temporary = pme_lb->setup[pme_lb->cur].rlistOuter / pme_lb->setup[0].rlistOuter;
     pp_ratio           = gmx::power3(pp_ratio_temporary);
     grid_ratio         = pme_grid_points(&pme_lb->setup[pme_lb->cur])/
-        (double)pme_grid_points(&pme_lb->setup[0]);
+        (double)pme_grid_points(&pme_lb->setup_start);
 
     fprintf(fplog, "\n");
     fprintf(fplog, "       P P   -   P M E   L O A D   B A L A N C I N G\n");
@@ -1078,8 +1482,8 @@ static void print_pme_loadbal_settings(pme_load_balancing_t *pme_lb,
     }
     fprintf(fplog, " PP/PME load balancing changed the cut-off and PME settings:\n");
     fprintf(fplog, "           particle-particle                    PME\n");
-    fprintf(fplog, "            rcoulomb  rlist            grid      spacing   1/beta\n");
-    print_pme_loadbal_setting(fplog, "initial", &pme_lb->setup[0]);
+    fprintf(fplog, "            rcoulomb  rlist            grid      spacing   1/beta   order\n");
+    print_pme_loadbal_setting(fplog, "initial", &pme_lb->setup_start);
     print_pme_loadbal_setting(fplog, "final", &pme_lb->setup[pme_lb->cur]);
     fprintf(fplog, " cost-ratio           %4.2f             %4.2f\n",
             pp_ratio, grid_ratio);
@@ -1103,7 +1507,8 @@ void pme_loadbal_done(pme_load_balancing_t *pme_lb,
                       const gmx::MDLogger  &mdlog,
                       gmx_bool              bNonBondedOnGPU)
 {
-    if (fplog != nullptr && (pme_lb->cur > 0 || pme_lb->elimited != epmelblimNO))
+    if (fplog != nullptr && (pme_lb->cur > 0 || pme_lb->elimited != epmelblimNO ||
+                             pme_lb->setup[0].pme_order != pme_lb->setup_start.pme_order))
     {
         print_pme_loadbal_settings(pme_lb, fplog, mdlog, bNonBondedOnGPU);
     }
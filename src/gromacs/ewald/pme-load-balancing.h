@@ -46,10 +46,12 @@
 #ifndef GMX_EWALD_PME_LOAD_BALANCING_H
 #define GMX_EWALD_PME_LOAD_BALANCING_H
 
+#include "gromacs/math/vectypes.h"
 #include "gromacs/mdtypes/forcerec.h"
 #include "gromacs/mdtypes/interaction_const.h"
 #include "gromacs/timing/wallcycle.h"
 
+struct NbnxnListParameters;
 struct t_commrec;
 struct t_inputrec;
 class t_state;
@@ -72,6 +74,8 @@ bool pme_loadbal_is_active(const pme_load_balancing_t *pme_lb);
  * Returns in bPrinting whether the load balancing is printing to fp_err.
  * The PME grid in pmedata is reused for smaller grids to lower the memory
  * usage.
+ * With the Verlet scheme listParams should be passed, with the group
+ * scheme listParams should be nullptr.
  */
 void pme_loadbal_init(pme_load_balancing_t     **pme_lb_p,
                       t_commrec                 *cr,
@@ -79,6 +83,7 @@ void pme_loadbal_init(pme_load_balancing_t     **pme_lb_p,
                       const t_inputrec          *ir,
                       matrix                     box,
                       const interaction_const_t *ic,
+                      const NbnxnListParameters *listParams,
                       gmx_pme_t                 *pmedata,
                       gmx_bool                   bUseGPU,
                       gmx_bool                  *bPrinting);
@@ -103,6 +108,16 @@ void pme_loadbal_do(pme_load_balancing_t  *pme_lb,
                     gmx_int64_t            step_rel,
                     gmx_bool              *bPrinting);
 
+/*! \brief Return an estimate of the reciprocal-space PME force error
+ *
+ * This is the charge-position independent term of the SPME error
+ * estimate of gmx pme_error, without the factor with the charges.
+ * For a given system it is proportional to the error, so it can be used
+ * to compare grids, interpolation orders and Ewald coefficients.
+ */
+double pme_loadbal_recip_error_estimate(const matrix box, const ivec grid,
+                                        int pme_order, real ewaldcoeff_q);
+
 /*! \brief Finish the PME load balancing and print the settings when fplog!=NULL */
 void pme_loadbal_done(pme_load_balancing_t *pme_lb,
                       FILE                 *fplog,
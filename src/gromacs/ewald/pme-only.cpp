@@ -106,7 +106,7 @@ static void reset_pmeonly_counters(gmx_wallcycle_t wcycle,
 
 
 static void gmx_pmeonly_switch(int *npmedata, struct gmx_pme_t ***pmedata,
-                               ivec grid_size,
+                               ivec grid_size, int pme_order,
                                real ewaldcoeff_q, real ewaldcoeff_lj,
                                t_commrec *cr, t_inputrec *ir,
                                struct gmx_pme_t **pme_ret)
@@ -120,7 +120,8 @@ static void gmx_pmeonly_switch(int *npmedata, struct gmx_pme_t ***pmedata,
         pme = (*pmedata)[ind];
         if (pme->nkx == grid_size[XX] &&
             pme->nky == grid_size[YY] &&
-            pme->nkz == grid_size[ZZ])
+            pme->nkz == grid_size[ZZ] &&
+            pme->pme_order == pme_order)
         {
             *pme_ret = pme;
 
@@ -134,7 +135,7 @@ static void gmx_pmeonly_switch(int *npmedata, struct gmx_pme_t ***pmedata,
     srenew(*pmedata, *npmedata);
 
     /* Generate a new PME data structure, copying part of the old pointers */
-    gmx_pme_reinit(&((*pmedata)[ind]), cr, pme, ir, grid_size, ewaldcoeff_q, ewaldcoeff_lj);
+    gmx_pme_reinit(&((*pmedata)[ind]), cr, pme, ir, grid_size, pme_order, ewaldcoeff_q, ewaldcoeff_lj);
 
     *pme_ret = (*pmedata)[ind];
 }
@@ -166,6 +167,7 @@ int gmx_pmeonly(struct gmx_pme_t *pme,
     gmx_bool           bEnerVir;
     gmx_int64_t        step;
     ivec               grid_switch;
+    int                pme_order_switch;
 
     /* This data will only use with PME tuning, i.e. switching PME grids */
     npmedata = 1;
@@ -193,12 +195,13 @@ int gmx_pmeonly(struct gmx_pme_t *pme,
                                              &lambda_q, &lambda_lj,
                                              &bEnerVir,
                                              &step,
-                                             grid_switch, &ewaldcoeff_q, &ewaldcoeff_lj);
+                                             grid_switch, &pme_order_switch,
+                                             &ewaldcoeff_q, &ewaldcoeff_lj);
 
             if (ret == pmerecvqxSWITCHGRID)
             {
-                /* Switch the PME grid to grid_switch */
-                gmx_pmeonly_switch(&npmedata, &pmedata, grid_switch, ewaldcoeff_q, ewaldcoeff_lj, cr, ir, &pme);
+                /* Switch the PME grid to grid_switch and pme_order_switch */
+                gmx_pmeonly_switch(&npmedata, &pmedata, grid_switch, pme_order_switch, ewaldcoeff_q, ewaldcoeff_lj, cr, ir, &pme);
             }
 
             if (ret == pmerecvqxRESETCOUNTERS)
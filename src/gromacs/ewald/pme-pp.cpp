@@ -49,9 +49,12 @@
 #include "config.h"
 
 #include <math.h>
+#include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
+
 #include "gromacs/domdec/domdec.h"
 #include "gromacs/domdec/domdec_struct.h"
 #include "gromacs/ewald/pme.h"
@@ -62,6 +65,7 @@
 #include "gromacs/mdtypes/commrec.h"
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/gmxassert.h"
 #include "gromacs/utility/gmxmpi.h"
 #include "gromacs/utility/smalloc.h"
 
@@ -140,6 +144,7 @@ struct gmx_pme_comm_n_box_t {
     //@{
     /*! \brief Used in PME grid tuning */
     ivec            grid_size;
+    int             pme_order;
     real            ewaldcoeff_q;
     real            ewaldcoeff_lj;
     //@}
@@ -160,6 +165,46 @@ typedef struct {
     gmx_stop_cond_t stop_cond;  /**< Flag used in responding to an external signal to terminate */
 } gmx_pme_comm_vir_ene_t;
 
+/*! \brief The minimum number of atoms per chunk of PME forces sent to a PP rank */
+static const int c_pmeForceChunkMinAtoms = 2048;
+/*! \brief The maximum number of chunks of PME forces sent to a PP rank */
+static const int c_pmeForceChunksMax     = 8;
+
+/*! \brief State of the non-blocking receive of PME forces, virial and energy on a PP rank
+ *
+ * The PP rank posts the receives directly after sending its coordinates,
+ * so the PME rank can deliver the forces while the PP rank is still
+ * computing and the wait in gmx_pme_receive_f only covers data that
+ * has not arrived yet. The forces arrive in chunks, which are reduced
+ * into the PP force buffer while the next chunk is still in flight.
+ */
+struct gmx_pme_f_recv_t {
+    gmx_bool               bOverlap;                        /**< Post receives early and defer the coordinate send wait */
+    gmx_bool               bPosted;                         /**< Whether the receives below are pending */
+    int                    natoms;                          /**< The number of atoms the receives are posted for */
+    int                    nchunk;                          /**< The number of force chunks */
+#if GMX_MPI
+    MPI_Request            req[c_pmeForceChunksMax + 1];    /**< Requests for the force chunks and the virial/energy */
+#endif
+    gmx_pme_comm_vir_ene_t cve;                             /**< Receive buffer for virial and energy */
+};
+
+/*! \brief Returns the number of chunks the PME forces for \p natoms atoms are sent in
+ *
+ * The PP and PME side both call this function, so the chunk
+ * boundaries match without communicating them.
+ */
+static int pme_force_num_chunks(int natoms)
+{
+    return std::min(c_pmeForceChunksMax, std::max(1, natoms/c_pmeForceChunkMinAtoms));
+}
+
+/*! \brief Returns the first atom of force chunk \p chunk out of \p nchunk chunks */
+static int pme_force_chunk_start(int natoms, int nchunk, int chunk)
+{
+    return static_cast<int>((static_cast<gmx_int64_t>(natoms)*chunk)/nchunk);
+}
+
 gmx_pme_pp_t gmx_pme_pp_init(t_commrec *cr)
 {
     struct gmx_pme_pp *pme_pp;
@@ -173,8 +218,12 @@ gmx_pme_pp_t gmx_pme_pp_init(t_commrec *cr)
     MPI_Comm_rank(cr->mpi_comm_mygroup, &rank);
     get_pme_ddnodes(cr, rank, &pme_pp->nnode, &pme_pp->node, &pme_pp->node_peer);
     snew(pme_pp->nat, pme_pp->nnode);
-    snew(pme_pp->req, eCommType_NR*pme_pp->nnode);
-    snew(pme_pp->stat, eCommType_NR*pme_pp->nnode);
+    /* We need space for the parameter receives and for the force chunks
+     * plus one virial/energy send.
+     */
+    int nreq = std::max(static_cast<int>(eCommType_NR), c_pmeForceChunksMax)*pme_pp->nnode + 1;
+    snew(pme_pp->req, nreq);
+    snew(pme_pp->stat, nreq);
     pme_pp->nalloc       = 0;
 #else
     GMX_UNUSED_VALUE(cr);
@@ -183,11 +232,7 @@ gmx_pme_pp_t gmx_pme_pp_init(t_commrec *cr)
     return pme_pp;
 }
 
-/*! \brief Block to wait for communication to PME ranks to complete
- *
- * This should be faster with a real non-blocking MPI implementation */
-/* #define GMX_PME_DELAYED_WAIT */
-
+/*! \brief Block to wait for communication to PME ranks to complete */
 static void gmx_pme_send_coeffs_coords_wait(gmx_domdec_t gmx_unused *dd)
 {
 #if GMX_MPI
@@ -199,6 +244,57 @@ static void gmx_pme_send_coeffs_coords_wait(gmx_domdec_t gmx_unused *dd)
 #endif
 }
 
+/*! \brief Returns the force receive state of this PP rank, allocates it at first call */
+static gmx_pme_f_recv_t *pme_f_recv_get(gmx_domdec_t *dd)
+{
+    if (dd->pme_f_recv == nullptr)
+    {
+        snew(dd->pme_f_recv, 1);
+        dd->pme_f_recv->bOverlap = (getenv("GMX_PME_PP_NO_OVERLAP") == nullptr);
+        if (debug)
+        {
+            fprintf(debug, "PP-PME communication overlap: %s\n",
+                    dd->pme_f_recv->bOverlap ? "on" : "off");
+        }
+    }
+
+    return dd->pme_f_recv;
+}
+
+/*! \brief Post the non-blocking receives of the PME forces, virial and energy */
+static void pme_post_force_receive(t_commrec *cr)
+{
+    gmx_domdec_t     *dd     = cr->dd;
+    gmx_pme_f_recv_t *fr     = pme_f_recv_get(dd);
+    int               natoms = dd->nat_home;
+
+    if (natoms > dd->pme_recv_f_alloc)
+    {
+        dd->pme_recv_f_alloc = over_alloc_dd(natoms);
+        srenew(dd->pme_recv_f_buf, dd->pme_recv_f_alloc);
+    }
+
+    fr->natoms = natoms;
+    fr->nchunk = pme_force_num_chunks(natoms);
+#if GMX_MPI
+    for (int chunk = 0; chunk < fr->nchunk; chunk++)
+    {
+        int start = pme_force_chunk_start(natoms, fr->nchunk, chunk);
+        int end   = pme_force_chunk_start(natoms, fr->nchunk, chunk + 1);
+        MPI_Irecv(dd->pme_recv_f_buf[start], (end - start)*sizeof(rvec), MPI_BYTE,
+                  dd->pme_nodeid, 0, cr->mpi_comm_mysim,
+                  &fr->req[chunk]);
+    }
+    if (dd->pme_receive_vir_ener)
+    {
+        MPI_Irecv(&fr->cve, sizeof(fr->cve), MPI_BYTE,
+                  dd->pme_nodeid, 1, cr->mpi_comm_mysim,
+                  &fr->req[fr->nchunk]);
+    }
+#endif
+    fr->bPosted = TRUE;
+}
+
 /*! \brief Send data to PME ranks */
 static void gmx_pme_send_coeffs_coords(t_commrec *cr, unsigned int flags,
                                        real gmx_unused *chargeA, real gmx_unused *chargeB,
@@ -210,10 +306,12 @@ static void gmx_pme_send_coeffs_coords(t_commrec *cr, unsigned int flags,
                                        gmx_int64_t step)
 {
     gmx_domdec_t         *dd;
+    gmx_pme_f_recv_t     *fr;
     gmx_pme_comm_n_box_t *cnb;
     int                   n;
 
     dd = cr->dd;
+    fr = pme_f_recv_get(dd);
     n  = dd->nat_home;
 
     if (debug)
@@ -226,10 +324,16 @@ static void gmx_pme_send_coeffs_coords(t_commrec *cr, unsigned int flags,
                 (flags & PP_PME_COORD)  ? " coordinates" : "");
     }
 
-#ifdef GMX_PME_DELAYED_WAIT
-    /* When can not use cnb until pending communication has finished */
+    /* We can not use cnb until pending communication has finished */
     gmx_pme_send_coeffs_coords_wait(dd);
-#endif
+
+    if ((flags & PP_PME_COORD) && fr->bOverlap)
+    {
+        /* Post the receives for the forces before the PME rank
+         * can start computing them.
+         */
+        pme_post_force_receive(cr);
+    }
 
     if (dd->pme_receive_vir_ener)
     {
@@ -314,13 +418,15 @@ static void gmx_pme_send_coeffs_coords(t_commrec *cr, unsigned int flags,
         }
     }
 
-#ifndef GMX_PME_DELAYED_WAIT
-    /* Wait for the data to arrive */
-    /* We can skip this wait as we are sure x and q will not be modified
-     * before the next call to gmx_pme_send_x_q or gmx_pme_receive_f.
+    /* With overlap we can skip this wait for the coordinates, as we are
+     * sure x will not be modified before the next call to
+     * gmx_pme_send_coeffs_coords or gmx_pme_receive_f, which wait.
+     * Parameter and finish messages are rare, we complete those here.
      */
-    gmx_pme_send_coeffs_coords_wait(dd);
-#endif
+    if (!fr->bOverlap || !(flags & PP_PME_COORD))
+    {
+        gmx_pme_send_coeffs_coords_wait(dd);
+    }
 #endif
 }
 
@@ -378,6 +484,7 @@ void gmx_pme_send_finish(t_commrec *cr)
 
 void gmx_pme_send_switchgrid(t_commrec gmx_unused *cr,
                              ivec gmx_unused       grid_size,
+                             int gmx_unused        pme_order,
                              real gmx_unused       ewaldcoeff_q,
                              real gmx_unused       ewaldcoeff_lj)
 {
@@ -389,6 +496,7 @@ void gmx_pme_send_switchgrid(t_commrec gmx_unused *cr,
     {
         cnb.flags = PP_PME_SWITCHGRID;
         copy_ivec(grid_size, cnb.grid_size);
+        cnb.pme_order     = pme_order;
         cnb.ewaldcoeff_q  = ewaldcoeff_q;
         cnb.ewaldcoeff_lj = ewaldcoeff_lj;
 
@@ -435,6 +543,7 @@ int gmx_pme_recv_coeffs_coords(struct gmx_pme_pp *pme_pp,
                                gmx_bool          *bEnerVir,
                                gmx_int64_t       *step,
                                ivec               grid_size,
+                               int               *pme_order,
                                real              *ewaldcoeff_q,
                                real              *ewaldcoeff_lj)
 {
@@ -479,6 +588,7 @@ int gmx_pme_recv_coeffs_coords(struct gmx_pme_pp *pme_pp,
         {
             /* Special case, receive the new parameters and return */
             copy_ivec(cnb.grid_size, grid_size);
+            *pme_order     = cnb.pme_order;
             *ewaldcoeff_q  = cnb.ewaldcoeff_q;
             *ewaldcoeff_lj = cnb.ewaldcoeff_lj;
 
@@ -670,7 +780,8 @@ static void receive_virial_energy(t_commrec *cr,
                                   real *dvdlambda_q, real *dvdlambda_lj,
                                   float *pme_cycles)
 {
-    gmx_pme_comm_vir_ene_t cve;
+    gmx_pme_f_recv_t       *fr = cr->dd->pme_f_recv;
+    gmx_pme_comm_vir_ene_t &cve = fr->cve;
 
     if (cr->dd->pme_receive_vir_ener)
     {
@@ -681,8 +792,7 @@ static void receive_virial_energy(t_commrec *cr,
                     cr->sim_nodeid, cr->dd->pme_nodeid);
         }
 #if GMX_MPI
-        MPI_Recv(&cve, sizeof(cve), MPI_BYTE, cr->dd->pme_nodeid, 1, cr->mpi_comm_mysim,
-                 MPI_STATUS_IGNORE);
+        MPI_Wait(&fr->req[fr->nchunk], MPI_STATUS_IGNORE);
 #else
         memset(&cve, 0, sizeof(cve));
 #endif
@@ -714,49 +824,57 @@ void gmx_pme_receive_f(t_commrec *cr,
                        real *dvdlambda_q, real *dvdlambda_lj,
                        float *pme_cycles)
 {
-#ifdef GMX_PME_DELAYED_WAIT
     /* Wait for the x request to finish */
     gmx_pme_send_coeffs_coords_wait(cr->dd);
-#endif
 
-    int natoms = cr->dd->nat_home;
+    gmx_pme_f_recv_t *fr = pme_f_recv_get(cr->dd);
 
-    if (natoms > cr->dd->pme_recv_f_alloc)
+    if (!fr->bPosted)
     {
-        cr->dd->pme_recv_f_alloc = over_alloc_dd(natoms);
-        srenew(cr->dd->pme_recv_f_buf, cr->dd->pme_recv_f_alloc);
+        pme_post_force_receive(cr);
     }
+    GMX_RELEASE_ASSERT(fr->natoms == cr->dd->nat_home, "The number of home atoms should not change between sending coordinates and receiving PME forces");
 
+    int   natoms = fr->natoms;
+    rvec *f_recv = cr->dd->pme_recv_f_buf;
+
+    /* The PME rank sends the chunks in order and MPI messages do not
+     * overtake each other, so we reduce each chunk as soon as it arrived.
+     */
+    for (int chunk = 0; chunk < fr->nchunk; chunk++)
+    {
 #if GMX_MPI
-    MPI_Recv(cr->dd->pme_recv_f_buf[0],
-             natoms*sizeof(rvec), MPI_BYTE,
-             cr->dd->pme_nodeid, 0, cr->mpi_comm_mysim,
-             MPI_STATUS_IGNORE);
+        MPI_Wait(&fr->req[chunk], MPI_STATUS_IGNORE);
 #endif
+        int start = pme_force_chunk_start(natoms, fr->nchunk, chunk);
+        int end   = pme_force_chunk_start(natoms, fr->nchunk, chunk + 1);
 
-    int nt = gmx_omp_nthreads_get_simple_rvec_task(emntDefault, natoms);
+        int nt = gmx_omp_nthreads_get_simple_rvec_task(emntDefault, end - start);
 
-    /* Note that we would like to avoid this conditional by putting it
-     * into the omp pragma instead, but then we still take the full
-     * omp parallel for overhead (at least with gcc5).
-     */
-    if (nt == 1)
-    {
-        for (int i = 0; i < natoms; i++)
+        /* Note that we would like to avoid this conditional by putting it
+         * into the omp pragma instead, but then we still take the full
+         * omp parallel for overhead (at least with gcc5).
+         */
+        if (nt == 1)
         {
-            rvec_inc(f[i], cr->dd->pme_recv_f_buf[i]);
+            for (int i = start; i < end; i++)
+            {
+                rvec_inc(f[i], f_recv[i]);
+            }
         }
-    }
-    else
-    {
-#pragma omp parallel for num_threads(nt) schedule(static)
-        for (int i = 0; i < natoms; i++)
+        else
         {
-            rvec_inc(f[i], cr->dd->pme_recv_f_buf[i]);
+#pragma omp parallel for num_threads(nt) schedule(static)
+            for (int i = start; i < end; i++)
+            {
+                rvec_inc(f[i], f_recv[i]);
+            }
         }
     }
 
     receive_virial_energy(cr, vir_q, energy_q, vir_lj, energy_lj, dvdlambda_q, dvdlambda_lj, pme_cycles);
+
+    fr->bPosted = FALSE;
 }
 
 void gmx_pme_send_force_vir_ener(struct gmx_pme_pp *pme_pp,
@@ -776,13 +894,23 @@ void gmx_pme_send_force_vir_ener(struct gmx_pme_pp *pme_pp,
     ind_end  = 0;
     for (int receiver = 0; receiver < pme_pp->nnode; receiver++)
     {
-        ind_start = ind_end;
-        ind_end   = ind_start + pme_pp->nat[receiver];
-        if (MPI_Isend(f[ind_start], (ind_end-ind_start)*sizeof(rvec), MPI_BYTE,
-                      pme_pp->node[receiver], 0,
-                      pme_pp->mpi_comm_mysim, &pme_pp->req[messages++]) != 0)
+        int offset = ind_end;
+        int nat    = pme_pp->nat[receiver];
+        int nchunk = pme_force_num_chunks(nat);
+
+        /* Send in chunks, so the PP rank can reduce the forces
+         * of a chunk while the next chunk is in flight.
+         */
+        for (int chunk = 0; chunk < nchunk; chunk++)
         {
-            gmx_comm("MPI_Isend failed in do_pmeonly");
+            ind_start = ind_end;
+            ind_end   = offset + pme_force_chunk_start(nat, nchunk, chunk + 1);
+            if (MPI_Isend(f[ind_start], (ind_end-ind_start)*sizeof(rvec), MPI_BYTE,
+                          pme_pp->node[receiver], 0,
+                          pme_pp->mpi_comm_mysim, &pme_pp->req[messages++]) != 0)
+            {
+                gmx_comm("MPI_Isend failed in do_pmeonly");
+            }
         }
     }
 
@@ -59,20 +59,41 @@
 
 using namespace gmx; // TODO: Remove when this file is moved into gmx namespace
 
+/*! \brief Cache of the influence function on the local part of the grid
+ *
+ * The influence function only depends on the box and the grid setup.
+ * When the box does not change, e.g. in NVT simulations, we store it
+ * so steps without energy and virial only need a multiplication.
+ * Only the box is checked for changes. This relies on the Ewald
+ * coefficients, epsilon_r and the grid being fixed for the lifetime
+ * of a gmx_pme_t; PME tuning switches between separate gmx_pme_t
+ * setups, each with their own cache.
+ */
+struct pme_influence_cache_t
+{
+    matrix   recipbox;  /* The reciprocal box used in the last call */
+    gmx_bool bValid;    /* Whether eterm contains values for recipbox */
+    int      nalloc;    /* Allocation size of eterm */
+    real    *eterm;     /* The influence function, x minor */
+};
+
 struct pme_solve_work_t
 {
     /* work data for solve_pme */
     int      nalloc;
+    real *   mx;
+    real *   bsp_mod_x;
     real *   mhx;
     real *   mhy;
     real *   mhz;
     real *   m2;
     real *   denom;
-    real *   tmp1_alloc;
     real *   tmp1;
     real *   tmp2;
     real *   eterm;
-    real *   m2inv;
+
+    pme_influence_cache_t cache_q;
+    pme_influence_cache_t cache_lj;
 
     real     energy_q;
     matrix   vir_q;
@@ -87,11 +108,7 @@ static void realloc_work(struct pme_solve_work_t *work, int nkx)
         int simd_width, i;
 
         work->nalloc = nkx;
-        srenew(work->mhx, work->nalloc);
-        srenew(work->mhy, work->nalloc);
-        srenew(work->mhz, work->nalloc);
-        srenew(work->m2, work->nalloc);
-        /* Allocate an aligned pointer for SIMD operations, including extra
+        /* Allocate aligned pointers for SIMD operations, including extra
          * elements at the end for padding.
          */
 #ifdef PME_SIMD_SOLVE
@@ -100,22 +117,24 @@ static void realloc_work(struct pme_solve_work_t *work, int nkx)
         /* We can use any alignment, apart from 0, so we use 4 */
         simd_width = 4;
 #endif
-        sfree_aligned(work->denom);
-        sfree_aligned(work->tmp1);
-        sfree_aligned(work->tmp2);
-        sfree_aligned(work->eterm);
-        snew_aligned(work->denom, work->nalloc+simd_width, simd_width*sizeof(real));
-        snew_aligned(work->tmp1,  work->nalloc+simd_width, simd_width*sizeof(real));
-        snew_aligned(work->tmp2,  work->nalloc+simd_width, simd_width*sizeof(real));
-        snew_aligned(work->eterm, work->nalloc+simd_width, simd_width*sizeof(real));
-        srenew(work->m2inv, work->nalloc);
-
-        /* Init all allocated elements of denom to 1 to avoid 1/0 exceptions
-         * of simd padded elements.
+        real **arrays[] = {
+            &work->mx, &work->bsp_mod_x,
+            &work->mhx, &work->mhy, &work->mhz, &work->m2,
+            &work->denom, &work->tmp1, &work->tmp2, &work->eterm
+        };
+        for (real **array : arrays)
+        {
+            sfree_aligned(*array);
+            snew_aligned(*array, work->nalloc+simd_width, simd_width*sizeof(real));
+        }
+
+        /* Init all allocated elements of denom and m2 to 1 to avoid 1/0
+         * exceptions of simd padded elements.
          */
         for (i = 0; i < work->nalloc+simd_width; i++)
         {
             work->denom[i] = 1;
+            work->m2[i]    = 1;
         }
     }
 }
@@ -142,15 +161,18 @@ static void free_work(struct pme_solve_work_t *work)
 {
     if (work)
     {
-        sfree(work->mhx);
-        sfree(work->mhy);
-        sfree(work->mhz);
-        sfree(work->m2);
+        sfree_aligned(work->mx);
+        sfree_aligned(work->bsp_mod_x);
+        sfree_aligned(work->mhx);
+        sfree_aligned(work->mhy);
+        sfree_aligned(work->mhz);
+        sfree_aligned(work->m2);
         sfree_aligned(work->denom);
         sfree_aligned(work->tmp1);
         sfree_aligned(work->tmp2);
         sfree_aligned(work->eterm);
-        sfree(work->m2inv);
+        sfree(work->cache_q.eterm);
+        sfree(work->cache_lj.eterm);
     }
 }
 
@@ -203,6 +225,269 @@ void get_pme_ener_vir_lj(struct pme_solve_work_t *work, int nthread,
     }
 }
 
+
+/*! \brief Energy and virial accumulators for one thread
+ *
+ * With SIMD these are SIMD registers, which are only reduced once
+ * at the end of the solve call.
+ */
+struct pme_ener_vir_acc_t
+{
+#if defined PME_SIMD_SOLVE
+    SimdReal energy, virxx, virxy, virxz, viryy, viryz, virzz;
+#else
+    real     energy, virxx, virxy, virxz, viryy, viryz, virzz;
+#endif
+};
+
+static void clear_ener_vir_acc(pme_ener_vir_acc_t *acc)
+{
+#if defined PME_SIMD_SOLVE
+    acc->energy = setZero();
+    acc->virxx  = setZero();
+    acc->virxy  = setZero();
+    acc->virxz  = setZero();
+    acc->viryy  = setZero();
+    acc->viryz  = setZero();
+    acc->virzz  = setZero();
+#else
+    acc->energy = 0;
+    acc->virxx  = 0;
+    acc->virxy  = 0;
+    acc->virxz  = 0;
+    acc->viryy  = 0;
+    acc->viryz  = 0;
+    acc->virzz  = 0;
+#endif
+}
+
+/* Reduces the accumulators and stores the (symmetric) virial and energy */
+static void reduce_ener_vir_acc(const pme_ener_vir_acc_t *acc,
+                                real *energy, matrix vir)
+{
+#if defined PME_SIMD_SOLVE
+    real e   = reduce(acc->energy);
+    real vxx = reduce(acc->virxx);
+    real vxy = reduce(acc->virxy);
+    real vxz = reduce(acc->virxz);
+    real vyy = reduce(acc->viryy);
+    real vyz = reduce(acc->viryz);
+    real vzz = reduce(acc->virzz);
+#else
+    real e   = acc->energy;
+    real vxx = acc->virxx;
+    real vxy = acc->virxy;
+    real vxz = acc->virxz;
+    real vyy = acc->viryy;
+    real vyz = acc->viryz;
+    real vzz = acc->virzz;
+#endif
+
+    /* Update virial with local values.
+     * The virial is symmetric by definition.
+     * this virial seems ok for isotropic scaling, but I'm
+     * experiencing problems on semiisotropic membranes.
+     * IS THAT COMMENT STILL VALID??? (DvdS, 2001/02/07).
+     */
+    vir[XX][XX] = 0.25*vxx;
+    vir[YY][YY] = 0.25*vyy;
+    vir[ZZ][ZZ] = 0.25*vzz;
+    vir[XX][YY] = vir[YY][XX] = 0.25*vxy;
+    vir[XX][ZZ] = vir[ZZ][XX] = 0.25*vxz;
+    vir[YY][ZZ] = vir[ZZ][YY] = 0.25*vyz;
+
+    /* This energy should be corrected for a charged system */
+    *energy = 0.5*e;
+}
+
+/* Sets elements [0,start) and [end,end rounded up to the SIMD width) of v */
+static void set_padding(real *v, int start, int end, real value)
+{
+    int kx;
+
+    for (kx = 0; kx < start; kx++)
+    {
+        v[kx] = value;
+    }
+#if defined PME_SIMD_SOLVE
+    for (kx = end; kx < ((end + GMX_SIMD_REAL_WIDTH - 1)/GMX_SIMD_REAL_WIDTH)*GMX_SIMD_REAL_WIDTH; kx++)
+    {
+        v[kx] = value;
+    }
+#else
+    GMX_UNUSED_VALUE(end);
+#endif
+}
+
+/* Sets the x-components of m, which wrap around at maxkx,
+ * and an aligned copy of the x B-spline moduli.
+ */
+static void init_mx(struct pme_solve_work_t *work, const struct gmx_pme_t *pme,
+                    int kxend)
+{
+    int maxkx = (pme->nkx + 1)/2;
+    int kx;
+
+    for (kx = 0; kx < kxend; kx++)
+    {
+        work->mx[kx]        = (kx < maxkx ? kx : kx - pme->nkx);
+        work->bsp_mod_x[kx] = pme->bsp_mod[XX][kx];
+    }
+    /* Set the SIMD padding to values that give finite results */
+    set_padding(work->mx, 0, kxend, 0);
+    set_padding(work->bsp_mod_x, 0, kxend, 1);
+}
+
+/* Returns whether the reciprocal box is the same as in the previous call,
+ * invalidates the cache when the box changed.
+ */
+static gmx_bool influence_cache_box_unchanged(pme_influence_cache_t *cache,
+                                              const matrix recipbox)
+{
+    gmx_bool bUnchanged = TRUE;
+
+    for (int d = 0; d < DIM; d++)
+    {
+        for (int e = 0; e < DIM; e++)
+        {
+            if (cache->recipbox[d][e] != recipbox[d][e])
+            {
+                bUnchanged = FALSE;
+            }
+        }
+    }
+    if (!bUnchanged)
+    {
+        copy_mat(recipbox, cache->recipbox);
+        cache->bValid = FALSE;
+    }
+
+    return bUnchanged;
+}
+
+static void realloc_influence_cache(pme_influence_cache_t *cache, int n)
+{
+    if (n > cache->nalloc)
+    {
+        cache->nalloc = n;
+        srenew(cache->eterm, cache->nalloc);
+    }
+}
+
+#if defined PME_SIMD_SOLVE
+/* Calculate the m-vectors, the denominator and the exponent arguments through SIMD */
+gmx_inline static void calc_mh_q(struct pme_solve_work_t *work,
+                                 int gmx_unused start, int end,
+                                 const matrix recipbox, real my, real mz,
+                                 real byz, real factor)
+{
+    const SimdReal rxx_S(recipbox[XX][XX]);
+    const SimdReal ryx_S(recipbox[YY][XX]);
+    const SimdReal rzx_S(recipbox[ZZ][XX]);
+    const SimdReal mhy0_S(my*recipbox[YY][YY]);
+    const SimdReal mhz0_S(my*recipbox[ZZ][YY] + mz*recipbox[ZZ][ZZ]);
+    const SimdReal byz_S(byz);
+    const SimdReal mfactor_S(-factor);
+
+    /* As for the exponentials, we always start from 0 */
+    for (int kx = 0; kx < end; kx += GMX_SIMD_REAL_WIDTH)
+    {
+        SimdReal mx_S  = load(work->mx + kx);
+        SimdReal mhx_S = mx_S * rxx_S;
+        SimdReal mhy_S = fma(mx_S, ryx_S, mhy0_S);
+        SimdReal mhz_S = fma(mx_S, rzx_S, mhz0_S);
+        SimdReal m2_S  = fma(mhz_S, mhz_S, fma(mhy_S, mhy_S, mhx_S * mhx_S));
+        store(work->mhx + kx, mhx_S);
+        store(work->mhy + kx, mhy_S);
+        store(work->mhz + kx, mhz_S);
+        store(work->m2 + kx, m2_S);
+        store(work->denom + kx, m2_S * byz_S * load(work->bsp_mod_x + kx));
+        store(work->tmp1 + kx, mfactor_S * m2_S);
+    }
+}
+
+/* Accumulate the energy and virial contributions through SIMD */
+gmx_inline static void accumulate_ener_vir_q(const struct pme_solve_work_t *work,
+                                             int gmx_unused start, int end,
+                                             real corner_fac, real factor,
+                                             pme_ener_vir_acc_t *acc)
+{
+    const SimdReal corner_fac_S(corner_fac);
+    const SimdReal factor_S(factor);
+    const SimdReal two_S(2.0);
+    const SimdReal one_S(1.0);
+
+    for (int kx = 0; kx < end; kx += GMX_SIMD_REAL_WIDTH)
+    {
+        SimdReal ets2_S    = corner_fac_S * load(work->tmp1 + kx);
+        SimdReal m2_S      = load(work->m2 + kx);
+        SimdReal vfactor_S = fma(factor_S, m2_S, one_S) * two_S * inv(m2_S);
+        SimdReal ets2vf_S  = ets2_S * vfactor_S;
+        SimdReal mhx_S     = load(work->mhx + kx);
+        SimdReal mhy_S     = load(work->mhy + kx);
+        SimdReal mhz_S     = load(work->mhz + kx);
+        SimdReal mhxvf_S   = ets2vf_S * mhx_S;
+        SimdReal mhyvf_S   = ets2vf_S * mhy_S;
+
+        acc->energy = acc->energy + ets2_S;
+        acc->virxx  = fma(mhxvf_S, mhx_S, acc->virxx - ets2_S);
+        acc->virxy  = fma(mhxvf_S, mhy_S, acc->virxy);
+        acc->virxz  = fma(mhxvf_S, mhz_S, acc->virxz);
+        acc->viryy  = fma(mhyvf_S, mhy_S, acc->viryy - ets2_S);
+        acc->viryz  = fma(mhyvf_S, mhz_S, acc->viryz);
+        acc->virzz  = fma(ets2vf_S * mhz_S, mhz_S, acc->virzz - ets2_S);
+    }
+}
+#else
+gmx_inline static void calc_mh_q(struct pme_solve_work_t *work,
+                                 int start, int end,
+                                 const matrix recipbox, real my, real mz,
+                                 real byz, real factor)
+{
+    real mhy0 = my*recipbox[YY][YY];
+    real mhz0 = my*recipbox[ZZ][YY] + mz*recipbox[ZZ][ZZ];
+
+    for (int kx = start; kx < end; kx++)
+    {
+        real mx   = work->mx[kx];
+        real mhxk = mx * recipbox[XX][XX];
+        real mhyk = mx * recipbox[YY][XX] + mhy0;
+        real mhzk = mx * recipbox[ZZ][XX] + mhz0;
+        real m2k  = mhxk*mhxk + mhyk*mhyk + mhzk*mhzk;
+        work->mhx[kx]   = mhxk;
+        work->mhy[kx]   = mhyk;
+        work->mhz[kx]   = mhzk;
+        work->m2[kx]    = m2k;
+        work->denom[kx] = m2k*byz*work->bsp_mod_x[kx];
+        work->tmp1[kx]  = -factor*m2k;
+    }
+}
+
+gmx_inline static void accumulate_ener_vir_q(const struct pme_solve_work_t *work,
+                                             int start, int end,
+                                             real corner_fac, real factor,
+                                             pme_ener_vir_acc_t *acc)
+{
+    for (int kx = start; kx < end; kx++)
+    {
+        real ets2    = corner_fac*work->tmp1[kx];
+        real vfactor = (factor*work->m2[kx] + 1.0)*2.0/work->m2[kx];
+        real ets2vf  = ets2*vfactor;
+        real mhxk    = work->mhx[kx];
+        real mhyk    = work->mhy[kx];
+        real mhzk    = work->mhz[kx];
+
+        acc->energy += ets2;
+        acc->virxx  += ets2vf*mhxk*mhxk - ets2;
+        acc->virxy  += ets2vf*mhxk*mhyk;
+        acc->virxz  += ets2vf*mhxk*mhzk;
+        acc->viryy  += ets2vf*mhyk*mhyk - ets2;
+        acc->viryz  += ets2vf*mhyk*mhzk;
+        acc->virzz  += ets2vf*mhzk*mhzk - ets2;
+    }
+}
+#endif
+
 #if defined PME_SIMD_SOLVE
 /* Calculate exponentials through SIMD */
 gmx_inline static void calc_exponentials_q(int gmx_unused start, int end, real f, real *d_aligned, real *r_aligned, real *e_aligned)
@@ -245,6 +530,154 @@ gmx_inline static void calc_exponentials_q(int start, int end, real f, real *d,
 }
 #endif
 
+#if defined PME_SIMD_SOLVE
+/* Calculate the m-vectors, the denominator and the exponent arguments through SIMD */
+gmx_inline static void calc_mh_lj(struct pme_solve_work_t *work,
+                                  int gmx_unused start, int end,
+                                  const matrix recipbox, real my, real mz,
+                                  real byz, real factor)
+{
+    const SimdReal rxx_S(recipbox[XX][XX]);
+    const SimdReal ryx_S(recipbox[YY][XX]);
+    const SimdReal rzx_S(recipbox[ZZ][XX]);
+    const SimdReal mhy0_S(my*recipbox[YY][YY]);
+    const SimdReal mhz0_S(my*recipbox[ZZ][YY] + mz*recipbox[ZZ][ZZ]);
+    const SimdReal byz_S(byz);
+    const SimdReal factor_S(factor);
+
+    for (int kx = 0; kx < end; kx += GMX_SIMD_REAL_WIDTH)
+    {
+        SimdReal mx_S  = load(work->mx + kx);
+        SimdReal mhx_S = mx_S * rxx_S;
+        SimdReal mhy_S = fma(mx_S, ryx_S, mhy0_S);
+        SimdReal mhz_S = fma(mx_S, rzx_S, mhz0_S);
+        SimdReal m2_S  = fma(mhz_S, mhz_S, fma(mhy_S, mhy_S, mhx_S * mhx_S));
+        store(work->mhx + kx, mhx_S);
+        store(work->mhy + kx, mhy_S);
+        store(work->mhz + kx, mhz_S);
+        store(work->m2 + kx, m2_S);
+        store(work->denom + kx, byz_S * load(work->bsp_mod_x + kx));
+        store(work->tmp1 + kx, -factor_S * m2_S);
+        store(work->tmp2 + kx, sqrt(factor_S * m2_S));
+    }
+}
+
+/* Calculate the energy and virial terms, scaled by the inverse denominator, through SIMD */
+gmx_inline static void calc_eterm_vterm_lj(struct pme_solve_work_t *work,
+                                           int gmx_unused start, int end,
+                                           real factor)
+{
+    const SimdReal factor_S(factor);
+    const SimdReal one_S(1.0);
+    const SimdReal two_S(2.0);
+    const SimdReal three_S(3.0);
+
+    for (int kx = 0; kx < end; kx += GMX_SIMD_REAL_WIDTH)
+    {
+        SimdReal m2k_S   = factor_S * load(work->m2 + kx);
+        SimdReal tmp1_S  = load(work->tmp1 + kx);
+        SimdReal tmp2_S  = load(work->tmp2 + kx);
+        SimdReal d_S     = load(work->denom + kx);
+        SimdReal eterm_S = -fma(fnma(two_S, m2k_S, one_S), tmp1_S, two_S * m2k_S * tmp2_S);
+        SimdReal vterm_S = three_S * (tmp2_S - tmp1_S);
+        store(work->tmp1 + kx, eterm_S * d_S);
+        store(work->tmp2 + kx, vterm_S * d_S);
+    }
+}
+
+/* Accumulate the energy and virial contributions through SIMD */
+gmx_inline static void accumulate_ener_vir_lj(const struct pme_solve_work_t *work,
+                                              int gmx_unused start, int end,
+                                              real corner_fac, real factor,
+                                              pme_ener_vir_acc_t *acc)
+{
+    const SimdReal corner_fac_S(corner_fac);
+    const SimdReal vfactor_S(2.0*factor*corner_fac);
+
+    for (int kx = 0; kx < end; kx += GMX_SIMD_REAL_WIDTH)
+    {
+        SimdReal ets2_S   = corner_fac_S * load(work->tmp1 + kx);
+        SimdReal ets2vf_S = vfactor_S * load(work->tmp2 + kx);
+        SimdReal mhx_S    = load(work->mhx + kx);
+        SimdReal mhy_S    = load(work->mhy + kx);
+        SimdReal mhz_S    = load(work->mhz + kx);
+        SimdReal mhxvf_S  = ets2vf_S * mhx_S;
+        SimdReal mhyvf_S  = ets2vf_S * mhy_S;
+
+        acc->energy = acc->energy + ets2_S;
+        acc->virxx  = fma(mhxvf_S, mhx_S, acc->virxx - ets2_S);
+        acc->virxy  = fma(mhxvf_S, mhy_S, acc->virxy);
+        acc->virxz  = fma(mhxvf_S, mhz_S, acc->virxz);
+        acc->viryy  = fma(mhyvf_S, mhy_S, acc->viryy - ets2_S);
+        acc->viryz  = fma(mhyvf_S, mhz_S, acc->viryz);
+        acc->virzz  = fma(ets2vf_S * mhz_S, mhz_S, acc->virzz - ets2_S);
+    }
+}
+#else
+gmx_inline static void calc_mh_lj(struct pme_solve_work_t *work,
+                                  int start, int end,
+                                  const matrix recipbox, real my, real mz,
+                                  real byz, real factor)
+{
+    real mhy0 = my*recipbox[YY][YY];
+    real mhz0 = my*recipbox[ZZ][YY] + mz*recipbox[ZZ][ZZ];
+
+    for (int kx = start; kx < end; kx++)
+    {
+        real mx   = work->mx[kx];
+        real mhxk = mx * recipbox[XX][XX];
+        real mhyk = mx * recipbox[YY][XX] + mhy0;
+        real mhzk = mx * recipbox[ZZ][XX] + mhz0;
+        real m2k  = mhxk*mhxk + mhyk*mhyk + mhzk*mhzk;
+        work->mhx[kx]   = mhxk;
+        work->mhy[kx]   = mhyk;
+        work->mhz[kx]   = mhzk;
+        work->m2[kx]    = m2k;
+        work->denom[kx] = byz*work->bsp_mod_x[kx];
+        work->tmp1[kx]  = -factor*m2k;
+        work->tmp2[kx]  = std::sqrt(factor*m2k);
+    }
+}
+
+gmx_inline static void calc_eterm_vterm_lj(struct pme_solve_work_t *work,
+                                           int start, int end,
+                                           real factor)
+{
+    for (int kx = start; kx < end; kx++)
+    {
+        real m2k   = factor*work->m2[kx];
+        real eterm = -((1.0 - 2.0*m2k)*work->tmp1[kx]
+                       + 2.0*m2k*work->tmp2[kx]);
+        real vterm = 3.0*(-work->tmp1[kx] + work->tmp2[kx]);
+        work->tmp1[kx] = eterm*work->denom[kx];
+        work->tmp2[kx] = vterm*work->denom[kx];
+    }
+}
+
+gmx_inline static void accumulate_ener_vir_lj(const struct pme_solve_work_t *work,
+                                              int start, int end,
+                                              real corner_fac, real factor,
+                                              pme_ener_vir_acc_t *acc)
+{
+    for (int kx = start; kx < end; kx++)
+    {
+        real ets2   = corner_fac*work->tmp1[kx];
+        real ets2vf = corner_fac*2.0*factor*work->tmp2[kx];
+        real mhxk   = work->mhx[kx];
+        real mhyk   = work->mhy[kx];
+        real mhzk   = work->mhz[kx];
+
+        acc->energy += ets2;
+        acc->virxx  += ets2vf*mhxk*mhxk - ets2;
+        acc->virxy  += ets2vf*mhxk*mhyk;
+        acc->virxz  += ets2vf*mhxk*mhzk;
+        acc->viryy  += ets2vf*mhyk*mhyk - ets2;
+        acc->viryz  += ets2vf*mhyk*mhzk;
+        acc->virzz  += ets2vf*mhzk*mhzk - ets2;
+    }
+}
+#endif
+
 #if defined PME_SIMD_SOLVE
 /* Calculate exponentials through SIMD */
 gmx_inline static void calc_exponentials_lj(int gmx_unused start, int end, real *r_aligned, real *factor_aligned, real *d_aligned)
@@ -298,27 +731,26 @@ int solve_pme_yzx(struct gmx_pme_t *pme, t_complex *grid, real vol,
     /* do recip sum over local cells in grid */
     /* y major, z middle, x minor or continuous */
     t_complex               *p0;
-    int                      kx, ky, kz, maxkx, maxky;
-    int                      nx, ny, nz, iyz0, iyz1, iyz, iy, iz, kxstart, kxend;
-    real                     mx, my, mz;
+    int                      kx, ky, kz, maxky;
+    int                      ny, nz, iyz0, iyz1, iyz, iy, iz, kxstart, kxend;
+    real                     my, mz;
     real                     ewaldcoeff = pme->ewaldcoeff_q;
     real                     factor     = M_PI*M_PI/(ewaldcoeff*ewaldcoeff);
-    real                     ets2, struct2, vfactor, ets2vf;
-    real                     d1, d2, energy = 0;
+    real                     struct2;
+    real                     d1, d2;
     real                     by, bz;
-    real                     virxx = 0, virxy = 0, virxz = 0, viryy = 0, viryz = 0, virzz = 0;
-    real                     rxx, ryx, ryy, rzx, rzy, rzz;
     struct pme_solve_work_t *work;
-    real                    *mhx, *mhy, *mhz, *m2, *denom, *tmp1, *eterm, *m2inv;
-    real                     mhxk, mhyk, mhzk, m2k;
+    pme_influence_cache_t   *cache;
+    pme_ener_vir_acc_t       acc;
+    real                    *tmp1, *eterm;
     real                     corner_fac;
     ivec                     complex_order;
     ivec                     local_ndata, local_offset, local_size;
     real                     elfac;
+    gmx_bool                 bFillCache, bUseCache;
 
     elfac = ONE_4PI_EPS0/pme->epsilon_r;
 
-    nx = pme->nkx;
     ny = pme->nky;
     nz = pme->nkz;
 
@@ -329,29 +761,38 @@ int solve_pme_yzx(struct gmx_pme_t *pme, t_complex *grid, real vol,
                                       local_offset,
                                       local_size);
 
-    rxx = pme->recipbox[XX][XX];
-    ryx = pme->recipbox[YY][XX];
-    ryy = pme->recipbox[YY][YY];
-    rzx = pme->recipbox[ZZ][XX];
-    rzy = pme->recipbox[ZZ][YY];
-    rzz = pme->recipbox[ZZ][ZZ];
-
-    maxkx = (nx+1)/2;
     maxky = (ny+1)/2;
 
     work  = &pme->solve_work[thread];
-    mhx   = work->mhx;
-    mhy   = work->mhy;
-    mhz   = work->mhz;
-    m2    = work->m2;
-    denom = work->denom;
     tmp1  = work->tmp1;
     eterm = work->eterm;
-    m2inv = work->m2inv;
 
     iyz0 = local_ndata[YY]*local_ndata[ZZ]* thread   /nthread;
     iyz1 = local_ndata[YY]*local_ndata[ZZ]*(thread+1)/nthread;
 
+    /* When the box did not change since the previous call, we store
+     * the influence function, so the next steps without energy and
+     * virial only need to multiply the grid with it.
+     * By waiting for a second call with the same box, we avoid
+     * the extra memory traffic with pressure coupling.
+     */
+    cache      = &work->cache_q;
+    bFillCache = FALSE;
+    if (influence_cache_box_unchanged(cache, pme->recipbox) && !cache->bValid)
+    {
+        realloc_influence_cache(cache, (iyz1 - iyz0)*local_ndata[XX]);
+        bFillCache = TRUE;
+    }
+    bUseCache = (cache->bValid && !bEnerVir);
+
+    kxend = local_offset[XX] + local_ndata[XX];
+
+    if (!bUseCache)
+    {
+        init_mx(work, pme, kxend);
+    }
+    clear_ener_vir_acc(&acc);
+
     for (iyz = iyz0; iyz < iyz1; iyz++)
     {
         iy = iyz/local_ndata[ZZ];
@@ -396,56 +837,44 @@ int solve_pme_yzx(struct gmx_pme_t *pme, t_complex *grid, real vol,
             kxstart = local_offset[XX] + 1;
             p0++;
         }
-        kxend = local_offset[XX] + local_ndata[XX];
 
-        if (bEnerVir)
+        if (bUseCache)
         {
-            /* More expensive inner loop, especially because of the storage
-             * of the mh elements in array's.
-             * Because x is the minor grid index, all mh elements
-             * depend on kx for triclinic unit cells.
-             */
-
-            /* Two explicit loops to avoid a conditional inside the loop */
-            for (kx = kxstart; kx < maxkx; kx++)
-            {
-                mx = kx;
-
-                mhxk      = mx * rxx;
-                mhyk      = mx * ryx + my * ryy;
-                mhzk      = mx * rzx + my * rzy + mz * rzz;
-                m2k       = mhxk*mhxk + mhyk*mhyk + mhzk*mhzk;
-                mhx[kx]   = mhxk;
-                mhy[kx]   = mhyk;
-                mhz[kx]   = mhzk;
-                m2[kx]    = m2k;
-                denom[kx] = m2k*bz*by*pme->bsp_mod[XX][kx];
-                tmp1[kx]  = -factor*m2k;
-            }
+            const real *eterm_cache = cache->eterm + (iyz - iyz0)*local_ndata[XX] - local_offset[XX];
 
-            for (kx = maxkx; kx < kxend; kx++)
+            for (kx = kxstart; kx < kxend; kx++, p0++)
             {
-                mx = (kx - nx);
-
-                mhxk      = mx * rxx;
-                mhyk      = mx * ryx + my * ryy;
-                mhzk      = mx * rzx + my * rzy + mz * rzz;
-                m2k       = mhxk*mhxk + mhyk*mhyk + mhzk*mhzk;
-                mhx[kx]   = mhxk;
-                mhy[kx]   = mhyk;
-                mhz[kx]   = mhzk;
-                m2[kx]    = m2k;
-                denom[kx] = m2k*bz*by*pme->bsp_mod[XX][kx];
-                tmp1[kx]  = -factor*m2k;
+                p0->re *= eterm_cache[kx];
+                p0->im *= eterm_cache[kx];
             }
 
+            continue;
+        }
+
+        /* Because x is the minor grid index, all mh elements
+         * depend on kx for triclinic unit cells.
+         */
+        calc_mh_q(work, kxstart, kxend, pme->recipbox, my, mz, bz*by, factor);
+
+        /* Avoid 1/0 for the skipped point (0,0,0) and the SIMD padding */
+        set_padding(work->denom, kxstart, kxend, 1);
+        set_padding(work->m2, kxstart, kxend, 1);
+        set_padding(tmp1, kxstart, kxend, 0);
+
+        calc_exponentials_q(kxstart, kxend, elfac, work->denom, tmp1, eterm);
+
+        if (bFillCache)
+        {
+            real *eterm_cache = cache->eterm + (iyz - iyz0)*local_ndata[XX] - local_offset[XX];
+
             for (kx = kxstart; kx < kxend; kx++)
             {
-                m2inv[kx] = 1.0/m2[kx];
+                eterm_cache[kx] = eterm[kx];
             }
+        }
 
-            calc_exponentials_q(kxstart, kxend, elfac, denom, tmp1, eterm);
-
+        if (bEnerVir)
+        {
             for (kx = kxstart; kx < kxend; kx++, p0++)
             {
                 d1      = p0->re;
@@ -459,55 +888,13 @@ int solve_pme_yzx(struct gmx_pme_t *pme, t_complex *grid, real vol,
                 tmp1[kx] = eterm[kx]*struct2;
             }
 
-            for (kx = kxstart; kx < kxend; kx++)
-            {
-                ets2     = corner_fac*tmp1[kx];
-                vfactor  = (factor*m2[kx] + 1.0)*2.0*m2inv[kx];
-                energy  += ets2;
-
-                ets2vf   = ets2*vfactor;
-                virxx   += ets2vf*mhx[kx]*mhx[kx] - ets2;
-                virxy   += ets2vf*mhx[kx]*mhy[kx];
-                virxz   += ets2vf*mhx[kx]*mhz[kx];
-                viryy   += ets2vf*mhy[kx]*mhy[kx] - ets2;
-                viryz   += ets2vf*mhy[kx]*mhz[kx];
-                virzz   += ets2vf*mhz[kx]*mhz[kx] - ets2;
-            }
+            /* The padding should not contribute to energy and virial */
+            set_padding(tmp1, kxstart, kxend, 0);
+
+            accumulate_ener_vir_q(work, kxstart, kxend, corner_fac, factor, &acc);
         }
         else
         {
-            /* We don't need to calculate the energy and the virial.
-             * In this case the triclinic overhead is small.
-             */
-
-            /* Two explicit loops to avoid a conditional inside the loop */
-
-            for (kx = kxstart; kx < maxkx; kx++)
-            {
-                mx = kx;
-
-                mhxk      = mx * rxx;
-                mhyk      = mx * ryx + my * ryy;
-                mhzk      = mx * rzx + my * rzy + mz * rzz;
-                m2k       = mhxk*mhxk + mhyk*mhyk + mhzk*mhzk;
-                denom[kx] = m2k*bz*by*pme->bsp_mod[XX][kx];
-                tmp1[kx]  = -factor*m2k;
-            }
-
-            for (kx = maxkx; kx < kxend; kx++)
-            {
-                mx = (kx - nx);
-
-                mhxk      = mx * rxx;
-                mhyk      = mx * ryx + my * ryy;
-                mhzk      = mx * rzx + my * rzy + mz * rzz;
-                m2k       = mhxk*mhxk + mhyk*mhyk + mhzk*mhzk;
-                denom[kx] = m2k*bz*by*pme->bsp_mod[XX][kx];
-                tmp1[kx]  = -factor*m2k;
-            }
-
-            calc_exponentials_q(kxstart, kxend, elfac, denom, tmp1, eterm);
-
             for (kx = kxstart; kx < kxend; kx++, p0++)
             {
                 d1      = p0->re;
@@ -519,23 +906,14 @@ int solve_pme_yzx(struct gmx_pme_t *pme, t_complex *grid, real vol,
         }
     }
 
-    if (bEnerVir)
+    if (bFillCache)
     {
-        /* Update virial with local values.
-         * The virial is symmetric by definition.
-         * this virial seems ok for isotropic scaling, but I'm
-         * experiencing problems on semiisotropic membranes.
-         * IS THAT COMMENT STILL VALID??? (DvdS, 2001/02/07).
-         */
-        work->vir_q[XX][XX] = 0.25*virxx;
-        work->vir_q[YY][YY] = 0.25*viryy;
-        work->vir_q[ZZ][ZZ] = 0.25*virzz;
-        work->vir_q[XX][YY] = work->vir_q[YY][XX] = 0.25*virxy;
-        work->vir_q[XX][ZZ] = work->vir_q[ZZ][XX] = 0.25*virxz;
-        work->vir_q[YY][ZZ] = work->vir_q[ZZ][YY] = 0.25*viryz;
+        cache->bValid = TRUE;
+    }
 
-        /* This energy should be corrected for a charged system */
-        work->energy_q = 0.5*energy;
+    if (bEnerVir)
+    {
+        reduce_ener_vir_acc(&acc, &work->energy_q, work->vir_q);
     }
 
     /* Return the loop count */
@@ -548,23 +926,22 @@ int solve_pme_lj_yzx(struct gmx_pme_t *pme, t_complex **grid, gmx_bool bLB, real
     /* do recip sum over local cells in grid */
     /* y major, z middle, x minor or continuous */
     int                      ig, gcount;
-    int                      kx, ky, kz, maxkx, maxky;
-    int                      nx, ny, nz, iy, iyz0, iyz1, iyz, iz, kxstart, kxend;
-    real                     mx, my, mz;
+    int                      kx, ky, kz, maxky;
+    int                      ny, nz, iy, iyz0, iyz1, iyz, iz, kxstart, kxend;
+    real                     my, mz;
     real                     ewaldcoeff = pme->ewaldcoeff_lj;
     real                     factor     = M_PI*M_PI/(ewaldcoeff*ewaldcoeff);
-    real                     ets2, ets2vf;
-    real                     eterm, vterm, d1, d2, energy = 0;
+    real                     eterm, vterm, d1, d2;
     real                     by, bz;
-    real                     virxx = 0, virxy = 0, virxz = 0, viryy = 0, viryz = 0, virzz = 0;
-    real                     rxx, ryx, ryy, rzx, rzy, rzz;
-    real                    *mhx, *mhy, *mhz, *m2, *denom, *tmp1, *tmp2;
-    real                     mhxk, mhyk, mhzk, m2k;
+    real                    *denom, *tmp1, *tmp2;
     struct pme_solve_work_t *work;
+    pme_influence_cache_t   *cache;
+    pme_ener_vir_acc_t       acc;
     real                     corner_fac;
     ivec                     complex_order;
     ivec                     local_ndata, local_offset, local_size;
-    nx = pme->nkx;
+    gmx_bool                 bFillCache, bUseCache;
+
     ny = pme->nky;
     nz = pme->nkz;
 
@@ -574,21 +951,10 @@ int solve_pme_lj_yzx(struct gmx_pme_t *pme, t_complex **grid, gmx_bool bLB, real
                                       local_ndata,
                                       local_offset,
                                       local_size);
-    rxx = pme->recipbox[XX][XX];
-    ryx = pme->recipbox[YY][XX];
-    ryy = pme->recipbox[YY][YY];
-    rzx = pme->recipbox[ZZ][XX];
-    rzy = pme->recipbox[ZZ][YY];
-    rzz = pme->recipbox[ZZ][ZZ];
-
-    maxkx = (nx+1)/2;
+
     maxky = (ny+1)/2;
 
     work  = &pme->solve_work[thread];
-    mhx   = work->mhx;
-    mhy   = work->mhy;
-    mhz   = work->mhz;
-    m2    = work->m2;
     denom = work->denom;
     tmp1  = work->tmp1;
     tmp2  = work->tmp2;
@@ -596,6 +962,28 @@ int solve_pme_lj_yzx(struct gmx_pme_t *pme, t_complex **grid, gmx_bool bLB, real
     iyz0 = local_ndata[YY]*local_ndata[ZZ]* thread   /nthread;
     iyz1 = local_ndata[YY]*local_ndata[ZZ]*(thread+1)/nthread;
 
+    /* Store the influence function when the box did not change,
+     * see solve_pme_yzx.
+     */
+    cache      = &work->cache_lj;
+    bFillCache = FALSE;
+    if (influence_cache_box_unchanged(cache, pme->recipbox) && !cache->bValid)
+    {
+        realloc_influence_cache(cache, (iyz1 - iyz0)*local_ndata[XX]);
+        bFillCache = TRUE;
+    }
+    bUseCache = (cache->bValid && !bEnerVir);
+
+    kxstart = local_offset[XX];
+    kxend   = local_offset[XX] + local_ndata[XX];
+    gcount  = (bLB ? 7 : 1);
+
+    if (!bUseCache)
+    {
+        init_mx(work, pme, kxend);
+    }
+    clear_ener_vir_acc(&acc);
+
     for (iyz = iyz0; iyz < iyz1; iyz++)
     {
         iy = iyz/local_ndata[ZZ];
@@ -628,63 +1016,46 @@ int solve_pme_lj_yzx(struct gmx_pme_t *pme, t_complex **grid, gmx_bool bLB, real
             corner_fac = 0.5;
         }
 
-        kxstart = local_offset[XX];
-        kxend   = local_offset[XX] + local_ndata[XX];
-        if (bEnerVir)
+        if (bUseCache)
         {
-            /* More expensive inner loop, especially because of the
-             * storage of the mh elements in array's.  Because x is the
-             * minor grid index, all mh elements depend on kx for
-             * triclinic unit cells.
-             */
-
-            /* Two explicit loops to avoid a conditional inside the loop */
-            for (kx = kxstart; kx < maxkx; kx++)
-            {
-                mx = kx;
-
-                mhxk      = mx * rxx;
-                mhyk      = mx * ryx + my * ryy;
-                mhzk      = mx * rzx + my * rzy + mz * rzz;
-                m2k       = mhxk*mhxk + mhyk*mhyk + mhzk*mhzk;
-                mhx[kx]   = mhxk;
-                mhy[kx]   = mhyk;
-                mhz[kx]   = mhzk;
-                m2[kx]    = m2k;
-                denom[kx] = bz*by*pme->bsp_mod[XX][kx];
-                tmp1[kx]  = -factor*m2k;
-                tmp2[kx]  = sqrt(factor*m2k);
-            }
+            const real *eterm_cache = cache->eterm + (iyz - iyz0)*local_ndata[XX] - local_offset[XX];
 
-            for (kx = maxkx; kx < kxend; kx++)
+            for (ig = 0; ig < gcount; ++ig)
             {
-                mx = (kx - nx);
-
-                mhxk      = mx * rxx;
-                mhyk      = mx * ryx + my * ryy;
-                mhzk      = mx * rzx + my * rzy + mz * rzz;
-                m2k       = mhxk*mhxk + mhyk*mhyk + mhzk*mhzk;
-                mhx[kx]   = mhxk;
-                mhy[kx]   = mhyk;
-                mhz[kx]   = mhzk;
-                m2[kx]    = m2k;
-                denom[kx] = bz*by*pme->bsp_mod[XX][kx];
-                tmp1[kx]  = -factor*m2k;
-                tmp2[kx]  = sqrt(factor*m2k);
+                t_complex *p0;
+
+                p0 = grid[ig] + iy*local_size[ZZ]*local_size[XX] + iz*local_size[XX];
+                for (kx = kxstart; kx < kxend; kx++, p0++)
+                {
+                    p0->re *= eterm_cache[kx];
+                    p0->im *= eterm_cache[kx];
+                }
             }
 
-            calc_exponentials_lj(kxstart, kxend, tmp1, tmp2, denom);
+            continue;
+        }
+
+        /* Because x is the minor grid index, all mh elements
+         * depend on kx for triclinic unit cells.
+         */
+        calc_mh_lj(work, kxstart, kxend, pme->recipbox, my, mz, bz*by, factor);
+
+        calc_exponentials_lj(kxstart, kxend, tmp1, tmp2, denom);
+
+        calc_eterm_vterm_lj(work, kxstart, kxend, factor);
+
+        if (bFillCache)
+        {
+            real *eterm_cache = cache->eterm + (iyz - iyz0)*local_ndata[XX] - local_offset[XX];
 
             for (kx = kxstart; kx < kxend; kx++)
             {
-                m2k   = factor*m2[kx];
-                eterm = -((1.0 - 2.0*m2k)*tmp1[kx]
-                          + 2.0*m2k*tmp2[kx]);
-                vterm    = 3.0*(-tmp1[kx] + tmp2[kx]);
-                tmp1[kx] = eterm*denom[kx];
-                tmp2[kx] = vterm*denom[kx];
+                eterm_cache[kx] = tmp1[kx];
             }
+        }
 
+        if (bEnerVir)
+        {
             if (!bLB)
             {
                 t_complex *p0;
@@ -756,66 +1127,14 @@ int solve_pme_lj_yzx(struct gmx_pme_t *pme, t_complex **grid, gmx_bool bLB, real
                 }
             }
 
-            for (kx = kxstart; kx < kxend; kx++)
-            {
-                ets2     = corner_fac*tmp1[kx];
-                vterm    = 2.0*factor*tmp2[kx];
-                energy  += ets2;
-                ets2vf   = corner_fac*vterm;
-                virxx   += ets2vf*mhx[kx]*mhx[kx] - ets2;
-                virxy   += ets2vf*mhx[kx]*mhy[kx];
-                virxz   += ets2vf*mhx[kx]*mhz[kx];
-                viryy   += ets2vf*mhy[kx]*mhy[kx] - ets2;
-                viryz   += ets2vf*mhy[kx]*mhz[kx];
-                virzz   += ets2vf*mhz[kx]*mhz[kx] - ets2;
-            }
+            /* The padding should not contribute to energy and virial */
+            set_padding(tmp1, kxstart, kxend, 0);
+            set_padding(tmp2, kxstart, kxend, 0);
+
+            accumulate_ener_vir_lj(work, kxstart, kxend, corner_fac, factor, &acc);
         }
         else
         {
-            /* We don't need to calculate the energy and the virial.
-             *  In this case the triclinic overhead is small.
-             */
-
-            /* Two explicit loops to avoid a conditional inside the loop */
-
-            for (kx = kxstart; kx < maxkx; kx++)
-            {
-                mx = kx;
-
-                mhxk      = mx * rxx;
-                mhyk      = mx * ryx + my * ryy;
-                mhzk      = mx * rzx + my * rzy + mz * rzz;
-                m2k       = mhxk*mhxk + mhyk*mhyk + mhzk*mhzk;
-                m2[kx]    = m2k;
-                denom[kx] = bz*by*pme->bsp_mod[XX][kx];
-                tmp1[kx]  = -factor*m2k;
-                tmp2[kx]  = sqrt(factor*m2k);
-            }
-
-            for (kx = maxkx; kx < kxend; kx++)
-            {
-                mx = (kx - nx);
-
-                mhxk      = mx * rxx;
-                mhyk      = mx * ryx + my * ryy;
-                mhzk      = mx * rzx + my * rzy + mz * rzz;
-                m2k       = mhxk*mhxk + mhyk*mhyk + mhzk*mhzk;
-                m2[kx]    = m2k;
-                denom[kx] = bz*by*pme->bsp_mod[XX][kx];
-                tmp1[kx]  = -factor*m2k;
-                tmp2[kx]  = sqrt(factor*m2k);
-            }
-
-            calc_exponentials_lj(kxstart, kxend, tmp1, tmp2, denom);
-
-            for (kx = kxstart; kx < kxend; kx++)
-            {
-                m2k    = factor*m2[kx];
-                eterm  = -((1.0 - 2.0*m2k)*tmp1[kx]
-                           + 2.0*m2k*tmp2[kx]);
-                tmp1[kx] = eterm*denom[kx];
-            }
-            gcount = (bLB ? 7 : 1);
             for (ig = 0; ig < gcount; ++ig)
             {
                 t_complex *p0;
@@ -834,18 +1153,17 @@ int solve_pme_lj_yzx(struct gmx_pme_t *pme, t_complex **grid, gmx_bool bLB, real
             }
         }
     }
-    if (bEnerVir)
+
+    if (bFillCache)
     {
-        work->vir_lj[XX][XX] = 0.25*virxx;
-        work->vir_lj[YY][YY] = 0.25*viryy;
-        work->vir_lj[ZZ][ZZ] = 0.25*virzz;
-        work->vir_lj[XX][YY] = work->vir_lj[YY][XX] = 0.25*virxy;
-        work->vir_lj[XX][ZZ] = work->vir_lj[ZZ][XX] = 0.25*virxz;
-        work->vir_lj[YY][ZZ] = work->vir_lj[ZZ][YY] = 0.25*viryz;
+        cache->bValid = TRUE;
+    }
 
-        /* This energy should be corrected for a charged system */
-        work->energy_lj = 0.5*energy;
+    if (bEnerVir)
+    {
+        reduce_ener_vir_acc(&acc, &work->energy_lj, work->vir_lj);
     }
+
     /* Return the loop count */
     return local_ndata[YY]*local_ndata[XX];
 }
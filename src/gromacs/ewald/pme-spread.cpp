@@ -50,6 +50,7 @@
 #include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
 #include "pme-grid.h"
@@ -211,6 +212,72 @@ static void make_thread_local_ind(const pme_atomcomm_t *atc,
     spline->n = n;
 }
 
+/* Minimum size of the grid spread on for sorting the atoms on grid column.
+ * Grids of around 0.4 million points or less are accessed from cache,
+ * then the random access to the atom data after sorting makes spreading
+ * and gathering slower. Larger grids are limited by memory bandwidth.
+ */
+static const int c_pmeSortMinGridSize = 512*1024;
+
+/* Sort the atom indices of spline on the grid column (x and y index) they
+ * spread to, so consecutive atoms access nearby grid points during spread
+ * and gather. The counting sort is stable, so sorting an already sorted
+ * index gives the same order.
+ */
+static void sort_spline_ind_on_grid(const pme_atomcomm_t *atc,
+                                    const pmegrid_t      *pmegrid,
+                                    splinedata_t         *spline)
+{
+    int  ny, ncolumn, i, c, n, tmp;
+    int *count, *ind_sort;
+
+    ny      = pmegrid->n[YY];
+    ncolumn = pmegrid->n[XX]*ny;
+
+    if (ncolumn + 1 > spline->sort_count_nalloc)
+    {
+        spline->sort_count_nalloc = over_alloc_large(ncolumn + 1);
+        srenew(spline->sort_count, spline->sort_count_nalloc);
+    }
+    count = spline->sort_count;
+
+    for (c = 0; c < ncolumn + 1; c++)
+    {
+        count[c] = 0;
+    }
+    for (i = 0; i < spline->n; i++)
+    {
+        const int *idxptr = atc->idx[spline->ind[i]];
+
+        c = (idxptr[XX] - pmegrid->offset[XX])*ny + idxptr[YY] - pmegrid->offset[YY];
+#ifdef DEBUG
+        range_check(c, 0, ncolumn);
+#endif
+        count[c + 1]++;
+    }
+    /* Convert to the start index of each column */
+    n = 0;
+    for (c = 0; c < ncolumn + 1; c++)
+    {
+        tmp      = count[c];
+        count[c] = n + tmp;
+        n       += tmp;
+    }
+
+    ind_sort = spline->ind_sort;
+    for (i = 0; i < spline->n; i++)
+    {
+        const int *idxptr = atc->idx[spline->ind[i]];
+
+        c = (idxptr[XX] - pmegrid->offset[XX])*ny + idxptr[YY] - pmegrid->offset[YY];
+        ind_sort[count[c]++] = spline->ind[i];
+    }
+
+    /* Swap the buffers instead of copying */
+    spline->ind_sort = spline->ind;
+    spline->ind      = ind_sort;
+}
+
 /* Macro to force loop unrolling by fixing order.
  * This gives a significant performance gain.
  */
@@ -862,9 +929,9 @@ void spread_on_grid(const gmx_pme_t *pme,
                     gmx_bool bCalcSplines, gmx_bool bSpread,
                     real *fftgrid, gmx_bool bDoSplines, int grid_index)
 {
-    int nthread, thread;
+    int nthread;
 #ifdef PME_TIME_THREADS
-    gmx_cycles_t c1, c2, c3, ct1a, ct1b, ct1c;
+    gmx_cycles_t c1, c2, c3, ct1a;
     static double cs1     = 0, cs2 = 0, cs3 = 0;
     static double cs1a[6] = {0, 0, 0, 0, 0, 0};
     static int cnt        = 0;
@@ -873,15 +940,19 @@ void spread_on_grid(const gmx_pme_t *pme,
     nthread = pme->nthread;
     assert(nthread > 0);
 
+    /* We run all phases in one thread parallel region, with barriers
+     * between the phases, to avoid repeated thread team start-up costs.
+     */
 #ifdef PME_TIME_THREADS
     c1 = omp_cyc_start();
 #endif
-    if (bCalcSplines)
+#pragma omp parallel num_threads(nthread)
     {
-#pragma omp parallel for num_threads(nthread) schedule(static)
-        for (thread = 0; thread < nthread; thread++)
+        try
         {
-            try
+            int thread = gmx_omp_get_thread_num();
+
+            if (bCalcSplines)
             {
                 int start, end;
 
@@ -892,23 +963,21 @@ void spread_on_grid(const gmx_pme_t *pme,
                  * with help of some extra variables.
                  */
                 calc_interpolation_idx(pme, atc, start, grid_index, end, thread);
+
+                /* The thread local atom indices depend on the grid
+                 * indices computed by all threads.
+                 */
+#pragma omp barrier
             }
-            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
-        }
-    }
 #ifdef PME_TIME_THREADS
-    c1   = omp_cyc_end(c1);
-    cs1 += (double)c1;
+            if (thread == 0)
+            {
+                c1   = omp_cyc_end(c1);
+                cs1 += (double)c1;
+                c2   = omp_cyc_start();
+            }
 #endif
 
-#ifdef PME_TIME_THREADS
-    c2 = omp_cyc_start();
-#endif
-#pragma omp parallel for num_threads(nthread) schedule(static)
-    for (thread = 0; thread < nthread; thread++)
-    {
-        try
-        {
             splinedata_t *spline;
 
             /* make local bsplines  */
@@ -934,6 +1003,32 @@ void spread_on_grid(const gmx_pme_t *pme,
                 }
             }
 
+            /* With large grids, sort the atoms for cache locality.
+             * The thread local index is rebuilt on every call, otherwise
+             * we only (re)set the index when computing the splines,
+             * since later grids reuse the splines in the same order.
+             */
+            const pmegrid_t *pmegrid         = nullptr;
+            bool             bThreadLocalInd = (grids != nullptr && pme->bUseThreads && grids->nthread > 1);
+            if (grids != nullptr)
+            {
+                pmegrid = pme->bUseThreads ? &grids->grid_th[thread] : &grids->grid;
+            }
+            if (pmegrid != nullptr &&
+                pmegrid->n[XX]*pmegrid->n[YY]*pmegrid->n[ZZ] >= c_pmeSortMinGridSize &&
+                (bThreadLocalInd || bCalcSplines))
+            {
+                if (!bThreadLocalInd)
+                {
+                    /* The number of atoms might have changed */
+                    for (int i = 0; i < spline->n; i++)
+                    {
+                        spline->ind[i] = i;
+                    }
+                }
+                sort_spline_ind_on_grid(atc, pmegrid, spline);
+            }
+
             if (bCalcSplines)
             {
                 make_bsplines(spline->theta, spline->dtheta, pme->pme_order,
@@ -959,45 +1054,48 @@ void spread_on_grid(const gmx_pme_t *pme,
                 cs1a[thread] += (double)ct1a;
 #endif
             }
-        }
-        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
-    }
-#ifdef PME_TIME_THREADS
-    c2   = omp_cyc_end(c2);
-    cs2 += (double)c2;
-#endif
 
-    if (bSpread && pme->bUseThreads)
-    {
+            if (bSpread && pme->bUseThreads)
+            {
+                /* The reduction reads the local grids of all threads */
+#pragma omp barrier
 #ifdef PME_TIME_THREADS
-        c3 = omp_cyc_start();
+                if (thread == 0)
+                {
+                    c2   = omp_cyc_end(c2);
+                    cs2 += (double)c2;
+                    c3   = omp_cyc_start();
+                }
 #endif
-#pragma omp parallel for num_threads(grids->nthread) schedule(static)
-        for (thread = 0; thread < grids->nthread; thread++)
-        {
-            try
-            {
                 reduce_threadgrid_overlap(pme, grids, thread,
                                           fftgrid,
                                           pme->overlap[0].sendbuf,
                                           pme->overlap[1].sendbuf,
                                           grid_index);
             }
-            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
         }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
+    }
 #ifdef PME_TIME_THREADS
+    if (bSpread && pme->bUseThreads)
+    {
         c3   = omp_cyc_end(c3);
         cs3 += (double)c3;
+    }
+    else
+    {
+        c2   = omp_cyc_end(c2);
+        cs2 += (double)c2;
+    }
 #endif
 
-        if (pme->nnodes > 1)
-        {
-            /* Communicate the overlapping part of the fftgrid.
-             * For this communication call we need to check pme->bUseThreads
-             * to have all ranks communicate here, regardless of pme->nthread.
-             */
-            sum_fftgrid_dd(pme, fftgrid, grid_index);
-        }
+    if (bSpread && pme->bUseThreads && pme->nnodes > 1)
+    {
+        /* Communicate the overlapping part of the fftgrid.
+         * For this communication call we need to check pme->bUseThreads
+         * to have all ranks communicate here, regardless of pme->nthread.
+         */
+        sum_fftgrid_dd(pme, fftgrid, grid_index);
     }
 
 #ifdef PME_TIME_THREADS
@@ -267,6 +267,8 @@ static void destroy_atomcomm(pme_atomcomm_t *atc)
             sfree(atc->thread_plist[i].i);
         }
         sfree(atc->spline[i].ind);
+        sfree(atc->spline[i].ind_sort);
+        sfree(atc->spline[i].sort_count);
         for (int d = 0; d < ZZ; d++)
         {
             sfree(atc->spline[i].theta[d]);
@@ -511,18 +513,26 @@ static int div_round_up(int enumerator, int denominator)
     return (enumerator + denominator - 1)/denominator;
 }
 
-int gmx_pme_init(struct gmx_pme_t **pmedata,
-                 t_commrec *        cr,
-                 int                nnodes_major,
-                 int                nnodes_minor,
-                 const t_inputrec * ir,
-                 int                homenr,
-                 gmx_bool           bFreeEnergy_q,
-                 gmx_bool           bFreeEnergy_lj,
-                 gmx_bool           bReproducible,
-                 real               ewaldcoeff_q,
-                 real               ewaldcoeff_lj,
-                 int                nthread)
+/*! \brief Initialize \p pmedata, see gmx_pme_init
+ *
+ * When \p pme_src is not nullptr, the new setup uses the same ranks
+ * and threads as \p pme_src. We then reuse its decomposition
+ * communicators and thread setup, which avoids collective MPI calls
+ * and creating new communicators at every PME grid switch.
+ */
+static int pme_init(struct gmx_pme_t      **pmedata,
+                    t_commrec              *cr,
+                    int                     nnodes_major,
+                    int                     nnodes_minor,
+                    const t_inputrec       *ir,
+                    int                     homenr,
+                    gmx_bool                bFreeEnergy_q,
+                    gmx_bool                bFreeEnergy_lj,
+                    gmx_bool                bReproducible,
+                    real                    ewaldcoeff_q,
+                    real                    ewaldcoeff_lj,
+                    int                     nthread,
+                    const struct gmx_pme_t *pme_src)
 {
     int               use_threads, sum_use_threads, i;
     ivec              ndata;
@@ -610,10 +620,19 @@ int gmx_pme_init(struct gmx_pme_t **pmedata,
             pme->ndecompdim = 2;
 
 #if GMX_MPI
-            MPI_Comm_split(pme->mpi_comm, pme->nodeid % nnodes_minor,
-                           pme->nodeid, &pme->mpi_comm_d[0]);  /* My communicator along major dimension */
-            MPI_Comm_split(pme->mpi_comm, pme->nodeid/nnodes_minor,
-                           pme->nodeid, &pme->mpi_comm_d[1]);  /* My communicator along minor dimension */
+            if (pme_src != nullptr)
+            {
+                /* The decomposition is unchanged, reuse the communicators */
+                pme->mpi_comm_d[0] = pme_src->mpi_comm_d[0];
+                pme->mpi_comm_d[1] = pme_src->mpi_comm_d[1];
+            }
+            else
+            {
+                MPI_Comm_split(pme->mpi_comm, pme->nodeid % nnodes_minor,
+                               pme->nodeid, &pme->mpi_comm_d[0]);  /* My communicator along major dimension */
+                MPI_Comm_split(pme->mpi_comm, pme->nodeid/nnodes_minor,
+                               pme->nodeid, &pme->mpi_comm_d[1]);  /* My communicator along minor dimension */
+            }
 
             MPI_Comm_rank(pme->mpi_comm_d[0], &pme->nodeid_major);
             MPI_Comm_size(pme->mpi_comm_d[0], &pme->nnodes_major);
@@ -628,8 +647,13 @@ int gmx_pme_init(struct gmx_pme_t **pmedata,
 
     /* Check if any of the PME MPI ranks uses threads */
     use_threads = (pme->nthread > 1 ? 1 : 0);
+    if (pme_src != nullptr)
+    {
+        /* The thread counts of all PME ranks are the same as for pme_src */
+        sum_use_threads = (pme_src->bUseThreads ? 1 : 0);
+    }
 #if GMX_MPI
-    if (pme->nnodes > 1)
+    else if (pme->nnodes > 1)
     {
         MPI_Allreduce(&use_threads, &sum_use_threads, 1, MPI_INT,
                       MPI_SUM, pme->mpi_comm);
@@ -697,7 +721,9 @@ int gmx_pme_init(struct gmx_pme_t **pmedata,
          */
 
         imbal = estimate_pme_load_imbalance(pme.get());
-        if (imbal >= 1.2 && pme->nodeid_major == 0 && pme->nodeid_minor == 0)
+        /* Only note this for the initial grid, not for each tuning setup */
+        if (pme_src == nullptr &&
+            imbal >= 1.2 && pme->nodeid_major == 0 && pme->nodeid_minor == 0)
         {
             fprintf(stderr,
                     "\n"
@@ -858,11 +884,30 @@ int gmx_pme_init(struct gmx_pme_t **pmedata,
     return 0;
 }
 
+int gmx_pme_init(struct gmx_pme_t **pmedata,
+                 t_commrec *        cr,
+                 int                nnodes_major,
+                 int                nnodes_minor,
+                 const t_inputrec * ir,
+                 int                homenr,
+                 gmx_bool           bFreeEnergy_q,
+                 gmx_bool           bFreeEnergy_lj,
+                 gmx_bool           bReproducible,
+                 real               ewaldcoeff_q,
+                 real               ewaldcoeff_lj,
+                 int                nthread)
+{
+    return pme_init(pmedata, cr, nnodes_major, nnodes_minor, ir, homenr,
+                    bFreeEnergy_q, bFreeEnergy_lj, bReproducible,
+                    ewaldcoeff_q, ewaldcoeff_lj, nthread, nullptr);
+}
+
 int gmx_pme_reinit(struct gmx_pme_t **pmedata,
                    t_commrec *        cr,
                    struct gmx_pme_t * pme_src,
                    const t_inputrec * ir,
                    ivec               grid_size,
+                   int                pme_order,
                    real               ewaldcoeff_q,
                    real               ewaldcoeff_lj)
 {
@@ -877,7 +922,7 @@ int gmx_pme_reinit(struct gmx_pme_t **pmedata,
     irc.coulombtype            = ir->coulombtype;
     irc.vdwtype                = ir->vdwtype;
     irc.efep                   = ir->efep;
-    irc.pme_order              = ir->pme_order;
+    irc.pme_order              = pme_order;
     irc.epsilon_r              = ir->epsilon_r;
     irc.ljpme_combination_rule = ir->ljpme_combination_rule;
     irc.nkx                    = grid_size[XX];
@@ -895,14 +940,17 @@ int gmx_pme_reinit(struct gmx_pme_t **pmedata,
 
     try
     {
-        ret = gmx_pme_init(pmedata, cr, pme_src->nnodes_major, pme_src->nnodes_minor,
-                           &irc, homenr, pme_src->bFEP_q, pme_src->bFEP_lj, FALSE, ewaldcoeff_q, ewaldcoeff_lj, pme_src->nthread);
+        ret = pme_init(pmedata, cr, pme_src->nnodes_major, pme_src->nnodes_minor,
+                       &irc, homenr, pme_src->bFEP_q, pme_src->bFEP_lj, FALSE, ewaldcoeff_q, ewaldcoeff_lj, pme_src->nthread,
+                       pme_src);
     }
     GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
 
-    if (ret == 0)
+    if (ret == 0 && pme_order == pme_src->pme_order)
     {
-        /* We can easily reuse the allocated pme grids in pme_src */
+        /* We can easily reuse the allocated pme grids in pme_src,
+         * but the thread-local grid sizes also depend on pme_order.
+         */
         reuse_pmegrids(&pme_src->pmegrid[PME_GRID_QA], &(*pmedata)->pmegrid[PME_GRID_QA]);
         /* We would like to reuse the fft grids, but that's harder */
     }
@@ -1169,6 +1217,21 @@ int gmx_pme_do(struct gmx_pme_t *pme,
              */
         }
 
+        /* With a single rank nothing needs to be communicated between
+         * the back FFT and the gathering, so we gather in the same thread
+         * parallel region, which avoids a pass over the grid to unwrap it
+         * and two thread synchronizations.
+         */
+        const gmx_bool bGatherInRegion = (bCalcF && pme->nnodes == 1);
+
+        /* If we are running without parallelization,
+         * atc->f is the actual force array, not a buffer,
+         * therefore we should not clear it.
+         */
+        lambda  = grid_index < DO_Q ? lambda_q : lambda_lj;
+        bClearF = (bFirst && PAR(cr));
+        scale   = pme->bFEP ? (grid_index % 2 == 0 ? 1.0-lambda : lambda) : 1.0;
+
         /* Here we start a large thread parallel region */
 #pragma omp parallel num_threads(pme->nthread) private(thread)
         {
@@ -1253,20 +1316,26 @@ int gmx_pme_do(struct gmx_pme_t *pme,
 
                     copy_fftgrid_to_pmegrid(pme, fftgrid, grid, grid_index, pme->nthread, thread);
                 }
+
+                if (bGatherInRegion)
+                {
+                    /* Wait for all threads to fill the grid, including the periodic overlap */
+#pragma omp barrier
+                    /* interpolate forces for our local atoms */
+                    gather_f_bsplines(pme, grid, bClearF, atc,
+                                      &atc->spline[thread], scale);
+                }
             } GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
         }
         /* End of thread parallel section.
          * With MPI we have to synchronize here before gmx_sum_qgrid_dd.
          */
 
-        if (bBackFFT)
+        if (bBackFFT && pme->nnodes > 1)
         {
             /* distribute local grid to all nodes */
 #if GMX_MPI
-            if (pme->nnodes > 1)
-            {
-                gmx_sum_qgrid_dd(pme, grid, GMX_SUM_GRID_BACKWARD);
-            }
+            gmx_sum_qgrid_dd(pme, grid, GMX_SUM_GRID_BACKWARD);
 #endif
             where();
 
@@ -1275,26 +1344,23 @@ int gmx_pme_do(struct gmx_pme_t *pme,
 
         if (bCalcF)
         {
-            /* interpolate forces for our local atoms */
+            if (!bGatherInRegion)
+            {
+                /* interpolate forces for our local atoms */
 
-            where();
+                where();
 
-            /* If we are running without parallelization,
-             * atc->f is the actual force array, not a buffer,
-             * therefore we should not clear it.
-             */
-            lambda  = grid_index < DO_Q ? lambda_q : lambda_lj;
-            bClearF = (bFirst && PAR(cr));
 #pragma omp parallel for num_threads(pme->nthread) schedule(static)
-            for (thread = 0; thread < pme->nthread; thread++)
-            {
-                try
+                for (thread = 0; thread < pme->nthread; thread++)
                 {
-                    gather_f_bsplines(pme, grid, bClearF, atc,
-                                      &atc->spline[thread],
-                                      pme->bFEP ? (grid_index % 2 == 0 ? 1.0-lambda : lambda) : 1.0);
+                    try
+                    {
+                        gather_f_bsplines(pme, grid, bClearF, atc,
+                                          &atc->spline[thread],
+                                          scale);
+                    }
+                    GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
                 }
-                GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
             }
 
             where();
@@ -1515,6 +1581,13 @@ int gmx_pme_do(struct gmx_pme_t *pme,
                     grid       = pmegrid->grid.grid;
                     calc_next_lb_coeffs(pme, local_sigma);
                     where();
+
+                    const gmx_bool bGatherInRegion = (bCalcF && pme->nnodes == 1);
+
+                    bClearF = (bFirst && PAR(cr));
+                    scale   = pme->bFEP ? (fep_state < 1 ? 1.0-lambda_lj : lambda_lj) : 1.0;
+                    scale  *= lb_scale_factor[grid_index-2];
+
 #pragma omp parallel num_threads(pme->nthread) private(thread)
                     {
                         try
@@ -1545,39 +1618,48 @@ int gmx_pme_do(struct gmx_pme_t *pme,
                             }
 
                             copy_fftgrid_to_pmegrid(pme, fftgrid, grid, grid_index, pme->nthread, thread);
+
+                            if (bGatherInRegion)
+                            {
+                                /* See the comment in the grid_index loop above */
+#pragma omp barrier
+                                gather_f_bsplines(pme, grid, bClearF, &pme->atc[0],
+                                                  &pme->atc[0].spline[thread],
+                                                  scale);
+                            }
                         }
                         GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
                     } /*#pragma omp parallel*/
 
-                    /* distribute local grid to all nodes */
-#if GMX_MPI
                     if (pme->nnodes > 1)
                     {
+                        /* distribute local grid to all nodes */
+#if GMX_MPI
                         gmx_sum_qgrid_dd(pme, grid, GMX_SUM_GRID_BACKWARD);
-                    }
 #endif
-                    where();
+                        where();
 
-                    unwrap_periodic_pmegrid(pme, grid);
+                        unwrap_periodic_pmegrid(pme, grid);
+                    }
 
                     if (bCalcF)
                     {
-                        /* interpolate forces for our local atoms */
-                        where();
-                        bClearF = (bFirst && PAR(cr));
-                        scale   = pme->bFEP ? (fep_state < 1 ? 1.0-lambda_lj : lambda_lj) : 1.0;
-                        scale  *= lb_scale_factor[grid_index-2];
+                        if (!bGatherInRegion)
+                        {
+                            /* interpolate forces for our local atoms */
+                            where();
 
 #pragma omp parallel for num_threads(pme->nthread) schedule(static)
-                        for (thread = 0; thread < pme->nthread; thread++)
-                        {
-                            try
+                            for (thread = 0; thread < pme->nthread; thread++)
                             {
-                                gather_f_bsplines(pme, grid, bClearF, &pme->atc[0],
-                                                  &pme->atc[0].spline[thread],
-                                                  scale);
+                                try
+                                {
+                                    gather_f_bsplines(pme, grid, bClearF, &pme->atc[0],
+                                                      &pme->atc[0].spline[thread],
+                                                      scale);
+                                }
+                                GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
                             }
-                            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
                         }
 
                         where();
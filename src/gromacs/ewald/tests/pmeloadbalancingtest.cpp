@@ -0,0 +1,130 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2017, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements tests of the reciprocal-space error estimate used by
+ * the PP-PME load balancing.
+ *
+ * \ingroup module_ewald
+ */
+
+#include "gmxpre.h"
+
+#include <gtest/gtest.h>
+
+#include "gromacs/ewald/pme-load-balancing.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/math/vectypes.h"
+
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Parameters and reference value of one error estimate
+struct RecipErrorCase
+{
+    //! The diagonal of the rectangular box
+    real   boxSize[DIM];
+    //! The number of grid points along each dimension
+    int    gridSize;
+    //! The PME interpolation order
+    int    pmeOrder;
+    //! The Ewald coefficient
+    real   ewaldCoeff;
+    //! The reference estimate
+    double reference;
+};
+
+/*! \brief The reference values
+ *
+ * These are the first reciprocal-space error term e_rec1 of
+ * gmx pme_error (Wang et al., J. Chem. Theory Comput. 6, 3228 (2010)),
+ * computed with the code of gmx pme_error for sum(q^2)^2/N = 1,
+ * as sqrt(e_rec1/(32 pi^2)). gmx pme_error only supports cubic grids
+ * and rectangular boxes correctly, so we only test those.
+ */
+const RecipErrorCase c_recipErrorCases[] = {
+    { { 3.0, 3.0, 3.0 }, 28, 4, 3.47, 3.06554916e-05 },
+    { { 3.0, 3.0, 3.0 }, 20, 6, 3.47, 2.16824472e-05 },
+    { { 3.2, 2.8, 3.5 }, 32, 5, 3.12, 2.86252617e-06 }
+};
+
+//! Returns the estimate for \p errorCase with grid size \p gridSize and order \p pmeOrder
+double recipErrorEstimate(const RecipErrorCase &errorCase, int gridSize, int pmeOrder)
+{
+    matrix box;
+    ivec   grid;
+
+    clear_mat(box);
+    for (int d = 0; d < DIM; d++)
+    {
+        box[d][d] = errorCase.boxSize[d];
+        grid[d]   = gridSize;
+    }
+
+    return pme_loadbal_recip_error_estimate(box, grid, pmeOrder, errorCase.ewaldCoeff);
+}
+
+TEST(PmeLoadBalancingTest, RecipErrorEstimateMatchesPmeError)
+{
+    for (const RecipErrorCase &errorCase : c_recipErrorCases)
+    {
+        EXPECT_REAL_EQ_TOL(errorCase.reference,
+                           recipErrorEstimate(errorCase, errorCase.gridSize, errorCase.pmeOrder),
+                           relativeToleranceAsFloatingPoint(errorCase.reference, 1e-5));
+    }
+}
+
+TEST(PmeLoadBalancingTest, RecipErrorEstimateDecreasesWithFinerGridAndHigherOrder)
+{
+    const RecipErrorCase &errorCase = c_recipErrorCases[0];
+    const double          error     = recipErrorEstimate(errorCase, errorCase.gridSize, errorCase.pmeOrder);
+
+    EXPECT_LT(recipErrorEstimate(errorCase, errorCase.gridSize + 4, errorCase.pmeOrder), error);
+    /* As in gmx pme_error, the estimate is pessimistic for odd orders,
+     * so we compare with the next even order.
+     */
+    EXPECT_LT(recipErrorEstimate(errorCase, errorCase.gridSize, errorCase.pmeOrder + 2), error);
+    EXPECT_GT(recipErrorEstimate(errorCase, errorCase.gridSize - 4, errorCase.pmeOrder), error);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
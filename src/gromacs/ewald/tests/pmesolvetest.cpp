@@ -0,0 +1,414 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2017, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements tests of the PME solvers against a scalar reference,
+ * including the influence-function cache used for an unchanged box.
+ *
+ * \ingroup module_ewald
+ */
+
+#include "gmxpre.h"
+
+#include <cmath>
+
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/ewald/pme-internal.h"
+#include "gromacs/ewald/pme-solve.h"
+#include "gromacs/fft/parallel_3dfft.h"
+#include "gromacs/math/invertmatrix.h"
+#include "gromacs/math/units.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/utility/stringutil.h"
+
+#include "testutils/refdata.h"
+#include "testutils/testasserts.h"
+
+#include "pmetestcommon.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! The reciprocal-space solver being tested
+enum class PmeSolveType
+{
+    Coulomb,
+    LJ
+};
+
+//! The PME grid dimensions
+const int  c_gridSize[DIM]    = { 7, 6, 8 };
+//! The PME interpolation order
+const int  c_pmeOrder         = 4;
+//! The Ewald coefficient for Coulomb
+const real c_ewaldCoeffQ      = 3.12;
+//! The Ewald coefficient for LJ
+const real c_ewaldCoeffLJ     = 2.25;
+
+/*! \brief Two triclinic boxes
+ *
+ * The second box is a slightly scaled version of the first,
+ * as happens with pressure coupling.
+ */
+const matrix c_boxes[] = {
+    { { 2.9, 0.0, 0.0 }, { 0.4, 3.1, 0.0 }, { -0.5, 0.6, 3.3 } },
+    { { 2.93, 0.0, 0.0 }, { 0.404, 3.131, 0.0 }, { -0.505, 0.606, 3.333 } }
+};
+
+//! One call of the solver
+struct SolveCall
+{
+    //! Index in c_boxes of the box to use
+    int  boxIndex;
+    //! Whether the energy and virial are computed
+    bool computeEnergyAndVirial;
+};
+
+/*! \brief The sequence of solver calls
+ *
+ * The influence function is cached on the second call with the same
+ * box and used by later calls without energy and virial. The first
+ * call with the second box has to notice the change and must not use
+ * the cached values of the first box.
+ */
+const SolveCall c_solveCalls[] = {
+    { 0, true }, { 0, false }, { 0, false },
+    { 1, false }, { 1, false }, { 1, false }, { 1, true }
+};
+
+//! Returns a PME setup for the solver tests
+PmeSafePointer pmeInitForSolve()
+{
+    t_inputrec inputRec;
+    inputRec.nkx                    = c_gridSize[XX];
+    inputRec.nky                    = c_gridSize[YY];
+    inputRec.nkz                    = c_gridSize[ZZ];
+    inputRec.pme_order              = c_pmeOrder;
+    inputRec.coulombtype            = eelPME;
+    inputRec.vdwtype                = evdwPME;
+    inputRec.ljpme_combination_rule = eljpmeGEOM;
+    inputRec.epsilon_r              = 1;
+
+    gmx_pme_t *pmeDataRaw = nullptr;
+    gmx_pme_init(&pmeDataRaw, nullptr, 1, 1, &inputRec,
+                 0, false, false, true, c_ewaldCoeffQ, c_ewaldCoeffLJ, 1);
+
+    return PmeSafePointer(pmeDataRaw);
+}
+
+//! Returns the index of the complex grid of \p type
+int gridIndex(PmeSolveType type)
+{
+    return (type == PmeSolveType::Coulomb ? PME_GRID_QA : PME_GRID_C6A);
+}
+
+/*! \brief Returns deterministic input values for the local complex grid
+ *
+ * The values are stored as real and imaginary parts of all elements,
+ * including padding.
+ */
+std::vector<real> makeInputGrid(int numElements)
+{
+    std::vector<real> grid(2*numElements);
+
+    for (size_t i = 0; i < grid.size(); i++)
+    {
+        grid[i] = std::sin(0.37*i + 0.2) + 0.5*std::cos(1.91*i);
+    }
+
+    return grid;
+}
+
+/*! \brief Scalar double-precision reference of the PME solvers
+ *
+ * Multiplies \p grid by the influence function of \p type and
+ * returns the energy and virial, using the plain loop over the
+ * grid that the SIMD and cached versions of solve_pme_yzx() and
+ * solve_pme_lj_yzx() were derived from.
+ */
+void referenceSolve(const gmx_pme_t *pme, PmeSolveType type, real vol,
+                    std::vector<double> *grid,
+                    double *energy, double virial[DIM][DIM])
+{
+    ivec complexOrder, localNData, localOffset, localSize;
+    gmx_parallel_3dfft_complex_limits(pme->pfft_setup[gridIndex(type)],
+                                      complexOrder, localNData, localOffset, localSize);
+
+    const double ewaldCoeff = (type == PmeSolveType::Coulomb ? pme->ewaldcoeff_q : pme->ewaldcoeff_lj);
+    const double factor     = M_PI*M_PI/(ewaldCoeff*ewaldCoeff);
+    const int    nk[DIM]    = { pme->nkx, pme->nky, pme->nkz };
+
+    *energy = 0;
+    for (int d = 0; d < DIM; d++)
+    {
+        for (int e = 0; e < DIM; e++)
+        {
+            virial[d][e] = 0;
+        }
+    }
+
+    for (int iy = 0; iy < localNData[YY]; iy++)
+    {
+        for (int iz = 0; iz < localNData[ZZ]; iz++)
+        {
+            for (int ix = 0; ix < localNData[XX]; ix++)
+            {
+                const int k[DIM] = { ix + localOffset[XX], iy + localOffset[YY], iz + localOffset[ZZ] };
+
+                if (type == PmeSolveType::Coulomb &&
+                    k[XX] == 0 && k[YY] == 0 && k[ZZ] == 0)
+                {
+                    continue;
+                }
+
+                /* Only z is halved by the real-to-complex transform */
+                double m[DIM];
+                for (int d = 0; d < DIM; d++)
+                {
+                    m[d] = ((d == ZZ || k[d] < (nk[d] + 1)/2) ? k[d] : k[d] - nk[d]);
+                }
+                double mh[DIM], m2 = 0;
+                for (int d = 0; d < DIM; d++)
+                {
+                    mh[d] = 0;
+                    for (int e = 0; e <= d; e++)
+                    {
+                        mh[d] += m[e]*pme->recipbox[d][e];
+                    }
+                    m2 += mh[d]*mh[d];
+                }
+                const double bspMod    = pme->bsp_mod[XX][k[XX]]*pme->bsp_mod[YY][k[YY]]*pme->bsp_mod[ZZ][k[ZZ]];
+                const double cornerFac = ((k[ZZ] == 0 || k[ZZ] == (nk[ZZ] + 1)/2) ? 0.5 : 1.0);
+
+                /* The influence function and the factor for the
+                 * off-diagonal virial term
+                 */
+                double       eterm, vfactor;
+                if (type == PmeSolveType::Coulomb)
+                {
+                    eterm   = ONE_4PI_EPS0/pme->epsilon_r*std::exp(-factor*m2)/(M_PI*vol*m2*bspMod);
+                    vfactor = eterm*(factor*m2 + 1.0)*2.0/m2;
+                }
+                else
+                {
+                    const double denom   = 3.0*vol*bspMod/(M_PI*std::sqrt(M_PI)*ewaldCoeff*ewaldCoeff*ewaldCoeff);
+                    const double fm2     = factor*m2;
+                    const double mk      = std::sqrt(fm2);
+                    const double expTerm = std::exp(-fm2);
+                    const double erfcTerm = std::sqrt(M_PI)*mk*std::erfc(mk);
+                    eterm   = -((1.0 - 2.0*fm2)*expTerm + 2.0*fm2*erfcTerm)/denom;
+                    vfactor = 2.0*factor*3.0*(erfcTerm - expTerm)/denom;
+                }
+
+                const size_t index   = 2*((iy*localSize[ZZ] + iz)*localSize[XX] + ix);
+                const double re      = (*grid)[index];
+                const double im      = (*grid)[index + 1];
+                const double struct2 = 2.0*(re*re + im*im);
+                (*grid)[index]     = re*eterm;
+                (*grid)[index + 1] = im*eterm;
+
+                const double ets2 = cornerFac*eterm*struct2;
+                *energy += ets2;
+                for (int d = 0; d < DIM; d++)
+                {
+                    for (int e = 0; e < DIM; e++)
+                    {
+                        virial[d][e] += cornerFac*struct2*vfactor*mh[d]*mh[e] - (d == e ? ets2 : 0);
+                    }
+                }
+            }
+        }
+    }
+
+    *energy *= 0.5;
+    for (int d = 0; d < DIM; d++)
+    {
+        for (int e = 0; e < DIM; e++)
+        {
+            virial[d][e] *= 0.25;
+        }
+    }
+}
+
+/*! \brief Runs the sequence of solver calls for \p type
+ *
+ * Every call is compared to the scalar reference, the calls with
+ * energy and virial are also checked against the reference data.
+ */
+void runSolveTest(PmeSolveType type)
+{
+    TestReferenceData    refData;
+    TestReferenceChecker rootChecker(refData.rootChecker());
+
+    PmeSafePointer       pmeSafe = pmeInitForSolve();
+    gmx_pme_t           *pme     = pmeSafe.get();
+
+    ivec                 complexOrder, localNData, localOffset, localSize;
+    gmx_parallel_3dfft_complex_limits(pme->pfft_setup[gridIndex(type)],
+                                      complexOrder, localNData, localOffset, localSize);
+    const int            numElements = localSize[XX]*localSize[YY]*localSize[ZZ];
+    const std::vector<real> inputGrid = makeInputGrid(numElements);
+    real                *grid        = reinterpret_cast<real *>(pme->cfftgrid[gridIndex(type)]);
+
+    for (size_t callIndex = 0; callIndex < sizeof(c_solveCalls)/sizeof(c_solveCalls[0]); callIndex++)
+    {
+        const SolveCall &call = c_solveCalls[callIndex];
+        SCOPED_TRACE(formatString("Solver call %zu with box %d, %s energy and virial",
+                                  callIndex, call.boxIndex,
+                                  call.computeEnergyAndVirial ? "with" : "without"));
+
+        const matrix &box = c_boxes[call.boxIndex];
+        invertBoxMatrix(box, pme->recipbox);
+        const real    vol = det(box);
+
+        std::copy(inputGrid.begin(), inputGrid.end(), grid);
+        if (type == PmeSolveType::Coulomb)
+        {
+            solve_pme_yzx(pme, pme->cfftgrid[PME_GRID_QA], vol,
+                          call.computeEnergyAndVirial, 1, 0);
+        }
+        else
+        {
+            solve_pme_lj_yzx(pme, &pme->cfftgrid[PME_GRID_C6A], FALSE, vol,
+                             call.computeEnergyAndVirial, 1, 0);
+        }
+
+        std::vector<double> referenceGrid(inputGrid.begin(), inputGrid.end());
+        double              referenceEnergy;
+        double              referenceVirial[DIM][DIM];
+        referenceSolve(pme, type, vol, &referenceGrid, &referenceEnergy, referenceVirial);
+
+        /* The grid values vary over orders of magnitude, so we
+         * use a tolerance relative to the largest value. The LJ
+         * influence function suffers from cancellation between
+         * its exponential and erfc terms, which limits the accuracy
+         * of the solver in double precision.
+         */
+        const bool         isCoulomb          = (type == PmeSolveType::Coulomb);
+        const gmx_uint64_t gridUlpTolerance   = (isCoulomb ? 16 : 128);
+        const gmx_uint64_t energyUlpTolerance = 64;
+        const gmx_uint64_t doubleUlpTolerance = 8192;
+        auto               tolerance          = [isCoulomb, doubleUlpTolerance](double magnitude, gmx_uint64_t ulpTolerance)
+            {
+                return relativeToleranceAsPrecisionDependentUlp(magnitude, ulpTolerance,
+                                                                isCoulomb ? ulpTolerance : doubleUlpTolerance);
+            };
+        double maxGridValue = 0;
+        for (double value : referenceGrid)
+        {
+            maxGridValue = std::max(maxGridValue, std::abs(value));
+        }
+        std::vector<real> outputGrid;
+        for (int iy = 0; iy < localNData[YY]; iy++)
+        {
+            for (int iz = 0; iz < localNData[ZZ]; iz++)
+            {
+                for (int ix = 0; ix < 2*localNData[XX]; ix++)
+                {
+                    const size_t index = 2*(iy*localSize[ZZ] + iz)*localSize[XX] + ix;
+                    EXPECT_REAL_EQ_TOL(referenceGrid[index], grid[index],
+                                       tolerance(maxGridValue, gridUlpTolerance));
+                    outputGrid.push_back(grid[index]);
+                }
+            }
+        }
+
+        if (call.computeEnergyAndVirial)
+        {
+            real   energy;
+            matrix virial;
+            if (type == PmeSolveType::Coulomb)
+            {
+                get_pme_ener_vir_q(pme->solve_work, 1, &energy, virial);
+            }
+            else
+            {
+                get_pme_ener_vir_lj(pme->solve_work, 1, &energy, virial);
+            }
+
+            double maxVirialValue = 0;
+            for (int d = 0; d < DIM; d++)
+            {
+                for (int e = 0; e < DIM; e++)
+                {
+                    maxVirialValue = std::max(maxVirialValue, std::abs(referenceVirial[d][e]));
+                }
+            }
+            EXPECT_REAL_EQ_TOL(referenceEnergy, energy,
+                               tolerance(std::abs(referenceEnergy), energyUlpTolerance));
+            for (int d = 0; d < DIM; d++)
+            {
+                for (int e = 0; e < DIM; e++)
+                {
+                    EXPECT_REAL_EQ_TOL(referenceVirial[d][e], virial[d][e],
+                                       tolerance(maxVirialValue, energyUlpTolerance));
+                }
+            }
+
+            TestReferenceChecker callChecker(rootChecker.checkCompound("SolverCall", formatString("Call%zu", callIndex).c_str()));
+            callChecker.setDefaultTolerance(tolerance(std::abs(referenceEnergy), energyUlpTolerance));
+            callChecker.checkReal(energy, "Energy");
+            callChecker.setDefaultTolerance(tolerance(maxVirialValue, energyUlpTolerance));
+            callChecker.checkVector(virial[XX], "VirialX");
+            callChecker.checkVector(virial[YY], "VirialY");
+            callChecker.checkVector(virial[ZZ], "VirialZ");
+            callChecker.setDefaultTolerance(tolerance(maxGridValue, gridUlpTolerance));
+            callChecker.checkSequence(outputGrid.begin(), outputGrid.end(), "Grid");
+        }
+    }
+}
+
+TEST(PmeSolveTest, CoulombMatchesReference)
+{
+    runSolveTest(PmeSolveType::Coulomb);
+}
+
+TEST(PmeSolveTest, LJMatchesReference)
+{
+    runSolveTest(PmeSolveType::LJ);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
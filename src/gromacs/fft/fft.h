@@ -2,7 +2,7 @@
  * This file is part of the GROMACS molecular simulation package.
  *
  * Copyright (c) 1991-2003 David van der Spoel, Erik Lindahl, University of Groningen.
- * Copyright (c) 2013,2014,2015, by the GROMACS development team, led by
+ * Copyright (c) 2013,2014,2015,2017, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -55,6 +55,7 @@
 #include <stdio.h>
 
 #include "gromacs/math/gmxcomplex.h"
+#include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/real.h"
 
 /*! \brief Datatype for FFT setup
@@ -408,4 +409,24 @@ gmx_fft_transpose_2d   (t_complex *       in_data,
  */
 void gmx_fft_cleanup();
 
+/*! \brief Read FFT planning data (wisdom) from a file
+ *
+ *  Only FFTW stores wisdom. Plans that were measured in earlier runs
+ *  and stored with gmx_fft_export_wisdom() are then set up without
+ *  measuring again. Should be called before any plans are created.
+ *
+ *  \param filename  Name of the wisdom file
+ *  \return TRUE when wisdom was read, FALSE otherwise or when the
+ *          FFT library does not support wisdom.
+ */
+gmx_bool gmx_fft_import_wisdom(const char *filename);
+
+/*! \brief Write the FFT planning data (wisdom) of this process to a file
+ *
+ *  \param filename  Name of the wisdom file
+ *  \return TRUE when wisdom was written, FALSE otherwise or when the
+ *          FFT library does not support wisdom.
+ */
+gmx_bool gmx_fft_export_wisdom(const char *filename);
+
 #endif
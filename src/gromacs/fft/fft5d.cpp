@@ -162,6 +162,22 @@ static int vmax(int* a, int s)
     return max;
 }
 
+/* Maximum number of chunks along z for pipelining the FFT with the transpose */
+static const int c_fft5dMaxPipelineChunks = 4;
+
+/* Returns the first local line and the number of local lines of chunk c.
+   The chunk boundaries are set along the maximum z size K, which is identical
+   on all ranks in the communicator of the transpose, and are clipped to the
+   local size pK. With nchunks=1 all pM*pK lines are returned. */
+static void chunk_lines(int c, int nchunks, int K, int pM, int pK, int* lineStart, int* nlines)
+{
+    int z0 = std::min((c*K)/nchunks, pK);
+    int z1 = std::min(((c+1)*K)/nchunks, pK);
+
+    *lineStart = z0*pM;
+    *nlines    = (z1 - z0)*pM;
+}
+
 
 /* NxMxK the size of the data
  * comm communicator to use for fft5d
@@ -177,7 +193,9 @@ fft5d_plan fft5d_plan_3d(int NG, int MG, int KG, MPI_Comm comm[2], int flags, t_
     int       *N0 = nullptr, *N1 = nullptr, *M0 = nullptr, *M1 = nullptr, *K0 = nullptr, *K1 = nullptr, *oN0 = nullptr, *oN1 = nullptr, *oM0 = nullptr, *oM1 = nullptr, *oK0 = nullptr, *oK1 = nullptr;
     int        N[3], M[3], K[3], pN[3], pM[3], pK[3], oM[3], oK[3], *iNin[3] = {nullptr}, *oNin[3] = {nullptr}, *iNout[3] = {nullptr}, *oNout[3] = {nullptr};
     int        C[3], rC[3], nP[2];
+    int        nchunks[3];
     int        lsize;
+    bool       bPipeline, bSeparateBuffers;
     t_complex *lin = nullptr, *lout = nullptr, *lout2 = nullptr, *lout3 = nullptr;
     fft5d_plan plan;
     int        s;
@@ -404,6 +422,31 @@ fft5d_plan fft5d_plan_3d(int NG, int MG, int KG, MPI_Comm comm[2], int flags, t_
     }
     N[2] = pN[2] = -1;       /*not used*/
 
+    /* With pipelining the FFT and split of step s are done in chunks along z,
+       so the transpose of a chunk can overlap with the FFT of the next one.
+       The chunks are transposed with point-to-point communication,
+       so pipelining is not supported with FFT5D_MPI_TRANSPOSE. */
+#if GMX_MPI && !defined FFT5D_MPI_TRANSPOSE
+    bPipeline = ((flags&FFT5D_PIPELINE) != 0);
+#else
+    bPipeline = false;
+#endif
+    for (s = 0; s < 3; s++)
+    {
+        if (bPipeline && s < 2 && nP[s] > 1)
+        {
+            nchunks[s] = std::max(1, std::min(c_fft5dMaxPipelineChunks, K[s]));
+        }
+        else
+        {
+            nchunks[s] = 1;
+        }
+    }
+    /* Pipelining requires separate transpose buffers, since communication and FFT run concurrently.
+       This only depends on the flags and rank counts, so the backward plan (with FFT5D_NOMALLOC)
+       makes the same choice as the forward plan. */
+    bSeparateBuffers = (nthreads > 1 || (bPipeline && (nP[0] > 1 || nP[1] > 1)));
+
     /*
        Difference between x-y-z regarding 2d decomposition is whether they are
        distributed along axis 1, 2 or both
@@ -416,7 +459,7 @@ fft5d_plan fft5d_plan_3d(int NG, int MG, int KG, MPI_Comm comm[2], int flags, t_
     {
         snew_aligned(lin, lsize, 32);
         snew_aligned(lout, lsize, 32);
-        if (nthreads > 1)
+        if (bSeparateBuffers)
         {
             /* We need extra transpose buffers to avoid OpenMP barriers */
             snew_aligned(lout2, lsize, 32);
@@ -433,7 +476,7 @@ fft5d_plan fft5d_plan_3d(int NG, int MG, int KG, MPI_Comm comm[2], int flags, t_
     {
         lin  = *rlin;
         lout = *rlout;
-        if (nthreads > 1)
+        if (bSeparateBuffers)
         {
             lout2 = *rlout2;
             lout3 = *rlout3;
@@ -591,30 +634,39 @@ fft5d_plan fft5d_plan_3d(int NG, int MG, int KG, MPI_Comm comm[2], int flags, t_
             fprintf(debug, "FFT5D: Plan s %d rC %d M %d pK %d C %d lsize %d\n",
                     s, rC[s], M[s], pK[s], C[s], lsize);
         }
-        plan->p1d[s] = (gmx_fft_t*)malloc(sizeof(gmx_fft_t)*nthreads);
+        /* One plan per thread and chunk, stored as p1d[s][c*nthreads+t] */
+        plan->p1d[s] = (gmx_fft_t*)malloc(sizeof(gmx_fft_t)*nthreads*nchunks[s]);
 
-        /* Make sure that the init routines are only called by one thread at a time and in order
-           (later is only important to not confuse valgrind)
-         */
-#pragma omp parallel for num_threads(nthreads) schedule(static) ordered
-        for (t = 0; t < nthreads; t++)
+        for (int c = 0; c < nchunks[s]; c++)
         {
-#pragma omp ordered
+            int lineStart, nlines;
+
+            chunk_lines(c, nchunks[s], K[s], pM[s], pK[s], &lineStart, &nlines);
+
+            /* Make sure that the init routines are only called by one thread at a time and in order
+               (later is only important to not confuse valgrind)
+             */
+#pragma omp parallel for num_threads(nthreads) schedule(static) ordered
+            for (t = 0; t < nthreads; t++)
             {
-                try
+#pragma omp ordered
                 {
-                    int tsize = ((t+1)*pM[s]*pK[s]/nthreads)-(t*pM[s]*pK[s]/nthreads);
-
-                    if ((flags&FFT5D_REALCOMPLEX) && ((!(flags&FFT5D_BACKWARD) && s == 0) || ((flags&FFT5D_BACKWARD) && s == 2)))
+                    try
                     {
-                        gmx_fft_init_many_1d_real( &plan->p1d[s][t], rC[s], tsize, (flags&FFT5D_NOMEASURE) ? GMX_FFT_FLAG_CONSERVATIVE : 0 );
-                    }
-                    else
-                    {
-                        gmx_fft_init_many_1d     ( &plan->p1d[s][t],  C[s], tsize, (flags&FFT5D_NOMEASURE) ? GMX_FFT_FLAG_CONSERVATIVE : 0 );
+                        int        tsize = ((t+1)*nlines/nthreads)-(t*nlines/nthreads);
+                        gmx_fft_t *p1d   = &plan->p1d[s][c*nthreads + t];
+
+                        if ((flags&FFT5D_REALCOMPLEX) && ((!(flags&FFT5D_BACKWARD) && s == 0) || ((flags&FFT5D_BACKWARD) && s == 2)))
+                        {
+                            gmx_fft_init_many_1d_real( p1d, rC[s], tsize, (flags&FFT5D_NOMEASURE) ? GMX_FFT_FLAG_CONSERVATIVE : 0 );
+                        }
+                        else
+                        {
+                            gmx_fft_init_many_1d     ( p1d,  C[s], tsize, (flags&FFT5D_NOMEASURE) ? GMX_FFT_FLAG_CONSERVATIVE : 0 );
+                        }
                     }
+                    GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
                 }
-                GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
             }
         }
     }
@@ -665,6 +717,25 @@ fft5d_plan fft5d_plan_3d(int NG, int MG, int KG, MPI_Comm comm[2], int flags, t_
     {
         plan->P[s] = nP[s]; plan->coor[s] = prank[s];
     }
+    for (s = 0; s < 3; s++)
+    {
+        plan->nchunks[s] = nchunks[s];
+    }
+#if GMX_MPI
+    if (nchunks[0] > 1 || nchunks[1] > 1)
+    {
+        for (s = 0; s < 2; s++)
+        {
+            plan->crank[s] = 0;
+            if (nchunks[s] > 1)
+            {
+                MPI_Comm_rank(plan->cart[s], &plan->crank[s]);
+            }
+        }
+        /* a send and a receive per rank and chunk */
+        plan->req = (MPI_Request*)malloc(2*std::max(nP[0]*nchunks[0], nP[1]*nchunks[1])*sizeof(MPI_Request));
+    }
+#endif
 
 /*    plan->fftorder=fftorder;
     plan->direction=direction;
@@ -967,6 +1038,96 @@ static void print_localdata(const t_complex* lin, const char* txt, int s, fft5d_
     }
 }
 
+#if GMX_MPI && !defined FFT5D_MPI_TRANSPOSE
+/*FFT, split and transpose of step s, pipelined in chunks along z:
+   the communication of chunk c is started with non-blocking send/receive calls
+   by the master thread and overlaps with the FFT and split of chunk c+1.
+   As with the blocking MPI_Alltoall, the block for each rank has size N*M*K,
+   with z as the slowest index, so chunk c is a contiguous part of each block.
+   Returns when all communication of the master thread has completed.*/
+static void fft5d_execute_pipelined(fft5d_plan plan, int s, int thread, fft5d_time times)
+{
+    t_complex *lin   = plan->lin;
+    t_complex *lout  = plan->lout;
+    t_complex *lout2 = plan->lout2;
+    t_complex *lout3 = plan->lout3;
+    int       *N     = plan->N, *M = plan->M, *K = plan->K, *pM = plan->pM, *pK = plan->pK,
+    *C               = plan->C, *P = plan->P, **iNout = plan->iNout, **oNout = plan->oNout;
+    int        nchunks   = plan->nchunks[s];
+    int        blockSize = N[s]*M[s]*K[s];
+    int        nreq      = 0;
+    int        c, i, lineStart, nlines, tstart, tend;
+
+    /* The input lines are written by the caller or by the join of the previous step
+       with the thread partition of the unchunked FFT, which differs from the partition here */
+#pragma omp barrier
+
+    for (c = 0; c < nchunks; c++)
+    {
+        chunk_lines(c, nchunks, K[s], pM[s], pK[s], &lineStart, &nlines);
+        tstart = lineStart + thread*nlines/plan->nthreads;
+        tend   = lineStart + (thread+1)*nlines/plan->nthreads;
+
+        if ((plan->flags&FFT5D_REALCOMPLEX) && !(plan->flags&FFT5D_BACKWARD) && s == 0)
+        {
+            gmx_fft_many_1d_real(plan->p1d[s][c*plan->nthreads + thread], GMX_FFT_REAL_TO_COMPLEX, lin+tstart*C[s], lout+tstart*C[s]);
+        }
+        else
+        {
+            gmx_fft_many_1d(     plan->p1d[s][c*plan->nthreads + thread], (plan->flags&FFT5D_BACKWARD) ? GMX_FFT_BACKWARD : GMX_FFT_FORWARD, lin+tstart*C[s], lout+tstart*C[s]);
+        }
+
+        if (tend > tstart)
+        {
+            splitaxes(lout2, lout, N[s], M[s], K[s], pM[s], P[s], C[s], iNout[s], oNout[s], tstart%pM[s], tstart/pM[s], tend%pM[s], tend/pM[s]);
+        }
+#pragma omp barrier /*all of chunk c has to be split before sending it*/
+
+        if (thread == 0)
+        {
+            /* offset and size of chunk c within the block for each rank */
+            int offset = ((c*K[s])/nchunks)*N[s]*M[s];
+            int count  = (((c+1)*K[s])/nchunks)*N[s]*M[s] - offset;
+
+#ifndef NOGMX
+            wallcycle_start(times, ewcPME_FFTCOMM);
+#endif
+            for (i = 0; i < P[s]; i++)
+            {
+                if (i == plan->crank[s])
+                {
+                    memcpy(lout3 + i*blockSize + offset, lout2 + i*blockSize + offset, count*sizeof(t_complex));
+                }
+                else
+                {
+                    MPI_Irecv((real *)(lout3 + i*blockSize + offset), count*sizeof(t_complex)/sizeof(real), GMX_MPI_REAL,
+                              i, c, plan->cart[s], &plan->req[nreq++]);
+                    MPI_Isend((real *)(lout2 + i*blockSize + offset), count*sizeof(t_complex)/sizeof(real), GMX_MPI_REAL,
+                              i, c, plan->cart[s], &plan->req[nreq++]);
+                }
+            }
+#ifndef NOGMX
+            wallcycle_stop(times, ewcPME_FFTCOMM);
+#endif
+        }
+    }
+
+    if (thread == 0)
+    {
+#ifndef NOGMX
+        wallcycle_start(times, ewcPME_FFTCOMM);
+#endif
+        MPI_Waitall(nreq, plan->req, MPI_STATUSES_IGNORE);
+#ifndef NOGMX
+        wallcycle_stop(times, ewcPME_FFTCOMM);
+#endif
+    }
+#ifdef NOGMX
+    (void)times;
+#endif
+}
+#endif
+
 void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
 {
     t_complex  *lin   = plan->lin;
@@ -987,7 +1148,7 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
 #endif
     int   *N = plan->N, *M = plan->M, *K = plan->K, *pN = plan->pN, *pM = plan->pM, *pK = plan->pK,
     *C       = plan->C, *P = plan->P, **iNin = plan->iNin, **oNin = plan->oNin, **iNout = plan->iNout, **oNout = plan->oNout;
-    int    s = 0, tstart, tend, bParallelDim;
+    int    s = 0, tstart, tend, bParallelDim, bPipelined;
 
 
 #if GMX_FFT_FFTW3
@@ -1035,6 +1196,8 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
             bParallelDim = 0;
         }
 
+        bPipelined = (bParallelDim && plan->nchunks[s] > 1);
+
         /* ---------- START FFT ------------ */
 #ifdef NOGMX
         if (times != 0 && thread == 0)
@@ -1060,7 +1223,14 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
         }
 
         tstart = (thread*pM[s]*pK[s]/plan->nthreads)*C[s];
-        if ((plan->flags&FFT5D_REALCOMPLEX) && !(plan->flags&FFT5D_BACKWARD) && s == 0)
+        if (bPipelined)
+        {
+            /* FFT, split and transpose in chunks, the transposed data ends up in lout3 */
+#if GMX_MPI && !defined FFT5D_MPI_TRANSPOSE
+            fft5d_execute_pipelined(plan, s, thread, times);
+#endif
+        }
+        else if ((plan->flags&FFT5D_REALCOMPLEX) && !(plan->flags&FFT5D_BACKWARD) && s == 0)
         {
             gmx_fft_many_1d_real(p1d[s][thread], (plan->flags&FFT5D_BACKWARD) ? GMX_FFT_COMPLEX_TO_REAL : GMX_FFT_REAL_TO_COMPLEX, lin+tstart, fftout+tstart);
         }
@@ -1083,7 +1253,7 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
         /* ---------- END FFT ------------ */
 
         /* ---------- START SPLIT + TRANSPOSE------------ (if parallel in in this dimension)*/
-        if (bParallelDim)
+        if (bParallelDim && !bPipelined)
         {
 #ifdef NOGMX
             if (times != NULL && thread == 0)
@@ -1255,7 +1425,7 @@ void fft5d_destroy(fft5d_plan plan)
     {
         if (plan->p1d[s])
         {
-            for (t = 0; t < plan->nthreads; t++)
+            for (t = 0; t < plan->nthreads*plan->nchunks[s]; t++)
             {
                 gmx_many_fft_destroy(plan->p1d[s][t]);
             }
@@ -1301,13 +1471,20 @@ void fft5d_destroy(fft5d_plan plan)
     {
         sfree_aligned(plan->lin);
         sfree_aligned(plan->lout);
-        if (plan->nthreads > 1)
+        if (plan->lout2 != plan->lin)
         {
             sfree_aligned(plan->lout2);
             sfree_aligned(plan->lout3);
         }
     }
 
+#if GMX_MPI
+    if (plan->req)
+    {
+        free(plan->req);
+    }
+#endif
+
 #ifdef FFT5D_THREADS
 #ifdef FFT5D_FFTW_THREADS
     /*FFTW(cleanup_threads)();*/
@@ -1,7 +1,7 @@
 /*
  * This file is part of the GROMACS molecular simulation package.
  *
- * Copyright (c) 2009,2010,2012,2013,2014,2015,2016, by the GROMACS development team, led by
+ * Copyright (c) 2009,2010,2012,2013,2014,2015,2016,2017, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -86,7 +86,8 @@ typedef enum fft5d_flags_t {
     FFT5D_DEBUG       = 8,
     FFT5D_NOMEASURE   = 16,
     FFT5D_INPLACE     = 32,
-    FFT5D_NOMALLOC    = 64
+    FFT5D_NOMALLOC    = 64,
+    FFT5D_PIPELINE    = 128
 } fft5d_flags;
 
 struct fft5d_plan_t {
@@ -117,6 +118,11 @@ struct fft5d_plan_t {
     /*int P[2];*/
     int coor[2];
     int nthreads;
+    int nchunks[3];      /*number of chunks along z for pipelining FFT and transpose (1: no pipelining)*/
+#if GMX_MPI
+    int          crank[2]; /*rank in cart*/
+    MPI_Request *req;      /*requests for the non-blocking transposes*/
+#endif
 };
 
 typedef struct fft5d_plan_t *fft5d_plan;
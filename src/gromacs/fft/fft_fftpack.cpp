@@ -494,3 +494,13 @@ gmx_fft_destroy(gmx_fft_t      fft)
 void gmx_fft_cleanup()
 {
 }
+
+gmx_bool gmx_fft_import_wisdom(const char gmx_unused *filename)
+{
+    return FALSE;
+}
+
+gmx_bool gmx_fft_export_wisdom(const char gmx_unused *filename)
+{
+    return FALSE;
+}
@@ -586,3 +586,25 @@ void gmx_fft_cleanup()
 {
     FFTWPREFIX(cleanup)();
 }
+
+gmx_bool gmx_fft_import_wisdom(const char *filename)
+{
+    int ret;
+
+    FFTW_LOCK;
+    ret = FFTWPREFIX(import_wisdom_from_filename)(filename);
+    FFTW_UNLOCK;
+
+    return (ret != 0);
+}
+
+gmx_bool gmx_fft_export_wisdom(const char *filename)
+{
+    int ret;
+
+    FFTW_LOCK;
+    ret = FFTWPREFIX(export_wisdom_to_filename)(filename);
+    FFTW_UNLOCK;
+
+    return (ret != 0);
+}
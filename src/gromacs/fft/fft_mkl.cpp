@@ -2,7 +2,7 @@
  * This file is part of the GROMACS molecular simulation package.
  *
  * Copyright (c) 1991-2003 David van der Spoel, Erik Lindahl, University of Groningen.
- * Copyright (c) 2013,2014,2015,2016, by the GROMACS development team, led by
+ * Copyright (c) 2013,2014,2015,2016,2017, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -637,3 +637,13 @@ void gmx_fft_cleanup()
 {
     mkl_free_buffers();
 }
+
+gmx_bool gmx_fft_import_wisdom(const char gmx_unused *filename)
+{
+    return FALSE;
+}
+
+gmx_bool gmx_fft_export_wisdom(const char gmx_unused *filename)
+{
+    return FALSE;
+}
@@ -72,6 +72,11 @@ gmx_parallel_3dfft_init   (gmx_parallel_3dfft_t     *    pfft_setup,
     {
         flags |= FFT5D_NOMEASURE;
     }
+    if (getenv("GMX_PME_FFT_PIPELINE") != nullptr)
+    {
+        /* Overlap the FFTs with the transpose communication */
+        flags |= FFT5D_PIPELINE;
+    }
 
     if (!(flags&FFT5D_ORDER_YZ))
     {
@@ -115,6 +115,7 @@ enum tpxv {
     tpxv_ReplacePullPrintCOM12,                              /**< Replaced print-com-1, 2 with pull-print-com */
     tpxv_PullExternalPotential,                              /**< Added pull type external potential */
     tpxv_GenericParamsForElectricField,                      /**< Introduced KeyValueTree and moved electric field parameters */
+    tpxv_PmeMultipleTimeStepping,                            /**< Added pme-mts-factor for multiple time-stepping of the PME mesh */
     tpxv_Count                                               /**< the total number of tpxv versions */
 };
 
@@ -1278,6 +1279,14 @@ static void do_inputrec(t_fileio *fio, t_inputrec *ir, gmx_bool bRead,
     }
     gmx_fio_do_int(fio, ir->ewald_geometry);
     gmx_fio_do_real(fio, ir->epsilon_surface);
+    if (file_version >= tpxv_PmeMultipleTimeStepping)
+    {
+        gmx_fio_do_int(fio, ir->pme_mts_factor);
+    }
+    else
+    {
+        ir->pme_mts_factor = 1;
+    }
 
     /* ignore bOptFFT */
     if (file_version < tpxv_RemoveObsoleteParameters1)
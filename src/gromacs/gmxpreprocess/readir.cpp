@@ -1225,6 +1225,42 @@ void check_ir(const char *mdparin, t_inputrec *ir, t_gromppopts *opts,
         }
     }
 
+    if (ir->pme_mts_factor != 1)
+    {
+        sprintf(err_buf, "pme-mts-factor should be at least 1");
+        CHECK(ir->pme_mts_factor < 1);
+        sprintf(err_buf, "pme-mts-factor > 1 is only supported with integrator = %s",
+                ei_names[eiMD]);
+        CHECK(ir->eI != eiMD);
+        sprintf(err_buf, "pme-mts-factor > 1 is only supported with cutoff-scheme = %s",
+                ecutscheme_names[ecutsVERLET]);
+        CHECK(ir->cutoff_scheme != ecutsVERLET);
+        sprintf(err_buf, "pme-mts-factor > 1 requires coulombtype = %s or vdwtype = %s",
+                eel_names[eelPME], evdw_names[evdwPME]);
+        CHECK(!EEL_PME(ir->coulombtype) && !EVDW_PME(ir->vdwtype));
+
+        if (ir->pme_mts_factor > 1)
+        {
+            if (ir->nstcalcenergy > 0 && ir->nstcalcenergy % ir->pme_mts_factor != 0)
+            {
+                sprintf(warn_buf, "nstcalcenergy (%d) is not a multiple of pme-mts-factor (%d). The PME mesh energy and virial will be computed additionally at energy steps that are not mesh steps, which does not affect the dynamics, but costs performance.",
+                        ir->nstcalcenergy, ir->pme_mts_factor);
+                warning_note(wi, warn_buf);
+            }
+            if (ir->epc != epcNO && ir->nstpcouple % ir->pme_mts_factor != 0)
+            {
+                sprintf(warn_buf, "nstpcouple (%d) is not a multiple of pme-mts-factor (%d). The PME mesh virial will be computed additionally at pressure coupling steps that are not mesh steps, which does not affect the dynamics, but costs performance.",
+                        ir->nstpcouple, ir->pme_mts_factor);
+                warning_note(wi, warn_buf);
+            }
+            /* The output forces contain the weighted mesh forces
+             * only at steps that are a multiple of pme-mts-factor.
+             */
+            check_nst("pme-mts-factor", ir->pme_mts_factor,
+                      "nstfout", &ir->nstfout, wi);
+        }
+    }
+
     if (ir_vdw_switched(ir))
     {
         sprintf(err_buf, "With switched vdw forces or potentials, rvdw-switch must be < rvdw");
@@ -1995,6 +2031,7 @@ void get_ir(const char *mdparin, const char *mdparout,
     EETYPE("lj-pme-comb-rule", ir->ljpme_combination_rule, eljpme_names);
     EETYPE("ewald-geometry", ir->ewald_geometry, eewg_names);
     RTYPE ("epsilon-surface", ir->epsilon_surface, 0.0);
+    ITYPE ("pme-mts-factor", ir->pme_mts_factor, 1);
 
     CCTYPE("IMPLICIT SOLVENT ALGORITHM");
     EETYPE("implicit-solvent", ir->implicit_solvent, eis_names);
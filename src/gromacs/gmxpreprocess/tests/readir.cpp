@@ -106,6 +106,27 @@ class GetIrTest : public ::testing::Test
             auto outputMdpContents = TextReader::readFileToString(outputMdpFilename);
             checker_.checkString(outputMdpContents, "OutputMdpFile");
         }
+        /*! \brief Test the consistency checks of the mdp settings
+         *
+         * Checks whether check_ir() found errors and returns
+         * the processed input record for further checks. */
+        const t_inputrec &runCheckIr(const std::string &inputMdpFileContents)
+        {
+            auto inputMdpFilename  = fileManager_.getTemporaryFilePath("input.mdp");
+            auto outputMdpFilename = fileManager_.getTemporaryFilePath("output.mdp");
+
+            TextWriter::writeFileFromString(inputMdpFilename, inputMdpFileContents);
+
+            get_ir(inputMdpFilename.c_str(), outputMdpFilename.c_str(),
+                   &mdModules_, &ir_, &opts_, WriteMdpHeader::no, wi_);
+            EXPECT_FALSE(warning_errors_exist(wi_)) << "Error parsing mdp file";
+            check_ir(inputMdpFilename.c_str(), &ir_, &opts_, wi_);
+            bool failure = warning_errors_exist(wi_);
+            checker_.checkBoolean(failure, "Error in mdp settings");
+            warning_reset(wi_);
+
+            return ir_;
+        }
 
         TestFileManager                    fileManager_;
         TestReferenceData                  data_;
@@ -170,5 +191,57 @@ TEST_F(GetIrTest, ProducesOutputFromElectricField)
     runTest(inputMdpFile);
 }
 
+TEST_F(GetIrTest, PmeMtsFactorWorksWithPme)
+{
+    const char       *inputMdpFile[] = {
+        "coulombtype = PME",
+        "pme-mts-factor = 2",
+        "nstfout = 6"
+    };
+    const t_inputrec &ir = runCheckIr(joinStrings(inputMdpFile, "\n"));
+    checker_.checkInteger(ir.pme_mts_factor, "pme-mts-factor");
+    checker_.checkInteger(ir.nstfout, "nstfout");
+}
+
+// The test fixture does not allow warnings, so this reports an error
+TEST_F(GetIrTest, PmeMtsFactorRoundsUpForceOutputInterval)
+{
+    const char       *inputMdpFile[] = {
+        "coulombtype = PME",
+        "pme-mts-factor = 2",
+        "nstfout = 5"
+    };
+    const t_inputrec &ir = runCheckIr(joinStrings(inputMdpFile, "\n"));
+    checker_.checkInteger(ir.nstfout, "nstfout");
+}
+
+TEST_F(GetIrTest, PmeMtsFactorRequiresPositiveValue)
+{
+    const char *inputMdpFile[] = {
+        "coulombtype = PME",
+        "pme-mts-factor = 0"
+    };
+    runCheckIr(joinStrings(inputMdpFile, "\n"));
+}
+
+TEST_F(GetIrTest, PmeMtsFactorRequiresMdIntegrator)
+{
+    const char *inputMdpFile[] = {
+        "integrator = sd",
+        "coulombtype = PME",
+        "pme-mts-factor = 2"
+    };
+    runCheckIr(joinStrings(inputMdpFile, "\n"));
+}
+
+TEST_F(GetIrTest, PmeMtsFactorRequiresPme)
+{
+    const char *inputMdpFile[] = {
+        "coulombtype = Reaction-field",
+        "pme-mts-factor = 2"
+    };
+    runCheckIr(joinStrings(inputMdpFile, "\n"));
+}
+
 } // namespace
 } // namespace
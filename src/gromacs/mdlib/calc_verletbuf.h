@@ -78,6 +78,8 @@ void verletbuf_get_list_setup(gmx_bool                bSIMD,
 /* Calculate the non-bonded pair-list buffer size for the Verlet list
  * based on the particle masses, temperature, LJ types, charges
  * and constraints as well as the non-bonded force behavior at the cut-off.
+ * The buffer is determined for a list that is used for nstlist steps,
+ * which does not need to match ir->nstlist, e.g. for dynamic pruning.
  * If reference_temperature < 0, the maximum coupling temperature will be used.
  * The target is a maximum energy drift of ir->verletbuf_tol.
  * Returns the number of non-linear virtual sites. For these it's difficult
@@ -86,6 +88,7 @@ void verletbuf_get_list_setup(gmx_bool                bSIMD,
  */
 void calc_verlet_buffer_size(const gmx_mtop_t *mtop, real boxvol,
                              const t_inputrec *ir,
+                             int nstlist,
                              real reference_temperature,
                              const verletbuf_list_setup_t *list_setup,
                              int *n_nonlin_vsite,
@@ -1034,7 +1034,12 @@ static void do_lincs(rvec *x, rvec *xp, matrix box, t_pbc *pbc,
 
     for (iter = 0; iter < lincsd->nIter; iter++)
     {
-        if ((lincsd->bCommIter && DOMAINDECOMP(cr) && cr->dd->constraints))
+        /* With redundant iterations, domain decomposition has provided
+         * enough coupled constraints to compute the corrected non-local
+         * coordinates required by our local constraints ourselves.
+         */
+        if ((lincsd->bCommIter && DOMAINDECOMP(cr) && cr->dd->constraints &&
+             !cr->dd->bRedundantConstrIter))
         {
 #pragma omp barrier
 #pragma omp master
@@ -1058,7 +1058,8 @@ static void constr_recur(const t_blocka *at2con,
 
 static real constr_r_max_moltype(const gmx_moltype_t *molt,
                                  const t_iparams     *iparams,
-                                 const t_inputrec    *ir)
+                                 const t_inputrec    *ir,
+                                 int                  nrec)
 {
     int      natoms, nflexcon, *path, at, count;
 
@@ -1075,8 +1076,8 @@ static real constr_r_max_moltype(const gmx_moltype_t *molt,
 
     at2con = make_at2con(0, natoms, molt->ilist, iparams,
                          EI_DYNAMICS(ir->eI), &nflexcon);
-    snew(path, 1+ir->nProjOrder);
-    for (at = 0; at < 1+ir->nProjOrder; at++)
+    snew(path, 1+nrec);
+    for (at = 0; at < 1+nrec; at++)
     {
         path[at] = -1;
     }
@@ -1089,7 +1090,7 @@ static real constr_r_max_moltype(const gmx_moltype_t *molt,
 
         count = 0;
         constr_recur(&at2con, molt->ilist, iparams,
-                     FALSE, at, 0, 1+ir->nProjOrder, path, r0, r1, &r2maxA, &count);
+                     FALSE, at, 0, 1+nrec, path, r0, r1, &r2maxA, &count);
     }
     if (ir->efep == efepNO)
     {
@@ -1104,7 +1105,7 @@ static real constr_r_max_moltype(const gmx_moltype_t *molt,
             r1    = 0;
             count = 0;
             constr_recur(&at2con, molt->ilist, iparams,
-                         TRUE, at, 0, 1+ir->nProjOrder, path, r0, r1, &r2maxB, &count);
+                         TRUE, at, 0, 1+nrec, path, r0, r1, &r2maxB, &count);
         }
         lam0 = ir->fepvals->init_lambda;
         if (EI_DYNAMICS(ir->eI))
@@ -1125,7 +1126,8 @@ static real constr_r_max_moltype(const gmx_moltype_t *molt,
     return rmax;
 }
 
-real constr_r_max(FILE *fplog, const gmx_mtop_t *mtop, const t_inputrec *ir)
+real constr_r_max(FILE *fplog, const gmx_mtop_t *mtop, const t_inputrec *ir,
+                  int nrec)
 {
     int  mt;
     real rmax;
@@ -1135,12 +1137,12 @@ real constr_r_max(FILE *fplog, const gmx_mtop_t *mtop, const t_inputrec *ir)
     {
         rmax = std::max(rmax,
                         constr_r_max_moltype(&mtop->moltype[mt],
-                                             mtop->ffparams.iparams, ir));
+                                             mtop->ffparams.iparams, ir, nrec));
     }
 
     if (fplog)
     {
-        fprintf(fplog, "Maximum distance for %d constraints, at 120 deg. angles, all-trans: %.3f nm\n", 1+ir->nProjOrder, rmax);
+        fprintf(fplog, "Maximum distance for %d constraints, at 120 deg. angles, all-trans: %.3f nm\n", 1+nrec, rmax);
     }
 
     return rmax;
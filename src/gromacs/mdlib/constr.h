@@ -273,9 +273,10 @@ void set_lincs(const t_idef *idef, const t_mdatoms *md,
 void set_lincs_matrix(gmx_lincsdata_t li, const real *invmass, real lambda);
 /* Sets the elements of the LINCS constraint coupling matrix */
 
-real constr_r_max(FILE *fplog, const gmx_mtop_t *mtop, const t_inputrec *ir);
+real constr_r_max(FILE *fplog, const gmx_mtop_t *mtop, const t_inputrec *ir,
+                  int nrec);
 /* Returns an estimate of the maximum distance between atoms
- * required for LINCS.
+ * required for LINCS, when walking out over nrec coupled constraints.
  */
 
 gmx_bool
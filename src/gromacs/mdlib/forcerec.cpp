@@ -73,6 +73,7 @@
 #include "gromacs/mdlib/nbnxn_gpu_data_mgmt.h"
 #include "gromacs/mdlib/nbnxn_search.h"
 #include "gromacs/mdlib/nbnxn_simd.h"
+#include "gromacs/mdlib/nbnxn_tuning.h"
 #include "gromacs/mdlib/nbnxn_util.h"
 #include "gromacs/mdlib/ns.h"
 #include "gromacs/mdlib/qmmm.h"
@@ -1508,6 +1509,11 @@ void forcerec_set_ranges(t_forcerec *fr,
         /* TODO: remove this + 1 when padding is properly implemented */
         fr->forceBufferNoVirialSummation->resize(natoms_f_novirsum + 1);
     }
+    if (fr->pmeMtsFactor > 1)
+    {
+        /* TODO: remove this + 1 when padding is properly implemented */
+        fr->forceBufferPmeMts->resize(natoms_f_novirsum + 1);
+    }
 }
 
 static real cutoff_inf(real cutoff)
@@ -2100,11 +2106,64 @@ init_interaction_const(FILE                       *fp,
     *interaction_const = ic;
 }
 
+/*! \brief Returns the combination rule setting for the nbnxn atom data */
+static int nbnxn_atomdata_combination_rule(const t_forcerec *fr)
+{
+    if (fr->vdwtype == evdwCUT &&
+        (fr->vdw_modifier == eintmodNONE ||
+         fr->vdw_modifier == eintmodPOTSHIFT) &&
+        getenv("GMX_NO_LJ_COMB_RULE") == nullptr)
+    {
+        /* Plain LJ cut-off: we can optimize with combination rules */
+        return enbnxninitcombruleDETECT;
+    }
+    else if (fr->vdwtype == evdwPME)
+    {
+        /* LJ-PME: we need to use a combination rule for the grid */
+        if (fr->ljpme_combination_rule == eljpmeGEOM)
+        {
+            return enbnxninitcombruleGEOM;
+        }
+        else
+        {
+            return enbnxninitcombruleLB;
+        }
+    }
+    else
+    {
+        /* We use a full combination matrix: no rule required */
+        return enbnxninitcombruleNONE;
+    }
+}
+
+nbnxn_atomdata_t *init_nbnxn_atomdata_cpu(const t_forcerec *fr,
+                                          const t_inputrec *ir,
+                                          int               kernel_type)
+{
+    nbnxn_atomdata_t *nbat;
+
+    GMX_RELEASE_ASSERT(nbnxn_kernel_pairlist_simple(kernel_type), "init_nbnxn_atomdata_cpu only supports CPU kernels");
+
+    snew(nbat, 1);
+    nbnxn_atomdata_init(nullptr,
+                        nbat,
+                        kernel_type,
+                        nbnxn_atomdata_combination_rule(fr),
+                        fr->ntype, fr->nbfp,
+                        ir->opts.ngener,
+                        gmx_omp_nthreads_get(emntNonbonded),
+                        nullptr, nullptr);
+
+    return nbat;
+}
+
 static void init_nb_verlet(FILE                *fp,
                            const gmx::MDLogger &mdlog,
                            nonbonded_verlet_t **nb_verlet,
                            gmx_bool             bFEP_NonBonded,
                            const t_inputrec    *ir,
+                           const gmx_mtop_t    *mtop,
+                           matrix               box,
                            const t_forcerec    *fr,
                            const t_commrec     *cr,
                            const char          *nbpu_opt)
@@ -2165,6 +2224,14 @@ static void init_nb_verlet(FILE                *fp,
         }
     }
 
+    gmx_bool useSimpleLists = !bEmulateGPU;
+    for (i = 0; i < nbv->ngrp; i++)
+    {
+        useSimpleLists = useSimpleLists && nbnxn_kernel_pairlist_simple(nbv->grp[i].kernel_type);
+    }
+    setupDynamicPairlistPruning(fp, ir, mtop, box, useSimpleLists, fr->ic,
+                                &nbv->listParams);
+
     nbnxn_init_search(&nbv->nbs,
                       DOMAINDECOMP(cr) ? &cr->dd->nc : nullptr,
                       DOMAINDECOMP(cr) ? domdec_zones(cr->dd) : nullptr,
@@ -2186,42 +2253,14 @@ static void init_nb_verlet(FILE                *fp,
             nbv->grp[0].kernel_type != nbv->grp[i].kernel_type)
         {
             gmx_bool bSimpleList;
-            int      enbnxninitcombrule;
 
             bSimpleList = nbnxn_kernel_pairlist_simple(nbv->grp[i].kernel_type);
 
-            if (fr->vdwtype == evdwCUT &&
-                (fr->vdw_modifier == eintmodNONE ||
-                 fr->vdw_modifier == eintmodPOTSHIFT) &&
-                getenv("GMX_NO_LJ_COMB_RULE") == nullptr)
-            {
-                /* Plain LJ cut-off: we can optimize with combination rules */
-                enbnxninitcombrule = enbnxninitcombruleDETECT;
-            }
-            else if (fr->vdwtype == evdwPME)
-            {
-                /* LJ-PME: we need to use a combination rule for the grid */
-                if (fr->ljpme_combination_rule == eljpmeGEOM)
-                {
-                    enbnxninitcombrule = enbnxninitcombruleGEOM;
-                }
-                else
-                {
-                    enbnxninitcombrule = enbnxninitcombruleLB;
-                }
-            }
-            else
-            {
-                /* We use a full combination matrix: no rule required */
-                enbnxninitcombrule = enbnxninitcombruleNONE;
-            }
-
-
             snew(nbv->grp[i].nbat, 1);
             nbnxn_atomdata_init(fp,
                                 nbv->grp[i].nbat,
                                 nbv->grp[i].kernel_type,
-                                enbnxninitcombrule,
+                                nbnxn_atomdata_combination_rule(fr),
                                 fr->ntype, fr->nbfp,
                                 ir->opts.ngener,
                                 bSimpleList ? gmx_omp_nthreads_get(emntNonbonded) : 1,
@@ -2833,6 +2872,13 @@ void init_forcerec(FILE                *fp,
         fr->forceBufferNoVirialSummation = new PaddedRVecVector;
     }
 
+    fr->pmeMtsFactor = ir->pme_mts_factor;
+    fr->bDoPmeMesh   = TRUE;
+    if (fr->pmeMtsFactor > 1)
+    {
+        fr->forceBufferPmeMts = new PaddedRVecVector;
+    }
+
     if (fr->cutoff_scheme == ecutsGROUP &&
         ncg_mtop(mtop) > fr->cg_nalloc && !DOMAINDECOMP(cr))
     {
@@ -3209,7 +3255,7 @@ void init_forcerec(FILE                *fp,
             GMX_RELEASE_ASSERT(ir->rcoulomb == ir->rvdw, "With Verlet lists and no PME rcoulomb and rvdw should be identical");
         }
 
-        init_nb_verlet(fp, mdlog, &fr->nbv, bFEP_NonBonded, ir, fr, cr, nbpu_opt);
+        init_nb_verlet(fp, mdlog, &fr->nbv, bFEP_NonBonded, ir, mtop, box, fr, cr, nbpu_opt);
     }
 
     if (ir->eDispCorr != edispcNO)
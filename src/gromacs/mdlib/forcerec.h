@@ -45,6 +45,7 @@
 #include "gromacs/timing/wallcycle.h"
 
 struct IForceProvider;
+struct nbnxn_atomdata_t;
 struct t_commrec;
 struct t_fcdata;
 struct t_filenm;
@@ -93,6 +94,19 @@ void init_interaction_const_tables(FILE                   *fp,
                                    interaction_const_t    *ic,
                                    real                    rtab);
 
+/*! \brief Initialize atom data for the CPU non-bonded kernel type kernel_type
+ *
+ * The atom data uses the same interaction parameters and settings
+ * as the atom data set up by init_forcerec. This is used to switch
+ * the CPU kernel cluster layout during a run.
+ * \param[in]  fr          The forcerec
+ * \param[in]  ir          Inputrec structure
+ * \param[in]  kernel_type The nbnxn CPU kernel type
+ */
+nbnxn_atomdata_t *init_nbnxn_atomdata_cpu(const t_forcerec *fr,
+                                          const t_inputrec *ir,
+                                          int               kernel_type);
+
 /*! \brief Initialize forcerec structure.
  *
  * The Force rec struct must be created with mk_forcerec.
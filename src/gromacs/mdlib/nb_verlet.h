@@ -97,6 +97,7 @@ typedef struct nonbonded_verlet_group_t {
 
 /* non-bonded data structure with Verlet-type cut-off */
 typedef struct nonbonded_verlet_t {
+    NbnxnListParameters      listParams;      /* parameters for the (dual) pair-list   */
     nbnxn_search_t           nbs;             /* n vs n atom pair searching data       */
     int                      ngrp;            /* number of interaction groups          */
     nonbonded_verlet_group_t grp[2];          /* local and non-local interaction group */
@@ -582,6 +582,7 @@ void nbnxn_atomdata_init(FILE *fp,
     nbat->alloc((void **)&nbat->nbfp,
                 nbat->ntype*nbat->ntype*2*sizeof(*nbat->nbfp));
     nbat->alloc((void **)&nbat->nbfp_comb, nbat->ntype*2*sizeof(*nbat->nbfp_comb));
+    nbat->nbfp_aligned = nullptr;
 
     /* A tolerance of 1e-5 seems reasonable for (possibly hand-typed)
      * force-field floating point parameters.
@@ -687,6 +688,7 @@ void nbnxn_atomdata_init(FILE *fp,
                 nbat->comb_rule = ljcrNONE;
 
                 nbat->free(nbat->nbfp_comb);
+                nbat->nbfp_comb = nullptr;
             }
 
             if (fp)
@@ -712,6 +714,7 @@ void nbnxn_atomdata_init(FILE *fp,
             nbat->comb_rule = ljcrNONE;
 
             nbat->free(nbat->nbfp_comb);
+            nbat->nbfp_comb = nullptr;
             break;
         default:
             gmx_incons("Unknown enbnxninitcombrule");
@@ -784,6 +787,11 @@ void nbnxn_atomdata_init(FILE *fp,
     nbat->fstride = (nbat->FFormat == nbatXYZQ ? STRIDE_XYZQ : DIM);
     nbat->x       = nullptr;
 
+    nbat->simd_4xn_diagonal_j_minus_i  = nullptr;
+    nbat->simd_2xnn_diagonal_j_minus_i = nullptr;
+    nbat->simd_exclusion_filter        = nullptr;
+    nbat->simd_exclusion_filter64      = nullptr;
+    nbat->simd_interaction_array       = nullptr;
 #if GMX_SIMD
     if (simple)
     {
@@ -830,6 +838,50 @@ void nbnxn_atomdata_init(FILE *fp,
         }
         snew(nbat->syncStep, nth);
     }
+    else
+    {
+        nbat->syncStep = nullptr;
+    }
+}
+
+void nbnxn_atomdata_destroy(nbnxn_atomdata_t *nbat)
+{
+    nbat->free(nbat->nbfp);
+    nbat->free(nbat->nbfp_comb);
+    nbat->free(nbat->nbfp_aligned);
+    nbat->free(nbat->type);
+    nbat->free(nbat->lj_comb);
+    nbat->free(nbat->q);
+    nbat->free(nbat->energrp);
+    nbat->free(nbat->shift_vec);
+    nbat->free(nbat->x);
+
+    sfree_aligned(nbat->simd_4xn_diagonal_j_minus_i);
+    sfree_aligned(nbat->simd_2xnn_diagonal_j_minus_i);
+    sfree_aligned(nbat->simd_exclusion_filter);
+    sfree_aligned(nbat->simd_exclusion_filter64);
+    sfree_aligned(nbat->simd_interaction_array);
+
+    for (int i = 0; i < nbat->nout; i++)
+    {
+        nbnxn_atomdata_output_t *out = &nbat->out[i];
+
+        nbat->free(out->f);
+        nbat->free(out->fshift);
+        nbat->free(out->Vvdw);
+        nbat->free(out->Vc);
+        if (out->nVS > 0)
+        {
+            nbat->free(out->VSvdw);
+            nbat->free(out->VSc);
+        }
+    }
+    sfree(nbat->out);
+
+    sfree(nbat->buffer_flags.flag);
+    sfree(nbat->syncStep);
+
+    sfree(nbat);
 }
 
 template<int packSize>
@@ -1539,54 +1591,106 @@ static void nbnxn_atomdata_add_nbat_f_to_f_treereduce(const nbnxn_atomdata_t *nb
 }
 
 
-static void nbnxn_atomdata_add_nbat_f_to_f_stdreduce(const nbnxn_atomdata_t *nbat,
-                                                     int                     nth)
+/* Reduce the thread force output buffers for buffer-flag blocks b0 to b1
+ * and add the result directly to f, in the spatially sorted grid order.
+ * Only the output buffers flagged as written for a block are read.
+ * With packSize=0 the force output uses a plain stride, otherwise
+ * the packed format with packSize.
+ */
+template<int packSize>
+static void
+nbnxn_atomdata_reduce_blocks_to_f(const nbnxn_search_t    nbs,
+                                  const nbnxn_atomdata_t *nbat,
+                                  int b0, int b1,
+                                  rvec *f)
+{
+    const nbnxn_buffer_flags_t *flags   = &nbat->buffer_flags;
+    const int                  *a       = nbs->a;
+    const int                   dstride = (packSize == 0 ? 1 : packSize);
+    const real                 *fptr[NBNXN_BUFFERFLAG_MAX_THREADS];
+
+    for (int b = b0; b < b1; b++)
+    {
+        int nfptr = 0;
+        for (int out = 0; out < nbat->nout; out++)
+        {
+            if (bitmask_is_set(flags->flag[b], out))
+            {
+                fptr[nfptr++] = nbat->out[out].f;
+            }
+        }
+        if (nfptr == 0)
+        {
+            /* No forces were computed for the atoms in this block */
+            continue;
+        }
+
+        int i0 = b*NBNXN_BUFFERFLAG_SIZE;
+        int i1 = std::min((b + 1)*NBNXN_BUFFERFLAG_SIZE, nbat->natoms);
+        for (int i = i0; i < i1; i++)
+        {
+            int ai = a[i];
+            if (ai < 0)
+            {
+                /* Filler particle */
+                continue;
+            }
+
+            int  ind = (packSize == 0 ? i*nbat->fstride : atom_to_x_index<packSize>(i));
+
+            real fx  = 0;
+            real fy  = 0;
+            real fz  = 0;
+            for (int fa = 0; fa < nfptr; fa++)
+            {
+                fx += fptr[fa][ind];
+                fy += fptr[fa][ind + dstride];
+                fz += fptr[fa][ind + 2*dstride];
+            }
+            f[ai][XX] += fx;
+            f[ai][YY] += fy;
+            f[ai][ZZ] += fz;
+        }
+    }
+}
+
+/* Reduce the thread force output buffers and add them to f in one pass.
+ * Each thread processes a contiguous range of buffer-flag blocks, which
+ * are spatially local in the grid order. Since every atom occurs only
+ * once in the grid, the threads never write the same elements of f.
+ * Compared to first reducing into buffer 0 and then adding buffer 0
+ * to f, this avoids a full write and read pass over the force buffer.
+ */
+static void nbnxn_atomdata_add_nbat_f_to_f_blocked(const nbnxn_search_t    nbs,
+                                                   const nbnxn_atomdata_t *nbat,
+                                                   int                     nth,
+                                                   rvec                   *f)
 {
+    const int nflag = nbat->buffer_flags.nflag;
+
 #pragma omp parallel for num_threads(nth) schedule(static)
     for (int th = 0; th < nth; th++)
     {
         try
         {
-            const nbnxn_buffer_flags_t *flags;
-            int   nfptr;
-            real *fptr[NBNXN_BUFFERFLAG_MAX_THREADS];
-
-            flags = &nbat->buffer_flags;
-
             /* Calculate the cell-block range for our thread */
-            int b0 = (flags->nflag* th   )/nth;
-            int b1 = (flags->nflag*(th+1))/nth;
+            int b0 = (nflag* th   )/nth;
+            int b1 = (nflag*(th+1))/nth;
 
-            for (int b = b0; b < b1; b++)
+            switch (nbat->FFormat)
             {
-                int i0 =  b   *NBNXN_BUFFERFLAG_SIZE*nbat->fstride;
-                int i1 = (b+1)*NBNXN_BUFFERFLAG_SIZE*nbat->fstride;
-
-                nfptr = 0;
-                for (int out = 1; out < nbat->nout; out++)
-                {
-                    if (bitmask_is_set(flags->flag[b], out))
-                    {
-                        fptr[nfptr++] = nbat->out[out].f;
-                    }
-                }
-                if (nfptr > 0)
-                {
-#if GMX_SIMD
-                    nbnxn_atomdata_reduce_reals_simd
-#else
-                    nbnxn_atomdata_reduce_reals
-#endif
-                        (nbat->out[0].f,
-                        bitmask_is_set(flags->flag[b], 0),
-                        fptr, nfptr,
-                        i0, i1);
-                }
-                else if (!bitmask_is_set(flags->flag[b], 0))
-                {
-                    nbnxn_atomdata_clear_reals(nbat->out[0].f,
-                                               i0, i1);
-                }
+                case nbatXYZ:
+                case nbatXYZQ:
+                    nbnxn_atomdata_reduce_blocks_to_f<0>(nbs, nbat, b0, b1, f);
+                    break;
+                case nbatX4:
+                    nbnxn_atomdata_reduce_blocks_to_f<c_packX4>(nbs, nbat, b0, b1, f);
+                    break;
+                case nbatX8:
+                    nbnxn_atomdata_reduce_blocks_to_f<c_packX8>(nbs, nbat, b0, b1, f);
+                    break;
+                default:
+                    gmx_incons("Unsupported nbnxn_atomdata_t format");
             }
         }
         GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
@@ -1628,17 +1732,20 @@ void nbnxn_atomdata_add_nbat_f_to_f(const nbnxn_search_t    nbs,
             gmx_incons("add_f_to_f called with nout>1 and locality!=eatAll");
         }
 
+        if (!nbat->bUseTreeReduce)
+        {
+            /* Reduce the force thread output buffers directly into f */
+            nbnxn_atomdata_add_nbat_f_to_f_blocked(nbs, nbat, nth, f);
+
+            nbs_cycle_stop(&nbs->cc[enbsCCreducef]);
+
+            return;
+        }
+
         /* Reduce the force thread output buffers into buffer 0, before adding
          * them to the, differently ordered, "real" force buffer.
          */
-        if (nbat->bUseTreeReduce)
-        {
-            nbnxn_atomdata_add_nbat_f_to_f_treereduce(nbat, nth);
-        }
-        else
-        {
-            nbnxn_atomdata_add_nbat_f_to_f_stdreduce(nbat, nth);
-        }
+        nbnxn_atomdata_add_nbat_f_to_f_treereduce(nbat, nth);
     }
 #pragma omp parallel for num_threads(nth) schedule(static)
     for (int th = 0; th < nth; th++)
@@ -89,6 +89,9 @@ void nbnxn_atomdata_init(FILE *fp,
                          nbnxn_alloc_t *alloc,
                          nbnxn_free_t  *free);
 
+/* Free all data in nbat and nbat itself, nbat should be allocated with snew */
+void nbnxn_atomdata_destroy(nbnxn_atomdata_t *nbat);
+
 /* Copy the atom data to the non-bonded atom data structure */
 void nbnxn_atomdata_set(nbnxn_atomdata_t    *nbat,
                         int                  locality,
@@ -67,7 +67,10 @@ static void nbnxn_grid_init(nbnxn_grid_t * grid)
 {
     grid->cxy_na      = nullptr;
     grid->cxy_ind     = nullptr;
+    grid->cxy_ind_prev = nullptr;
+    grid->cxy_nfill   = nullptr;
     grid->cxy_nalloc  = 0;
+    grid->ncxy_prev   = -1;
     grid->bb          = nullptr;
     grid->bbj         = nullptr;
     grid->nc_nalloc   = 0;
@@ -174,6 +177,8 @@ static int set_grid_size_xy(const nbnxn_search_t nbs,
         grid->cxy_nalloc = over_alloc_large(grid->ncx*grid->ncy+1);
         srenew(grid->cxy_na, grid->cxy_nalloc);
         srenew(grid->cxy_ind, grid->cxy_nalloc+1);
+        srenew(grid->cxy_ind_prev, grid->cxy_nalloc+1);
+        srenew(grid->cxy_nfill, grid->cxy_nalloc);
     }
     for (int t = 0; t < nbs->nthread_max; t++)
     {
@@ -194,12 +199,23 @@ static int set_grid_size_xy(const nbnxn_search_t nbs,
         nc_max = n/grid->na_sc + grid->ncx*grid->ncy*grid->na_cj/grid->na_c;
     }
 
-    if (nc_max > grid->nc_nalloc)
+    /* bbj is an alias of bb when the i- and j-cluster sizes are equal.
+     * When the kernel layout changed, we need to (re)allocate bbj.
+     */
+    gmx_bool bbjLayoutChanged = (grid->bSimple && grid->nc_nalloc > 0 &&
+                                 ((grid->bbj == grid->bb) != (grid->na_cj == grid->na_c)));
+
+    if (nc_max > grid->nc_nalloc || bbjLayoutChanged)
     {
-        grid->nc_nalloc = over_alloc_large(nc_max);
+        grid->nc_nalloc = std::max(grid->nc_nalloc, over_alloc_large(nc_max));
         srenew(grid->nsubc, grid->nc_nalloc);
         srenew(grid->bbcz, grid->nc_nalloc*NNBSBB_D);
 
+        if (grid->bbj != grid->bb)
+        {
+            sfree_aligned(grid->bbj);
+        }
+        grid->bbj = nullptr;
         sfree_aligned(grid->bb);
         /* This snew also zeros the contents, this avoid possible
          * floating exceptions in SIMD with the unused bb elements.
@@ -228,7 +244,6 @@ static int set_grid_size_xy(const nbnxn_search_t nbs,
             }
             else
             {
-                sfree_aligned(grid->bbj);
                 snew_aligned(grid->bbj, grid->nc_nalloc*grid->na_c/grid->na_cj, 16);
             }
         }
@@ -626,13 +641,14 @@ static void calc_bounding_box_xxxx_simd4(int na, const float *x,
 #endif /* NBNXN_SEARCH_SIMD4_FLOAT_X_BB */
 
 
-/* Combines pairs of consecutive bounding boxes */
-static void combine_bounding_box_pairs(nbnxn_grid_t *grid, const nbnxn_bb_t *bb)
+/* Combines pairs of consecutive bounding boxes for columns cxy_start to cxy_end */
+static void combine_bounding_box_pairs(nbnxn_grid_t *grid, const nbnxn_bb_t *bb,
+                                       int cxy_start, int cxy_end)
 {
     // TODO: During SIMDv2 transition only some archs use namespace (remove when done)
     using namespace gmx;
 
-    for (int i = 0; i < grid->ncx*grid->ncy; i++)
+    for (int i = cxy_start; i < cxy_end; i++)
     {
         /* Starting bb in a column is expected to be 2-aligned */
         int sc2 = grid->cxy_ind[i]>>1;
@@ -964,7 +980,50 @@ static void fill_cell(const nbnxn_search_t nbs,
     }
 }
 
-/* Spatially sort the atoms within one grid column */
+/* Fill the cells of the z-sorted grid column cxy of a simple grid */
+static void fill_column_simple(const nbnxn_search_t nbs,
+                               nbnxn_grid_t *grid,
+                               const int *atinfo,
+                               rvec *x,
+                               nbnxn_atomdata_t *nbat,
+                               int cxy)
+{
+    int na  = grid->cxy_na[cxy];
+    int ncz = grid->cxy_ind[cxy+1] - grid->cxy_ind[cxy];
+    int ash = (grid->cell0 + grid->cxy_ind[cxy])*grid->na_sc;
+
+    /* Fill the ncz cells in this column */
+    int cfilled = grid->cxy_ind[cxy];
+    for (int cz = 0; cz < ncz; cz++)
+    {
+        int c     = grid->cxy_ind[cxy] + cz;
+
+        int ash_c = ash + cz*grid->na_sc;
+        int na_c  = std::min(grid->na_sc, na-(ash_c-ash));
+
+        fill_cell(nbs, grid, nbat,
+                  ash_c, ash_c+na_c, atinfo, x,
+                  nullptr);
+
+        /* This copy to bbcz is not really necessary.
+         * But it allows to use the same grid search code
+         * for the simple and supersub cell setups.
+         */
+        if (na_c > 0)
+        {
+            cfilled = c;
+        }
+        grid->bbcz[c*NNBSBB_D  ] = grid->bb[cfilled].lower[BB_Z];
+        grid->bbcz[c*NNBSBB_D+1] = grid->bb[cfilled].upper[BB_Z];
+    }
+
+    /* Set the unused atom indices to -1 */
+    for (int ind = na; ind < ncz*grid->na_sc; ind++)
+    {
+        nbs->a[ash+ind] = -1;
+    }
+}
+
 static void sort_columns_simple(const nbnxn_search_t nbs,
                                 int dd_zone,
                                 nbnxn_grid_t *grid,
@@ -975,8 +1034,6 @@ static void sort_columns_simple(const nbnxn_search_t nbs,
                                 int cxy_start, int cxy_end,
                                 int *sort_work)
 {
-    int  cfilled, c;
-
     if (debug)
     {
         fprintf(debug, "cell0 %d sorting columns %d - %d, atoms %d - %d\n",
@@ -997,36 +1054,104 @@ static void sort_columns_simple(const nbnxn_search_t nbs,
                    1.0/grid->size[ZZ], ncz*grid->na_sc,
                    sort_work);
 
-        /* Fill the ncz cells in this column */
-        cfilled = grid->cxy_ind[cxy];
-        for (int cz = 0; cz < ncz; cz++)
-        {
-            c  = grid->cxy_ind[cxy] + cz;
+        fill_column_simple(nbs, grid, atinfo, x, nbat, cxy);
+    }
+}
 
-            int ash_c = ash + cz*grid->na_sc;
-            int na_c  = std::min(grid->na_sc, na-(ash_c-ash));
+/* Sort the n atoms in a on increasing coordinate x[][dim] with insertion sort.
+ * The order is the same as with sort_atoms: atoms with identical
+ * coordinates are ordered on index.
+ * This is efficient when a is (nearly) sorted already.
+ */
+static void sort_atoms_insertion(int dim, int *a, int n, const rvec *x)
+{
+    for (int i = 1; i < n; i++)
+    {
+        int  ai = a[i];
+        real xi = x[ai][dim];
+        int  j  = i;
+        while (j > 0 && (x[a[j-1]][dim] > xi ||
+                         (x[a[j-1]][dim] == xi && a[j-1] > ai)))
+        {
+            a[j] = a[j-1];
+            j--;
+        }
+        a[j] = ai;
+    }
+}
 
-            fill_cell(nbs, grid, nbat,
-                      ash_c, ash_c+na_c, atinfo, x,
-                      nullptr);
+/* Puts the atoms of the previous grid that are still in the same column
+ * at the start of columns cxy_start to cxy_end, in their previous order.
+ * The atoms that moved to another column are stored in work->moved.
+ * At this point nbs->cell contains the local grid x,y indices.
+ */
+static void collect_columns_update(const nbnxn_search_t nbs,
+                                   nbnxn_grid_t *grid,
+                                   int cxy_start, int cxy_end,
+                                   nbnxn_search_work_t *work)
+{
+    work->nmoved = 0;
+    for (int cxy = cxy_start; cxy < cxy_end; cxy++)
+    {
+        int ash      = (grid->cell0 + grid->cxy_ind[cxy])*grid->na_sc;
+        int ind_prev = grid->cxy_ind_prev[cxy]*grid->na_sc;
+        int ind_end  = grid->cxy_ind_prev[cxy+1]*grid->na_sc;
+        int nfill    = 0;
 
-            /* This copy to bbcz is not really necessary.
-             * But it allows to use the same grid search code
-             * for the simple and supersub cell setups.
-             */
-            if (na_c > 0)
+        for (; ind_prev < ind_end; ind_prev++)
+        {
+            int a = nbs->a_prev[ind_prev];
+            if (a < 0)
+            {
+                /* Filler particle */
+                continue;
+            }
+            if (nbs->cell[a] == cxy)
+            {
+                nbs->a[ash + nfill++] = a;
+            }
+            else
             {
-                cfilled = c;
+                if (work->nmoved + 1 > work->moved_nalloc)
+                {
+                    work->moved_nalloc = over_alloc_large(work->nmoved + 1);
+                    srenew(work->moved, work->moved_nalloc);
+                }
+                work->moved[work->nmoved++] = a;
             }
-            grid->bbcz[c*NNBSBB_D  ] = grid->bb[cfilled].lower[BB_Z];
-            grid->bbcz[c*NNBSBB_D+1] = grid->bb[cfilled].upper[BB_Z];
         }
+        grid->cxy_nfill[cxy] = nfill;
+    }
+}
 
-        /* Set the unused atom indices to -1 */
-        for (int ind = na; ind < ncz*grid->na_sc; ind++)
+/* Sort the atoms in columns cxy_start to cxy_end on z, starting from
+ * the order of the previous grid, and fill the cells of a simple grid.
+ */
+static void update_columns_simple(const nbnxn_search_t nbs,
+                                  nbnxn_grid_t *grid,
+                                  const int *atinfo,
+                                  rvec *x,
+                                  nbnxn_atomdata_t *nbat,
+                                  int cxy_start, int cxy_end)
+{
+    if (debug)
+    {
+        fprintf(debug, "cell0 %d updating columns %d - %d\n",
+                grid->cell0, cxy_start, cxy_end);
+    }
+
+    for (int cxy = cxy_start; cxy < cxy_end; cxy++)
+    {
+        int ash = (grid->cell0 + grid->cxy_ind[cxy])*grid->na_sc;
+
+        if (grid->cxy_nfill[cxy] != grid->cxy_na[cxy])
         {
-            nbs->a[ash+ind] = -1;
+            gmx_incons("Lost particles while updating the grid");
         }
+
+        sort_atoms_insertion(ZZ, nbs->a+ash, grid->cxy_na[cxy], x);
+
+        fill_column_simple(nbs, grid, atinfo, x, nbat, cxy);
     }
 }
 
@@ -1140,6 +1265,14 @@ static void sort_columns_supersub(const nbnxn_search_t nbs,
     }
 }
 
+/* Returns the range of atoms, out of a0 to a1, assigned to thread */
+static void thread_atom_range(int a0, int a1, int thread, int nthread,
+                              int *n0, int *n1)
+{
+    *n0 = a0 + static_cast<int>((thread+0)*(a1 - a0))/nthread;
+    *n1 = a0 + static_cast<int>((thread+1)*(a1 - a0))/nthread;
+}
+
 /* Determine in which grid column atoms should go */
 static void calc_column_indices(nbnxn_grid_t *grid,
                                 int a0, int a1,
@@ -1155,8 +1288,8 @@ static void calc_column_indices(nbnxn_grid_t *grid,
         cxy_na[i] = 0;
     }
 
-    int n0 = a0 + static_cast<int>((thread+0)*(a1 - a0))/nthread;
-    int n1 = a0 + static_cast<int>((thread+1)*(a1 - a0))/nthread;
+    int n0, n1;
+    thread_atom_range(a0, a1, thread, nthread, &n0, &n1);
     if (dd_zone == 0)
     {
         /* Home zone */
@@ -1232,7 +1365,39 @@ static void calc_column_indices(nbnxn_grid_t *grid,
     }
 }
 
-/* Determine in which grid cells the atoms should go */
+/* Returns the first column for thread, such that the threads get
+ * (nearly) equal numbers of cells and thus atoms to sort.
+ */
+static int thread_column_start(const nbnxn_grid_t *grid,
+                               int thread, int nthread)
+{
+    int ncxy = grid->ncx*grid->ncy;
+
+    if (thread == 0)
+    {
+        return 0;
+    }
+    if (thread == nthread)
+    {
+        return ncxy;
+    }
+
+    int cellStart = static_cast<int>((static_cast<gmx_int64_t>(thread)*grid->nc)/nthread);
+
+    return std::lower_bound(grid->cxy_ind, grid->cxy_ind + ncxy, cellStart) - grid->cxy_ind;
+}
+
+/* When updating the grid, we switch to sorting from scratch when more
+ * than this fraction of the atoms moved to a different column.
+ * The insertion sort cost per moved atom scales with the column size.
+ */
+static const real c_gridUpdateMaxMovedFraction = 0.1;
+
+/* Determine in which grid cells the atoms should go.
+ * With bUpdate the atom order of the previous grid is used as a starting
+ * point, this requires that the atoms and the number of columns did not
+ * change and that the previous grid order is stored in nbs->a_prev.
+ */
 static void calc_cell_indices(const nbnxn_search_t nbs,
                               int dd_zone,
                               nbnxn_grid_t *grid,
@@ -1240,15 +1405,17 @@ static void calc_cell_indices(const nbnxn_search_t nbs,
                               const int *atinfo,
                               rvec *x,
                               const int *move,
-                              nbnxn_atomdata_t *nbat)
+                              nbnxn_atomdata_t *nbat,
+                              gmx_bool bUpdate)
 {
     int   n0, n1;
-    int   cx, cy, cxy, ncz_max, ncz;
+    int   cx, cy, ncz_max, ncz;
     int   nthread;
-    int   cxy_na_i;
 
     nthread = gmx_omp_nthreads_get(emntPairsearch);
 
+    const int ncxy = grid->ncx*grid->ncy;
+
 #pragma omp parallel for num_threads(nthread) schedule(static)
     for (int thread = 0; thread < nthread; thread++)
     {
@@ -1260,36 +1427,49 @@ static void calc_cell_indices(const nbnxn_search_t nbs,
         GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
     }
 
+    /* Reduce the thread-local column atom counts and convert them,
+     * in place, to the thread-local starting offsets within each column.
+     * This is parallelized over columns, since with many threads
+     * the reduction cost is significant. Temporarily store the number
+     * of cells in each column in cxy_ind.
+     */
+#pragma omp parallel for num_threads(nthread) schedule(static)
+    for (int i = 0; i < ncxy + 1; i++)
+    {
+        int na = 0;
+        for (int thread = 0; thread < nthread; thread++)
+        {
+            int na_thread                = nbs->work[thread].cxy_na[i];
+            nbs->work[thread].cxy_na[i]  = na;
+            na                          += na_thread;
+        }
+        grid->cxy_na[i] = na;
+
+        int ncz_i = (na + grid->na_sc - 1)/grid->na_sc;
+        if (nbat->XFormat == nbatX8)
+        {
+            /* Make the number of cell a multiple of 2 */
+            ncz_i = (ncz_i + 1) & ~1;
+        }
+        grid->cxy_ind[i+1] = ncz_i;
+    }
+
     /* Make the cell index as a function of x and y */
     ncz_max          = 0;
-    ncz              = 0;
     grid->cxy_ind[0] = 0;
-    for (int i = 0; i < grid->ncx*grid->ncy+1; i++)
+    for (int i = 0; i < ncxy + 1; i++)
     {
-        /* We set ncz_max at the beginning of the loop iso at the end
-         * to skip i=grid->ncx*grid->ncy which are moved particles
+        ncz = grid->cxy_ind[i+1];
+        /* Skip i=ncxy which are moved particles
          * that do not need to be ordered on the grid.
          */
-        if (ncz > ncz_max)
+        if (i < ncxy && ncz > ncz_max)
         {
             ncz_max = ncz;
         }
-        cxy_na_i = nbs->work[0].cxy_na[i];
-        for (int thread = 1; thread < nthread; thread++)
-        {
-            cxy_na_i += nbs->work[thread].cxy_na[i];
-        }
-        ncz = (cxy_na_i + grid->na_sc - 1)/grid->na_sc;
-        if (nbat->XFormat == nbatX8)
-        {
-            /* Make the number of cell a multiple of 2 */
-            ncz = (ncz + 1) & ~1;
-        }
         grid->cxy_ind[i+1] = grid->cxy_ind[i] + ncz;
-        /* Clear cxy_na, so we can reuse the array below */
-        grid->cxy_na[i] = 0;
     }
-    grid->nc = grid->cxy_ind[grid->ncx*grid->ncy] - grid->cxy_ind[0];
+    grid->nc = grid->cxy_ind[ncxy] - grid->cxy_ind[0];
 
     nbat->natoms = (grid->cell0 + grid->nc)*grid->na_sc;
 
@@ -1331,23 +1511,86 @@ static void calc_cell_indices(const nbnxn_search_t nbs,
         }
     }
 
-    /* Now we know the dimensions we can fill the grid.
-     * This is the first, unsorted fill. We sort the columns after this.
-     */
-    for (int i = a0; i < a1; i++)
+    if (bUpdate)
     {
-        /* At this point nbs->cell contains the local grid x,y indices */
-        cxy = nbs->cell[i];
-        nbs->a[(grid->cell0 + grid->cxy_ind[cxy])*grid->na_sc + grid->cxy_na[cxy]++] = i;
+        /* Keep the atoms that stayed in the same column in their previous,
+         * nearly sorted, order and collect the atoms that changed column.
+         */
+#pragma omp parallel for num_threads(nthread) schedule(static)
+        for (int thread = 0; thread < nthread; thread++)
+        {
+            try
+            {
+                collect_columns_update(nbs, grid,
+                                       thread_column_start(grid, thread, nthread),
+                                       thread_column_start(grid, thread + 1, nthread),
+                                       &nbs->work[thread]);
+            }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
+        }
+
+        int nmoved = 0;
+        for (int thread = 0; thread < nthread; thread++)
+        {
+            nmoved += nbs->work[thread].nmoved;
+        }
+
+        if (nmoved <= c_gridUpdateMaxMovedFraction*(a1 - a0))
+        {
+            /* Add the atoms that changed column at the end of their new column.
+             * There are few of these, so we do this serially.
+             */
+            for (int thread = 0; thread < nthread; thread++)
+            {
+                const nbnxn_search_work_t *work = &nbs->work[thread];
+
+                for (int m = 0; m < work->nmoved; m++)
+                {
+                    int a   = work->moved[m];
+                    int cxy = nbs->cell[a];
+                    nbs->a[(grid->cell0 + grid->cxy_ind[cxy])*grid->na_sc + grid->cxy_nfill[cxy]++] = a;
+                }
+            }
+        }
+        else
+        {
+            bUpdate = FALSE;
+        }
+
+        if (debug)
+        {
+            fprintf(debug, "ns grid update: %d atoms changed column, %s\n",
+                    nmoved, bUpdate ? "updating" : "sorting from scratch");
+        }
     }
 
-    if (dd_zone == 0)
+    if (!bUpdate)
     {
-        /* Set the cell indices for the moved particles */
-        n0 = grid->nc*grid->na_sc;
-        n1 = grid->nc*grid->na_sc+grid->cxy_na[grid->ncx*grid->ncy];
+        /* Now we know the dimensions we can fill the grid.
+         * This is the first, unsorted fill. We sort the columns after this.
+         * Each thread fills the atoms it assigned to columns above,
+         * using its own offsets, which gives the same order as a serial fill.
+         */
+#pragma omp parallel for num_threads(nthread) schedule(static)
+        for (int thread = 0; thread < nthread; thread++)
+        {
+            int *cxy_offset = nbs->work[thread].cxy_na;
+            int  t0, t1;
+
+            thread_atom_range(a0, a1, thread, nthread, &t0, &t1);
+            for (int i = t0; i < t1; i++)
+            {
+                /* At this point nbs->cell contains the local grid x,y indices */
+                int cxy = nbs->cell[i];
+                nbs->a[(grid->cell0 + grid->cxy_ind[cxy])*grid->na_sc + cxy_offset[cxy]++] = i;
+            }
+        }
+
         if (dd_zone == 0)
         {
+            /* Set the cell indices for the moved particles */
+            n0 = grid->nc*grid->na_sc;
+            n1 = grid->nc*grid->na_sc+grid->cxy_na[ncxy];
             for (int i = n0; i < n1; i++)
             {
                 nbs->cell[nbs->a[i]] = i;
@@ -1355,35 +1598,48 @@ static void calc_cell_indices(const nbnxn_search_t nbs,
         }
     }
 
-    /* Sort the super-cell columns along z into the sub-cells. */
+    /* Sort the super-cell columns along z into the sub-cells.
+     * We divide the columns over the threads such that the number
+     * of cells, and thus the amount of work, per thread is balanced.
+     */
 #pragma omp parallel for num_threads(nthread) schedule(static)
     for (int thread = 0; thread < nthread; thread++)
     {
         try
         {
+            int cxy_start = thread_column_start(grid, thread, nthread);
+            int cxy_end   = thread_column_start(grid, thread + 1, nthread);
+
             if (grid->bSimple)
             {
-                sort_columns_simple(nbs, dd_zone, grid, a0, a1, atinfo, x, nbat,
-                                    ((thread+0)*grid->ncx*grid->ncy)/nthread,
-                                    ((thread+1)*grid->ncx*grid->ncy)/nthread,
-                                    nbs->work[thread].sort_work);
+                if (bUpdate)
+                {
+                    update_columns_simple(nbs, grid, atinfo, x, nbat,
+                                          cxy_start, cxy_end);
+                }
+                else
+                {
+                    sort_columns_simple(nbs, dd_zone, grid, a0, a1, atinfo, x, nbat,
+                                        cxy_start, cxy_end,
+                                        nbs->work[thread].sort_work);
+                }
+
+                if (nbat->XFormat == nbatX8)
+                {
+                    combine_bounding_box_pairs(grid, grid->bb,
+                                               cxy_start, cxy_end);
+                }
             }
             else
             {
                 sort_columns_supersub(nbs, dd_zone, grid, a0, a1, atinfo, x, nbat,
-                                      ((thread+0)*grid->ncx*grid->ncy)/nthread,
-                                      ((thread+1)*grid->ncx*grid->ncy)/nthread,
+                                      cxy_start, cxy_end,
                                       nbs->work[thread].sort_work);
             }
         }
         GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
     }
 
-    if (grid->bSimple && nbat->XFormat == nbatX8)
-    {
-        combine_bounding_box_pairs(grid, grid->bb);
-    }
-
     if (!grid->bSimple)
     {
         grid->nsubc_tot = 0;
@@ -1443,11 +1699,26 @@ void nbnxn_put_on_grid(nbnxn_search_t nbs,
     nbnxn_grid_t *grid;
     int           n;
     int           nc_max_grid, nc_max;
+    gmx_bool      bUpdate;
 
     grid = &nbs->grid[dd_zone];
 
     nbs_cycle_start(&nbs->cc[enbsCCgrid]);
 
+    /* Without domain decomposition we can update the local grid starting
+     * from the previous atom order, when the atoms did not change.
+     * The previous order and column indices are kept in the _prev arrays.
+     */
+    bUpdate = (nbs->bUpdateGrid && dd_zone == 0);
+    if (bUpdate)
+    {
+        std::swap(nbs->a, nbs->a_prev);
+        std::swap(nbs->a_nalloc, nbs->a_prev_nalloc);
+        std::swap(grid->cxy_ind, grid->cxy_ind_prev);
+
+        bUpdate = (nmoved == 0 && a0 == 0 && a1 == nbs->natoms_local);
+    }
+
     grid->bSimple = nbnxn_kernel_pairlist_simple(nb_kernel_type);
 
     grid->na_c      = nbnxn_kernel_to_cluster_i_size(nb_kernel_type);
@@ -1513,6 +1784,10 @@ void nbnxn_put_on_grid(nbnxn_search_t nbs,
 
     nc_max = grid->cell0 + nc_max_grid;
 
+    /* We can only update with the same grid column setup */
+    bUpdate = (bUpdate && grid->bSimple &&
+               grid->ncx*grid->ncy == grid->ncxy_prev);
+
     if (a1 > nbs->cell_nalloc)
     {
         nbs->cell_nalloc = over_alloc_large(a1);
@@ -1534,13 +1809,23 @@ void nbnxn_put_on_grid(nbnxn_search_t nbs,
         nbnxn_atomdata_realloc(nbat, nc_max*grid->na_sc+NBNXN_BUFFERFLAG_SIZE);
     }
 
-    calc_cell_indices(nbs, dd_zone, grid, a0, a1, atinfo, x, move, nbat);
+    calc_cell_indices(nbs, dd_zone, grid, a0, a1, atinfo, x, move, nbat,
+                      bUpdate);
 
     if (dd_zone == 0)
     {
         nbat->natoms_local = nbat->natoms;
     }
 
+    if (nbs->bUpdateGrid && dd_zone == 0 && grid->bSimple)
+    {
+        grid->ncxy_prev = grid->ncx*grid->ncy;
+    }
+    else
+    {
+        grid->ncxy_prev = -1;
+    }
+
     nbs_cycle_stop(&nbs->cc[enbsCCgrid]);
 }
 
@@ -1666,7 +1951,7 @@ void nbnxn_grid_add_simple(nbnxn_search_t    nbs,
 
     if (grid->bSimple && nbat->XFormat == nbatX8)
     {
-        combine_bounding_box_pairs(grid, grid->bb_simple);
+        combine_bounding_box_pairs(grid, grid->bb_simple, 0, grid->ncx*grid->ncy);
     }
 }
 
@@ -1,7 +1,7 @@
 /*
  * This file is part of the GROMACS molecular simulation package.
  *
- * Copyright (c) 2012,2013,2014,2015,2016, by the GROMACS development team, led by
+ * Copyright (c) 2012,2013,2014,2015,2016,2017, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -171,7 +171,11 @@ typedef struct {
 
     int          *cxy_na;           /* The number of atoms for each column in x,y  */
     int          *cxy_ind;          /* Grid (super)cell index, offset from cell0   */
-    int           cxy_nalloc;       /* Allocation size for cxy_na and cxy_ind      */
+    int          *cxy_ind_prev;     /* cxy_ind of the previous grid, for updates   */
+    int          *cxy_nfill;        /* The number of atoms filled per column       */
+    int           cxy_nalloc;       /* Allocation size for the cxy arrays above    */
+    int           ncxy_prev;        /* ncx*ncy of the previous grid, -1 when the
+                                     * previous grid can not be updated            */
 
     int          *nsubc;            /* The number of sub cells for each super cell */
     float        *bbcz;             /* Bounding boxes in z for the super cells     */
@@ -255,6 +259,10 @@ typedef struct {
     int                 *sort_work;
     int                  sort_work_nalloc;
 
+    int                 *moved;        /* Atoms that moved to another column */
+    int                  nmoved;       /* The number of moved atoms          */
+    int                  moved_nalloc; /* Allocation size of moved           */
+
     nbnxn_buffer_flags_t buffer_flags; /* Flags for force buffer access */
 
     int                  ndistc;       /* Number of distance checks for flop counting */
@@ -282,6 +290,9 @@ typedef struct nbnxn_search {
     int                        cell_nalloc;     /* Allocation size of cell                    */
     int                       *a;               /* Atom index for grid, the inverse of cell   */
     int                        a_nalloc;        /* Allocation size of a                       */
+    gmx_bool                   bUpdateGrid;     /* Update the local grid iso rebuilding it    */
+    int                       *a_prev;          /* Atom index of the previous local grid      */
+    int                        a_prev_nalloc;   /* Allocation size of a_prev                  */
 
     int                        natoms_local;    /* The local atoms run from 0 to natoms_local */
     int                        natoms_nonlocal; /* The non-local atoms run from natoms_local
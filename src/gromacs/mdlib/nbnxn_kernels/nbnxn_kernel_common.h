@@ -1,7 +1,7 @@
 /*
  * This file is part of the GROMACS molecular simulation package.
  *
- * Copyright (c) 2012,2013,2014,2015, by the GROMACS development team, led by
+ * Copyright (c) 2012,2013,2014,2015,2017, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -40,6 +40,12 @@
 #include "gromacs/mdlib/nbnxn_pairlist.h"
 #include "gromacs/utility/real.h"
 
+/*! \brief Kinds of energy output of the nbnxn kernels
+ */
+enum {
+    enrgoutNONE, enrgoutSYSTEM, enrgoutGROUPPAIRS, enrgoutNR
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -2,7 +2,7 @@
 #
 # This file is part of the GROMACS molecular simulation package.
 #
-# Copyright (c) 2013,2014,2015, by the GROMACS development team, led by
+# Copyright (c) 2013,2014,2015,2017, by the GROMACS development team, led by
 # Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
 # and including many others, as listed in the AUTHORS file in the
 # top-level source directory and at http://www.gromacs.org.
@@ -36,7 +36,10 @@
 # This script is used by the GROMACS developers to build most of the
 # files from which the nbnxn kernels are compiled. It is not called at
 # CMake time, and users should never need to use it. It currently
-# works for nbnxn kernel structure types 2xnn and 4xn. The generated
+# works for nbnxn kernel structure type 2xnn. The 4xn kernels are not
+# generated: all 4xn kernel flavors are instantiations of a single
+# function template, selected through a lookup table in
+# ../simd_4xn/nbnxn_kernel_simd_4xn.cpp. The generated
 # files are versions of the *.pre files in this directory, customized
 # for the kernel structure type and/or the detailed kernel type. These
 # are:
@@ -141,14 +144,6 @@ VerletKernelTypeDict = {
                         '#endif\n'),
         'UnrollSize' : 2,
     },
-    '4xn' : {
-        'Define' : 'GMX_NBNXN_SIMD_4XN',
-        'WidthSetup' : (''),
-        'WidthCheck' : ('#if !(GMX_SIMD_REAL_WIDTH == 2 || GMX_SIMD_REAL_WIDTH == 4 || GMX_SIMD_REAL_WIDTH == 8)\n' \
-                        '#error "unsupported SIMD width"\n' \
-                        '#endif\n'),
-        'UnrollSize' : 1,
-    },
 }
 
 KernelDispatcherTemplate = read_kernel_template("nbnxn_kernel_simd_template.cpp.pre")
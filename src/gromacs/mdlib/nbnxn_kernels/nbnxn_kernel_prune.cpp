@@ -0,0 +1,193 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2017, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \internal \file
+ *
+ * \brief
+ * Implements the dispatch and the plain-C version of the nbnxn
+ * dynamic pair-list pruning kernels.
+ *
+ * \ingroup module_mdlib
+ */
+
+#include "gmxpre.h"
+
+#include "nbnxn_kernel_prune.h"
+
+#include "gromacs/math/vec.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
+#include "gromacs/mdlib/nb_verlet.h"
+#include "gromacs/mdlib/nbnxn_consts.h"
+#include "gromacs/pbcutil/ishift.h"
+#include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/gmxassert.h"
+
+void
+nbnxn_kernel_prune_ref(nbnxn_pairlist_t *         nbl,
+                       const nbnxn_atomdata_t *   nbat,
+                       const rvec * gmx_restrict  shift_vec,
+                       real                       rlistInner)
+{
+    const nbnxn_ci_t * gmx_restrict ciOuter  = nbl->ciOuter;
+    nbnxn_ci_t       * gmx_restrict ciInner  = nbl->ci;
+
+    const nbnxn_cj_t * gmx_restrict cjOuter  = nbl->cjOuter;
+    nbnxn_cj_t       * gmx_restrict cjInner  = nbl->cj;
+
+    const real       * gmx_restrict shiftvec = shift_vec[0];
+    const real       * gmx_restrict x        = nbat->x;
+
+    const int                       xstride  = nbat->xstride;
+    const int                       na_ci    = nbl->na_ci;
+    const int                       na_cj    = nbl->na_cj;
+
+    const real                      rlist2   = rlistInner*rlistInner;
+
+    GMX_ASSERT(na_ci <= NBNXN_CPU_CLUSTER_I_SIZE, "The reference prune kernel supports at most NBNXN_CPU_CLUSTER_I_SIZE i-atoms");
+
+    /* Initialize the new list as empty and add pairs that are in range */
+    int nciInner = 0;
+    int ncjInner = 0;
+    for (int ciIndex = 0; ciIndex < nbl->nciOuter; ciIndex++)
+    {
+        const nbnxn_ci_t * gmx_restrict ciEntry = &ciOuter[ciIndex];
+
+        /* Copy the original list entry to the pruned entry */
+        nbnxn_ci_t * gmx_restrict ciEntryInner = &ciInner[nciInner];
+        ciEntryInner->ci           = ciEntry->ci;
+        ciEntryInner->shift        = ciEntry->shift;
+        ciEntryInner->cj_ind_start = ncjInner;
+
+        /* Extract shift data */
+        int ish  = (ciEntry->shift & NBNXN_CI_SHIFT);
+        int ishf = ish*DIM;
+        int ci   = ciEntry->ci;
+
+        /* Load the shifted i-atom coordinates */
+        real xi[NBNXN_CPU_CLUSTER_I_SIZE*DIM];
+        for (int i = 0; i < na_ci; i++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                xi[i*DIM + d] = x[(ci*na_ci + i)*xstride + d] + shiftvec[ishf + d];
+            }
+        }
+
+        for (int cjind = ciEntry->cj_ind_start; cjind < ciEntry->cj_ind_end; cjind++)
+        {
+            /* j-cluster index */
+            int  cj        = cjOuter[cjind].cj;
+
+            bool isInRange = false;
+            for (int i = 0; i < na_ci && !isInRange; i++)
+            {
+                for (int j = 0; j < na_cj; j++)
+                {
+                    int  aj  = cj*na_cj + j;
+
+                    real dx  = xi[i*DIM + XX] - x[aj*xstride + XX];
+                    real dy  = xi[i*DIM + YY] - x[aj*xstride + YY];
+                    real dz  = xi[i*DIM + ZZ] - x[aj*xstride + ZZ];
+
+                    real rsq = dx*dx + dy*dy + dz*dz;
+
+                    /* A single atom pair in range is sufficient to keep
+                     * the cluster pair. Excluded pairs are not skipped,
+                     * since the kernels use the diagonal (self) pairs.
+                     */
+                    if (rsq < rlist2)
+                    {
+                        isInRange = true;
+                        break;
+                    }
+                }
+            }
+
+            if (isInRange)
+            {
+                cjInner[ncjInner++] = cjOuter[cjind];
+            }
+        }
+
+        /* Check if there are any j's in the list, if so use it */
+        if (ncjInner > ciEntryInner->cj_ind_start)
+        {
+            ciEntryInner->cj_ind_end = ncjInner;
+            nciInner++;
+        }
+    }
+
+    nbl->nci      = nciInner;
+    nbl->ncj      = ncjInner;
+    nbl->ncjInUse = ncjInner;
+}
+
+void
+nbnxn_kernel_cpu_prune(nonbonded_verlet_group_t *nbv_group,
+                       const rvec               *shift_vec,
+                       real                      rlistInner)
+{
+    nbnxn_pairlist_set_t   *nbl_lists = &nbv_group->nbl_lists;
+    const nbnxn_atomdata_t *nbat      = nbv_group->nbat;
+
+    GMX_ASSERT(nbl_lists->bSimple, "Dynamic pruning is only supported for simple, CPU pair-lists");
+
+    // cppcheck-suppress unreadVariable
+    int nthreads = gmx_omp_nthreads_get(emntNonbonded);
+#pragma omp parallel for schedule(static) num_threads(nthreads)
+    for (int i = 0; i < nbl_lists->nnbl; i++)
+    {
+        // The prune kernels do not call C++ code that can throw,
+        // so no need for a try/catch pair in this OpenMP region.
+        nbnxn_pairlist_t *nbl = nbl_lists->nbl[i];
+
+        GMX_ASSERT(nbl->nciOuter >= 0, "Dynamic pruning requires an outer list");
+
+        switch (nbv_group->kernel_type)
+        {
+            case nbnxnk4xN_SIMD_4xN:
+                nbnxn_kernel_prune_4xn(nbl, nbat, shift_vec, rlistInner);
+                break;
+            case nbnxnk4xN_SIMD_2xNN:
+                nbnxn_kernel_prune_2xnn(nbl, nbat, shift_vec, rlistInner);
+                break;
+            case nbnxnk4x4_PlainC:
+                nbnxn_kernel_prune_ref(nbl, nbat, shift_vec, rlistInner);
+                break;
+            default:
+                gmx_incons("kernel type not handled (yet)");
+        }
+    }
+}
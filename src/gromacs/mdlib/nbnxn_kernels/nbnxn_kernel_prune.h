@@ -0,0 +1,96 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2017, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \internal \file
+ *
+ * \brief
+ * Declares the dynamic pair-list pruning kernels for the nbnxn CPU lists.
+ *
+ * With dynamic pruning the pair search generates an outer list with
+ * a large buffer, which only needs to be updated rarely. Every few
+ * steps the kernels declared here generate a compact inner list,
+ * with a buffer just sufficient for the pruning interval, from the
+ * outer list. The non-bonded force kernels only operate on the inner list.
+ *
+ * \ingroup module_mdlib
+ */
+
+#ifndef _nbnxn_kernel_prune_h
+#define _nbnxn_kernel_prune_h
+
+#include "gromacs/math/vectypes.h"
+#include "gromacs/mdlib/nbnxn_pairlist.h"
+#include "gromacs/utility/real.h"
+
+struct nonbonded_verlet_group_t;
+
+/*! \brief Prune all pair-lists in the group with cut-off rlistInner
+ *
+ * Generates the inner pair-lists from the outer lists for all
+ * (thread-)lists in \p nbv_group, using the prune kernel matching
+ * the non-bonded kernel type of the group. This should only be called
+ * when the lists have been prepared for dynamic pruning.
+ *
+ * \param[in,out] nbv_group   The group of pair-lists and atom data
+ * \param[in]     shift_vec   The shift vectors
+ * \param[in]     rlistInner  The cut-off for the pruned, inner list
+ */
+void
+nbnxn_kernel_cpu_prune(nonbonded_verlet_group_t *nbv_group,
+                       const rvec               *shift_vec,
+                       real                      rlistInner);
+
+/*! \brief Prune a single plain-C cluster pair-list with cut-off rlistInner */
+void
+nbnxn_kernel_prune_ref(nbnxn_pairlist_t *         nbl,
+                       const nbnxn_atomdata_t *   nbat,
+                       const rvec * gmx_restrict  shift_vec,
+                       real                       rlistInner);
+
+/*! \brief Prune a single SIMD 4xN pair-list with cut-off rlistInner */
+void
+nbnxn_kernel_prune_4xn(nbnxn_pairlist_t *         nbl,
+                       const nbnxn_atomdata_t *   nbat,
+                       const rvec * gmx_restrict  shift_vec,
+                       real                       rlistInner);
+
+/*! \brief Prune a single SIMD 2x(N+N) pair-list with cut-off rlistInner */
+void
+nbnxn_kernel_prune_2xnn(nbnxn_pairlist_t *         nbl,
+                        const nbnxn_atomdata_t *   nbat,
+                        const rvec * gmx_restrict  shift_vec,
+                        real                       rlistInner);
+
+#endif
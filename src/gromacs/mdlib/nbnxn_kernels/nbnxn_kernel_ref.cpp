@@ -1,7 +1,7 @@
 /*
  * This file is part of the GROMACS molecular simulation package.
  *
- * Copyright (c) 2012,2013,2014,2015,2016, by the GROMACS development team, led by
+ * Copyright (c) 2012,2013,2014,2015,2016,2017, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -56,124 +56,65 @@
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/smalloc.h"
 
-/*! \brief Typedefs for declaring lookup tables of kernel functions.
+/*! \brief Kinds of electrostatic treatments in the reference kernels
  */
-
-typedef void (*p_nbk_func_noener)(const nbnxn_pairlist_t     *nbl,
-                                  const nbnxn_atomdata_t     *nbat,
-                                  const interaction_const_t  *ic,
-                                  rvec                       *shift_vec,
-                                  real                       *f,
-                                  real                       *fshift);
-
-typedef void (*p_nbk_func_ener)(const nbnxn_pairlist_t     *nbl,
-                                const nbnxn_atomdata_t     *nbat,
-                                const interaction_const_t  *ic,
-                                rvec                       *shift_vec,
-                                real                       *f,
-                                real                       *fshift,
-                                real                       *Vvdw,
-                                real                       *Vc);
-
-/* Analytical reaction-field kernels */
-#define CALC_COUL_RF
-#define LJ_CUT
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_includes.h"
-#undef LJ_CUT
-#define LJ_FORCE_SWITCH
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_includes.h"
-#undef LJ_FORCE_SWITCH
-#define LJ_POT_SWITCH
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_includes.h"
-#undef LJ_POT_SWITCH
-#define LJ_EWALD
-#define LJ_CUT
-#define LJ_EWALD_COMB_GEOM
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_includes.h"
-#undef LJ_EWALD_COMB_GEOM
-#define LJ_EWALD_COMB_LB
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_includes.h"
-#undef LJ_EWALD_COMB_LB
-#undef LJ_CUT
-#undef LJ_EWALD
-#undef CALC_COUL_RF
-
-
-/* Tabulated exclusion interaction electrostatics kernels */
-#define CALC_COUL_TAB
-#define LJ_CUT
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_includes.h"
-#undef LJ_CUT
-#define LJ_FORCE_SWITCH
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_includes.h"
-#undef LJ_FORCE_SWITCH
-#define LJ_POT_SWITCH
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_includes.h"
-#undef LJ_POT_SWITCH
-#define LJ_EWALD
-#define LJ_CUT
-#define LJ_EWALD_COMB_GEOM
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_includes.h"
-#undef LJ_EWALD_COMB_GEOM
-#define LJ_EWALD_COMB_LB
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_includes.h"
-#undef LJ_EWALD_COMB_LB
-#undef LJ_CUT
-#undef LJ_EWALD
-/* Twin-range cut-off kernels */
-#define VDW_CUTOFF_CHECK
-#define LJ_CUT
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_includes.h"
-#undef LJ_CUT
-#define LJ_FORCE_SWITCH
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_includes.h"
-#undef LJ_FORCE_SWITCH
-#define LJ_POT_SWITCH
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_includes.h"
-#undef LJ_POT_SWITCH
-#define LJ_EWALD
-#define LJ_CUT
-#define LJ_EWALD_COMB_GEOM
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_includes.h"
-#undef LJ_EWALD_COMB_GEOM
-#define LJ_EWALD_COMB_LB
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_includes.h"
-#undef LJ_EWALD_COMB_LB
-#undef LJ_CUT
-#undef LJ_EWALD
-#undef VDW_CUTOFF_CHECK
-#undef CALC_COUL_TAB
-
-
 enum {
     coultRF, coultTAB, coultTAB_TWIN, coultNR
 };
 
+/*! \brief Kinds of Van der Waals treatments in the reference kernels
+ */
 enum {
     vdwtCUT, vdwtFSWITCH, vdwtPSWITCH, vdwtEWALDGEOM, vdwtEWALDLB, vdwtNR
 };
 
-p_nbk_func_noener p_nbk_c_noener[coultNR][vdwtNR] =
-{
-    { nbnxn_kernel_ElecRF_VdwLJ_F_ref,           nbnxn_kernel_ElecRF_VdwLJFsw_F_ref,           nbnxn_kernel_ElecRF_VdwLJPsw_F_ref,           nbnxn_kernel_ElecRF_VdwLJEwCombGeom_F_ref,           nbnxn_kernel_ElecRF_VdwLJEwCombLB_F_ref           },
-    { nbnxn_kernel_ElecQSTab_VdwLJ_F_ref,        nbnxn_kernel_ElecQSTab_VdwLJFsw_F_ref,        nbnxn_kernel_ElecQSTab_VdwLJPsw_F_ref,        nbnxn_kernel_ElecQSTab_VdwLJEwCombGeom_F_ref,        nbnxn_kernel_ElecQSTab_VdwLJEwCombLB_F_ref        },
-    { nbnxn_kernel_ElecQSTabTwinCut_VdwLJ_F_ref, nbnxn_kernel_ElecQSTabTwinCut_VdwLJFsw_F_ref, nbnxn_kernel_ElecQSTabTwinCut_VdwLJPsw_F_ref, nbnxn_kernel_ElecQSTabTwinCut_VdwLJEwCombGeom_F_ref, nbnxn_kernel_ElecQSTabTwinCut_VdwLJEwCombLB_F_ref }
-};
+#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_outer.h"
 
-p_nbk_func_ener p_nbk_c_ener[coultNR][vdwtNR] =
-{
-    { nbnxn_kernel_ElecRF_VdwLJ_VF_ref,           nbnxn_kernel_ElecRF_VdwLJFsw_VF_ref,           nbnxn_kernel_ElecRF_VdwLJPsw_VF_ref,           nbnxn_kernel_ElecRF_VdwLJEwCombGeom_VF_ref,           nbnxn_kernel_ElecRF_VdwLJEwCombLB_VF_ref            },
-    { nbnxn_kernel_ElecQSTab_VdwLJ_VF_ref,        nbnxn_kernel_ElecQSTab_VdwLJFsw_VF_ref,        nbnxn_kernel_ElecQSTab_VdwLJPsw_VF_ref,        nbnxn_kernel_ElecQSTab_VdwLJEwCombGeom_VF_ref,        nbnxn_kernel_ElecQSTab_VdwLJEwCombLB_VF_ref         },
-    { nbnxn_kernel_ElecQSTabTwinCut_VdwLJ_VF_ref, nbnxn_kernel_ElecQSTabTwinCut_VdwLJFsw_VF_ref, nbnxn_kernel_ElecQSTabTwinCut_VdwLJPsw_VF_ref, nbnxn_kernel_ElecQSTabTwinCut_VdwLJEwCombGeom_VF_ref, nbnxn_kernel_ElecQSTabTwinCut_VdwLJEwCombLB_VF_ref  }
-};
+/*! \brief Typedef for declaring the lookup table of kernel functions.
+ */
+typedef void (*p_nbk_func)(const nbnxn_pairlist_t     *nbl,
+                           const nbnxn_atomdata_t     *nbat,
+                           const interaction_const_t  *ic,
+                           rvec                       *shift_vec,
+                           real                       *f,
+                           real                       *fshift,
+                           real                       *Vvdw,
+                           real                       *Vc);
+
+/*! \brief The kernels for all VdW treatments for one Coulomb treatment and energy output */
+#define NBK_FUNC_VDW(coult, enrgout) \
+    { \
+        nbnxn_kernel_ref_outer<coult, vdwtCUT, enrgout>, \
+        nbnxn_kernel_ref_outer<coult, vdwtFSWITCH, enrgout>, \
+        nbnxn_kernel_ref_outer<coult, vdwtPSWITCH, enrgout>, \
+        nbnxn_kernel_ref_outer<coult, vdwtEWALDGEOM, enrgout>, \
+        nbnxn_kernel_ref_outer<coult, vdwtEWALDLB, enrgout> \
+    }
 
-p_nbk_func_ener p_nbk_c_energrp[coultNR][vdwtNR] =
+/*! \brief The kernels for all Coulomb and VdW treatments for one energy output */
+#define NBK_FUNC_COUL_VDW(enrgout) \
+    { \
+        NBK_FUNC_VDW(coultRF, enrgout), \
+        NBK_FUNC_VDW(coultTAB, enrgout), \
+        NBK_FUNC_VDW(coultTAB_TWIN, enrgout) \
+    }
+
+/*! \brief Kernel lookup table, index with [energy output][Coulomb][VdW]
+ *
+ * All entries are instantiations of the single nbnxn_kernel_ref_outer
+ * template. Adding a kernel flavor requires adding an enum entry,
+ * an entry here and the code for the flavor in the template.
+ */
+static const p_nbk_func p_nbk_c[enrgoutNR][coultNR][vdwtNR] =
 {
-    { nbnxn_kernel_ElecRF_VdwLJ_VgrpF_ref,           nbnxn_kernel_ElecRF_VdwLJFsw_VgrpF_ref,           nbnxn_kernel_ElecRF_VdwLJPsw_VgrpF_ref,           nbnxn_kernel_ElecRF_VdwLJEwCombGeom_VgrpF_ref,           nbnxn_kernel_ElecRF_VdwLJEwCombLB_VgrpF_ref           },
-    { nbnxn_kernel_ElecQSTab_VdwLJ_VgrpF_ref,        nbnxn_kernel_ElecQSTab_VdwLJFsw_VgrpF_ref,        nbnxn_kernel_ElecQSTab_VdwLJPsw_VgrpF_ref,        nbnxn_kernel_ElecQSTab_VdwLJEwCombGeom_VgrpF_ref,        nbnxn_kernel_ElecQSTab_VdwLJEwCombLB_VgrpF_ref        },
-    { nbnxn_kernel_ElecQSTabTwinCut_VdwLJ_VgrpF_ref, nbnxn_kernel_ElecQSTabTwinCut_VdwLJFsw_VgrpF_ref, nbnxn_kernel_ElecQSTabTwinCut_VdwLJPsw_VgrpF_ref, nbnxn_kernel_ElecQSTabTwinCut_VdwLJEwCombGeom_VgrpF_ref, nbnxn_kernel_ElecQSTabTwinCut_VdwLJEwCombLB_VgrpF_ref }
+    NBK_FUNC_COUL_VDW(enrgoutNONE),
+    NBK_FUNC_COUL_VDW(enrgoutSYSTEM),
+    NBK_FUNC_COUL_VDW(enrgoutGROUPPAIRS)
 };
 
+#undef NBK_FUNC_COUL_VDW
+#undef NBK_FUNC_VDW
+
 void
 nbnxn_kernel_ref(const nbnxn_pairlist_set_t *nbl_list,
                  const nbnxn_atomdata_t     *nbat,
@@ -282,11 +223,13 @@ nbnxn_kernel_ref(const nbnxn_pairlist_set_t *nbl_list,
         if (!(force_flags & GMX_FORCE_ENERGY))
         {
             /* Don't calculate energies */
-            p_nbk_c_noener[coult][vdwt](nbl[nb], nbat,
-                                        ic,
-                                        shift_vec,
-                                        out->f,
-                                        fshift_p);
+            p_nbk_c[enrgoutNONE][coult][vdwt](nbl[nb], nbat,
+                                              ic,
+                                              shift_vec,
+                                              out->f,
+                                              fshift_p,
+                                              nullptr,
+                                              nullptr);
         }
         else if (out->nV == 1)
         {
@@ -294,13 +237,13 @@ nbnxn_kernel_ref(const nbnxn_pairlist_set_t *nbl_list,
             out->Vvdw[0] = 0;
             out->Vc[0]   = 0;
 
-            p_nbk_c_ener[coult][vdwt](nbl[nb], nbat,
-                                      ic,
-                                      shift_vec,
-                                      out->f,
-                                      fshift_p,
-                                      out->Vvdw,
-                                      out->Vc);
+            p_nbk_c[enrgoutSYSTEM][coult][vdwt](nbl[nb], nbat,
+                                                ic,
+                                                shift_vec,
+                                                out->f,
+                                                fshift_p,
+                                                out->Vvdw,
+                                                out->Vc);
         }
         else
         {
@@ -316,13 +259,13 @@ nbnxn_kernel_ref(const nbnxn_pairlist_set_t *nbl_list,
                 out->Vc[i] = 0;
             }
 
-            p_nbk_c_energrp[coult][vdwt](nbl[nb], nbat,
-                                         ic,
-                                         shift_vec,
-                                         out->f,
-                                         fshift_p,
-                                         out->Vvdw,
-                                         out->Vc);
+            p_nbk_c[enrgoutGROUPPAIRS][coult][vdwt](nbl[nb], nbat,
+                                                    ic,
+                                                    shift_vec,
+                                                    out->f,
+                                                    fshift_p,
+                                                    out->Vvdw,
+                                                    out->Vc);
         }
     }
 
@@ -43,208 +43,127 @@
 #define XI_STRIDE  3
 #define FI_STRIDE  3
 
-
-/* All functionality defines are set here, except for:
- * CALC_ENERGIES, ENERGY_GROUPS which are defined before.
- * CHECK_EXCLS, which is set just before including the inner loop contents.
+/*! \brief Constant parameters for the reference kernels, set once per call
+ *
+ * Which of the parameters are used depends on the kernel flavor.
  */
+struct nbnxn_kernel_ref_params_t
+{
+    const nbnxn_atomdata_t    *nbat;          //!< The atom data
+    const interaction_const_t *ic;            //!< The interaction constants
+    const real                *x;             //!< The coordinates, stride 3
+    const real                *q;             //!< The charges
+    const int                 *type;          //!< The atom types
+    const real                *nbfp;          //!< The LJ parameter matrix
+    int                        ntype2;        //!< Twice the number of atom types
+    int                        egp_mask;      //!< Mask for extracting an energy group
+    real                       rcut2;         //!< The (Coulomb) cut-off squared
+    real                       rvdw2;         //!< The VdW cut-off squared
+    real                       k_rf2;         //!< Twice the RF k constant
+    real                       k_rf;          //!< The RF k constant
+    real                       c_rf;          //!< The RF c constant
+    real                       halfsp;        //!< Half the Coulomb table spacing
+    const real                *tab_coul_FDV0; //!< Coulomb F, dF, V, 0 table (single precision)
+    const real                *tab_coul_F;    //!< Coulomb F table (double precision)
+    const real                *tab_coul_V;    //!< Coulomb V table (double precision)
+    real                       swV3, swV4, swV5; //!< LJ potential switch energy constants
+    real                       swF2, swF3, swF4; //!< LJ potential switch force constants
+    real                       lje_coeff2;    //!< The LJ-PME coefficient squared
+    real                       lje_coeff6_6;  //!< The LJ-PME coefficient to the sixth power /6
+    real                       lje_vc;        //!< The LJ-PME grid potential shift
+    const real                *ljc;           //!< The LJ-PME combination rule parameters
+};
 
-/* We always calculate shift forces, because it's cheap anyhow */
-#define CALC_SHIFTFORCES
-
-#ifdef CALC_COUL_RF
-#define NBK_FUNC_NAME2(ljt, feg) nbnxn_kernel ## _ElecRF ## ljt ## feg ## _ref
-#endif
-#ifdef CALC_COUL_TAB
-#ifndef VDW_CUTOFF_CHECK
-#define NBK_FUNC_NAME2(ljt, feg) nbnxn_kernel ## _ElecQSTab ## ljt ## feg ## _ref
-#else
-#define NBK_FUNC_NAME2(ljt, feg) nbnxn_kernel ## _ElecQSTabTwinCut ## ljt ## feg ## _ref
-#endif
-#endif
-
-#if defined LJ_CUT && !defined LJ_EWALD
-#define NBK_FUNC_NAME(feg) NBK_FUNC_NAME2(_VdwLJ, feg)
-#elif defined LJ_FORCE_SWITCH
-#define NBK_FUNC_NAME(feg) NBK_FUNC_NAME2(_VdwLJFsw, feg)
-#elif defined LJ_POT_SWITCH
-#define NBK_FUNC_NAME(feg) NBK_FUNC_NAME2(_VdwLJPsw, feg)
-#elif defined LJ_EWALD
-#ifdef LJ_EWALD_COMB_GEOM
-#define NBK_FUNC_NAME(feg) NBK_FUNC_NAME2(_VdwLJEwCombGeom, feg)
-#else
-#define NBK_FUNC_NAME(feg) NBK_FUNC_NAME2(_VdwLJEwCombLB, feg)
-#endif
-#else
-#error "No VdW type defined"
-#endif
+#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_inner.h"
 
+/* The plain-C reference kernel outer loop.
+ *
+ * Template parameters:
+ *   coulombType:  one of coultRF, coultTAB, coultTAB_TWIN
+ *   vdwType:      one of the vdwt* values
+ *   energyOutput: one of enrgoutNONE, enrgoutSYSTEM, enrgoutGROUPPAIRS
+ *
+ * Vvdw and Vc are only used when energyOutput != enrgoutNONE.
+ * We always calculate shift forces, because it's cheap anyhow.
+ */
+template <int coulombType, int vdwType, int energyOutput>
 static void
-#ifndef CALC_ENERGIES
-NBK_FUNC_NAME(_F)
-#else
-#ifndef ENERGY_GROUPS
-NBK_FUNC_NAME(_VF)
-#else
-NBK_FUNC_NAME(_VgrpF)
-#endif
-#endif
-#undef NBK_FUNC_NAME
-#undef NBK_FUNC_NAME2
-(const nbnxn_pairlist_t     *nbl,
- const nbnxn_atomdata_t     *nbat,
- const interaction_const_t  *ic,
- rvec                       *shift_vec,
- real                       *f
-#ifdef CALC_SHIFTFORCES
- ,
- real                       *fshift
-#endif
-#ifdef CALC_ENERGIES
- ,
- real                       *Vvdw,
- real                       *Vc
-#endif
-)
+nbnxn_kernel_ref_outer(const nbnxn_pairlist_t     *nbl,
+                       const nbnxn_atomdata_t     *nbat,
+                       const interaction_const_t  *ic,
+                       rvec                       *shift_vec,
+                       real                       *f,
+                       real                       *fshift,
+                       real                       *Vvdw,
+                       real                       *Vc)
 {
-    const nbnxn_ci_t   *nbln;
-    const nbnxn_cj_t   *l_cj;
-    const int          *type;
-    const real         *q;
-    const real         *shiftvec;
-    const real         *x;
-    const real         *nbfp;
-    real                rcut2;
-#ifdef VDW_CUTOFF_CHECK
-    real                rvdw2;
-#endif
-    int                 ntype2;
-    real                facel;
-    int                 n, ci, ci_sh;
-    int                 ish, ishf;
-    gmx_bool            do_LJ, half_LJ, do_coul;
-    int                 cjind0, cjind1, cjind;
-
-    real                xi[UNROLLI*XI_STRIDE];
-    real                fi[UNROLLI*FI_STRIDE];
-    real                qi[UNROLLI];
-
-#ifdef CALC_ENERGIES
-#ifndef ENERGY_GROUPS
-
-    real       Vvdw_ci, Vc_ci;
-#else
-    int        egp_mask;
-    int        egp_sh_i[UNROLLI];
-#endif
-#endif
-#ifdef LJ_POT_SWITCH
-    real       swV3, swV4, swV5;
-    real       swF2, swF3, swF4;
-#endif
-#ifdef LJ_EWALD
-    real        lje_coeff2, lje_coeff6_6;
-#ifdef CALC_ENERGIES
-    real        lje_vc;
-#endif
-    const real *ljc;
-#endif
-
-#ifdef CALC_COUL_RF
-    real       k_rf2;
-#ifdef CALC_ENERGIES
-    real       k_rf, c_rf;
-#endif
-#endif
-#ifdef CALC_COUL_TAB
-#ifdef CALC_ENERGIES
-    real       halfsp;
-#endif
-#if !GMX_DOUBLE
-    const real            *tab_coul_FDV0;
-#else
-    const real            *tab_coul_F;
-    const real gmx_unused *tab_coul_V;
-#endif
-#endif
-
-#ifdef COUNT_PAIRS
-    int npair = 0;
-#endif
-
-#ifdef LJ_POT_SWITCH
-    swV3 = ic->vdw_switch.c3;
-    swV4 = ic->vdw_switch.c4;
-    swV5 = ic->vdw_switch.c5;
-    swF2 = 3*ic->vdw_switch.c3;
-    swF3 = 4*ic->vdw_switch.c4;
-    swF4 = 5*ic->vdw_switch.c5;
-#endif
-
-#ifdef LJ_EWALD
-    lje_coeff2   = ic->ewaldcoeff_lj*ic->ewaldcoeff_lj;
-    lje_coeff6_6 = lje_coeff2*lje_coeff2*lje_coeff2/6.0;
-#ifdef CALC_ENERGIES
-    lje_vc       = ic->sh_lj_ewald;
-#endif
-
-    ljc          = nbat->nbfp_comb;
-#endif
-
-#ifdef CALC_COUL_RF
-    k_rf2 = 2*ic->k_rf;
-#ifdef CALC_ENERGIES
-    k_rf = ic->k_rf;
-    c_rf = ic->c_rf;
-#endif
-#endif
-#ifdef CALC_COUL_TAB
-#ifdef CALC_ENERGIES
-    halfsp = 0.5/ic->tabq_scale;
-#endif
-
-#if !GMX_DOUBLE
-    tab_coul_FDV0 = ic->tabq_coul_FDV0;
-#else
-    tab_coul_F    = ic->tabq_coul_F;
-    tab_coul_V    = ic->tabq_coul_V;
-#endif
-#endif
-
-#ifdef ENERGY_GROUPS
-    egp_mask = (1<<nbat->neg_2log) - 1;
-#endif
-
-
-    rcut2               = ic->rcoulomb*ic->rcoulomb;
-#ifdef VDW_CUTOFF_CHECK
-    rvdw2               = ic->rvdw*ic->rvdw;
-#endif
-
-    ntype2              = nbat->ntype*2;
-    nbfp                = nbat->nbfp;
-    q                   = nbat->q;
-    type                = nbat->type;
-    facel               = ic->epsfac;
-    shiftvec            = shift_vec[0];
-    x                   = nbat->x;
-
-    l_cj = nbl->cj;
-
-    for (n = 0; n < nbl->nci; n++)
+    const bool                calcEnergies = (energyOutput != enrgoutNONE);
+    const bool                energyGroups = (energyOutput == enrgoutGROUPPAIRS);
+    const bool                ljEwald      = (vdwType == vdwtEWALDGEOM || vdwType == vdwtEWALDLB);
+
+    nbnxn_kernel_ref_params_t p;
+
+    p.nbat          = nbat;
+    p.ic            = ic;
+    p.x             = nbat->x;
+    p.q             = nbat->q;
+    p.type          = nbat->type;
+    p.nbfp          = nbat->nbfp;
+    p.ntype2        = nbat->ntype*2;
+    p.egp_mask      = (1<<nbat->neg_2log) - 1;
+
+    p.rcut2         = ic->rcoulomb*ic->rcoulomb;
+    p.rvdw2         = ic->rvdw*ic->rvdw;
+
+    p.k_rf2         = 2*ic->k_rf;
+    p.k_rf          = ic->k_rf;
+    p.c_rf          = ic->c_rf;
+
+    /* Avoid division by zero when no table is used */
+    p.halfsp        = (coulombType == coultRF ? 0 : 0.5/ic->tabq_scale);
+    p.tab_coul_FDV0 = ic->tabq_coul_FDV0;
+    p.tab_coul_F    = ic->tabq_coul_F;
+    p.tab_coul_V    = ic->tabq_coul_V;
+
+    p.swV3          = ic->vdw_switch.c3;
+    p.swV4          = ic->vdw_switch.c4;
+    p.swV5          = ic->vdw_switch.c5;
+    p.swF2          = 3*ic->vdw_switch.c3;
+    p.swF3          = 4*ic->vdw_switch.c4;
+    p.swF4          = 5*ic->vdw_switch.c5;
+
+    p.lje_coeff2    = ic->ewaldcoeff_lj*ic->ewaldcoeff_lj;
+    p.lje_coeff6_6  = p.lje_coeff2*p.lje_coeff2*p.lje_coeff2/6.0;
+    p.lje_vc        = ic->sh_lj_ewald;
+    p.ljc           = nbat->nbfp_comb;
+
+    const real *q        = nbat->q;
+    const real *x        = nbat->x;
+    const real *shiftvec = shift_vec[0];
+    real        facel    = ic->epsfac;
+
+    const nbnxn_cj_t *l_cj = nbl->cj;
+
+    for (int n = 0; n < nbl->nci; n++)
     {
-        int i, d;
+        real xi[UNROLLI*XI_STRIDE];
+        real fi[UNROLLI*FI_STRIDE];
+        real qi[UNROLLI];
+        int  egp_sh_i[UNROLLI];
+        /* Energy accumulation for this i-cluster without energy groups */
+        real Vvdw_ci = 0;
+        real Vc_ci   = 0;
 
-        nbln = &nbl->ci[n];
+        const nbnxn_ci_t *nbln = &nbl->ci[n];
 
-        ish              = (nbln->shift & NBNXN_CI_SHIFT);
+        int ish              = (nbln->shift & NBNXN_CI_SHIFT);
         /* x, f and fshift are assumed to be stored with stride 3 */
-        ishf             = ish*DIM;
-        cjind0           = nbln->cj_ind_start;
-        cjind1           = nbln->cj_ind_end;
+        int ishf             = ish*DIM;
+        int cjind0           = nbln->cj_ind_start;
+        int cjind1           = nbln->cj_ind_end;
         /* Currently only works super-cells equal to sub-cells */
-        ci               = nbln->ci;
-        ci_sh            = (ish == CENTRAL ? ci : -1);
+        int ci               = nbln->ci;
+        int ci_sh            = (ish == CENTRAL ? ci : -1);
 
         /* We have 5 LJ/C combinations, but use only three inner loops,
          * as the other combinations are unlikely and/or not much faster:
@@ -252,31 +171,21 @@ NBK_FUNC_NAME(_VgrpF)
          * inner LJ + C      for full-LJ + C
          * inner LJ          for full-LJ + no-C / half-LJ + no-C
          */
-        do_LJ   = (nbln->shift & NBNXN_CI_DO_LJ(0));
-        do_coul = (nbln->shift & NBNXN_CI_DO_COUL(0));
-        half_LJ = ((nbln->shift & NBNXN_CI_HALF_LJ(0)) || !do_LJ) && do_coul;
-#ifdef CALC_ENERGIES
-
-#ifdef LJ_EWALD
-        gmx_bool do_self = TRUE;
-#else
-        gmx_bool do_self = do_coul;
-#endif
+        gmx_bool do_LJ   = (nbln->shift & NBNXN_CI_DO_LJ(0));
+        gmx_bool do_coul = (nbln->shift & NBNXN_CI_DO_COUL(0));
+        gmx_bool half_LJ = ((nbln->shift & NBNXN_CI_HALF_LJ(0)) || !do_LJ) && do_coul;
 
-#ifndef ENERGY_GROUPS
-        Vvdw_ci = 0;
-        Vc_ci   = 0;
-#else
-        for (i = 0; i < UNROLLI; i++)
+        if (energyGroups)
         {
-            egp_sh_i[i] = ((nbat->energrp[ci]>>(i*nbat->neg_2log)) & egp_mask)*nbat->nenergrp;
+            for (int i = 0; i < UNROLLI; i++)
+            {
+                egp_sh_i[i] = ((nbat->energrp[ci]>>(i*nbat->neg_2log)) & p.egp_mask)*nbat->nenergrp;
+            }
         }
-#endif
-#endif
 
-        for (i = 0; i < UNROLLI; i++)
+        for (int i = 0; i < UNROLLI; i++)
         {
-            for (d = 0; d < DIM; d++)
+            for (int d = 0; d < DIM; d++)
             {
                 xi[i*XI_STRIDE+d] = x[(ci*UNROLLI+i)*X_STRIDE+d] + shiftvec[ishf+d];
                 fi[i*FI_STRIDE+d] = 0;
@@ -285,67 +194,72 @@ NBK_FUNC_NAME(_VgrpF)
             qi[i] = facel*q[ci*UNROLLI+i];
         }
 
-#ifdef CALC_ENERGIES
-        if (do_self)
+        if (calcEnergies && (do_coul || ljEwald))
         {
             real Vc_sub_self;
 
-#ifdef CALC_COUL_RF
-            Vc_sub_self = 0.5*c_rf;
-#endif
-#ifdef CALC_COUL_TAB
+            if (coulombType == coultRF)
+            {
+                Vc_sub_self = 0.5*p.c_rf;
+            }
+            else
+            {
 #if GMX_DOUBLE
-            Vc_sub_self = 0.5*tab_coul_V[0];
+                Vc_sub_self = 0.5*p.tab_coul_V[0];
 #else
-            Vc_sub_self = 0.5*tab_coul_FDV0[2];
-#endif
+                Vc_sub_self = 0.5*p.tab_coul_FDV0[2];
 #endif
+            }
 
             if (l_cj[nbln->cj_ind_start].cj == ci_sh)
             {
-                for (i = 0; i < UNROLLI; i++)
+                for (int i = 0; i < UNROLLI; i++)
                 {
                     int egp_ind;
-#ifdef ENERGY_GROUPS
-                    egp_ind = egp_sh_i[i] + ((nbat->energrp[ci]>>(i*nbat->neg_2log)) & egp_mask);
-#else
-                    egp_ind = 0;
-#endif
+                    if (energyGroups)
+                    {
+                        egp_ind = egp_sh_i[i] + ((nbat->energrp[ci]>>(i*nbat->neg_2log)) & p.egp_mask);
+                    }
+                    else
+                    {
+                        egp_ind = 0;
+                    }
                     /* Coulomb self interaction */
                     Vc[egp_ind]   -= qi[i]*q[ci*UNROLLI+i]*Vc_sub_self;
 
-#ifdef LJ_EWALD
-                    /* LJ Ewald self interaction */
-                    Vvdw[egp_ind] += 0.5*nbat->nbfp[nbat->type[ci*UNROLLI+i]*(nbat->ntype + 1)*2]/6*lje_coeff6_6;
-#endif
+                    if (ljEwald)
+                    {
+                        /* LJ Ewald self interaction */
+                        Vvdw[egp_ind] += 0.5*nbat->nbfp[nbat->type[ci*UNROLLI+i]*(nbat->ntype + 1)*2]/6*p.lje_coeff6_6;
+                    }
                 }
             }
         }
-#endif  /* CALC_ENERGIES */
 
-        cjind = cjind0;
+        /* Without energy groups the inner loops accumulate in Vvdw_ci/Vc_ci,
+         * with energy groups they accumulate directly in Vvdw/Vc.
+         */
+        real *Vvdw_inner = (energyGroups ? Vvdw : &Vvdw_ci);
+        real *Vc_inner   = (energyGroups ? Vc   : &Vc_ci);
+
+        int   cjind      = cjind0;
         while (cjind < cjind1 && nbl->cj[cjind].excl != 0xffff)
         {
-#define CHECK_EXCLS
             if (half_LJ)
             {
-#define CALC_COULOMB
-#define HALF_LJ
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_inner.h"
-#undef HALF_LJ
-#undef CALC_COULOMB
+                nbnxn_kernel_ref_inner<coulombType, vdwType, energyOutput, true, true, true>
+                    (p, l_cj[cjind], ci, ci_sh, xi, qi, fi, egp_sh_i, f, Vvdw_inner, Vc_inner);
             }
             else if (do_coul)
             {
-#define CALC_COULOMB
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_inner.h"
-#undef CALC_COULOMB
+                nbnxn_kernel_ref_inner<coulombType, vdwType, energyOutput, true, true, false>
+                    (p, l_cj[cjind], ci, ci_sh, xi, qi, fi, egp_sh_i, f, Vvdw_inner, Vc_inner);
             }
             else
             {
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_inner.h"
+                nbnxn_kernel_ref_inner<coulombType, vdwType, energyOutput, true, false, false>
+                    (p, l_cj[cjind], ci, ci_sh, xi, qi, fi, egp_sh_i, f, Vvdw_inner, Vc_inner);
             }
-#undef CHECK_EXCLS
             cjind++;
         }
 
@@ -353,61 +267,49 @@ NBK_FUNC_NAME(_VgrpF)
         {
             if (half_LJ)
             {
-#define CALC_COULOMB
-#define HALF_LJ
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_inner.h"
-#undef HALF_LJ
-#undef CALC_COULOMB
+                nbnxn_kernel_ref_inner<coulombType, vdwType, energyOutput, false, true, true>
+                    (p, l_cj[cjind], ci, ci_sh, xi, qi, fi, egp_sh_i, f, Vvdw_inner, Vc_inner);
             }
             else if (do_coul)
             {
-#define CALC_COULOMB
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_inner.h"
-#undef CALC_COULOMB
+                nbnxn_kernel_ref_inner<coulombType, vdwType, energyOutput, false, true, false>
+                    (p, l_cj[cjind], ci, ci_sh, xi, qi, fi, egp_sh_i, f, Vvdw_inner, Vc_inner);
             }
             else
             {
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_inner.h"
+                nbnxn_kernel_ref_inner<coulombType, vdwType, energyOutput, false, false, false>
+                    (p, l_cj[cjind], ci, ci_sh, xi, qi, fi, egp_sh_i, f, Vvdw_inner, Vc_inner);
             }
         }
 
         /* Add accumulated i-forces to the force array */
-        for (i = 0; i < UNROLLI; i++)
+        for (int i = 0; i < UNROLLI; i++)
         {
-            for (d = 0; d < DIM; d++)
+            for (int d = 0; d < DIM; d++)
             {
                 f[(ci*UNROLLI+i)*F_STRIDE+d] += fi[i*FI_STRIDE+d];
             }
         }
-#ifdef CALC_SHIFTFORCES
         if (fshift != nullptr)
         {
             /* Add i forces to shifted force list */
-            for (i = 0; i < UNROLLI; i++)
+            for (int i = 0; i < UNROLLI; i++)
             {
-                for (d = 0; d < DIM; d++)
+                for (int d = 0; d < DIM; d++)
                 {
                     fshift[ishf+d] += fi[i*FI_STRIDE+d];
                 }
             }
         }
-#endif
 
-#ifdef CALC_ENERGIES
-#ifndef ENERGY_GROUPS
-        *Vvdw += Vvdw_ci;
-        *Vc   += Vc_ci;
-#endif
-#endif
+        if (calcEnergies && !energyGroups)
+        {
+            *Vvdw += Vvdw_ci;
+            *Vc   += Vc_ci;
+        }
     }
-
-#ifdef COUNT_PAIRS
-    printf("atom pairs %d\n", npair);
-#endif
 }
 
-#undef CALC_SHIFTFORCES
-
 #undef X_STRIDE
 #undef F_STRIDE
 #undef XI_STRIDE
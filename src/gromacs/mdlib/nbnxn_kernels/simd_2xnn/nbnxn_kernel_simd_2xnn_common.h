@@ -1,7 +1,7 @@
 /*
  * This file is part of the GROMACS molecular simulation package.
  *
- * Copyright (c) 2012,2013,2014,2015, by the GROMACS development team, led by
+ * Copyright (c) 2012,2013,2014,2015,2017, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -33,6 +33,7 @@
  * the research papers on the package. Check out http://www.gromacs.org.
  */
 #include "gromacs/mdlib/nbnxn_consts.h"
+#include "gromacs/mdlib/nbnxn_util.h"
 #include "gromacs/pbcutil/ishift.h"
 #include "gromacs/simd/simd.h"
 #include "gromacs/simd/simd_math.h"
@@ -83,6 +84,16 @@ add_ener_grp_halves(SimdReal e_S, real *v0, real *v1, const int *offset_jj)
                       v1+offset_jj[jj]+jj*GMX_SIMD_REAL_WIDTH/2, e_S);
     }
 }
+
+/* Add the energy accumulated in register e_S for a run of j-clusters
+ * which all interact with the i-cluster through a single energy group pair
+ * to the first element of the buffer v of that pair and clear e_S.
+ */
+static gmx_inline void add_ener_grp_run(SimdReal *e_S, real *v)
+{
+    *v  += reduce(*e_S);
+    *e_S = setZero();
+}
 #endif
 
 #if GMX_SIMD_HAVE_INT32_LOGICAL
@@ -94,12 +105,19 @@ typedef SimdReal     SimdBitMask;
 
 static gmx_inline void gmx_simdcall
 gmx_load_simd_2xnn_interactions(int                  excl,
-                                SimdBitMask          filter_S0,
-                                SimdBitMask          filter_S2,
+                                SimdBitMask gmx_unused filter_S0,
+                                SimdBitMask gmx_unused filter_S2,
                                 SimdBool            *interact_S0,
                                 SimdBool            *interact_S2)
 {
-#if GMX_SIMD_HAVE_INT32_LOGICAL
+#if GMX_SIMD_HAVE_BOOL_FROM_BITS
+    /* The exclusion bits are stored in SIMD lane order, so we can
+     * convert them directly to SIMD booleans. With AVX-512 this avoids
+     * a broadcast, a bitwise and and a compare.
+     */
+    *interact_S0  = boolFromBits(excl);
+    *interact_S2  = boolFromBits(excl >> GMX_SIMD_REAL_WIDTH);
+#elif GMX_SIMD_HAVE_INT32_LOGICAL
     SimdInt32 mask_pr_S(excl);
     *interact_S0  = cvtIB2B( testBits( mask_pr_S & filter_S0 ) );
     *interact_S2  = cvtIB2B( testBits( mask_pr_S & filter_S2 ) );
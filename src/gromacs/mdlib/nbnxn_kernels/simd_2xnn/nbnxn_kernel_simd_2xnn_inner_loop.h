@@ -0,0 +1,90 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2017, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/* This is the loop over the j-clusters without exclusions for the 2 x (N+N)
+ * atom simd kernel. It is included once for each combination of
+ * Coulomb and LJ interactions by the outer loop.
+ *
+ * With energy groups, the part of the j-list without exclusions is sorted
+ * on the energy group of the j-clusters, with clusters that contain
+ * multiple groups at the end. When all i-atoms are in one group,
+ * we run each stretch of j-clusters in one group with the inner loop
+ * without energy groups, which accumulates the energies in registers.
+ */
+
+#ifndef ENERGY_GROUPS
+for (; (cjind < cjind1); cjind++)
+{
+#include "gromacs/mdlib/nbnxn_kernels/simd_2xnn/nbnxn_kernel_simd_2xnn_inner.h"
+}
+#else
+if (egp_i < 0)
+{
+    /* The i-atoms are in multiple energy groups, use the buffered
+     * energy accumulation for all j-clusters.
+     */
+    for (; (cjind < cjind1); cjind++)
+    {
+#include "gromacs/mdlib/nbnxn_kernels/simd_2xnn/nbnxn_kernel_simd_2xnn_inner.h"
+    }
+}
+while (cjind < cjind1)
+{
+    egp_j = nbnxn_cluster_energygroup(nbat, l_cj[cjind].cj, UNROLLJ);
+    if (egp_j >= 0)
+    {
+        /* Accumulate the run of j-clusters in group egp_j in registers */
+#undef ENERGY_GROUPS
+        do
+        {
+#include "gromacs/mdlib/nbnxn_kernels/simd_2xnn/nbnxn_kernel_simd_2xnn_inner.h"
+            cjind++;
+        }
+        while (cjind < cjind1 &&
+               nbnxn_cluster_energygroup(nbat, l_cj[cjind].cj, UNROLLJ) == egp_j);
+#define ENERGY_GROUPS
+        egp_offset = (egp_j + (egp_j << egps_ishift))*egps_jstride;
+#ifdef CALC_COULOMB
+        add_ener_grp_run(&vctot_S, vctp[0] + egp_offset);
+#endif
+        add_ener_grp_run(&Vvdwtot_S, vvdwtp[0] + egp_offset);
+    }
+    else
+    {
+#include "gromacs/mdlib/nbnxn_kernels/simd_2xnn/nbnxn_kernel_simd_2xnn_inner.h"
+        cjind++;
+    }
+}
+#endif
@@ -1,7 +1,7 @@
 /*
  * This file is part of the GROMACS molecular simulation package.
  *
- * Copyright (c) 2012,2013,2014,2015,2016, by the GROMACS development team, led by
+ * Copyright (c) 2012,2013,2014,2015,2016,2017, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -51,6 +51,7 @@
     int         egps_ishift, egps_imask;
     int         egps_jshift, egps_jmask, egps_jstride;
     int         egps_i;
+    int         egp_i, egp_j, egp_offset;
     real       *vvdwtp[UNROLLI];
     real       *vctp[UNROLLI];
 #endif
@@ -402,6 +403,8 @@
                 vctp[ia]   = Vc   + egp_ia*Vstride_i;
             }
         }
+        /* Check if all i-atoms are in the same energy group */
+        egp_i = nbnxn_cluster_energygroup(nbat, ci, UNROLLI);
 #endif
 
 #ifdef CALC_ENERGIES
@@ -572,10 +575,7 @@
                 cjind++;
             }
 #undef CHECK_EXCLS
-            for (; (cjind < cjind1); cjind++)
-            {
-#include "gromacs/mdlib/nbnxn_kernels/simd_2xnn/nbnxn_kernel_simd_2xnn_inner.h"
-            }
+#include "gromacs/mdlib/nbnxn_kernels/simd_2xnn/nbnxn_kernel_simd_2xnn_inner_loop.h"
 #undef HALF_LJ
 #undef CALC_COULOMB
         }
@@ -590,10 +590,7 @@
                 cjind++;
             }
 #undef CHECK_EXCLS
-            for (; (cjind < cjind1); cjind++)
-            {
-#include "gromacs/mdlib/nbnxn_kernels/simd_2xnn/nbnxn_kernel_simd_2xnn_inner.h"
-            }
+#include "gromacs/mdlib/nbnxn_kernels/simd_2xnn/nbnxn_kernel_simd_2xnn_inner_loop.h"
 #undef CALC_COULOMB
         }
         else
@@ -606,10 +603,7 @@
                 cjind++;
             }
 #undef CHECK_EXCLS
-            for (; (cjind < cjind1); cjind++)
-            {
-#include "gromacs/mdlib/nbnxn_kernels/simd_2xnn/nbnxn_kernel_simd_2xnn_inner.h"
-            }
+#include "gromacs/mdlib/nbnxn_kernels/simd_2xnn/nbnxn_kernel_simd_2xnn_inner_loop.h"
         }
 #undef CALC_LJ
         ninner += cjind1 - cjind0;
@@ -1,7 +1,7 @@
 /*
  * This file is part of the GROMACS molecular simulation package.
  *
- * Copyright (c) 2012,2013,2014,2015,2016, by the GROMACS development team, led by
+ * Copyright (c) 2012,2013,2014,2015,2016,2017, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -32,11 +32,6 @@
  * To help us fund GROMACS development, we humbly ask that you cite
  * the research papers on the package. Check out http://www.gromacs.org.
  */
-/*
- * Note: this file was generated by the Verlet kernel generator for
- * kernel type 4xn.
- */
-
 #include "gmxpre.h"
 
 #include "config.h"
@@ -77,142 +72,60 @@ enum {
     vdwktLJCUT_COMBGEOM, vdwktLJCUT_COMBLB, vdwktLJCUT_COMBNONE, vdwktLJFORCESWITCH, vdwktLJPOTSWITCH, vdwktLJEWALDCOMBGEOM, vdwktNR
 };
 
-/* Declare and define the kernel function pointer lookup tables.
- * The minor index of the array goes over both the LJ combination rules,
+#include "gromacs/mdlib/nbnxn_kernels/simd_4xn/nbnxn_kernel_simd_4xn_common.h"
+#include "gromacs/mdlib/nbnxn_kernels/simd_4xn/nbnxn_kernel_simd_4xn_outer.h"
+
+/*! \brief Typedef for declaring the lookup table of kernel functions.
+ */
+typedef void (*p_nbk_func)(const nbnxn_pairlist_t     *nbl,
+                           const nbnxn_atomdata_t     *nbat,
+                           const interaction_const_t  *ic,
+                           rvec                       *shift_vec,
+                           real                       *f,
+                           real                       *fshift,
+                           real                       *Vvdw,
+                           real                       *Vc);
+
+/*! \brief The kernels for all VdW treatments for one Coulomb treatment and energy output
+ *
+ * The minor index goes over both the LJ combination rules,
  * which is only supported by plain cut-off, and the LJ switch/PME functions.
  */
-static p_nbk_func_noener p_nbk_noener[coulktNR][vdwktNR] =
-{
-    {
-        nbnxn_kernel_ElecRF_VdwLJCombGeom_F_4xn,
-        nbnxn_kernel_ElecRF_VdwLJCombLB_F_4xn,
-        nbnxn_kernel_ElecRF_VdwLJ_F_4xn,
-        nbnxn_kernel_ElecRF_VdwLJFSw_F_4xn,
-        nbnxn_kernel_ElecRF_VdwLJPSw_F_4xn,
-        nbnxn_kernel_ElecRF_VdwLJEwCombGeom_F_4xn,
-    },
-    {
-        nbnxn_kernel_ElecQSTab_VdwLJCombGeom_F_4xn,
-        nbnxn_kernel_ElecQSTab_VdwLJCombLB_F_4xn,
-        nbnxn_kernel_ElecQSTab_VdwLJ_F_4xn,
-        nbnxn_kernel_ElecQSTab_VdwLJFSw_F_4xn,
-        nbnxn_kernel_ElecQSTab_VdwLJPSw_F_4xn,
-        nbnxn_kernel_ElecQSTab_VdwLJEwCombGeom_F_4xn,
-    },
-    {
-        nbnxn_kernel_ElecQSTabTwinCut_VdwLJCombGeom_F_4xn,
-        nbnxn_kernel_ElecQSTabTwinCut_VdwLJCombLB_F_4xn,
-        nbnxn_kernel_ElecQSTabTwinCut_VdwLJ_F_4xn,
-        nbnxn_kernel_ElecQSTabTwinCut_VdwLJFSw_F_4xn,
-        nbnxn_kernel_ElecQSTabTwinCut_VdwLJPSw_F_4xn,
-        nbnxn_kernel_ElecQSTabTwinCut_VdwLJEwCombGeom_F_4xn,
-    },
-    {
-        nbnxn_kernel_ElecEw_VdwLJCombGeom_F_4xn,
-        nbnxn_kernel_ElecEw_VdwLJCombLB_F_4xn,
-        nbnxn_kernel_ElecEw_VdwLJ_F_4xn,
-        nbnxn_kernel_ElecEw_VdwLJFSw_F_4xn,
-        nbnxn_kernel_ElecEw_VdwLJPSw_F_4xn,
-        nbnxn_kernel_ElecEw_VdwLJEwCombGeom_F_4xn,
-    },
-    {
-        nbnxn_kernel_ElecEwTwinCut_VdwLJCombGeom_F_4xn,
-        nbnxn_kernel_ElecEwTwinCut_VdwLJCombLB_F_4xn,
-        nbnxn_kernel_ElecEwTwinCut_VdwLJ_F_4xn,
-        nbnxn_kernel_ElecEwTwinCut_VdwLJFSw_F_4xn,
-        nbnxn_kernel_ElecEwTwinCut_VdwLJPSw_F_4xn,
-        nbnxn_kernel_ElecEwTwinCut_VdwLJEwCombGeom_F_4xn,
-    },
-};
+#define NBK_FUNC_VDW(coulkt, enrgout) \
+    { \
+        nbnxn_kernel_simd_4xn_outer<coulkt, vdwktLJCUT_COMBGEOM, enrgout>, \
+        nbnxn_kernel_simd_4xn_outer<coulkt, vdwktLJCUT_COMBLB, enrgout>, \
+        nbnxn_kernel_simd_4xn_outer<coulkt, vdwktLJCUT_COMBNONE, enrgout>, \
+        nbnxn_kernel_simd_4xn_outer<coulkt, vdwktLJFORCESWITCH, enrgout>, \
+        nbnxn_kernel_simd_4xn_outer<coulkt, vdwktLJPOTSWITCH, enrgout>, \
+        nbnxn_kernel_simd_4xn_outer<coulkt, vdwktLJEWALDCOMBGEOM, enrgout> \
+    }
 
-static p_nbk_func_ener p_nbk_ener[coulktNR][vdwktNR] =
-{
-    {
-        nbnxn_kernel_ElecRF_VdwLJCombGeom_VF_4xn,
-        nbnxn_kernel_ElecRF_VdwLJCombLB_VF_4xn,
-        nbnxn_kernel_ElecRF_VdwLJ_VF_4xn,
-        nbnxn_kernel_ElecRF_VdwLJFSw_VF_4xn,
-        nbnxn_kernel_ElecRF_VdwLJPSw_VF_4xn,
-        nbnxn_kernel_ElecRF_VdwLJEwCombGeom_VF_4xn,
-    },
-    {
-        nbnxn_kernel_ElecQSTab_VdwLJCombGeom_VF_4xn,
-        nbnxn_kernel_ElecQSTab_VdwLJCombLB_VF_4xn,
-        nbnxn_kernel_ElecQSTab_VdwLJ_VF_4xn,
-        nbnxn_kernel_ElecQSTab_VdwLJFSw_VF_4xn,
-        nbnxn_kernel_ElecQSTab_VdwLJPSw_VF_4xn,
-        nbnxn_kernel_ElecQSTab_VdwLJEwCombGeom_VF_4xn,
-    },
-    {
-        nbnxn_kernel_ElecQSTabTwinCut_VdwLJCombGeom_VF_4xn,
-        nbnxn_kernel_ElecQSTabTwinCut_VdwLJCombLB_VF_4xn,
-        nbnxn_kernel_ElecQSTabTwinCut_VdwLJ_VF_4xn,
-        nbnxn_kernel_ElecQSTabTwinCut_VdwLJFSw_VF_4xn,
-        nbnxn_kernel_ElecQSTabTwinCut_VdwLJPSw_VF_4xn,
-        nbnxn_kernel_ElecQSTabTwinCut_VdwLJEwCombGeom_VF_4xn,
-    },
-    {
-        nbnxn_kernel_ElecEw_VdwLJCombGeom_VF_4xn,
-        nbnxn_kernel_ElecEw_VdwLJCombLB_VF_4xn,
-        nbnxn_kernel_ElecEw_VdwLJ_VF_4xn,
-        nbnxn_kernel_ElecEw_VdwLJFSw_VF_4xn,
-        nbnxn_kernel_ElecEw_VdwLJPSw_VF_4xn,
-        nbnxn_kernel_ElecEw_VdwLJEwCombGeom_VF_4xn,
-    },
-    {
-        nbnxn_kernel_ElecEwTwinCut_VdwLJCombGeom_VF_4xn,
-        nbnxn_kernel_ElecEwTwinCut_VdwLJCombLB_VF_4xn,
-        nbnxn_kernel_ElecEwTwinCut_VdwLJ_VF_4xn,
-        nbnxn_kernel_ElecEwTwinCut_VdwLJFSw_VF_4xn,
-        nbnxn_kernel_ElecEwTwinCut_VdwLJPSw_VF_4xn,
-        nbnxn_kernel_ElecEwTwinCut_VdwLJEwCombGeom_VF_4xn,
-    },
-};
+/*! \brief The kernels for all Coulomb and VdW treatments for one energy output */
+#define NBK_FUNC_COUL_VDW(enrgout) \
+    { \
+        NBK_FUNC_VDW(coulktRF, enrgout), \
+        NBK_FUNC_VDW(coulktTAB, enrgout), \
+        NBK_FUNC_VDW(coulktTAB_TWIN, enrgout), \
+        NBK_FUNC_VDW(coulktEWALD, enrgout), \
+        NBK_FUNC_VDW(coulktEWALD_TWIN, enrgout) \
+    }
 
-static p_nbk_func_ener p_nbk_energrp[coulktNR][vdwktNR] =
+/*! \brief Kernel lookup table, index with [energy output][Coulomb][VdW]
+ *
+ * All entries are instantiations of the single nbnxn_kernel_simd_4xn_outer
+ * template. Adding a kernel flavor requires adding an enum entry,
+ * an entry here and the code for the flavor in the template.
+ */
+static const p_nbk_func p_nbk[enrgoutNR][coulktNR][vdwktNR] =
 {
-    {
-        nbnxn_kernel_ElecRF_VdwLJCombGeom_VgrpF_4xn,
-        nbnxn_kernel_ElecRF_VdwLJCombLB_VgrpF_4xn,
-        nbnxn_kernel_ElecRF_VdwLJ_VgrpF_4xn,
-        nbnxn_kernel_ElecRF_VdwLJFSw_VgrpF_4xn,
-        nbnxn_kernel_ElecRF_VdwLJPSw_VgrpF_4xn,
-        nbnxn_kernel_ElecRF_VdwLJEwCombGeom_VgrpF_4xn,
-    },
-    {
-        nbnxn_kernel_ElecQSTab_VdwLJCombGeom_VgrpF_4xn,
-        nbnxn_kernel_ElecQSTab_VdwLJCombLB_VgrpF_4xn,
-        nbnxn_kernel_ElecQSTab_VdwLJ_VgrpF_4xn,
-        nbnxn_kernel_ElecQSTab_VdwLJFSw_VgrpF_4xn,
-        nbnxn_kernel_ElecQSTab_VdwLJPSw_VgrpF_4xn,
-        nbnxn_kernel_ElecQSTab_VdwLJEwCombGeom_VgrpF_4xn,
-    },
-    {
-        nbnxn_kernel_ElecQSTabTwinCut_VdwLJCombGeom_VgrpF_4xn,
-        nbnxn_kernel_ElecQSTabTwinCut_VdwLJCombLB_VgrpF_4xn,
-        nbnxn_kernel_ElecQSTabTwinCut_VdwLJ_VgrpF_4xn,
-        nbnxn_kernel_ElecQSTabTwinCut_VdwLJFSw_VgrpF_4xn,
-        nbnxn_kernel_ElecQSTabTwinCut_VdwLJPSw_VgrpF_4xn,
-        nbnxn_kernel_ElecQSTabTwinCut_VdwLJEwCombGeom_VgrpF_4xn,
-    },
-    {
-        nbnxn_kernel_ElecEw_VdwLJCombGeom_VgrpF_4xn,
-        nbnxn_kernel_ElecEw_VdwLJCombLB_VgrpF_4xn,
-        nbnxn_kernel_ElecEw_VdwLJ_VgrpF_4xn,
-        nbnxn_kernel_ElecEw_VdwLJFSw_VgrpF_4xn,
-        nbnxn_kernel_ElecEw_VdwLJPSw_VgrpF_4xn,
-        nbnxn_kernel_ElecEw_VdwLJEwCombGeom_VgrpF_4xn,
-    },
-    {
-        nbnxn_kernel_ElecEwTwinCut_VdwLJCombGeom_VgrpF_4xn,
-        nbnxn_kernel_ElecEwTwinCut_VdwLJCombLB_VgrpF_4xn,
-        nbnxn_kernel_ElecEwTwinCut_VdwLJ_VgrpF_4xn,
-        nbnxn_kernel_ElecEwTwinCut_VdwLJFSw_VgrpF_4xn,
-        nbnxn_kernel_ElecEwTwinCut_VdwLJPSw_VgrpF_4xn,
-        nbnxn_kernel_ElecEwTwinCut_VdwLJEwCombGeom_VgrpF_4xn,
-    },
+    NBK_FUNC_COUL_VDW(enrgoutNONE),
+    NBK_FUNC_COUL_VDW(enrgoutSYSTEM),
+    NBK_FUNC_COUL_VDW(enrgoutGROUPPAIRS)
 };
 
+#undef NBK_FUNC_COUL_VDW
+#undef NBK_FUNC_VDW
 
 static void
 reduce_group_energies(int ng, int ng_2log,
@@ -381,11 +294,13 @@ nbnxn_kernel_simd_4xn(nbnxn_pairlist_set_t      gmx_unused *nbl_list,
         if (!(force_flags & GMX_FORCE_ENERGY))
         {
             /* Don't calculate energies */
-            p_nbk_noener[coulkt][vdwkt](nbl[nb], nbat,
-                                        ic,
-                                        shift_vec,
-                                        out->f,
-                                        fshift_p);
+            p_nbk[enrgoutNONE][coulkt][vdwkt](nbl[nb], nbat,
+                                              ic,
+                                              shift_vec,
+                                              out->f,
+                                              fshift_p,
+                                              nullptr,
+                                              nullptr);
         }
         else if (out->nV == 1)
         {
@@ -393,13 +308,13 @@ nbnxn_kernel_simd_4xn(nbnxn_pairlist_set_t      gmx_unused *nbl_list,
             out->Vvdw[0] = 0;
             out->Vc[0]   = 0;
 
-            p_nbk_ener[coulkt][vdwkt](nbl[nb], nbat,
-                                      ic,
-                                      shift_vec,
-                                      out->f,
-                                      fshift_p,
-                                      out->Vvdw,
-                                      out->Vc);
+            p_nbk[enrgoutSYSTEM][coulkt][vdwkt](nbl[nb], nbat,
+                                                ic,
+                                                shift_vec,
+                                                out->f,
+                                                fshift_p,
+                                                out->Vvdw,
+                                                out->Vc);
         }
         else
         {
@@ -415,13 +330,13 @@ nbnxn_kernel_simd_4xn(nbnxn_pairlist_set_t      gmx_unused *nbl_list,
                 out->VSc[i] = 0;
             }
 
-            p_nbk_energrp[coulkt][vdwkt](nbl[nb], nbat,
-                                         ic,
-                                         shift_vec,
-                                         out->f,
-                                         fshift_p,
-                                         out->VSvdw,
-                                         out->VSc);
+            p_nbk[enrgoutGROUPPAIRS][coulkt][vdwkt](nbl[nb], nbat,
+                                                    ic,
+                                                    shift_vec,
+                                                    out->f,
+                                                    fshift_p,
+                                                    out->VSvdw,
+                                                    out->VSc);
 
             reduce_group_energies(nbat->nenergrp, nbat->neg_2log,
                                   out->VSvdw, out->VSc,
@@ -1,7 +1,7 @@
 /*
  * This file is part of the GROMACS molecular simulation package.
  *
- * Copyright (c) 2012,2013,2014,2015, by the GROMACS development team, led by
+ * Copyright (c) 2012,2013,2014,2015,2017, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -32,15 +32,14 @@
  * To help us fund GROMACS development, we humbly ask that you cite
  * the research papers on the package. Check out http://www.gromacs.org.
  */
+#include "gromacs/math/utilities.h"
 #include "gromacs/mdlib/nbnxn_consts.h"
+#include "gromacs/mdlib/nbnxn_util.h"
 #include "gromacs/pbcutil/ishift.h"
 #include "gromacs/simd/simd.h"
 #include "gromacs/simd/simd_math.h"
 #include "gromacs/simd/vector_operations.h"
 #include "gromacs/utility/basedefinitions.h"
-#ifdef CALC_COUL_EWALD
-#include "gromacs/math/utilities.h"
-#endif
 
 #include "config.h"
 
@@ -89,6 +88,16 @@ static gmx_inline void add_ener_grp(SimdReal e_S, real *v, const int *offset_jj)
         store(v+offset_jj[jj]+jj*GMX_SIMD_REAL_WIDTH, v_S + e_S);
     }
 }
+
+/* Add the energy accumulated in register e_S for a run of j-clusters
+ * which all interact with the i-cluster through a single energy group pair
+ * to the first element of the buffer v of that pair and clear e_S.
+ */
+static gmx_inline void add_ener_grp_run(SimdReal *e_S, real *v)
+{
+    *v  += reduce(*e_S);
+    *e_S = setZero();
+}
 #endif
 
 #if GMX_SIMD_HAVE_INT32_LOGICAL
@@ -109,7 +118,16 @@ gmx_load_simd_4xn_interactions(int                               excl,
                                SimdBool                         *interact_S2,
                                SimdBool                         *interact_S3)
 {
-#if GMX_SIMD_HAVE_INT32_LOGICAL
+#if GMX_SIMD_HAVE_BOOL_FROM_BITS
+    /* The exclusion bits are stored in SIMD lane order, so we can
+     * convert them directly to SIMD booleans. With AVX-512 this avoids
+     * a broadcast, a bitwise and and a compare.
+     */
+    *interact_S0  = boolFromBits(excl >> (0 * UNROLLJ));
+    *interact_S1  = boolFromBits(excl >> (1 * UNROLLJ));
+    *interact_S2  = boolFromBits(excl >> (2 * UNROLLJ));
+    *interact_S3  = boolFromBits(excl >> (3 * UNROLLJ));
+#elif GMX_SIMD_HAVE_INT32_LOGICAL
     /* Load integer interaction mask */
     SimdInt32 mask_pr_S(excl);
     *interact_S0  = cvtIB2B(testBits( mask_pr_S & filter_S0 ));
@@ -144,18 +162,3 @@ gmx_load_simd_4xn_interactions(int                               excl,
     *interact_S3  = ( zero < load( simd_interaction_array + GMX_SIMD_REAL_WIDTH*((excl >> (3 * UNROLLJ)) & 0xF) ) );
 #endif
 }
-
-/* All functionality defines are set here, except for:
- * CALC_ENERGIES, ENERGY_GROUPS which are defined before.
- * CHECK_EXCLS, which is set just before including the inner loop contents.
- * The combination rule defines, LJ_COMB_GEOM or LJ_COMB_LB are currently
- * set before calling the kernel function. We might want to move that
- * to inside the n-loop and have a different combination rule for different
- * ci's, as no combination rule gives a 50% performance hit for LJ.
- */
-
-/* We always calculate shift forces, because it's cheap anyhow */
-#define CALC_SHIFTFORCES
-
-/* Assumes all LJ parameters are identical */
-/* #define FIX_LJ_C */
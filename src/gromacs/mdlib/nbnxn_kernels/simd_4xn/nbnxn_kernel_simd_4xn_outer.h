@@ -33,189 +33,296 @@
  * the research papers on the package. Check out http://www.gromacs.org.
  */
 
-
+/*! \brief Constant parameters for the 4xN SIMD kernels, set once per call
+ *
+ * Which of the parameters are used depends on the kernel flavor.
+ */
+struct nbnxn_kernel_simd_4xn_params_t
 {
-    const nbnxn_ci_t   *nbln;
-    const nbnxn_cj_t   *l_cj;
-    const real *        q;
-    const real         *shiftvec;
-    const real         *x;
-    real                facel;
-    int                 n, ci, ci_sh;
-    int                 ish, ish3;
-    gmx_bool            do_LJ, half_LJ, do_coul;
-    int                 cjind0, cjind1, cjind;
-
-#ifdef ENERGY_GROUPS
-    int         Vstride_i;
-    int         egps_ishift, egps_imask;
-    int         egps_jshift, egps_jmask, egps_jstride;
-    int         egps_i;
-    real       *vvdwtp[UNROLLI];
-    real       *vctp[UNROLLI];
-#endif
-
-    SimdReal  shX_S;
-    SimdReal  shY_S;
-    SimdReal  shZ_S;
-    SimdReal  ix_S0, iy_S0, iz_S0;
-    SimdReal  ix_S1, iy_S1, iz_S1;
-    SimdReal  ix_S2, iy_S2, iz_S2;
-    SimdReal  ix_S3, iy_S3, iz_S3;
-    SimdReal  fix_S0, fiy_S0, fiz_S0;
-    SimdReal  fix_S1, fiy_S1, fiz_S1;
-    SimdReal  fix_S2, fiy_S2, fiz_S2;
-    SimdReal  fix_S3, fiy_S3, fiz_S3;
-
-    SimdReal  diagonal_jmi_S;
+    const nbnxn_atomdata_t *nbat;            //!< The atom data
+    const real             *x;               //!< The coordinates
+    const real             *q;               //!< The charges
+    const int              *type;            //!< The atom types
+    const real             *ljc;             //!< The LJ combination rule parameters
+
+    SimdBitMask             filter_S0;       //!< Exclusion filter for i-atom 0
+    SimdBitMask             filter_S1;       //!< Exclusion filter for i-atom 1
+    SimdBitMask             filter_S2;       //!< Exclusion filter for i-atom 2
+    SimdBitMask             filter_S3;       //!< Exclusion filter for i-atom 3
 #if UNROLLI == UNROLLJ
-    SimdBool  diagonal_mask_S0, diagonal_mask_S1, diagonal_mask_S2, diagonal_mask_S3;
+    SimdBool                diagonal_mask_S0;  //!< Diagonal mask for i-atom 0
+    SimdBool                diagonal_mask_S1;  //!< Diagonal mask for i-atom 1
+    SimdBool                diagonal_mask_S2;  //!< Diagonal mask for i-atom 2
+    SimdBool                diagonal_mask_S3;  //!< Diagonal mask for i-atom 3
 #else
-    SimdBool  diagonal_mask0_S0, diagonal_mask0_S1, diagonal_mask0_S2, diagonal_mask0_S3;
-    SimdBool  diagonal_mask1_S0, diagonal_mask1_S1, diagonal_mask1_S2, diagonal_mask1_S3;
-#endif
-
-#if GMX_DOUBLE && !GMX_SIMD_HAVE_INT32_LOGICAL
-    std::uint64_t       *exclusion_filter;
-#else
-    std::uint32_t       *exclusion_filter;
-#endif
-    SimdBitMask          filter_S0, filter_S1, filter_S2, filter_S3;
-
-    SimdReal             zero_S(0.0);
-
-    SimdReal             one_S(1.0);
-    SimdReal             iq_S0  = setZero();
-    SimdReal             iq_S1  = setZero();
-    SimdReal             iq_S2  = setZero();
-    SimdReal             iq_S3  = setZero();
-
-#ifdef CALC_COUL_RF
-    SimdReal      mrc_3_S;
-#ifdef CALC_ENERGIES
-    SimdReal      hrc_3_S, moh_rc_S;
-#endif
-#endif
-
-#ifdef CALC_COUL_TAB
-    /* Coulomb table variables */
-    SimdReal               invtsp_S;
-    const real      *      tab_coul_F;
-#ifndef TAB_FDV0
-    const real gmx_unused *tab_coul_V;
-#endif
-#ifdef CALC_ENERGIES
-    SimdReal   mhalfsp_S;
-#endif
-#endif
+    SimdBool                diagonal_mask0_S0; //!< Diagonal mask for i-atom 0, first half
+    SimdBool                diagonal_mask0_S1; //!< Diagonal mask for i-atom 1, first half
+    SimdBool                diagonal_mask0_S2; //!< Diagonal mask for i-atom 2, first half
+    SimdBool                diagonal_mask0_S3; //!< Diagonal mask for i-atom 3, first half
+    SimdBool                diagonal_mask1_S0; //!< Diagonal mask for i-atom 0, second half
+    SimdBool                diagonal_mask1_S1; //!< Diagonal mask for i-atom 1, second half
+    SimdBool                diagonal_mask1_S2; //!< Diagonal mask for i-atom 2, second half
+    SimdBool                diagonal_mask1_S3; //!< Diagonal mask for i-atom 3, second half
+#endif
+
+    SimdReal                rc2_S;           //!< The (Coulomb) cut-off squared
+    SimdReal                rcvdw2_S;        //!< The VdW cut-off squared
+    SimdReal                minRsq_S;        //!< The minimum distance squared
+
+    SimdReal                mrc_3_S;         //!< RF: -2 times k
+    SimdReal                hrc_3_S;         //!< RF: k
+    SimdReal                moh_rc_S;        //!< RF: -c
+
+    SimdReal                invtsp_S;        //!< Table: the inverse table spacing
+    SimdReal                mhalfsp_S;       //!< Table: minus half the table spacing
+    const real             *tab_coul_F;      //!< Table: the force (FDV0) table
+    const real             *tab_coul_V;      //!< Table: the energy table, not used with FDV0
+
+    SimdReal                beta2_S;         //!< Ewald: the Ewald coefficient squared
+    SimdReal                beta_S;          //!< Ewald: the Ewald coefficient
+    SimdReal                sh_ewald_S;      //!< Ewald/table: the potential shift
+
+    SimdReal                p6_cpot_S;       //!< LJ cut: the dispersion potential shift
+    SimdReal                p12_cpot_S;      //!< LJ cut: the repulsion potential shift
+
+    SimdReal                rswitch_S;       //!< LJ switch: the switching distance
+    SimdReal                swV3_S;          //!< LJ potential switch energy constant
+    SimdReal                swV4_S;          //!< LJ potential switch energy constant
+    SimdReal                swV5_S;          //!< LJ potential switch energy constant
+    SimdReal                swF2_S;          //!< LJ potential switch force constant
+    SimdReal                swF3_S;          //!< LJ potential switch force constant
+    SimdReal                swF4_S;          //!< LJ potential switch force constant
+    SimdReal                p6_fc2_S;        //!< LJ force switch dispersion force constant
+    SimdReal                p6_fc3_S;        //!< LJ force switch dispersion force constant
+    SimdReal                p12_fc2_S;       //!< LJ force switch repulsion force constant
+    SimdReal                p12_fc3_S;       //!< LJ force switch repulsion force constant
+    SimdReal                p6_vc3_S;        //!< LJ force switch dispersion energy constant
+    SimdReal                p6_vc4_S;        //!< LJ force switch dispersion energy constant
+    SimdReal                p12_vc3_S;       //!< LJ force switch repulsion energy constant
+    SimdReal                p12_vc4_S;       //!< LJ force switch repulsion energy constant
+    SimdReal                p6_6cpot_S;      //!< LJ force switch dispersion shift /6
+    SimdReal                p12_12cpot_S;    //!< LJ force switch repulsion shift /12
+
+    SimdReal                lje_c2_S;        //!< LJ-PME: the coefficient squared
+    SimdReal                lje_c6_6_S;      //!< LJ-PME: the coefficient to the sixth power /6
+    SimdReal                lje_vc_S;        //!< LJ-PME: the grid potential shift
+
+    int                     egps_ishift;     //!< Energy groups: bit shift per i-atom
+    int                     egps_jshift;     //!< Energy groups: bit shift per j-atom pair
+    int                     egps_jmask;      //!< Energy groups: mask for a j-atom pair
+    int                     egps_jstride;    //!< Energy groups: stride of the j-group buffers
+};
+
+/*! \brief The data of the current i-cluster
+ *
+ * Contains the i-atom data loaded by the outer loop and
+ * the force and energy accumulators updated by the inner loops.
+ */
+struct nbnxn_kernel_simd_4xn_icluster_t
+{
+    int          ci_sh;                         //!< The cluster index, -1 when shifted
+    int          egp_i;                         //!< The energy group of all i-atoms, -1 when mixed
+    real        *vvdwtp[UNROLLI];               //!< Energy groups: LJ energy buffers
+    real        *vctp[UNROLLI];                 //!< Energy groups: Coulomb energy buffers
+
+    SimdReal     ix_S0, iy_S0, iz_S0;           //!< The coordinates of i-atom 0
+    SimdReal     ix_S1, iy_S1, iz_S1;           //!< The coordinates of i-atom 1
+    SimdReal     ix_S2, iy_S2, iz_S2;           //!< The coordinates of i-atom 2
+    SimdReal     ix_S3, iy_S3, iz_S3;           //!< The coordinates of i-atom 3
+    SimdReal     iq_S0, iq_S1, iq_S2, iq_S3;    //!< The charges times epsfac
+    SimdReal     hsig_i_S0, hsig_i_S1;          //!< LB: half sigma of i-atoms 0 and 1
+    SimdReal     hsig_i_S2, hsig_i_S3;          //!< LB: half sigma of i-atoms 2 and 3
+    SimdReal     seps_i_S0, seps_i_S1;          //!< LB: sqrt(epsilon) of i-atoms 0 and 1
+    SimdReal     seps_i_S2, seps_i_S3;          //!< LB: sqrt(epsilon) of i-atoms 2 and 3
+    SimdReal     c6s_S0, c6s_S1, c6s_S2, c6s_S3;     //!< Geometric: sqrt(C6) of the i-atoms
+    SimdReal     c12s_S0, c12s_S1, c12s_S2, c12s_S3; //!< Geometric: sqrt(C12) of the i-atoms
+    const real  *nbfp0, *nbfp1, *nbfp2, *nbfp3; //!< Full matrix: LJ parameter rows of the i-atoms
+
+    SimdReal     fix_S0, fiy_S0, fiz_S0;        //!< The force on i-atom 0
+    SimdReal     fix_S1, fiy_S1, fiz_S1;        //!< The force on i-atom 1
+    SimdReal     fix_S2, fiy_S2, fiz_S2;        //!< The force on i-atom 2
+    SimdReal     fix_S3, fiy_S3, fiz_S3;        //!< The force on i-atom 3
+    SimdReal     vctot_S;                       //!< The Coulomb energy without energy groups
+    SimdReal     Vvdwtot_S;                     //!< The LJ energy without energy groups
+};
 
-#ifdef CALC_COUL_EWALD
-    SimdReal beta2_S, beta_S;
-#endif
+#include "gromacs/mdlib/nbnxn_kernels/simd_4xn/nbnxn_kernel_simd_4xn_inner.h"
 
-#if defined CALC_ENERGIES && (defined CALC_COUL_EWALD || defined CALC_COUL_TAB)
-    SimdReal  sh_ewald_S;
-#endif
+/* Computes the interactions of the i-cluster with j-cluster entries
+ * cjind0 to cjind1.
+ *
+ * With energy groups, when all i-atoms are in the same energy group,
+ * the j-cluster entries are split in runs of clusters that all
+ * are in the same energy group. Such runs interact through a single
+ * energy group pair, so we accumulate their energies in registers
+ * and add them to the energy buffer once per run.
+ */
+template <int coulombType, int vdwType, int energyOutput,
+          bool checkExcls, bool calcCoulomb, bool halfLJ>
+static inline void
+nbnxn_kernel_simd_4xn_inner_range(const nbnxn_kernel_simd_4xn_params_t &p,
+                                  const nbnxn_cj_t                     *l_cj,
+                                  int                                   cjind0,
+                                  int                                   cjind1,
+                                  nbnxn_kernel_simd_4xn_icluster_t     *icl,
+                                  real                                 *f)
+{
+    if (energyOutput != enrgoutGROUPPAIRS || icl->egp_i < 0)
+    {
+        nbnxn_kernel_simd_4xn_inner<coulombType, vdwType, energyOutput, checkExcls, calcCoulomb, halfLJ>
+            (p, l_cj, cjind0, cjind1, icl, f);
 
-#if defined LJ_CUT && defined CALC_ENERGIES
-    SimdReal   p6_cpot_S, p12_cpot_S;
-#endif
-#ifdef LJ_POT_SWITCH
-    SimdReal   rswitch_S;
-    SimdReal   swV3_S, swV4_S, swV5_S;
-    SimdReal   swF2_S, swF3_S, swF4_S;
-#endif
-#ifdef LJ_FORCE_SWITCH
-    SimdReal   rswitch_S;
-    SimdReal   p6_fc2_S, p6_fc3_S;
-    SimdReal   p12_fc2_S, p12_fc3_S;
-#ifdef CALC_ENERGIES
-    SimdReal   p6_vc3_S, p6_vc4_S;
-    SimdReal   p12_vc3_S, p12_vc4_S;
-    SimdReal   p6_6cpot_S, p12_12cpot_S;
-#endif
-#endif
-#ifdef LJ_EWALD_GEOM
-    real              lj_ewaldcoeff2, lj_ewaldcoeff6_6;
-    SimdReal          mone_S, half_S, lje_c2_S, lje_c6_6_S;
-#endif
+        return;
+    }
 
-#ifdef LJ_COMB_LB
-    const real       *ljc;
+    int cjind = cjind0;
+    while (cjind < cjind1)
+    {
+        int egp_j   = nbnxn_cluster_energygroup(p.nbat, l_cj[cjind].cj, UNROLLJ);
+        int cjindEnd = cjind + 1;
+        while (cjindEnd < cjind1 &&
+               nbnxn_cluster_energygroup(p.nbat, l_cj[cjindEnd].cj, UNROLLJ) == egp_j)
+        {
+            cjindEnd++;
+        }
 
-    SimdReal          hsig_i_S0, seps_i_S0;
-    SimdReal          hsig_i_S1, seps_i_S1;
-    SimdReal          hsig_i_S2, seps_i_S2;
-    SimdReal          hsig_i_S3, seps_i_S3;
-#else
+        if (egp_j >= 0)
+        {
+            /* Accumulate the run of j-clusters in group egp_j in registers */
+            nbnxn_kernel_simd_4xn_inner<coulombType, vdwType, enrgoutSYSTEM, checkExcls, calcCoulomb, halfLJ>
+                (p, l_cj, cjind, cjindEnd, icl, f);
 
-#if defined LJ_COMB_GEOM || defined LJ_EWALD_GEOM
-    const real       *ljc;
-#endif
-#endif /* LJ_COMB_LB */
+            int egp_offset = (egp_j + (egp_j << p.egps_ishift))*p.egps_jstride;
+            if (calcCoulomb)
+            {
+                add_ener_grp_run(&icl->vctot_S, icl->vctp[0] + egp_offset);
+            }
+            add_ener_grp_run(&icl->Vvdwtot_S, icl->vvdwtp[0] + egp_offset);
+        }
+        else
+        {
+            /* The j-clusters contain atoms in multiple energy groups */
+            nbnxn_kernel_simd_4xn_inner<coulombType, vdwType, enrgoutGROUPPAIRS, checkExcls, calcCoulomb, halfLJ>
+                (p, l_cj, cjind, cjindEnd, icl, f);
+        }
 
-    SimdReal  minRsq_S;
-    SimdReal  rc2_S;
-#ifdef VDW_CUTOFF_CHECK
-    SimdReal  rcvdw2_S;
-#endif
+        cjind = cjindEnd;
+    }
+}
 
-    int ninner;
+/* Computes the interactions of the i-cluster with all its j-cluster entries,
+ * using the inner loop variant matching the i-cluster interaction flags.
+ * The leading j-cluster entries that contain exclusions are computed
+ * with exclusion checks, the remaining entries without.
+ */
+template <int coulombType, int vdwType, int energyOutput, bool calcCoulomb, bool halfLJ>
+static inline void
+nbnxn_kernel_simd_4xn_ci(const nbnxn_kernel_simd_4xn_params_t &p,
+                         const nbnxn_cj_t                     *l_cj,
+                         int                                   cjind0,
+                         int                                   cjind1,
+                         nbnxn_kernel_simd_4xn_icluster_t     *icl,
+                         real                                 *f)
+{
+    int cjindExcl = cjind0;
+    while (cjindExcl < cjind1 && l_cj[cjindExcl].excl != NBNXN_INTERACTION_MASK_ALL)
+    {
+        cjindExcl++;
+    }
 
-#ifdef COUNT_PAIRS
-    int npair = 0;
-#endif
+    nbnxn_kernel_simd_4xn_inner_range<coulombType, vdwType, energyOutput, true, calcCoulomb, halfLJ>
+        (p, l_cj, cjind0, cjindExcl, icl, f);
+    nbnxn_kernel_simd_4xn_inner_range<coulombType, vdwType, energyOutput, false, calcCoulomb, halfLJ>
+        (p, l_cj, cjindExcl, cjind1, icl, f);
+}
 
-#if defined LJ_COMB_GEOM || defined LJ_COMB_LB || defined LJ_EWALD_GEOM
-    ljc = nbat->lj_comb;
-#endif
-#if !(defined LJ_COMB_GEOM || defined LJ_COMB_LB || defined FIX_LJ_C)
-    /* No combination rule used */
-    real      *nbfp_ptr    = nbat->nbfp_aligned;
-    const int *type        = nbat->type;
-#endif
+/* The 4xN SIMD kernel outer loop.
+ *
+ * Template parameters:
+ *   coulombType:  one of the coulkt* values
+ *   vdwType:      one of the vdwkt* values
+ *   energyOutput: one of enrgoutNONE, enrgoutSYSTEM, enrgoutGROUPPAIRS
+ *
+ * Vvdw and Vc are only used when energyOutput != enrgoutNONE.
+ * With energy groups they are the SIMD energy group buffers.
+ * We always calculate shift forces, because it's cheap anyhow.
+ */
+template <int coulombType, int vdwType, int energyOutput>
+static void
+nbnxn_kernel_simd_4xn_outer(const nbnxn_pairlist_t     *nbl,
+                            const nbnxn_atomdata_t     *nbat,
+                            const interaction_const_t  *ic,
+                            rvec                       *shift_vec,
+                            real                       *f,
+                            real                       *fshift,
+                            real                       *Vvdw,
+                            real                       *Vc)
+{
+    const bool calcEnergies   = (energyOutput != enrgoutNONE);
+    const bool energyGroups   = (energyOutput == enrgoutGROUPPAIRS);
+    const bool coulRF         = (coulombType == coulktRF);
+    const bool coulTab        = (coulombType == coulktTAB || coulombType == coulktTAB_TWIN);
+    const bool coulEwald      = (coulombType == coulktEWALD || coulombType == coulktEWALD_TWIN);
+    const bool ljCut          = (vdwType == vdwktLJCUT_COMBGEOM || vdwType == vdwktLJCUT_COMBLB ||
+                                 vdwType == vdwktLJCUT_COMBNONE || vdwType == vdwktLJEWALDCOMBGEOM);
+    const bool ljCombGeom     = (vdwType == vdwktLJCUT_COMBGEOM);
+    const bool ljCombLB       = (vdwType == vdwktLJCUT_COMBLB);
+    const bool ljForceSwitch  = (vdwType == vdwktLJFORCESWITCH);
+    const bool ljPotSwitch    = (vdwType == vdwktLJPOTSWITCH);
+    const bool ljEwaldGeom    = (vdwType == vdwktLJEWALDCOMBGEOM);
+
+    nbnxn_kernel_simd_4xn_params_t p;
+
+    p.nbat = nbat;
+    p.x    = nbat->x;
+    p.q    = nbat->q;
+    p.type = nbat->type;
+    p.ljc  = nbat->lj_comb;
+
+    const SimdReal zero_S(0.0);
+    const SimdReal one_S(1.0);
 
     /* Load j-i for the first i */
-    diagonal_jmi_S    = load(nbat->simd_4xn_diagonal_j_minus_i);
+    SimdReal diagonal_jmi_S = load(nbat->simd_4xn_diagonal_j_minus_i);
     /* Generate all the diagonal masks as comparison results */
 #if UNROLLI == UNROLLJ
-    diagonal_mask_S0  = (zero_S < diagonal_jmi_S);
-    diagonal_jmi_S    = diagonal_jmi_S - one_S;
-    diagonal_mask_S1  = (zero_S < diagonal_jmi_S);
-    diagonal_jmi_S    = diagonal_jmi_S - one_S;
-    diagonal_mask_S2  = (zero_S < diagonal_jmi_S);
-    diagonal_jmi_S    = diagonal_jmi_S - one_S;
-    diagonal_mask_S3  = (zero_S < diagonal_jmi_S);
+    p.diagonal_mask_S0  = (zero_S < diagonal_jmi_S);
+    diagonal_jmi_S      = diagonal_jmi_S - one_S;
+    p.diagonal_mask_S1  = (zero_S < diagonal_jmi_S);
+    diagonal_jmi_S      = diagonal_jmi_S - one_S;
+    p.diagonal_mask_S2  = (zero_S < diagonal_jmi_S);
+    diagonal_jmi_S      = diagonal_jmi_S - one_S;
+    p.diagonal_mask_S3  = (zero_S < diagonal_jmi_S);
 #else
 #if UNROLLI == 2*UNROLLJ || 2*UNROLLI == UNROLLJ
-    diagonal_mask0_S0 = (zero_S < diagonal_jmi_S);
-    diagonal_jmi_S    = diagonal_jmi_S - one_S;
-    diagonal_mask0_S1 = (zero_S < diagonal_jmi_S);
-    diagonal_jmi_S    = diagonal_jmi_S - one_S;
-    diagonal_mask0_S2 = (zero_S < diagonal_jmi_S);
-    diagonal_jmi_S    = diagonal_jmi_S - one_S;
-    diagonal_mask0_S3 = (zero_S < diagonal_jmi_S);
-    diagonal_jmi_S    = diagonal_jmi_S - one_S;
+    p.diagonal_mask0_S0 = (zero_S < diagonal_jmi_S);
+    diagonal_jmi_S      = diagonal_jmi_S - one_S;
+    p.diagonal_mask0_S1 = (zero_S < diagonal_jmi_S);
+    diagonal_jmi_S      = diagonal_jmi_S - one_S;
+    p.diagonal_mask0_S2 = (zero_S < diagonal_jmi_S);
+    diagonal_jmi_S      = diagonal_jmi_S - one_S;
+    p.diagonal_mask0_S3 = (zero_S < diagonal_jmi_S);
+    diagonal_jmi_S      = diagonal_jmi_S - one_S;
 
 #if UNROLLI == 2*UNROLLJ
     /* Load j-i for the second half of the j-cluster */
-    diagonal_jmi_S    = load(nbat->simd_4xn_diagonal_j_minus_i + UNROLLJ);
+    diagonal_jmi_S      = load(nbat->simd_4xn_diagonal_j_minus_i + UNROLLJ);
 #endif
 
-    diagonal_mask1_S0 = (zero_S < diagonal_jmi_S);
-    diagonal_jmi_S    = diagonal_jmi_S - one_S;
-    diagonal_mask1_S1 = (zero_S < diagonal_jmi_S);
-    diagonal_jmi_S    = diagonal_jmi_S - one_S;
-    diagonal_mask1_S2 = (zero_S < diagonal_jmi_S);
-    diagonal_jmi_S    = diagonal_jmi_S - one_S;
-    diagonal_mask1_S3 = (zero_S < diagonal_jmi_S);
+    p.diagonal_mask1_S0 = (zero_S < diagonal_jmi_S);
+    diagonal_jmi_S      = diagonal_jmi_S - one_S;
+    p.diagonal_mask1_S1 = (zero_S < diagonal_jmi_S);
+    diagonal_jmi_S      = diagonal_jmi_S - one_S;
+    p.diagonal_mask1_S2 = (zero_S < diagonal_jmi_S);
+    diagonal_jmi_S      = diagonal_jmi_S - one_S;
+    p.diagonal_mask1_S3 = (zero_S < diagonal_jmi_S);
 #endif
 #endif
 
 #if GMX_DOUBLE && !GMX_SIMD_HAVE_INT32_LOGICAL
-    exclusion_filter = nbat->simd_exclusion_filter64;
+    const std::uint64_t *exclusion_filter = nbat->simd_exclusion_filter64;
 #else
-    exclusion_filter = nbat->simd_exclusion_filter;
+    const std::uint32_t *exclusion_filter = nbat->simd_exclusion_filter;
 #endif
 
     /* Here we cast the exclusion filters from unsigned * to int * or real *.
@@ -223,185 +330,158 @@
      * matter, as long as both filter and mask data are treated the same way.
      */
 #if GMX_SIMD_HAVE_INT32_LOGICAL
-    filter_S0 = load(reinterpret_cast<const int *>(exclusion_filter + 0*UNROLLJ));
-    filter_S1 = load(reinterpret_cast<const int *>(exclusion_filter + 1*UNROLLJ));
-    filter_S2 = load(reinterpret_cast<const int *>(exclusion_filter + 2*UNROLLJ));
-    filter_S3 = load(reinterpret_cast<const int *>(exclusion_filter + 3*UNROLLJ));
+    p.filter_S0 = load(reinterpret_cast<const int *>(exclusion_filter + 0*UNROLLJ));
+    p.filter_S1 = load(reinterpret_cast<const int *>(exclusion_filter + 1*UNROLLJ));
+    p.filter_S2 = load(reinterpret_cast<const int *>(exclusion_filter + 2*UNROLLJ));
+    p.filter_S3 = load(reinterpret_cast<const int *>(exclusion_filter + 3*UNROLLJ));
 #else
-    filter_S0 = load(reinterpret_cast<const real *>(exclusion_filter + 0*UNROLLJ));
-    filter_S1 = load(reinterpret_cast<const real *>(exclusion_filter + 1*UNROLLJ));
-    filter_S2 = load(reinterpret_cast<const real *>(exclusion_filter + 2*UNROLLJ));
-    filter_S3 = load(reinterpret_cast<const real *>(exclusion_filter + 3*UNROLLJ));
+    p.filter_S0 = load(reinterpret_cast<const real *>(exclusion_filter + 0*UNROLLJ));
+    p.filter_S1 = load(reinterpret_cast<const real *>(exclusion_filter + 1*UNROLLJ));
+    p.filter_S2 = load(reinterpret_cast<const real *>(exclusion_filter + 2*UNROLLJ));
+    p.filter_S3 = load(reinterpret_cast<const real *>(exclusion_filter + 3*UNROLLJ));
 #endif
 
-#ifdef CALC_COUL_RF
-    /* Reaction-field constants */
-    mrc_3_S  = SimdReal(-2*ic->k_rf);
-#ifdef CALC_ENERGIES
-    hrc_3_S  = SimdReal(ic->k_rf);
-    moh_rc_S = SimdReal(-ic->c_rf);
-#endif
-#endif
-
-#ifdef CALC_COUL_TAB
-
-    invtsp_S  = SimdReal(ic->tabq_scale);
-#ifdef CALC_ENERGIES
-    mhalfsp_S = SimdReal(-0.5/ic->tabq_scale);
-#endif
+    if (coulRF)
+    {
+        /* Reaction-field constants */
+        p.mrc_3_S  = SimdReal(-2*ic->k_rf);
+        p.hrc_3_S  = SimdReal(ic->k_rf);
+        p.moh_rc_S = SimdReal(-ic->c_rf);
+    }
 
+    if (coulTab)
+    {
+        p.invtsp_S  = SimdReal(ic->tabq_scale);
+        p.mhalfsp_S = SimdReal(-0.5/ic->tabq_scale);
 #ifdef TAB_FDV0
-    tab_coul_F = ic->tabq_coul_FDV0;
+        p.tab_coul_F = ic->tabq_coul_FDV0;
+        p.tab_coul_V = nullptr;
 #else
-    tab_coul_F = ic->tabq_coul_F;
-    tab_coul_V = ic->tabq_coul_V;
+        p.tab_coul_F = ic->tabq_coul_F;
+        p.tab_coul_V = ic->tabq_coul_V;
 #endif
-#endif /* CALC_COUL_TAB */
+    }
 
-#ifdef CALC_COUL_EWALD
-    beta2_S = SimdReal(ic->ewaldcoeff_q*ic->ewaldcoeff_q);
-    beta_S  = SimdReal(ic->ewaldcoeff_q);
-#endif
+    if (coulEwald)
+    {
+        p.beta2_S = SimdReal(ic->ewaldcoeff_q*ic->ewaldcoeff_q);
+        p.beta_S  = SimdReal(ic->ewaldcoeff_q);
+    }
 
-#if (defined CALC_COUL_TAB || defined CALC_COUL_EWALD) && defined CALC_ENERGIES
-    sh_ewald_S = SimdReal(ic->sh_ewald);
-#endif
+    if (coulTab || coulEwald)
+    {
+        p.sh_ewald_S = SimdReal(ic->sh_ewald);
+    }
 
     /* LJ function constants */
-#if defined CALC_ENERGIES || defined LJ_POT_SWITCH
-    SimdReal sixth_S(1.0/6.0);
-    SimdReal twelveth_S(1.0/12.0);
-#endif
+    if (ljCut)
+    {
+        /* We shift the potential by cpot, which can be zero */
+        p.p6_cpot_S    = SimdReal(ic->dispersion_shift.cpot);
+        p.p12_cpot_S   = SimdReal(ic->repulsion_shift.cpot);
+    }
+    if (ljPotSwitch)
+    {
+        p.rswitch_S    = SimdReal(ic->rvdw_switch);
+        p.swV3_S       = SimdReal(ic->vdw_switch.c3);
+        p.swV4_S       = SimdReal(ic->vdw_switch.c4);
+        p.swV5_S       = SimdReal(ic->vdw_switch.c5);
+        p.swF2_S       = SimdReal(3*ic->vdw_switch.c3);
+        p.swF3_S       = SimdReal(4*ic->vdw_switch.c4);
+        p.swF4_S       = SimdReal(5*ic->vdw_switch.c5);
+    }
+    if (ljForceSwitch)
+    {
+        const SimdReal mthird_S(-1.0/3.0);
+        const SimdReal mfourth_S(-1.0/4.0);
+
+        p.rswitch_S    = SimdReal(ic->rvdw_switch);
+        p.p6_fc2_S     = SimdReal(ic->dispersion_shift.c2);
+        p.p6_fc3_S     = SimdReal(ic->dispersion_shift.c3);
+        p.p12_fc2_S    = SimdReal(ic->repulsion_shift.c2);
+        p.p12_fc3_S    = SimdReal(ic->repulsion_shift.c3);
+        p.p6_vc3_S     = mthird_S * p.p6_fc2_S;
+        p.p6_vc4_S     = mfourth_S * p.p6_fc3_S;
+        p.p6_6cpot_S   = SimdReal(ic->dispersion_shift.cpot/6);
+        p.p12_vc3_S    = mthird_S * p.p12_fc2_S;
+        p.p12_vc4_S    = mfourth_S * p.p12_fc3_S;
+        p.p12_12cpot_S = SimdReal(ic->repulsion_shift.cpot/12);
+    }
 
-#if defined LJ_CUT && defined CALC_ENERGIES
-    /* We shift the potential by cpot, which can be zero */
-    p6_cpot_S    = SimdReal(ic->dispersion_shift.cpot);
-    p12_cpot_S   = SimdReal(ic->repulsion_shift.cpot);
-#endif
-#ifdef LJ_POT_SWITCH
-    rswitch_S = SimdReal(ic->rvdw_switch);
-    swV3_S    = SimdReal(ic->vdw_switch.c3);
-    swV4_S    = SimdReal(ic->vdw_switch.c4);
-    swV5_S    = SimdReal(ic->vdw_switch.c5);
-    swF2_S    = SimdReal(3*ic->vdw_switch.c3);
-    swF3_S    = SimdReal(4*ic->vdw_switch.c4);
-    swF4_S    = SimdReal(5*ic->vdw_switch.c5);
-#endif
-#ifdef LJ_FORCE_SWITCH
-    rswitch_S = SimdReal(ic->rvdw_switch);
-    p6_fc2_S  = SimdReal(ic->dispersion_shift.c2);
-    p6_fc3_S  = SimdReal(ic->dispersion_shift.c3);
-    p12_fc2_S = SimdReal(ic->repulsion_shift.c2);
-    p12_fc3_S = SimdReal(ic->repulsion_shift.c3);
-#ifdef CALC_ENERGIES
+    real lj_ewaldcoeff6_6 = 0;
+    if (ljEwaldGeom)
     {
-        SimdReal mthird_S(-1.0/3.0);
-        SimdReal mfourth_S(-1.0/4.0);
-
-        p6_vc3_S     = mthird_S * p6_fc2_S;
-        p6_vc4_S     = mfourth_S * p6_fc3_S;
-        p6_6cpot_S   = SimdReal(ic->dispersion_shift.cpot/6);
-        p12_vc3_S    = mthird_S * p12_fc2_S;
-        p12_vc4_S    = mfourth_S * p12_fc3_S;
-        p12_12cpot_S = SimdReal(ic->repulsion_shift.cpot/12);
+        real lj_ewaldcoeff2 = ic->ewaldcoeff_lj*ic->ewaldcoeff_lj;
+        lj_ewaldcoeff6_6    = lj_ewaldcoeff2*lj_ewaldcoeff2*lj_ewaldcoeff2/6;
+        p.lje_c2_S          = SimdReal(lj_ewaldcoeff2);
+        p.lje_c6_6_S        = SimdReal(lj_ewaldcoeff6_6);
+        /* Determine the grid potential at the cut-off */
+        p.lje_vc_S          = SimdReal(ic->sh_lj_ewald);
     }
-#endif
-#endif
-#ifdef LJ_EWALD_GEOM
-    mone_S           = SimdReal(-1.0);
-    half_S           = SimdReal(0.5);
-    lj_ewaldcoeff2   = ic->ewaldcoeff_lj*ic->ewaldcoeff_lj;
-    lj_ewaldcoeff6_6 = lj_ewaldcoeff2*lj_ewaldcoeff2*lj_ewaldcoeff2/6;
-    lje_c2_S         = SimdReal(lj_ewaldcoeff2);
-    lje_c6_6_S       = SimdReal(lj_ewaldcoeff6_6);
-#ifdef CALC_ENERGIES
-    /* Determine the grid potential at the cut-off */
-    SimdReal lje_vc_S(ic->sh_lj_ewald);
-#endif
-#endif
 
     /* The kernel either supports rcoulomb = rvdw or rcoulomb >= rvdw */
-    rc2_S    =  SimdReal(ic->rcoulomb*ic->rcoulomb);
-#ifdef VDW_CUTOFF_CHECK
-    rcvdw2_S =  SimdReal(ic->rvdw*ic->rvdw);
-#endif
+    p.rc2_S    = SimdReal(ic->rcoulomb*ic->rcoulomb);
+    p.rcvdw2_S = SimdReal(ic->rvdw*ic->rvdw);
+    p.minRsq_S = SimdReal(NBNXN_MIN_RSQ);
 
-    minRsq_S            = SimdReal(NBNXN_MIN_RSQ);
+    const real *q        = nbat->q;
+    const real  facel    = ic->epsfac;
+    const real *shiftvec = shift_vec[0];
+    const real *x        = nbat->x;
+    const real *ljc      = nbat->lj_comb;
 
-    q                   = nbat->q;
-    facel               = ic->epsfac;
-    shiftvec            = shift_vec[0];
-    x                   = nbat->x;
-
-#ifdef FIX_LJ_C
-    GMX_ALIGNED(real, GMX_SIMD_REAL_WIDTH)  pvdw_c6[2*UNROLLI*UNROLLJ];
-    real *pvdw_c12 = pvdw_c6 + UNROLLI*UNROLLJ;
+    /* No combination rule used */
+    const real *nbfp_ptr = nbat->nbfp_aligned;
+    const int  *type     = nbat->type;
 
-    for (int jp = 0; jp < UNROLLJ; jp++)
+    int         egps_imask = 0;
+    int         Vstride_i  = 0;
+    if (energyGroups)
     {
-        pvdw_c6 [0*UNROLLJ+jp] = nbat->nbfp[0*2];
-        pvdw_c6 [1*UNROLLJ+jp] = nbat->nbfp[0*2];
-        pvdw_c6 [2*UNROLLJ+jp] = nbat->nbfp[0*2];
-        pvdw_c6 [3*UNROLLJ+jp] = nbat->nbfp[0*2];
-
-        pvdw_c12[0*UNROLLJ+jp] = nbat->nbfp[0*2+1];
-        pvdw_c12[1*UNROLLJ+jp] = nbat->nbfp[0*2+1];
-        pvdw_c12[2*UNROLLJ+jp] = nbat->nbfp[0*2+1];
-        pvdw_c12[3*UNROLLJ+jp] = nbat->nbfp[0*2+1];
+        p.egps_ishift  = nbat->neg_2log;
+        egps_imask     = (1<<p.egps_ishift) - 1;
+        p.egps_jshift  = 2*nbat->neg_2log;
+        p.egps_jmask   = (1<<p.egps_jshift) - 1;
+        p.egps_jstride = (UNROLLJ>>1)*UNROLLJ;
+        /* Major division is over i-particle energy groups, determine the stride */
+        Vstride_i      = nbat->nenergrp*(1<<nbat->neg_2log)*p.egps_jstride;
     }
-    SimdReal c6_S0  = simdLoad(pvdw_c6 +0*UNROLLJ);
-    SimdReal c6_S1  = simdLoad(pvdw_c6 +1*UNROLLJ);
-    SimdReal c6_S2  = simdLoad(pvdw_c6 +2*UNROLLJ);
-    SimdReal c6_S3  = simdLoad(pvdw_c6 +3*UNROLLJ);
-
-    SimdReal c12_S0 = simdLoad(pvdw_c12+0*UNROLLJ);
-    SimdReal c12_S1 = simdLoad(pvdw_c12+1*UNROLLJ);
-    SimdReal c12_S2 = simdLoad(pvdw_c12+2*UNROLLJ);
-    SimdReal c12_S3 = simdLoad(pvdw_c12+3*UNROLLJ);
-#endif /* FIX_LJ_C */
-
-#ifdef ENERGY_GROUPS
-    egps_ishift  = nbat->neg_2log;
-    egps_imask   = (1<<egps_ishift) - 1;
-    egps_jshift  = 2*nbat->neg_2log;
-    egps_jmask   = (1<<egps_jshift) - 1;
-    egps_jstride = (UNROLLJ>>1)*UNROLLJ;
-    /* Major division is over i-particle energy groups, determine the stride */
-    Vstride_i    = nbat->nenergrp*(1<<nbat->neg_2log)*egps_jstride;
-#endif
 
-    l_cj = nbl->cj;
+    const nbnxn_cj_t *l_cj = nbl->cj;
 
-    ninner = 0;
+    nbnxn_kernel_simd_4xn_icluster_t icl;
 
-    for (n = 0; n < nbl->nci; n++)
+    icl.iq_S0 = setZero();
+    icl.iq_S1 = setZero();
+    icl.iq_S2 = setZero();
+    icl.iq_S3 = setZero();
+
+    for (int n = 0; n < nbl->nci; n++)
     {
-        nbln = &nbl->ci[n];
+        const nbnxn_ci_t *nbln = &nbl->ci[n];
+
+        int ish              = (nbln->shift & NBNXN_CI_SHIFT);
+        int ish3             = ish*3;
+        int cjind0           = nbln->cj_ind_start;
+        int cjind1           = nbln->cj_ind_end;
+        int ci               = nbln->ci;
+        int ci_sh            = (ish == CENTRAL ? ci : -1);
 
-        ish              = (nbln->shift & NBNXN_CI_SHIFT);
-        ish3             = ish*3;
-        cjind0           = nbln->cj_ind_start;
-        cjind1           = nbln->cj_ind_end;
-        ci               = nbln->ci;
-        ci_sh            = (ish == CENTRAL ? ci : -1);
+        icl.ci_sh            = ci_sh;
 
-        shX_S = SimdReal(shiftvec[ish3]);
-        shY_S = SimdReal(shiftvec[ish3+1]);
-        shZ_S = SimdReal(shiftvec[ish3+2]);
+        SimdReal shX_S       = SimdReal(shiftvec[ish3]);
+        SimdReal shY_S       = SimdReal(shiftvec[ish3+1]);
+        SimdReal shZ_S       = SimdReal(shiftvec[ish3+2]);
 
 #if UNROLLJ <= 4
-        int sci          = ci*STRIDE;
-        int scix         = sci*DIM;
-#if defined LJ_COMB_LB || defined LJ_COMB_GEOM || defined LJ_EWALD_GEOM
-        int sci2         = sci*2;
-#endif
+        int sci              = ci*STRIDE;
+        int scix             = sci*DIM;
+        int sci2             = sci*2;
 #else
-        int sci          = (ci>>1)*STRIDE;
-        int scix         = sci*DIM + (ci & 1)*(STRIDE>>1);
-#if defined LJ_COMB_LB || defined LJ_COMB_GEOM || defined LJ_EWALD_GEOM
-        int sci2         = sci*2 + (ci & 1)*(STRIDE>>1);
-#endif
-        sci             += (ci & 1)*(STRIDE>>1);
+        int sci              = (ci>>1)*STRIDE;
+        int scix             = sci*DIM + (ci & 1)*(STRIDE>>1);
+        int sci2             = sci*2 + (ci & 1)*(STRIDE>>1);
+        sci                 += (ci & 1)*(STRIDE>>1);
 #endif
 
         /* We have 5 LJ/C combinations, but use only three inner loops,
@@ -410,282 +490,232 @@
          * inner LJ + C      for full-LJ + C
          * inner LJ          for full-LJ + no-C / half-LJ + no-C
          */
-        do_LJ   = (nbln->shift & NBNXN_CI_DO_LJ(0));
-        do_coul = (nbln->shift & NBNXN_CI_DO_COUL(0));
-        half_LJ = ((nbln->shift & NBNXN_CI_HALF_LJ(0)) || !do_LJ) && do_coul;
+        bool do_LJ   = (nbln->shift & NBNXN_CI_DO_LJ(0));
+        bool do_coul = (nbln->shift & NBNXN_CI_DO_COUL(0));
+        bool half_LJ = ((nbln->shift & NBNXN_CI_HALF_LJ(0)) || !do_LJ) && do_coul;
 
-#ifdef ENERGY_GROUPS
-        egps_i = nbat->energrp[ci];
+        int  egps_i  = 0;
+        if (energyGroups)
         {
-            int ia, egp_ia;
-
-            for (ia = 0; ia < UNROLLI; ia++)
+            egps_i = nbat->energrp[ci];
+            for (int ia = 0; ia < UNROLLI; ia++)
             {
-                egp_ia     = (egps_i >> (ia*egps_ishift)) & egps_imask;
-                vvdwtp[ia] = Vvdw + egp_ia*Vstride_i;
-                vctp[ia]   = Vc   + egp_ia*Vstride_i;
+                int egp_ia     = (egps_i >> (ia*p.egps_ishift)) & egps_imask;
+                icl.vvdwtp[ia] = Vvdw + egp_ia*Vstride_i;
+                icl.vctp[ia]   = Vc   + egp_ia*Vstride_i;
             }
+            /* Check if all i-atoms are in the same energy group */
+            icl.egp_i = nbnxn_cluster_energygroup(nbat, ci, UNROLLI);
         }
-#endif
 
-#ifdef CALC_ENERGIES
-#ifdef LJ_EWALD_GEOM
-        gmx_bool do_self = TRUE;
-#else
-        gmx_bool do_self = do_coul;
-#endif
+        if (calcEnergies)
+        {
+            bool do_self = (ljEwaldGeom || do_coul);
 #if UNROLLJ == 4
-        if (do_self && l_cj[nbln->cj_ind_start].cj == ci_sh)
+            if (do_self && l_cj[nbln->cj_ind_start].cj == ci_sh)
 #endif
 #if UNROLLJ == 2
-        if (do_self && l_cj[nbln->cj_ind_start].cj == (ci_sh<<1))
+            if (do_self && l_cj[nbln->cj_ind_start].cj == (ci_sh<<1))
 #endif
 #if UNROLLJ == 8
-        if (do_self && l_cj[nbln->cj_ind_start].cj == (ci_sh>>1))
+            if (do_self && l_cj[nbln->cj_ind_start].cj == (ci_sh>>1))
 #endif
-        {
-            if (do_coul)
             {
-                real Vc_sub_self;
-                int  ia;
-
-#ifdef CALC_COUL_RF
-                Vc_sub_self = 0.5*ic->c_rf;
-#endif
-#ifdef CALC_COUL_TAB
-#ifdef TAB_FDV0
-                Vc_sub_self = 0.5*tab_coul_F[2];
-#else
-                Vc_sub_self = 0.5*tab_coul_V[0];
-#endif
-#endif
-#ifdef CALC_COUL_EWALD
-                /* beta/sqrt(pi) */
-                Vc_sub_self = 0.5*ic->ewaldcoeff_q*M_2_SQRTPI;
-#endif
-
-                for (ia = 0; ia < UNROLLI; ia++)
+                if (do_coul)
                 {
-                    real qi;
-
-                    qi = q[sci+ia];
-#ifdef ENERGY_GROUPS
-                    vctp[ia][((egps_i>>(ia*egps_ishift)) & egps_imask)*egps_jstride]
+                    real Vc_sub_self;
+
+                    if (coulRF)
+                    {
+                        Vc_sub_self = 0.5*ic->c_rf;
+                    }
+                    else if (coulTab)
+                    {
+#ifdef TAB_FDV0
+                        Vc_sub_self = 0.5*p.tab_coul_F[2];
 #else
-                    Vc[0]
-#endif
-                        -= facel*qi*qi*Vc_sub_self;
+                        Vc_sub_self = 0.5*p.tab_coul_V[0];
+#endif
+                    }
+                    else
+                    {
+                        /* beta/sqrt(pi) */
+                        Vc_sub_self = 0.5*ic->ewaldcoeff_q*M_2_SQRTPI;
+                    }
+
+                    for (int ia = 0; ia < UNROLLI; ia++)
+                    {
+                        real  qi = q[sci+ia];
+                        real *Vc_ia;
+                        if (energyGroups)
+                        {
+                            Vc_ia = icl.vctp[ia] + ((egps_i>>(ia*p.egps_ishift)) & egps_imask)*p.egps_jstride;
+                        }
+                        else
+                        {
+                            Vc_ia = Vc;
+                        }
+                        *Vc_ia -= facel*qi*qi*Vc_sub_self;
+                    }
                 }
-            }
 
-#ifdef LJ_EWALD_GEOM
-            {
-                int  ia;
-
-                for (ia = 0; ia < UNROLLI; ia++)
+                if (ljEwaldGeom)
                 {
-                    real c6_i;
-
-                    c6_i = nbat->nbfp[nbat->type[sci+ia]*(nbat->ntype + 1)*2]/6;
-#ifdef ENERGY_GROUPS
-                    vvdwtp[ia][((egps_i>>(ia*egps_ishift)) & egps_imask)*egps_jstride]
-#else
-                    Vvdw[0]
-#endif
-                        += 0.5*c6_i*lj_ewaldcoeff6_6;
+                    for (int ia = 0; ia < UNROLLI; ia++)
+                    {
+                        real  c6_i = nbat->nbfp[nbat->type[sci+ia]*(nbat->ntype + 1)*2]/6;
+                        real *Vvdw_ia;
+                        if (energyGroups)
+                        {
+                            Vvdw_ia = icl.vvdwtp[ia] + ((egps_i>>(ia*p.egps_ishift)) & egps_imask)*p.egps_jstride;
+                        }
+                        else
+                        {
+                            Vvdw_ia = Vvdw;
+                        }
+                        *Vvdw_ia += 0.5*c6_i*lj_ewaldcoeff6_6;
+                    }
                 }
             }
-#endif      /* LJ_EWALD_GEOM */
         }
-#endif
 
         /* Load i atom data */
-        int sciy         = scix + STRIDE;
-        int sciz         = sciy + STRIDE;
-        ix_S0            = SimdReal(x[scix]) + shX_S;
-        ix_S1            = SimdReal(x[scix+1]) + shX_S;
-        ix_S2            = SimdReal(x[scix+2]) + shX_S;
-        ix_S3            = SimdReal(x[scix+3]) + shX_S;
-        iy_S0            = SimdReal(x[sciy]) + shY_S;
-        iy_S1            = SimdReal(x[sciy+1]) + shY_S;
-        iy_S2            = SimdReal(x[sciy+2]) + shY_S;
-        iy_S3            = SimdReal(x[sciy+3]) + shY_S;
-        iz_S0            = SimdReal(x[sciz]) + shZ_S;
-        iz_S1            = SimdReal(x[sciz+1]) + shZ_S;
-        iz_S2            = SimdReal(x[sciz+2]) + shZ_S;
-        iz_S3            = SimdReal(x[sciz+3]) + shZ_S;
+        int sciy             = scix + STRIDE;
+        int sciz             = sciy + STRIDE;
+        icl.ix_S0            = SimdReal(x[scix]) + shX_S;
+        icl.ix_S1            = SimdReal(x[scix+1]) + shX_S;
+        icl.ix_S2            = SimdReal(x[scix+2]) + shX_S;
+        icl.ix_S3            = SimdReal(x[scix+3]) + shX_S;
+        icl.iy_S0            = SimdReal(x[sciy]) + shY_S;
+        icl.iy_S1            = SimdReal(x[sciy+1]) + shY_S;
+        icl.iy_S2            = SimdReal(x[sciy+2]) + shY_S;
+        icl.iy_S3            = SimdReal(x[sciy+3]) + shY_S;
+        icl.iz_S0            = SimdReal(x[sciz]) + shZ_S;
+        icl.iz_S1            = SimdReal(x[sciz+1]) + shZ_S;
+        icl.iz_S2            = SimdReal(x[sciz+2]) + shZ_S;
+        icl.iz_S3            = SimdReal(x[sciz+3]) + shZ_S;
 
         if (do_coul)
         {
-            iq_S0      = SimdReal(facel*q[sci]);
-            iq_S1      = SimdReal(facel*q[sci+1]);
-            iq_S2      = SimdReal(facel*q[sci+2]);
-            iq_S3      = SimdReal(facel*q[sci+3]);
+            icl.iq_S0        = SimdReal(facel*q[sci]);
+            icl.iq_S1        = SimdReal(facel*q[sci+1]);
+            icl.iq_S2        = SimdReal(facel*q[sci+2]);
+            icl.iq_S3        = SimdReal(facel*q[sci+3]);
         }
 
-#ifdef LJ_COMB_LB
-        hsig_i_S0      = SimdReal(ljc[sci2+0]);
-        hsig_i_S1      = SimdReal(ljc[sci2+1]);
-        hsig_i_S2      = SimdReal(ljc[sci2+2]);
-        hsig_i_S3      = SimdReal(ljc[sci2+3]);
-        seps_i_S0      = SimdReal(ljc[sci2+STRIDE+0]);
-        seps_i_S1      = SimdReal(ljc[sci2+STRIDE+1]);
-        seps_i_S2      = SimdReal(ljc[sci2+STRIDE+2]);
-        seps_i_S3      = SimdReal(ljc[sci2+STRIDE+3]);
-#else
-#ifdef LJ_COMB_GEOM
-        SimdReal c6s_S0 = SimdReal(ljc[sci2+0]);
-        SimdReal c6s_S1 = SimdReal(ljc[sci2+1]);
-        SimdReal c6s_S2, c6s_S3;
-        if (!half_LJ)
+        if (ljCombLB)
         {
-            c6s_S2     = SimdReal(ljc[sci2+2]);
-            c6s_S3     = SimdReal(ljc[sci2+3]);
+            icl.hsig_i_S0    = SimdReal(ljc[sci2+0]);
+            icl.hsig_i_S1    = SimdReal(ljc[sci2+1]);
+            icl.hsig_i_S2    = SimdReal(ljc[sci2+2]);
+            icl.hsig_i_S3    = SimdReal(ljc[sci2+3]);
+            icl.seps_i_S0    = SimdReal(ljc[sci2+STRIDE+0]);
+            icl.seps_i_S1    = SimdReal(ljc[sci2+STRIDE+1]);
+            icl.seps_i_S2    = SimdReal(ljc[sci2+STRIDE+2]);
+            icl.seps_i_S3    = SimdReal(ljc[sci2+STRIDE+3]);
         }
-        else
+        else if (ljCombGeom)
         {
-            c6s_S2     = setZero();
-            c6s_S3     = setZero();
-        }
-        SimdReal c12s_S0 = SimdReal(ljc[sci2+STRIDE+0]);
-        SimdReal c12s_S1 = SimdReal(ljc[sci2+STRIDE+1]);
-        SimdReal c12s_S2, c12s_S3;
-        if (!half_LJ)
-        {
-            c12s_S2    = SimdReal(ljc[sci2+STRIDE+2]);
-            c12s_S3    = SimdReal(ljc[sci2+STRIDE+3]);
+            icl.c6s_S0       = SimdReal(ljc[sci2+0]);
+            icl.c6s_S1       = SimdReal(ljc[sci2+1]);
+            icl.c12s_S0      = SimdReal(ljc[sci2+STRIDE+0]);
+            icl.c12s_S1      = SimdReal(ljc[sci2+STRIDE+1]);
+            if (!half_LJ)
+            {
+                icl.c6s_S2   = SimdReal(ljc[sci2+2]);
+                icl.c6s_S3   = SimdReal(ljc[sci2+3]);
+                icl.c12s_S2  = SimdReal(ljc[sci2+STRIDE+2]);
+                icl.c12s_S3  = SimdReal(ljc[sci2+STRIDE+3]);
+            }
+            else
+            {
+                icl.c6s_S2   = setZero();
+                icl.c6s_S3   = setZero();
+                icl.c12s_S2  = setZero();
+                icl.c12s_S3  = setZero();
+            }
         }
         else
         {
-            c12s_S2    = setZero();
-            c12s_S3    = setZero();
-        }
-#else
-        const real *nbfp0     = nbfp_ptr + type[sci  ]*nbat->ntype*c_simdBestPairAlignment;
-        const real *nbfp1     = nbfp_ptr + type[sci+1]*nbat->ntype*c_simdBestPairAlignment;
-        const real *nbfp2     = nullptr, *nbfp3 = nullptr;
-        if (!half_LJ)
-        {
-            nbfp2 = nbfp_ptr + type[sci+2]*nbat->ntype*c_simdBestPairAlignment;
-            nbfp3 = nbfp_ptr + type[sci+3]*nbat->ntype*c_simdBestPairAlignment;
+            icl.nbfp0        = nbfp_ptr + type[sci  ]*nbat->ntype*c_simdBestPairAlignment;
+            icl.nbfp1        = nbfp_ptr + type[sci+1]*nbat->ntype*c_simdBestPairAlignment;
+            icl.nbfp2        = nullptr;
+            icl.nbfp3        = nullptr;
+            if (!half_LJ)
+            {
+                icl.nbfp2    = nbfp_ptr + type[sci+2]*nbat->ntype*c_simdBestPairAlignment;
+                icl.nbfp3    = nbfp_ptr + type[sci+3]*nbat->ntype*c_simdBestPairAlignment;
+            }
         }
-#endif
-#endif
-#ifdef LJ_EWALD_GEOM
-        /* We need the geometrically combined C6 for the PME grid correction */
-        SimdReal c6s_S0 = SimdReal(ljc[sci2+0]);
-        SimdReal c6s_S1 = SimdReal(ljc[sci2+1]);
-        SimdReal c6s_S2, c6s_S3;
-        if (!half_LJ)
+        if (ljEwaldGeom)
         {
-            c6s_S2 = SimdReal(ljc[sci2+2]);
-            c6s_S3 = SimdReal(ljc[sci2+3]);
+            /* We need the geometrically combined C6 for the PME grid correction */
+            icl.c6s_S0       = SimdReal(ljc[sci2+0]);
+            icl.c6s_S1       = SimdReal(ljc[sci2+1]);
+            if (!half_LJ)
+            {
+                icl.c6s_S2   = SimdReal(ljc[sci2+2]);
+                icl.c6s_S3   = SimdReal(ljc[sci2+3]);
+            }
         }
-#endif
 
         /* Zero the potential energy for this list */
-#ifdef CALC_ENERGIES
-        SimdReal Vvdwtot_S = setZero();
-        SimdReal vctot_S   = setZero();
-#endif
+        icl.Vvdwtot_S        = setZero();
+        icl.vctot_S          = setZero();
 
         /* Clear i atom forces */
-        fix_S0           = setZero();
-        fix_S1           = setZero();
-        fix_S2           = setZero();
-        fix_S3           = setZero();
-        fiy_S0           = setZero();
-        fiy_S1           = setZero();
-        fiy_S2           = setZero();
-        fiy_S3           = setZero();
-        fiz_S0           = setZero();
-        fiz_S1           = setZero();
-        fiz_S2           = setZero();
-        fiz_S3           = setZero();
-
-        cjind = cjind0;
+        icl.fix_S0           = setZero();
+        icl.fix_S1           = setZero();
+        icl.fix_S2           = setZero();
+        icl.fix_S3           = setZero();
+        icl.fiy_S0           = setZero();
+        icl.fiy_S1           = setZero();
+        icl.fiy_S2           = setZero();
+        icl.fiy_S3           = setZero();
+        icl.fiz_S0           = setZero();
+        icl.fiz_S1           = setZero();
+        icl.fiz_S2           = setZero();
+        icl.fiz_S3           = setZero();
 
         /* Currently all kernels use (at least half) LJ */
-#define CALC_LJ
         if (half_LJ)
         {
             /* Coulomb: all i-atoms, LJ: first half i-atoms */
-#define CALC_COULOMB
-#define HALF_LJ
-#define CHECK_EXCLS
-            while (cjind < cjind1 && nbl->cj[cjind].excl != NBNXN_INTERACTION_MASK_ALL)
-            {
-#include "gromacs/mdlib/nbnxn_kernels/simd_4xn/nbnxn_kernel_simd_4xn_inner.h"
-                cjind++;
-            }
-#undef CHECK_EXCLS
-            for (; (cjind < cjind1); cjind++)
-            {
-#include "gromacs/mdlib/nbnxn_kernels/simd_4xn/nbnxn_kernel_simd_4xn_inner.h"
-            }
-#undef HALF_LJ
-#undef CALC_COULOMB
+            nbnxn_kernel_simd_4xn_ci<coulombType, vdwType, energyOutput, true, true>
+                (p, l_cj, cjind0, cjind1, &icl, f);
         }
         else if (do_coul)
         {
             /* Coulomb: all i-atoms, LJ: all i-atoms */
-#define CALC_COULOMB
-#define CHECK_EXCLS
-            while (cjind < cjind1 && nbl->cj[cjind].excl != NBNXN_INTERACTION_MASK_ALL)
-            {
-#include "gromacs/mdlib/nbnxn_kernels/simd_4xn/nbnxn_kernel_simd_4xn_inner.h"
-                cjind++;
-            }
-#undef CHECK_EXCLS
-            for (; (cjind < cjind1); cjind++)
-            {
-#include "gromacs/mdlib/nbnxn_kernels/simd_4xn/nbnxn_kernel_simd_4xn_inner.h"
-            }
-#undef CALC_COULOMB
+            nbnxn_kernel_simd_4xn_ci<coulombType, vdwType, energyOutput, true, false>
+                (p, l_cj, cjind0, cjind1, &icl, f);
         }
         else
         {
             /* Coulomb: none, LJ: all i-atoms */
-#define CHECK_EXCLS
-            while (cjind < cjind1 && nbl->cj[cjind].excl != NBNXN_INTERACTION_MASK_ALL)
-            {
-#include "gromacs/mdlib/nbnxn_kernels/simd_4xn/nbnxn_kernel_simd_4xn_inner.h"
-                cjind++;
-            }
-#undef CHECK_EXCLS
-            for (; (cjind < cjind1); cjind++)
-            {
-#include "gromacs/mdlib/nbnxn_kernels/simd_4xn/nbnxn_kernel_simd_4xn_inner.h"
-            }
+            nbnxn_kernel_simd_4xn_ci<coulombType, vdwType, energyOutput, false, false>
+                (p, l_cj, cjind0, cjind1, &icl, f);
         }
-#undef CALC_LJ
-        ninner += cjind1 - cjind0;
 
         /* Add accumulated i-forces to the force array */
-        real fShiftX = reduceIncr4ReturnSum(f+scix, fix_S0, fix_S1, fix_S2, fix_S3);
-        real fShiftY = reduceIncr4ReturnSum(f+sciy, fiy_S0, fiy_S1, fiy_S2, fiy_S3);
-        real fShiftZ = reduceIncr4ReturnSum(f+sciz, fiz_S0, fiz_S1, fiz_S2, fiz_S3);
-
+        real fShiftX = reduceIncr4ReturnSum(f+scix, icl.fix_S0, icl.fix_S1, icl.fix_S2, icl.fix_S3);
+        real fShiftY = reduceIncr4ReturnSum(f+sciy, icl.fiy_S0, icl.fiy_S1, icl.fiy_S2, icl.fiy_S3);
+        real fShiftZ = reduceIncr4ReturnSum(f+sciz, icl.fiz_S0, icl.fiz_S1, icl.fiz_S2, icl.fiz_S3);
 
-#ifdef CALC_SHIFTFORCES
         fshift[ish3+0] += fShiftX;
         fshift[ish3+1] += fShiftY;
         fshift[ish3+2] += fShiftZ;
-#endif
 
-#ifdef CALC_ENERGIES
-        if (do_coul)
+        if (calcEnergies && !energyGroups)
         {
-            *Vc += reduce(vctot_S);
-        }
+            if (do_coul)
+            {
+                *Vc += reduce(icl.vctot_S);
+            }
 
-        *Vvdw += reduce(Vvdwtot_S);
-#endif
+            *Vvdw += reduce(icl.Vvdwtot_S);
+        }
 
         /* Outer loop uses 6 flops/iteration */
     }
-
-#ifdef COUNT_PAIRS
-    printf("atom pairs %d\n", npair);
-#endif
 }
@@ -74,6 +74,19 @@ typedef struct {
     int dummy[16];
 } gmx_cache_protect_t;
 
+/* The parameters for the (dual) pair-list setup.
+ * With dynamic pruning an outer list is generated with cut-off rlistOuter
+ * every nstlist steps and this list is pruned to an inner list with
+ * cut-off rlistInner every nstlistPrune steps. Without dynamic pruning
+ * rlistInner=rlistOuter and only a single list is used.
+ */
+typedef struct NbnxnListParameters {
+    real     rlistOuter;        /* Cut-off of the rarely updated, outer pair-list */
+    real     rlistInner;        /* Cut-off of the dynamically pruned, inner list   */
+    gmx_bool useDynamicPruning; /* Are we using dynamic pair-list pruning          */
+    int      nstlistPrune;      /* Pair-list dynamic pruning interval              */
+} NbnxnListParameters;
+
 /* Abstract type for pair searching data */
 typedef struct nbnxn_search * nbnxn_search_t;
 
@@ -170,6 +183,16 @@ typedef struct nbnxn_pairlist_t {
     int                     cj_nalloc;   /* The allocation size of cj                */
     int                     ncjInUse;    /* The number of j-clusters that are used by ci entries in this list, will be <= ncj */
 
+    /* With dynamic pruning the lists above are the pruned, inner lists
+     * and the lists below are the outer lists generated by the search.
+     */
+    int                     nciOuter;       /* The number of i-clusters in the outer list, -1 when invalid */
+    nbnxn_ci_t             *ciOuter;        /* The outer, unpruned i-cluster list, size nciOuter */
+    int                     ciOuter_nalloc; /* The allocation size of ciOuter                */
+    int                     ncjOuter;       /* The number of j-clusters in the outer list    */
+    nbnxn_cj_t             *cjOuter;        /* The outer, unpruned j-cluster list            */
+    int                     cjOuter_nalloc; /* The allocation size of cjOuter                */
+
     int                     ncj4;        /* The total number of 4*j clusters         */
     nbnxn_cj4_t            *cj4;         /* The 4*j cluster list, size ncj4          */
     int                     cj4_nalloc;  /* The allocation size of cj4               */
@@ -194,6 +217,7 @@ typedef struct {
     int                natpair_lj;  /* Total number of atom pairs for LJ kernel   */
     int                natpair_q;   /* Total number of atom pairs for Q kernel    */
     t_nblist         **nbl_fep;
+    gmx_int64_t        outerListCreationStep; /* Step at which the outer list was created */
 } nbnxn_pairlist_set_t;
 
 enum {
@@ -324,6 +324,14 @@ void nbnxn_init_search(nbnxn_search_t           * nbs_ptr,
     nbs->a           = nullptr;
     nbs->a_nalloc    = 0;
 
+    /* Without domain decomposition the local atoms never change,
+     * so we can update the grid using the previous atom order.
+     */
+    nbs->bUpdateGrid   = (!nbs->DomDec &&
+                          getenv("GMX_NBNXN_NO_GRID_UPDATE") == nullptr);
+    nbs->a_prev        = nullptr;
+    nbs->a_prev_nalloc = 0;
+
     nbs->nthread_max = nthread_max;
 
     /* Initialize the work data structures for each thread */
@@ -334,6 +342,9 @@ void nbnxn_init_search(nbnxn_search_t           * nbs_ptr,
         nbs->work[t].cxy_na_nalloc    = 0;
         nbs->work[t].sort_work        = nullptr;
         nbs->work[t].sort_work_nalloc = 0;
+        nbs->work[t].moved            = nullptr;
+        nbs->work[t].nmoved           = 0;
+        nbs->work[t].moved_nalloc     = 0;
 
         snew(nbs->work[t].nbl_fep, 1);
         nbnxn_init_pairlist_fep(nbs->work[t].nbl_fep);
@@ -824,6 +835,12 @@ static void nbnxn_init_pairlist(nbnxn_pairlist_t *nbl,
     nbl->ncjInUse    = 0;
     nbl->cj          = nullptr;
     nbl->cj_nalloc   = 0;
+    nbl->nciOuter       = -1;
+    nbl->ciOuter        = nullptr;
+    nbl->ciOuter_nalloc = 0;
+    nbl->ncjOuter       = 0;
+    nbl->cjOuter        = nullptr;
+    nbl->cjOuter_nalloc = 0;
     nbl->ncj4        = 0;
     /* We need one element extra in sj, so alloc initially with 1 */
     nbl->cj4_nalloc  = 0;
@@ -897,6 +914,7 @@ void nbnxn_init_pairlist_set(nbnxn_pairlist_set_t *nbl_list,
         snew(nbl_list->nbl_work, nbl_list->nnbl);
     }
     snew(nbl_list->nbl_fep, nbl_list->nnbl);
+    nbl_list->outerListCreationStep = -1;
     /* Execute in order to avoid memory interleaving between threads */
 #pragma omp parallel for num_threads(nbl_list->nnbl) schedule(static)
     for (int i = 0; i < nbl_list->nnbl; i++)
@@ -2208,8 +2226,74 @@ static void sort_cj_excl(nbnxn_cj_t *cj, int ncj,
     }
 }
 
+/* Sort the exclusion-free part of the simple j-list cj on the energy
+ * group of the j-clusters, j-clusters with atoms in multiple energy groups
+ * are put last. Should be called after sort_cj_excl.
+ * This gives runs of j-clusters that interact with a uniform i-cluster
+ * through a single energy group pair, for which the energy group kernels
+ * can accumulate the energies in registers.
+ * The sort is stable, so the spatial ordering within each group is kept.
+ */
+static void sort_cj_energygroup(const nbnxn_atomdata_t *nbat, int na_cj,
+                                nbnxn_cj_t *cj, int ncj,
+                                nbnxn_list_work_t *work)
+{
+    /* The energy group count per group, the last entry for mixed clusters */
+    int count[64 + 1];
+    int nkey, jstart, egp;
+
+    /* The entries with exclusions are at the start and should stay there */
+    jstart = 0;
+    while (jstart < ncj && cj[jstart].excl != NBNXN_INTERACTION_MASK_ALL)
+    {
+        jstart++;
+    }
+    if (ncj - jstart <= 1)
+    {
+        return;
+    }
+
+    /* Counting sort with key nenergrp for mixed j-clusters */
+    nkey = nbat->nenergrp + 1;
+    for (int k = 0; k < nkey; k++)
+    {
+        count[k] = 0;
+    }
+    for (int j = jstart; j < ncj; j++)
+    {
+        egp = nbnxn_cluster_energygroup(nbat, cj[j].cj, na_cj);
+        count[egp >= 0 ? egp : nbat->nenergrp]++;
+    }
+    for (int k = 0; k < nkey; k++)
+    {
+        if (count[k] == ncj - jstart)
+        {
+            /* All j-clusters have the same key, the order is correct */
+            return;
+        }
+    }
+    /* Convert the counts to start indices in work->cj */
+    int offset = 0;
+    for (int k = 0; k < nkey; k++)
+    {
+        int n    = count[k];
+        count[k] = offset;
+        offset  += n;
+    }
+    for (int j = jstart; j < ncj; j++)
+    {
+        egp = nbnxn_cluster_energygroup(nbat, cj[j].cj, na_cj);
+        work->cj[count[egp >= 0 ? egp : nbat->nenergrp]++] = cj[j];
+    }
+    for (int j = jstart; j < ncj; j++)
+    {
+        cj[j] = work->cj[j - jstart];
+    }
+}
+
 /* Close this simple list i entry */
-static void close_ci_entry_simple(nbnxn_pairlist_t *nbl)
+static void close_ci_entry_simple(const nbnxn_atomdata_t *nbat,
+                                  nbnxn_pairlist_t       *nbl)
 {
     int jlen;
 
@@ -2221,6 +2305,13 @@ static void close_ci_entry_simple(nbnxn_pairlist_t *nbl)
     {
         sort_cj_excl(nbl->cj+nbl->ci[nbl->nci].cj_ind_start, jlen, nbl->work);
 
+        if (nbat->nenergrp > 1)
+        {
+            sort_cj_energygroup(nbat, nbl->na_cj,
+                                nbl->cj+nbl->ci[nbl->nci].cj_ind_start, jlen,
+                                nbl->work);
+        }
+
         /* The counts below are used for non-bonded pair/flop counts
          * and should therefore match the available kernel setups.
          */
@@ -3721,7 +3812,7 @@ static void nbnxn_make_pairlist_part(const nbnxn_search_t nbs,
                     /* Close this ci list */
                     if (nbl->bSimple)
                     {
-                        close_ci_entry_simple(nbl);
+                        close_ci_entry_simple(nbat, nbl);
                     }
                     else
                     {
@@ -4073,17 +4164,48 @@ static void sort_sci(nbnxn_pairlist_t *nbl)
     nbl->sci       = sci_sort;
 }
 
+/* Turns the freshly generated list into the outer list for dynamic pruning.
+ * The search output is moved to the outer list by swapping pointers
+ * and the inner list storage is (re)allocated to be able to hold
+ * the complete outer list, so the prune kernels never need to allocate.
+ */
+static void prepareListsForDynamicPruning(nbnxn_pairlist_t *nbl)
+{
+    std::swap(nbl->ci, nbl->ciOuter);
+    std::swap(nbl->ci_nalloc, nbl->ciOuter_nalloc);
+    std::swap(nbl->cj, nbl->cjOuter);
+    std::swap(nbl->cj_nalloc, nbl->cjOuter_nalloc);
+
+    nbl->nciOuter = nbl->nci;
+    nbl->ncjOuter = nbl->ncj;
+
+    /* The i- and j-lists are empty until they get pruned */
+    nbl->nci      = 0;
+    nbl->ncj      = 0;
+    nbl->ncjInUse = 0;
+
+    if (nbl->nciOuter > nbl->ci_nalloc)
+    {
+        nb_realloc_ci(nbl, nbl->nciOuter);
+    }
+    check_cell_list_space_simple(nbl, nbl->ncjOuter);
+}
+
 /* Make a local or non-local pair-list, depending on iloc */
-void nbnxn_make_pairlist(const nbnxn_search_t  nbs,
-                         nbnxn_atomdata_t     *nbat,
-                         const t_blocka       *excl,
-                         real                  rlist,
-                         int                   min_ci_balanced,
-                         nbnxn_pairlist_set_t *nbl_list,
-                         int                   iloc,
-                         int                   nb_kernel_type,
-                         t_nrnb               *nrnb)
+void nbnxn_make_pairlist(const nbnxn_search_t       nbs,
+                         nbnxn_atomdata_t          *nbat,
+                         const t_blocka            *excl,
+                         const NbnxnListParameters *listParams,
+                         int                        min_ci_balanced,
+                         nbnxn_pairlist_set_t      *nbl_list,
+                         int                        iloc,
+                         int                        nb_kernel_type,
+                         gmx_int64_t                step,
+                         t_nrnb                    *nrnb)
 {
+    /* The search generates the (outer) list with the largest cut-off */
+    const real         rlist = listParams->rlistOuter;
+
     nbnxn_grid_t      *gridi, *gridj;
     gmx_bool           bGPUCPU;
     int                nzi, zj0, zj1;
@@ -4384,4 +4506,18 @@ void nbnxn_make_pairlist(const nbnxn_search_t  nbs,
             print_reduction_cost(&nbat->buffer_flags, nbl_list->nnbl);
         }
     }
+
+    nbl_list->outerListCreationStep = step;
+
+    if (nbl_list->bSimple && listParams->useDynamicPruning)
+    {
+        /* The inner lists are generated from the outer lists
+         * by the prune kernel, which is called before the first
+         * non-bonded kernel call on this step.
+         */
+        for (int th = 0; th < nbl_list->nnbl; th++)
+        {
+            prepareListsForDynamicPruning(nbl_list->nbl[th]);
+        }
+    }
 }
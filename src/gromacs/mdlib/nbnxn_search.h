@@ -66,21 +66,24 @@ void nbnxn_init_pairlist_set(nbnxn_pairlist_set_t *nbl_list,
                              nbnxn_alloc_t *alloc,
                              nbnxn_free_t  *free);
 
-/* Make a apir-list with radius rlist, store it in nbl.
+/* Make a pair-list with radius listParams->rlistOuter, store it in nbl.
  * The parameter min_ci_balanced sets the minimum required
  * number or roughly equally sized ci blocks in nbl.
  * When set >0 ci lists will be chopped up when the estimate
  * for the number of equally sized lists is below min_ci_balanced.
  * With perturbed particles, also a group scheme style nbl_fep list is made.
+ * With dynamic pruning of simple lists, the result is stored as
+ * the outer list and the inner list is left empty until it is pruned.
  */
-void nbnxn_make_pairlist(const nbnxn_search_t  nbs,
-                         nbnxn_atomdata_t     *nbat,
-                         const t_blocka       *excl,
-                         real                  rlist,
-                         int                   min_ci_balanced,
-                         nbnxn_pairlist_set_t *nbl_list,
-                         int                   iloc,
-                         int                   nb_kernel_type,
-                         t_nrnb               *nrnb);
+void nbnxn_make_pairlist(const nbnxn_search_t       nbs,
+                         nbnxn_atomdata_t          *nbat,
+                         const t_blocka            *excl,
+                         const NbnxnListParameters *listParams,
+                         int                        min_ci_balanced,
+                         nbnxn_pairlist_set_t      *nbl_list,
+                         int                        iloc,
+                         int                        nb_kernel_type,
+                         gmx_int64_t                step,
+                         t_nrnb                    *nrnb);
 
 #endif
@@ -0,0 +1,478 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2017, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \internal \file
+ *
+ * \brief Implements functions for tuning the nbnxn pair-list setup
+ * and the CPU kernel cluster layout.
+ *
+ * \ingroup module_mdlib
+ */
+
+#include "gmxpre.h"
+
+#include "nbnxn_tuning.h"
+
+#include <stdlib.h>
+
+#include <cmath>
+
+#include <algorithm>
+
+#include "gromacs/gmxlib/network.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/mdlib/calc_verletbuf.h"
+#include "gromacs/mdlib/forcerec.h"
+#include "gromacs/mdlib/nb_verlet.h"
+#include "gromacs/mdlib/nbnxn_atomdata.h"
+#include "gromacs/mdlib/nbnxn_search.h"
+#include "gromacs/mdlib/nbnxn_simd.h"
+#include "gromacs/mdlib/nbnxn_util.h"
+#include "gromacs/mdtypes/commrec.h"
+#include "gromacs/mdtypes/forcerec.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/mdtypes/interaction_const.h"
+#include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/topology/topology.h"
+#include "gromacs/utility/cstringutil.h"
+#include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/smalloc.h"
+
+/*! \brief The cost of the prune kernel per cluster pair relative to the force kernel
+ *
+ * The prune kernel only computes distances, which is roughly a factor 6
+ * cheaper per cluster pair than the force-only non-bonded kernels.
+ */
+static const real c_nbnxnPruneKernelRelativeCost = 0.15;
+
+/*! \brief The minimum relative kernel cost reduction required to use pruning */
+static const real c_nbnxnPruneMinimumGain = 0.03;
+
+/*! \brief The largest pruning interval we consider */
+static const int  c_nbnxnPruneMaxInterval = 20;
+
+gmx_bool nbnxnDynamicPruningIsSupported(const t_inputrec *ir,
+                                        gmx_bool          useGpu)
+{
+    /* With GPUs the outer list is only pruned on the GPU, which
+     * is not supported. GPU emulation uses the GPU list layout.
+     */
+    if (useGpu || getenv("GMX_EMULATE_GPU") != nullptr)
+    {
+        return FALSE;
+    }
+
+    /* We need dynamics and the Verlet buffer tolerance to determine
+     * the inner list buffer, for NVE the buffer is not updated.
+     */
+    if (!EI_DYNAMICS(ir->eI) || ir->verletbuf_tol <= 0 ||
+        (EI_MD(ir->eI) && ir->etc == etcNO))
+    {
+        return FALSE;
+    }
+
+    return (getenv("GMX_DISABLE_DYNAMICPRUNING") == nullptr);
+}
+
+void setupDynamicPairlistPruning(FILE                      *fplog,
+                                 const t_inputrec          *ir,
+                                 const gmx_mtop_t          *mtop,
+                                 matrix                     box,
+                                 gmx_bool                   useSimpleLists,
+                                 const interaction_const_t *ic,
+                                 NbnxnListParameters       *listParams)
+{
+    /* By default we use a single list, i.e. no pruning */
+    listParams->rlistOuter        = ic->rlist;
+    listParams->rlistInner        = ic->rlist;
+    listParams->useDynamicPruning = FALSE;
+    listParams->nstlistPrune      = ir->nstlist;
+
+    if (!useSimpleLists || ir->nstlist <= 2 ||
+        !nbnxnDynamicPruningIsSupported(ir, FALSE))
+    {
+        return;
+    }
+
+    verletbuf_list_setup_t ls;
+    verletbuf_get_list_setup(TRUE, FALSE, &ls);
+
+    /* The effective list radius increase due to the cluster setup */
+    const real rlistInc   = nbnxn_get_rlist_effective_inc(ls.cluster_size_j,
+                                                          mtop->natoms/det(box));
+    /* The kernel cost is proportional to the effective list volume */
+    const real costOuter  = gmx::power3(listParams->rlistOuter + rlistInc);
+
+    int        nstlistPrune;
+    real       rlistInner = listParams->rlistOuter;
+
+    const char *env       = getenv("GMX_NSTLIST_DYNAMICPRUNING");
+    if (env != nullptr)
+    {
+        char *end;
+
+        nstlistPrune = strtol(env, &end, 10);
+        if (!end || (*end != 0) || nstlistPrune < 1)
+        {
+            gmx_fatal(FARGS, "Invalid value passed in GMX_NSTLIST_DYNAMICPRUNING=%s, positive integer required", env);
+        }
+        if (nstlistPrune >= ir->nstlist)
+        {
+            /* Pruning at or beyond the list update interval is useless */
+            return;
+        }
+        calc_verlet_buffer_size(mtop, det(box), ir, nstlistPrune, -1, &ls,
+                                nullptr, &rlistInner);
+    }
+    else
+    {
+        /* Determine the pruning interval that minimizes the estimated
+         * cost of the force plus prune kernels per step.
+         */
+        real costMin = costOuter*(1 - c_nbnxnPruneMinimumGain);
+
+        nstlistPrune = -1;
+        for (int nstPrune = 2; nstPrune < std::min(ir->nstlist, c_nbnxnPruneMaxInterval + 1); nstPrune++)
+        {
+            real rlist;
+
+            calc_verlet_buffer_size(mtop, det(box), ir, nstPrune, -1, &ls,
+                                    nullptr, &rlist);
+            rlist     = std::min(rlist, listParams->rlistOuter);
+
+            real cost = gmx::power3(rlist + rlistInc) +
+                c_nbnxnPruneKernelRelativeCost*costOuter/nstPrune;
+
+            if (debug)
+            {
+                fprintf(debug, "Dynamic pruning: nstlistPrune %d rlistInner %.3f relative cost %.3f\n",
+                        nstPrune, rlist, cost/costOuter);
+            }
+
+            if (cost < costMin)
+            {
+                costMin      = cost;
+                nstlistPrune = nstPrune;
+                rlistInner   = rlist;
+            }
+        }
+
+        if (nstlistPrune < 0)
+        {
+            /* Pruning does not pay off */
+            return;
+        }
+    }
+
+    listParams->useDynamicPruning = TRUE;
+    listParams->nstlistPrune      = nstlistPrune;
+    listParams->rlistInner        = std::min(rlistInner, listParams->rlistOuter);
+
+    if (fplog != nullptr)
+    {
+        const real rcut = std::max(ic->rvdw, ic->rcoulomb);
+
+        fprintf(fplog,
+                "Using a dual %dx%d pair-list setup updated with dynamic pruning:\n"
+                "  outer list: updated every %3d steps, buffer %.3f nm, rlist %.3f nm\n"
+                "  inner list: updated every %3d steps, buffer %.3f nm, rlist %.3f nm\n\n",
+                ls.cluster_size_i, ls.cluster_size_j,
+                ir->nstlist, listParams->rlistOuter - rcut, listParams->rlistOuter,
+                listParams->nstlistPrune, listParams->rlistInner - rcut, listParams->rlistInner);
+    }
+}
+
+/*! \brief The number of CPU kernel layouts we choose from */
+static const int c_nbnxnNumLayouts = 2;
+
+/*! \brief The number of search intervals we time each layout
+ *
+ * We use the minimum over the intervals to reduce the effect
+ * of fluctuations due to other activity on the node.
+ */
+static const int c_nbnxnLayoutNumTimedIntervals = 3;
+
+/*! \brief CPU non-bonded kernel layout tuning data */
+struct NbnxnLayoutTuning
+{
+    bool              isActive;                          /**< Is the tuning still active? */
+    int               kernelType[c_nbnxnNumLayouts];     /**< The nbnxn kernel type of each layout */
+    nbnxn_atomdata_t *nbat[c_nbnxnNumLayouts];           /**< The atom data for each layout */
+    double            cycles[c_nbnxnNumLayouts];         /**< The fastest time per step in cycles */
+    int               numTimed[c_nbnxnNumLayouts];       /**< The number of timed intervals */
+    int               cur;                               /**< The layout currently in use */
+    bool              skipInterval;                      /**< Do not use the timing of the current interval */
+    int               cyclesN;                           /**< Step cycle counter cumulative count */
+    double            cyclesC;                           /**< Step cycle counter cumulative cycles */
+};
+
+/*! \brief Write the name and cluster sizes of the layout of kernelType to buf */
+static void layoutName(int kernelType, char *buf)
+{
+    sprintf(buf, "%s %dx%d",
+            kernelType == nbnxnk4xN_SIMD_2xNN ? "2xNN" : "4xN",
+            nbnxn_kernel_to_cluster_i_size(kernelType),
+            nbnxn_kernel_to_cluster_j_size(kernelType));
+}
+
+void nbnxnLayoutTuningInit(NbnxnLayoutTuning **tunePtr,
+                           const t_inputrec   *ir,
+                           const t_forcerec   *fr)
+{
+    NbnxnLayoutTuning *tune;
+
+    snew(tune, 1);
+
+    tune->isActive = false;
+
+#if defined GMX_NBNXN_SIMD_4XN && defined GMX_NBNXN_SIMD_2XNN
+    const nonbonded_verlet_t *nbv = fr->nbv;
+
+    /* We only tune when the layout was chosen by our heuristics
+     * and all interaction groups use the same CPU SIMD kernels.
+     */
+    bool doTuning = (nbv != nullptr && !nbv->bUseGPU &&
+                     (nbv->grp[0].kernel_type == nbnxnk4xN_SIMD_4xN ||
+                      nbv->grp[0].kernel_type == nbnxnk4xN_SIMD_2xNN) &&
+                     (nbv->ngrp == 1 || nbv->grp[1].nbat == nbv->grp[0].nbat) &&
+                     getenv("GMX_NBNXN_SIMD_4XN") == nullptr &&
+                     getenv("GMX_NBNXN_SIMD_2XNN") == nullptr &&
+                     getenv("GMX_DISABLE_NBNXN_LAYOUT_TUNING") == nullptr);
+
+    if (doTuning)
+    {
+        /* We start with the layout picked at initialization */
+        tune->kernelType[0] = nbv->grp[0].kernel_type;
+        tune->nbat[0]       = nbv->grp[0].nbat;
+
+        tune->kernelType[1] = (tune->kernelType[0] == nbnxnk4xN_SIMD_4xN ?
+                               nbnxnk4xN_SIMD_2xNN : nbnxnk4xN_SIMD_4xN);
+        tune->nbat[1]       = init_nbnxn_atomdata_cpu(fr, ir, tune->kernelType[1]);
+
+        tune->isActive      = true;
+    }
+#else
+    GMX_UNUSED_VALUE(ir);
+    GMX_UNUSED_VALUE(fr);
+#endif
+
+    for (int l = 0; l < c_nbnxnNumLayouts; l++)
+    {
+        tune->cycles[l]   = 0;
+        tune->numTimed[l] = 0;
+    }
+    tune->cur          = 0;
+    /* The first interval includes initial allocation, so we skip it */
+    tune->skipInterval = true;
+    tune->cyclesN      = 0;
+    tune->cyclesC      = 0;
+
+    *tunePtr = tune;
+}
+
+bool nbnxnLayoutTuningIsActive(const NbnxnLayoutTuning *tune)
+{
+    return (tune != nullptr && tune->isActive);
+}
+
+/*! \brief Switch all interaction groups of nbv to layout \p l
+ *
+ * The grid, atom data and pair lists are regenerated for the new
+ * layout at the next pair search.
+ */
+static void setLayout(NbnxnLayoutTuning *tune, nonbonded_verlet_t *nbv,
+                      int l)
+{
+    for (int i = 0; i < nbv->ngrp; i++)
+    {
+        nbv->grp[i].kernel_type = tune->kernelType[l];
+        nbv->grp[i].nbat        = tune->nbat[l];
+    }
+    tune->cur = l;
+}
+
+/*! \brief Print a timing, or the choice when cycles<0, for the layout of kernelType */
+static void printLayout(FILE *fp_err, FILE *fp_log, gmx_int64_t step,
+                        const char *desc, int kernelType, double cycles)
+{
+    char buf[STRLEN], bufl[STRLEN/4], bufs[STEPSTRSIZE];
+    char buft[STRLEN/4];
+
+    layoutName(kernelType, bufl);
+    if (cycles >= 0)
+    {
+        sprintf(buft, ": %.3f M-cycles per step", cycles*1e-6);
+    }
+    else
+    {
+        buft[0] = '\0';
+    }
+    sprintf(buf, "step %4s: %s non-bonded kernel layout %s%s",
+            gmx_step_str(step, bufs), desc, bufl, buft);
+    if (fp_err != nullptr)
+    {
+        fprintf(fp_err, "\r%s\n", buf);
+        fflush(fp_err);
+    }
+    if (fp_log != nullptr)
+    {
+        fprintf(fp_log, "%s\n", buf);
+    }
+}
+
+void nbnxnLayoutTuningDo(NbnxnLayoutTuning *tune,
+                         const t_commrec   *cr,
+                         FILE              *fp_err,
+                         FILE              *fp_log,
+                         t_forcerec        *fr,
+                         gmx_wallcycle_t    wcycle,
+                         gmx_int64_t        step,
+                         gmx_bool           pauseTuning)
+{
+    if (!nbnxnLayoutTuningIsActive(tune))
+    {
+        return;
+    }
+
+    int    nPrev      = tune->cyclesN;
+    double cyclesPrev = tune->cyclesC;
+    wallcycle_get(wcycle, ewcSTEP, &tune->cyclesN, &tune->cyclesC);
+
+    if (tune->cyclesN <= nPrev)
+    {
+        /* No steps have been done yet or the counters have been reset */
+        return;
+    }
+
+    if (pauseTuning || tune->skipInterval)
+    {
+        /* Skip this interval, time the next one, unless we are paused */
+        tune->skipInterval = pauseTuning;
+
+        return;
+    }
+
+    /* The cycles per step, averaged over the PP ranks,
+     * so all ranks make the same choice.
+     */
+    double cycles = (tune->cyclesC - cyclesPrev)/(tune->cyclesN - nPrev);
+    if (PAR(cr))
+    {
+        gmx_sumd(1, &cycles, cr);
+        cycles /= cr->nnodes;
+    }
+
+    int cur = tune->cur;
+    if (tune->numTimed[cur] == 0 || cycles < tune->cycles[cur])
+    {
+        tune->cycles[cur] = cycles;
+    }
+    tune->numTimed[cur]++;
+
+    printLayout(fp_err, fp_log, step, "timed with", tune->kernelType[cur], cycles);
+
+    if (tune->numTimed[cur] < c_nbnxnLayoutNumTimedIntervals)
+    {
+        return;
+    }
+
+    /* Continue with the next layout that has not been timed yet */
+    int next = -1;
+    for (int l = c_nbnxnNumLayouts - 1; l >= 0; l--)
+    {
+        if (tune->numTimed[l] < c_nbnxnLayoutNumTimedIntervals)
+        {
+            next = l;
+        }
+    }
+
+    if (next < 0)
+    {
+        /* All layouts have been timed, select the fastest */
+        next = 0;
+        for (int l = 1; l < c_nbnxnNumLayouts; l++)
+        {
+            if (tune->cycles[l] < tune->cycles[next])
+            {
+                next = l;
+            }
+        }
+        tune->isActive = false;
+
+        printLayout(fp_err, fp_log, step, "optimal", tune->kernelType[next], -1);
+    }
+
+    if (next != cur)
+    {
+        setLayout(tune, fr->nbv, next);
+        /* The first interval with a new layout includes allocation */
+        tune->skipInterval = true;
+    }
+}
+
+void nbnxnLayoutTuningDone(NbnxnLayoutTuning *tune,
+                           FILE              *fplog)
+{
+    if (fplog != nullptr && tune->numTimed[0] > 0)
+    {
+        char buf[STRLEN];
+
+        fprintf(fplog, "\nNon-bonded kernel layout tuning %s:\n",
+                tune->isActive ? "did not finish" : "finished");
+        for (int l = 0; l < c_nbnxnNumLayouts; l++)
+        {
+            if (tune->numTimed[l] > 0)
+            {
+                layoutName(tune->kernelType[l], buf);
+                fprintf(fplog, "   %-10s %10.3f M-cycles per step\n",
+                        buf, tune->cycles[l]*1e-6);
+            }
+        }
+        layoutName(tune->kernelType[tune->cur], buf);
+        fprintf(fplog, "   Used the %s layout\n\n", buf);
+    }
+
+    /* Free the atom data of the layouts that are not in use,
+     * nbv only refers to the atom data of the current layout.
+     */
+    for (int l = 0; l < c_nbnxnNumLayouts; l++)
+    {
+        if (tune->nbat[l] != nullptr && l != tune->cur)
+        {
+            nbnxn_atomdata_destroy(tune->nbat[l]);
+        }
+    }
+    sfree(tune);
+}
@@ -0,0 +1,153 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2017, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \internal \file
+ *
+ * \brief Declares functions for tuning the nbnxn pair-list setup
+ * and the CPU kernel cluster layout.
+ *
+ * \ingroup module_mdlib
+ */
+
+#ifndef GMX_MDLIB_NBNXN_TUNING_H
+#define GMX_MDLIB_NBNXN_TUNING_H
+
+#include <stdio.h>
+
+#include "gromacs/math/vectypes.h"
+#include "gromacs/mdlib/nbnxn_pairlist.h"
+#include "gromacs/timing/wallcycle.h"
+#include "gromacs/utility/basedefinitions.h"
+
+struct gmx_mtop_t;
+struct interaction_const_t;
+struct t_commrec;
+struct t_forcerec;
+struct t_inputrec;
+
+/*! \brief Returns whether dynamic pruning of the CPU pair-lists can be used
+ *
+ * Dynamic pruning requires dynamics with an automatically determined
+ * Verlet buffer and non-bonded interactions computed on the CPU.
+ * It can be turned off with the environment variable GMX_DISABLE_DYNAMICPRUNING.
+ *
+ * \param[in] ir      The input parameter record
+ * \param[in] useGpu  Tells if non-bonded interactions are computed on a GPU
+ */
+gmx_bool nbnxnDynamicPruningIsSupported(const t_inputrec *ir,
+                                        gmx_bool          useGpu);
+
+/*! \brief Set up the dynamic pair-list pruning parameters
+ *
+ * Sets listParams->rlistOuter to ic->rlist and, when dynamic pruning
+ * is supported and beneficial, determines the pruning interval
+ * and the cut-off of the pruned, inner list. The pruning interval
+ * can be set with the environment variable GMX_NSTLIST_DYNAMICPRUNING.
+ *
+ * \param[in,out] fplog           Log file
+ * \param[in]     ir              The input parameter record
+ * \param[in]     mtop            The global topology
+ * \param[in]     box             The unit cell
+ * \param[in]     useSimpleLists  Tells if all non-bonded lists are CPU lists
+ * \param[in]     ic              The nonbonded interactions constants
+ * \param[out]    listParams      The list setup parameters
+ */
+void setupDynamicPairlistPruning(FILE                      *fplog,
+                                 const t_inputrec          *ir,
+                                 const gmx_mtop_t          *mtop,
+                                 matrix                     box,
+                                 gmx_bool                   useSimpleLists,
+                                 const interaction_const_t *ic,
+                                 NbnxnListParameters       *listParams);
+
+/*! \brief Object to manage the CPU non-bonded kernel layout tuning
+ *
+ * With both 4xN and 2xNN SIMD kernels available, which is faster
+ * depends on the system, the settings and the CPU. We time both
+ * layouts during the first pair-search intervals of the run,
+ * in the same way as PME load balancing times PME setups,
+ * and then continue with the fastest layout.
+ */
+struct NbnxnLayoutTuning;
+
+/*! \brief Initialize the CPU non-bonded kernel layout tuning
+ *
+ * Tuning is only activated with CPU SIMD kernels when both the 4xN
+ * and 2xNN layouts are available and the layout was not set with
+ * an environment variable. It can be turned off with the environment
+ * variable GMX_DISABLE_NBNXN_LAYOUT_TUNING.
+ *
+ * \param[out] tunePtr  The tuning object
+ * \param[in]  ir       The input parameter record
+ * \param[in]  fr       The force record, with fr->nbv set up
+ */
+void nbnxnLayoutTuningInit(NbnxnLayoutTuning **tunePtr,
+                           const t_inputrec   *ir,
+                           const t_forcerec   *fr);
+
+/*! \brief Returns whether the kernel layout tuning is active */
+bool nbnxnLayoutTuningIsActive(const NbnxnLayoutTuning *tune);
+
+/*! \brief Process the cycles of the last search interval and switch layout when needed
+ *
+ * Should be called at search steps, before the pair search,
+ * after the ewcSTEP cycle counter has been stopped.
+ * The layout is switched by changing the kernel type and atom data
+ * in fr->nbv, the grid and pair list are regenerated at the search.
+ *
+ * \param[in,out] tune         The tuning object
+ * \param[in]     cr           Communication record
+ * \param[in]     fp_err       File for printing timings to, can be nullptr
+ * \param[in]     fp_log       Log file, can be nullptr
+ * \param[in,out] fr           The force record
+ * \param[in]     wcycle       The wallcycle counters
+ * \param[in]     step         The MD step
+ * \param[in]     pauseTuning  Do not use the last interval, should be set
+ *                             while other tuning, e.g. of PME, is active
+ */
+void nbnxnLayoutTuningDo(NbnxnLayoutTuning *tune,
+                         const t_commrec   *cr,
+                         FILE              *fp_err,
+                         FILE              *fp_log,
+                         t_forcerec        *fr,
+                         gmx_wallcycle_t    wcycle,
+                         gmx_int64_t        step,
+                         gmx_bool           pauseTuning);
+
+/*! \brief Print the tuning result to fplog, when fplog!=nullptr, and free tune */
+void nbnxnLayoutTuningDone(NbnxnLayoutTuning *tune,
+                           FILE              *fplog);
+
+#endif /* GMX_MDLIB_NBNXN_TUNING_H */
@@ -1,7 +1,7 @@
 /*
  * This file is part of the GROMACS molecular simulation package.
  *
- * Copyright (c) 2012,2013,2014,2015,2016, by the GROMACS development team, led by
+ * Copyright (c) 2012,2013,2014,2015,2016,2017, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -124,6 +124,56 @@ static gmx_inline int nbnxn_kernel_to_cluster_j_size(int nb_kernel_type)
     return cj_size;
 }
 
+/* Returns the energy group of the atoms in cluster index c of size
+ * cluster_size, or -1 when the cluster contains atoms of multiple groups.
+ * The energy groups are stored per nbat->na_c atoms, cluster_size should
+ * be a compile-time constant in kernels for efficient code.
+ */
+static gmx_inline int nbnxn_cluster_energygroup(const nbnxn_atomdata_t *nbat,
+                                                int                     c,
+                                                int                     cluster_size)
+{
+    const int  egp_shift = nbat->neg_2log;
+    const int  egp_mask  = (1 << egp_shift) - 1;
+    const int *energrp   = nbat->energrp;
+    int        code, egp, na;
+
+    if (cluster_size >= nbat->na_c)
+    {
+        /* The cluster consists of one or more whole group entries */
+        int nentry = cluster_size/nbat->na_c;
+
+        egp = energrp[c*nentry] & egp_mask;
+        for (int e = 0; e < nentry; e++)
+        {
+            code = energrp[c*nentry + e];
+            for (int a = 0; a < nbat->na_c; a++)
+            {
+                if (((code >> (a*egp_shift)) & egp_mask) != egp)
+                {
+                    return -1;
+                }
+            }
+        }
+
+        return egp;
+    }
+
+    /* The cluster is part of a group entry */
+    na   = cluster_size;
+    code = energrp[(c*na)/nbat->na_c] >> (((c*na) % nbat->na_c)*egp_shift);
+    egp  = code & egp_mask;
+    for (int a = 1; a < na; a++)
+    {
+        if (((code >> (a*egp_shift)) & egp_mask) != egp)
+        {
+            return -1;
+        }
+    }
+
+    return egp;
+}
+
 
 #ifdef __cplusplus
 }
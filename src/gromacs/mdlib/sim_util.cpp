@@ -82,6 +82,7 @@
 #include "gromacs/mdlib/qmmm.h"
 #include "gromacs/mdlib/update.h"
 #include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_gpu_ref.h"
+#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_prune.h"
 #include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref.h"
 #include "gromacs/mdlib/nbnxn_kernels/simd_2xnn/nbnxn_kernel_simd_2xnn.h"
 #include "gromacs/mdlib/nbnxn_kernels/simd_4xn/nbnxn_kernel_simd_4xn.h"
@@ -224,6 +225,26 @@ static void sum_forces(rvec f[], const PaddedRVecVector *forceToAdd)
     }
 }
 
+/* Adds weight*forceToAdd to f */
+static void sum_forces_weighted(rvec f[], const PaddedRVecVector *forceToAdd,
+                                real weight)
+{
+    /* TODO: remove this - 1 when padding is properly implemented */
+    int         end  = forceToAdd->size() - 1;
+    const rvec *fAdd = as_rvec_array(forceToAdd->data());
+
+    // cppcheck-suppress unreadVariable
+    int gmx_unused nt = gmx_omp_nthreads_get(emntDefault);
+#pragma omp parallel for num_threads(nt) schedule(static)
+    for (int i = 0; i < end; i++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            f[i][d] += weight*fAdd[i][d];
+        }
+    }
+}
+
 static void calc_virial(int start, int homenr, rvec x[], rvec f[],
                         tensor vir_part, t_graph *graph, matrix box,
                         t_nrnb *nrnb, const t_forcerec *fr, int ePBC)
@@ -305,7 +326,8 @@ static void pme_receive_force_ener(t_commrec      *cr,
     wallcycle_start(wcycle, ewcPP_PMEWAITRECVF);
     dvdl_q  = 0;
     dvdl_lj = 0;
-    gmx_pme_receive_f(cr, as_rvec_array(fr->f_novirsum->data()), fr->vir_el_recip, &e_q,
+    PaddedRVecVector *forceMesh = (fr->pmeMtsFactor > 1 ? fr->forceBufferPmeMts : fr->f_novirsum);
+    gmx_pme_receive_f(cr, as_rvec_array(forceMesh->data()), fr->vir_el_recip, &e_q,
                       fr->vir_lj_recip, &e_lj, &dvdl_q, &dvdl_lj,
                       &cycles_seppme);
     enerd->term[F_COUL_RECIP] += e_q;
@@ -363,6 +385,27 @@ static void post_process_forces(t_commrec *cr,
                                 t_forcerec *fr, gmx_vsite_t *vsite,
                                 int flags)
 {
+    if (fr->pmeMtsFactor > 1 && fr->bDoPmeMesh)
+    {
+        if (vsite)
+        {
+            wallcycle_start(wcycle, ewcVSITESPREAD);
+            spread_vsite_f(vsite, x, as_rvec_array(fr->forceBufferPmeMts->data()), nullptr,
+                           (flags & GMX_FORCE_VIRIAL), fr->vir_el_recip,
+                           nrnb,
+                           &top->idef, fr->ePBC, fr->bMolPBC, graph, box, cr);
+            wallcycle_stop(wcycle, ewcVSITESPREAD);
+        }
+        /* Apply the mesh forces as an impulse at multiples of pmeMtsFactor.
+         * At other steps they were only computed for the energy/virial.
+         * The mesh virial was computed by PME and is not weighted.
+         */
+        if (do_per_step(step, fr->pmeMtsFactor))
+        {
+            sum_forces_weighted(f, fr->forceBufferPmeMts, fr->pmeMtsFactor);
+        }
+    }
+
     if (fr->bF_NoVirSum)
     {
         if (vsite)
@@ -411,6 +454,7 @@ static void do_nb_verlet(t_forcerec *fr,
                          gmx_enerdata_t *enerd,
                          int flags, int ilocality,
                          int clearF,
+                         gmx_int64_t step,
                          t_nrnb *nrnb,
                          gmx_wallcycle_t wcycle)
 {
@@ -434,6 +478,19 @@ static void do_nb_verlet(t_forcerec *fr,
 
     bUsingGpuKernels = (nbvg->kernel_type == nbnxnk8x8x8_GPU);
 
+    const NbnxnListParameters *listParams = &fr->nbv->listParams;
+
+    if (!bUsingGpuKernels && listParams->useDynamicPruning &&
+        (step - nbvg->nbl_lists.outerListCreationStep) % listParams->nstlistPrune == 0)
+    {
+        /* Prune the outer list to the inner list, this is also done
+         * at the search step, as the search only generates the outer list.
+         */
+        wallcycle_sub_start(wcycle, ewcsNONBONDED_PRUNING);
+        nbnxn_kernel_cpu_prune(nbvg, fr->shift_vec, listParams->rlistInner);
+        wallcycle_sub_stop(wcycle, ewcsNONBONDED_PRUNING);
+    }
+
     if (!bUsingGpuKernels)
     {
         wallcycle_sub_start(wcycle, ewcsNONBONDED);
@@ -740,6 +797,7 @@ void do_force_cutsVERLET(FILE *fplog, t_commrec *cr,
     gmx_bool            bStateChanged, bNS, bFillGrid, bCalcCGCM;
     gmx_bool            bDoForces, bUseGPU, bUseOrEmulGPU;
     gmx_bool            bDiffKernels = FALSE;
+    gmx_bool            bOverlapMoveX;
     rvec                vzero, box_diag;
     float               cycles_pme, cycles_force, cycles_wait_gpu;
     /* TODO To avoid loss of precision, float can't be used for a
@@ -777,6 +835,20 @@ void do_force_cutsVERLET(FILE *fplog, t_commrec *cr,
     bDoForces     = (flags & GMX_FORCE_FORCES);
     bUseGPU       = fr->nbv->bUseGPU;
     bUseOrEmulGPU = bUseGPU || (nbv->grp[0].kernel_type == nbnxnk8x8x8_PlainC);
+    /* With CPU non-bonded kernels we overlap the coordinate halo
+     * communication with the local non-bonded calculation.
+     */
+    bOverlapMoveX = (DOMAINDECOMP(cr) && !bNS && !bUseOrEmulGPU);
+
+    if (fr->pmeMtsFactor > 1)
+    {
+        /* With multiple time-stepping the mesh forces are only applied
+         * every pmeMtsFactor steps. At other steps we only need the mesh
+         * part when the energy or virial is requested.
+         */
+        fr->bDoPmeMesh = (do_per_step(step, fr->pmeMtsFactor) ||
+                          (flags & (GMX_FORCE_VIRIAL | GMX_FORCE_ENERGY)));
+    }
 
     if (bStateChanged)
     {
@@ -818,7 +890,7 @@ void do_force_cutsVERLET(FILE *fplog, t_commrec *cr,
                                  fr->shift_vec, nbv->grp[0].nbat);
 
 #if GMX_MPI
-    if (!(cr->duty & DUTY_PME))
+    if (!(cr->duty & DUTY_PME) && fr->bDoPmeMesh)
     {
         gmx_bool bBS;
         matrix   boxs;
@@ -921,11 +993,12 @@ void do_force_cutsVERLET(FILE *fplog, t_commrec *cr,
         wallcycle_sub_start(wcycle, ewcsNBS_SEARCH_LOCAL);
         nbnxn_make_pairlist(nbv->nbs, nbv->grp[eintLocal].nbat,
                             &top->excls,
-                            ic->rlist,
+                            &nbv->listParams,
                             nbv->min_ci_balanced,
                             &nbv->grp[eintLocal].nbl_lists,
                             eintLocal,
                             nbv->grp[eintLocal].kernel_type,
+                            step,
                             nrnb);
         wallcycle_sub_stop(wcycle, ewcsNBS_SEARCH_LOCAL);
 
@@ -953,7 +1026,7 @@ void do_force_cutsVERLET(FILE *fplog, t_commrec *cr,
         wallcycle_start(wcycle, ewcLAUNCH_GPU_NB);
         /* launch local nonbonded F on GPU */
         do_nb_verlet(fr, ic, enerd, flags, eintLocal, enbvClearFNo,
-                     nrnb, wcycle);
+                     step, nrnb, wcycle);
         wallcycle_stop(wcycle, ewcLAUNCH_GPU_NB);
     }
 
@@ -991,11 +1064,12 @@ void do_force_cutsVERLET(FILE *fplog, t_commrec *cr,
 
             nbnxn_make_pairlist(nbv->nbs, nbv->grp[eintNonlocal].nbat,
                                 &top->excls,
-                                ic->rlist,
+                                &nbv->listParams,
                                 nbv->min_ci_balanced,
                                 &nbv->grp[eintNonlocal].nbl_lists,
                                 eintNonlocal,
                                 nbv->grp[eintNonlocal].kernel_type,
+                                step,
                                 nrnb);
 
             wallcycle_sub_stop(wcycle, ewcsNBS_SEARCH_NONLOCAL);
@@ -1009,6 +1083,15 @@ void do_force_cutsVERLET(FILE *fplog, t_commrec *cr,
             }
             wallcycle_stop(wcycle, ewcNS);
         }
+        else if (bOverlapMoveX)
+        {
+            /* The communication is completed after the local non-bonded
+             * kernel, together with the non-local x buffer operations.
+             */
+            wallcycle_start(wcycle, ewcMOVEX);
+            dd_move_x_start(cr->dd, box, x);
+            wallcycle_stop(wcycle, ewcMOVEX);
+        }
         else
         {
             wallcycle_start(wcycle, ewcMOVEX);
@@ -1028,7 +1111,7 @@ void do_force_cutsVERLET(FILE *fplog, t_commrec *cr,
             wallcycle_start(wcycle, ewcLAUNCH_GPU_NB);
             /* launch non-local nonbonded F on GPU */
             do_nb_verlet(fr, ic, enerd, flags, eintNonlocal, enbvClearFNo,
-                         nrnb, wcycle);
+                         step, nrnb, wcycle);
             cycles_force += wallcycle_stop(wcycle, ewcLAUNCH_GPU_NB);
         }
     }
@@ -1080,9 +1163,12 @@ void do_force_cutsVERLET(FILE *fplog, t_commrec *cr,
     reset_enerdata(enerd);
     clear_rvecs(SHIFTS, fr->fshift);
 
-    if (DOMAINDECOMP(cr) && !(cr->duty & DUTY_PME))
+    if (DOMAINDECOMP(cr))
     {
-        wallcycle_start(wcycle, ewcPPDURINGPME);
+        if (!(cr->duty & DUTY_PME) && fr->bDoPmeMesh)
+        {
+            wallcycle_start(wcycle, ewcPPDURINGPME);
+        }
         dd_force_flop_start(cr->dd, nrnb);
     }
 
@@ -1134,6 +1220,12 @@ void do_force_cutsVERLET(FILE *fplog, t_commrec *cr,
                                 as_rvec_array(fr->f_novirsum->data()));
             }
         }
+        if (fr->pmeMtsFactor > 1 && fr->bDoPmeMesh)
+        {
+            /* TODO: remove this - 1 when padding is properly implemented */
+            clear_rvecs_omp(fr->forceBufferPmeMts->size() - 1,
+                            as_rvec_array(fr->forceBufferPmeMts->data()));
+        }
         /* Clear the short- and long-range forces */
         clear_rvecs_omp(fr->natoms_force_constr, f);
 
@@ -1157,7 +1249,26 @@ void do_force_cutsVERLET(FILE *fplog, t_commrec *cr,
     {
         /* Maybe we should move this into do_force_lowlevel */
         do_nb_verlet(fr, ic, enerd, flags, eintLocal, enbvClearFYes,
-                     nrnb, wcycle);
+                     step, nrnb, wcycle);
+    }
+
+    if (bOverlapMoveX)
+    {
+        /* Complete the coordinate communication, which should not count
+         * as force time for the dynamic load balancing.
+         */
+        cycles_force += wallcycle_stop(wcycle, ewcFORCE);
+        wallcycle_start_nocount(wcycle, ewcMOVEX);
+        dd_move_x_finish(cr->dd, box, x);
+        wallcycle_stop(wcycle, ewcMOVEX);
+
+        wallcycle_start(wcycle, ewcNB_XF_BUF_OPS);
+        wallcycle_sub_start(wcycle, ewcsNB_X_BUF_OPS);
+        nbnxn_atomdata_copy_x_to_nbat_x(nbv->nbs, eatNonlocal, FALSE, x,
+                                        nbv->grp[eintNonlocal].nbat);
+        wallcycle_sub_stop(wcycle, ewcsNB_X_BUF_OPS);
+        cycles_force += wallcycle_stop(wcycle, ewcNB_XF_BUF_OPS);
+        wallcycle_start_nocount(wcycle, ewcFORCE);
     }
 
     if (fr->efep != efepNO)
@@ -1191,7 +1302,7 @@ void do_force_cutsVERLET(FILE *fplog, t_commrec *cr,
         {
             do_nb_verlet(fr, ic, enerd, flags, eintNonlocal,
                          bDiffKernels ? enbvClearFYes : enbvClearFNo,
-                         nrnb, wcycle);
+                         step, nrnb, wcycle);
         }
 
         if (!bUseOrEmulGPU)
@@ -1269,7 +1380,7 @@ void do_force_cutsVERLET(FILE *fplog, t_commrec *cr,
             {
                 wallcycle_start_nocount(wcycle, ewcFORCE);
                 do_nb_verlet(fr, ic, enerd, flags, eintNonlocal, enbvClearFYes,
-                             nrnb, wcycle);
+                             step, nrnb, wcycle);
                 cycles_force += wallcycle_stop(wcycle, ewcFORCE);
             }
             wallcycle_start(wcycle, ewcNB_XF_BUF_OPS);
@@ -1361,7 +1472,7 @@ void do_force_cutsVERLET(FILE *fplog, t_commrec *cr,
             wallcycle_start_nocount(wcycle, ewcFORCE);
             do_nb_verlet(fr, ic, enerd, flags, eintLocal,
                          DOMAINDECOMP(cr) ? enbvClearFNo : enbvClearFYes,
-                         nrnb, wcycle);
+                         step, nrnb, wcycle);
             wallcycle_stop(wcycle, ewcFORCE);
         }
         wallcycle_start(wcycle, ewcNB_XF_BUF_OPS);
@@ -1433,7 +1544,7 @@ void do_force_cutsVERLET(FILE *fplog, t_commrec *cr,
     /* Add forces from interactive molecular dynamics (IMD), if bIMD == TRUE. */
     IMD_apply_forces(inputrec->bIMD, inputrec->imd, cr, f, wcycle);
 
-    if (PAR(cr) && !(cr->duty & DUTY_PME))
+    if (PAR(cr) && !(cr->duty & DUTY_PME) && fr->bDoPmeMesh)
     {
         /* In case of node-splitting, the PP nodes receive the long-range
          * forces, virial and energy from the PME nodes here.
@@ -1652,9 +1763,12 @@ void do_force_cutsGROUP(FILE *fplog, t_commrec *cr,
                        x, box, fr, &top->idef, graph, fr->born);
     }
 
-    if (DOMAINDECOMP(cr) && !(cr->duty & DUTY_PME))
+    if (DOMAINDECOMP(cr))
     {
-        wallcycle_start(wcycle, ewcPPDURINGPME);
+        if (!(cr->duty & DUTY_PME))
+        {
+            wallcycle_start(wcycle, ewcPPDURINGPME);
+        }
         dd_force_flop_start(cr->dd, nrnb);
     }
 
@@ -0,0 +1,355 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2017, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests that the SIMD nbnxn kernels with energy groups reproduce
+ * the forces and group-pair energies of the plain-C reference kernels
+ *
+ * \ingroup module_mdlib
+ */
+#include "gmxpre.h"
+
+#include <cmath>
+
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/gmxlib/nrnb.h"
+#include "gromacs/math/units.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/mdlib/force_flags.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
+#include "gromacs/mdlib/nb_verlet.h"
+#include "gromacs/mdlib/nbnxn_atomdata.h"
+#include "gromacs/mdlib/nbnxn_grid.h"
+#include "gromacs/mdlib/nbnxn_search.h"
+#include "gromacs/mdlib/nbnxn_simd.h"
+#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref.h"
+#include "gromacs/mdlib/nbnxn_kernels/simd_2xnn/nbnxn_kernel_simd_2xnn.h"
+#include "gromacs/mdlib/nbnxn_kernels/simd_4xn/nbnxn_kernel_simd_4xn.h"
+#include "gromacs/mdtypes/forcerec.h"
+#include "gromacs/mdtypes/interaction_const.h"
+#include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/mdtypes/mdatom.h"
+#include "gromacs/pbcutil/ishift.h"
+#include "gromacs/pbcutil/pbc.h"
+#include "gromacs/topology/block.h"
+#include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/smalloc.h"
+
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+#if GMX_SIMD && (defined GMX_NBNXN_SIMD_4XN || defined GMX_NBNXN_SIMD_2XNN)
+
+//! Number of lattice sites along each box vector
+const int  c_numSitesPerDim  = 8;
+//! Lattice spacing in nm
+const real c_spacing         = 0.4;
+//! Cut-off for Coulomb and VdW in nm
+const real c_cutoff          = 0.9;
+//! Number of atom types, alternating over the atoms
+const int  c_numTypes        = 2;
+//! Number of energy groups
+const int  c_numEnergyGroups = 3;
+
+//! Forces and group-pair energies from one non-bonded kernel call
+struct NonbondedOutput
+{
+    //! The forces
+    std::vector<RVec> f;
+    //! The Coulomb energies, the upper triangle of the group-pair matrix is set
+    std::vector<real> Vc;
+    //! The VdW energies, the upper triangle of the group-pair matrix is set
+    std::vector<real> Vvdw;
+};
+
+/*! \brief Computes the non-bonded interactions with energy groups
+ *
+ * Puts a distorted lattice of charged LJ particles on the nbnxn grid,
+ * makes a pair list and computes the forces and group-pair energies
+ * with the kernels of type \p kernelType. The energy groups are slabs
+ * along x, with a few atoms moved to the next group, so there are both
+ * clusters with one group and clusters with multiple groups.
+ */
+NonbondedOutput computeNonbonded(int kernelType)
+{
+    const int numAtoms = c_numSitesPerDim*c_numSitesPerDim*c_numSitesPerDim;
+
+    matrix    box;
+    clear_mat(box);
+    for (int d = 0; d < DIM; d++)
+    {
+        box[d][d] = c_numSitesPerDim*c_spacing;
+    }
+
+    /* Distort the lattice deterministically, without close contacts */
+    std::vector<RVec> x(numAtoms);
+    std::vector<int>  type(numAtoms);
+    std::vector<real> charge(numAtoms);
+    std::vector<int>  atinfo(numAtoms, 0);
+    for (int a = 0; a < numAtoms; a++)
+    {
+        const int site[DIM] = {
+            a % c_numSitesPerDim,
+            (a/c_numSitesPerDim) % c_numSitesPerDim,
+            a/(c_numSitesPerDim*c_numSitesPerDim)
+        };
+        for (int d = 0; d < DIM; d++)
+        {
+            x[a][d] = (site[d] + 0.5 + 0.15*std::sin(1.3*a + 2.1*d))*c_spacing;
+        }
+        type[a]   = (site[XX] + site[YY] + site[ZZ]) % c_numTypes;
+        charge[a] = (type[a] == 0 ? 0.6 : -0.6);
+
+        int energyGroup = (site[XX]*c_numEnergyGroups)/c_numSitesPerDim;
+        if (a % 23 == 0)
+        {
+            energyGroup = (energyGroup + 1) % c_numEnergyGroups;
+        }
+        SET_CGINFO_GID(atinfo[a], energyGroup);
+        SET_CGINFO_HAS_VDW(atinfo[a]);
+        SET_CGINFO_HAS_Q(atinfo[a]);
+    }
+
+    /* The nbnxn parameter matrix stores 6*C6 and 12*C12 */
+    const real        sigma[c_numTypes]   = { 0.30, 0.25 };
+    const real        epsilon[c_numTypes] = { 0.60, 0.40 };
+    std::vector<real> nbfp(c_numTypes*c_numTypes*2);
+    for (int ti = 0; ti < c_numTypes; ti++)
+    {
+        for (int tj = 0; tj < c_numTypes; tj++)
+        {
+            const real sigma6 = std::pow(0.5*(sigma[ti] + sigma[tj]), 6);
+            const real eps    = std::sqrt(epsilon[ti]*epsilon[tj]);
+
+            nbfp[(ti*c_numTypes + tj)*2    ] =  6*4*eps*sigma6;
+            nbfp[(ti*c_numTypes + tj)*2 + 1] = 12*4*eps*sigma6*sigma6;
+        }
+    }
+
+    /* Each atom only excludes itself */
+    std::vector<int> exclIndex(numAtoms + 1);
+    std::vector<int> exclAtoms(numAtoms);
+    for (int a = 0; a < numAtoms; a++)
+    {
+        exclIndex[a] = a;
+        exclAtoms[a] = a;
+    }
+    exclIndex[numAtoms] = numAtoms;
+    t_blocka excls;
+    excls.nr           = numAtoms;
+    excls.index        = exclIndex.data();
+    excls.nalloc_index = numAtoms + 1;
+    excls.nra          = numAtoms;
+    excls.a            = exclAtoms.data();
+    excls.nalloc_a     = numAtoms;
+
+    /* Reaction-field with epsilon_rf=infinity and plain LJ */
+    interaction_const_t ic = {};
+    ic.eeltype      = eelRF;
+    ic.vdwtype      = evdwCUT;
+    ic.vdw_modifier = eintmodNONE;
+    ic.rcoulomb     = c_cutoff;
+    ic.rvdw         = c_cutoff;
+    ic.epsfac       = ONE_4PI_EPS0;
+    ic.k_rf         = 1/(2*c_cutoff*c_cutoff*c_cutoff);
+    ic.c_rf         = 1/c_cutoff + ic.k_rf*c_cutoff*c_cutoff;
+
+    gmx_omp_nthreads_set(emntNonbonded, 1);
+    gmx_omp_nthreads_set(emntPairsearch, 1);
+
+    nbnxn_search_t       nbs;
+    nbnxn_pairlist_set_t nbl_list;
+    nbnxn_atomdata_t    *nbat;
+
+    nbnxn_init_search(&nbs, nullptr, nullptr, FALSE, 1);
+    nbnxn_init_pairlist_set(&nbl_list, TRUE, FALSE, nullptr, nullptr);
+    snew(nbat, 1);
+    nbnxn_atomdata_init(nullptr, nbat, kernelType,
+                        enbnxninitcombruleNONE, c_numTypes, nbfp.data(),
+                        c_numEnergyGroups, 1, nullptr, nullptr);
+
+    rvec lowerCorner, upperCorner;
+    clear_rvec(lowerCorner);
+    for (int d = 0; d < DIM; d++)
+    {
+        upperCorner[d] = box[d][d];
+    }
+    nbnxn_put_on_grid(nbs, epbcXYZ, box, 0, lowerCorner, upperCorner,
+                      0, numAtoms, -1, atinfo.data(), as_rvec_array(x.data()),
+                      0, nullptr, kernelType, nbat);
+
+    t_mdatoms mdatoms = {};
+    mdatoms.nr        = numAtoms;
+    mdatoms.typeA     = type.data();
+    mdatoms.chargeA   = charge.data();
+    nbnxn_atomdata_set(nbat, eatAll, nbs, &mdatoms, atinfo.data());
+
+    rvec shift_vec[SHIFTS];
+    calc_shifts(box, shift_vec);
+    nbnxn_atomdata_copy_shiftvec(FALSE, shift_vec, nbat);
+
+    NbnxnListParameters listParams;
+    listParams.rlistOuter        = c_cutoff;
+    listParams.rlistInner        = c_cutoff;
+    listParams.useDynamicPruning = FALSE;
+    listParams.nstlistPrune      = 0;
+
+    t_nrnb nrnb;
+    init_nrnb(&nrnb);
+    nbnxn_make_pairlist(nbs, nbat, &excls, &listParams, 0, &nbl_list,
+                        eintLocal, kernelType, 0, &nrnb);
+
+    nbnxn_atomdata_copy_x_to_nbat_x(nbs, eatAll, FALSE,
+                                    as_rvec_array(x.data()), nbat);
+
+    NonbondedOutput   output;
+    std::vector<real> fshift(SHIFTS*DIM);
+    output.Vc.assign(c_numEnergyGroups*c_numEnergyGroups, 0);
+    output.Vvdw.assign(c_numEnergyGroups*c_numEnergyGroups, 0);
+    const int         forceFlags = GMX_FORCE_FORCES | GMX_FORCE_ENERGY;
+    switch (kernelType)
+    {
+        case nbnxnk4x4_PlainC:
+            nbnxn_kernel_ref(&nbl_list, nbat, &ic, shift_vec,
+                             forceFlags, enbvClearFYes, fshift.data(),
+                             output.Vc.data(), output.Vvdw.data());
+            break;
+#ifdef GMX_NBNXN_SIMD_4XN
+        case nbnxnk4xN_SIMD_4xN:
+            nbnxn_kernel_simd_4xn(&nbl_list, nbat, &ic, ewaldexclTable,
+                                  shift_vec, forceFlags, enbvClearFYes,
+                                  fshift.data(),
+                                  output.Vc.data(), output.Vvdw.data());
+            break;
+#endif
+#ifdef GMX_NBNXN_SIMD_2XNN
+        case nbnxnk4xN_SIMD_2xNN:
+            nbnxn_kernel_simd_2xnn(&nbl_list, nbat, &ic, ewaldexclTable,
+                                   shift_vec, forceFlags, enbvClearFYes,
+                                   fshift.data(),
+                                   output.Vc.data(), output.Vvdw.data());
+            break;
+#endif
+        default:
+            GMX_RELEASE_ASSERT(false, "Unsupported kernel type");
+    }
+
+    output.f.assign(numAtoms, RVec(0, 0, 0));
+    nbnxn_atomdata_add_nbat_f_to_f(nbs, eatAll, nbat,
+                                   as_rvec_array(output.f.data()));
+
+    nbnxn_atomdata_destroy(nbat);
+
+    return output;
+}
+
+//! Checks that the forces and upper-triangle group-pair energies agree
+void compareNonbondedOutput(const NonbondedOutput &reference,
+                            const NonbondedOutput &test)
+{
+    real fMax = 0;
+    for (const RVec &f : reference.f)
+    {
+        fMax = std::max(fMax, norm(f));
+    }
+    FloatingPointTolerance forceTolerance =
+        relativeToleranceAsFloatingPoint(fMax, 1e-4);
+    ASSERT_EQ(reference.f.size(), test.f.size());
+    for (size_t a = 0; a < reference.f.size(); a++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_REAL_EQ_TOL(reference.f[a][d], test.f[a][d], forceTolerance)
+            << "atom " << a << " dimension " << d;
+        }
+    }
+
+    real VMax = 0;
+    for (int i = 0; i < c_numEnergyGroups*c_numEnergyGroups; i++)
+    {
+        VMax = std::max(VMax, std::abs(reference.Vc[i]));
+        VMax = std::max(VMax, std::abs(reference.Vvdw[i]));
+    }
+    FloatingPointTolerance energyTolerance =
+        relativeToleranceAsFloatingPoint(VMax, 1e-5);
+    for (int gi = 0; gi < c_numEnergyGroups; gi++)
+    {
+        for (int gj = gi; gj < c_numEnergyGroups; gj++)
+        {
+            const int ind = gi*c_numEnergyGroups + gj;
+            EXPECT_REAL_EQ_TOL(reference.Vc[ind], test.Vc[ind], energyTolerance)
+            << "Coulomb energy of group pair " << gi << "-" << gj;
+            EXPECT_REAL_EQ_TOL(reference.Vvdw[ind], test.Vvdw[ind], energyTolerance)
+            << "VdW energy of group pair " << gi << "-" << gj;
+        }
+    }
+}
+
+#ifdef GMX_NBNXN_SIMD_4XN
+TEST(NbnxnKernelTest, Simd4xNEnergyGroupsMatchReference)
+{
+    NonbondedOutput reference = computeNonbonded(nbnxnk4x4_PlainC);
+    NonbondedOutput simd      = computeNonbonded(nbnxnk4xN_SIMD_4xN);
+
+    compareNonbondedOutput(reference, simd);
+}
+#endif
+
+#ifdef GMX_NBNXN_SIMD_2XNN
+TEST(NbnxnKernelTest, Simd2xNNEnergyGroupsMatchReference)
+{
+    NonbondedOutput reference = computeNonbonded(nbnxnk4x4_PlainC);
+    NonbondedOutput simd      = computeNonbonded(nbnxnk4xN_SIMD_2xNN);
+
+    compareNonbondedOutput(reference, simd);
+}
+#endif
+
+#endif
+
+} // namespace
+} // namespace test
+} // namespace gmx
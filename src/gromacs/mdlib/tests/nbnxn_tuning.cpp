@@ -0,0 +1,235 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2017, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests the setup of the dual pair-list with dynamic pruning
+ *
+ * \ingroup module_mdlib
+ */
+#include "gmxpre.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/math/vec.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/mdlib/calc_verletbuf.h"
+#include "gromacs/mdlib/nbnxn_pairlist.h"
+#include "gromacs/mdlib/nbnxn_tuning.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/mdtypes/interaction_const.h"
+#include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/topology/topology.h"
+#include "gromacs/utility/smalloc.h"
+
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Number of argon atoms
+const int  c_numAtoms = 1000;
+//! Edge of the cubic box in nm, giving liquid argon density
+const real c_boxSize  = 3.6;
+//! Cut-off for VdW and Coulomb in nm
+const real c_cutoff   = 1.0;
+
+/*! \brief Test fixture for the dynamic pruning setup
+ *
+ * Sets up a box of liquid argon with a thermostat, for which
+ * dynamic pruning pays off with long pair-list update intervals.
+ */
+class DynamicPruningSetupTest : public ::testing::Test
+{
+    public:
+        DynamicPruningSetupTest()
+        {
+            clear_mat(box_);
+            for (int d = 0; d < DIM; d++)
+            {
+                box_[d][d] = c_boxSize;
+            }
+
+            atom_.m     = 39.948;
+            atom_.q     = 0;
+            atom_.type  = 0;
+            atom_.ptype = eptAtom;
+            iparams_.lj.c6  = 0.0062;
+            iparams_.lj.c12 = 9.69e-06;
+
+            mtop_.ffparams.atnr     = 1;
+            mtop_.ffparams.ntypes   = 1;
+            mtop_.ffparams.iparams  = &iparams_;
+            mtop_.ffparams.reppow   = 12;
+            mtop_.nmoltype          = 1;
+            mtop_.moltype           = &moltype_;
+            mtop_.nmolblock         = 1;
+            mtop_.molblock          = &molblock_;
+            mtop_.natoms            = c_numAtoms;
+            moltype_.atoms.nr       = 1;
+            moltype_.atoms.atom     = &atom_;
+            molblock_.type          = 0;
+            molblock_.nmol          = c_numAtoms;
+            molblock_.natoms_mol    = 1;
+
+            ir_.eI              = eiMD;
+            ir_.delta_t         = 0.005;
+            ir_.etc             = etcBERENDSEN;
+            ir_.verletbuf_tol   = 1e-5;
+            ir_.cutoff_scheme   = ecutsVERLET;
+            ir_.vdwtype         = evdwCUT;
+            ir_.vdw_modifier    = eintmodPOTSHIFT;
+            ir_.rvdw            = c_cutoff;
+            ir_.coulombtype     = eelRF;
+            ir_.epsilon_r       = 1;
+            ir_.epsilon_rf      = 0;
+            ir_.rcoulomb        = c_cutoff;
+            ir_.opts.ngtc       = 1;
+            snew(ir_.opts.ref_t, ir_.opts.ngtc);
+            snew(ir_.opts.tau_t, ir_.opts.ngtc);
+            ir_.opts.ref_t[0]   = 90;
+            ir_.opts.tau_t[0]   = 0.1;
+
+            ic_.rvdw            = c_cutoff;
+            ic_.rcoulomb        = c_cutoff;
+        }
+
+        //! Sets the pair-list update interval and the outer list cut-off for it
+        void setNstlist(int nstlist)
+        {
+            ir_.nstlist = nstlist;
+            ic_.rlist   = computeRlist(nstlist);
+            ir_.rlist   = ic_.rlist;
+        }
+
+        //! Returns the list cut-off for a list updated every \p nstlist steps
+        real computeRlist(int nstlist)
+        {
+            verletbuf_list_setup_t listSetup;
+            verletbuf_get_list_setup(TRUE, FALSE, &listSetup);
+            real                   rlist;
+            calc_verlet_buffer_size(&mtop_, det(box_), &ir_, nstlist, -1, &listSetup,
+                                    nullptr, &rlist);
+
+            return rlist;
+        }
+
+        //! Calls setupDynamicPairlistPruning() with the current settings
+        NbnxnListParameters setupPruning(gmx_bool useSimpleLists)
+        {
+            NbnxnListParameters listParams;
+            setupDynamicPairlistPruning(nullptr, &ir_, &mtop_, box_, useSimpleLists,
+                                        &ic_, &listParams);
+
+            return listParams;
+        }
+
+        //! Checks that \p listParams describe a single list updated every nstlist steps
+        void checkSingleList(const NbnxnListParameters &listParams)
+        {
+            EXPECT_FALSE(listParams.useDynamicPruning);
+            EXPECT_EQ(ir_.nstlist, listParams.nstlistPrune);
+            EXPECT_EQ(ic_.rlist, listParams.rlistOuter);
+            EXPECT_EQ(ic_.rlist, listParams.rlistInner);
+        }
+
+        //! The unit cell
+        matrix              box_;
+        //! The argon atom
+        t_atom              atom_ = {};
+        //! The LJ parameters of the argon atom pair
+        t_iparams           iparams_ = {};
+        //! The argon molecule type
+        gmx_moltype_t       moltype_ = {};
+        //! The block of argon atoms
+        gmx_molblock_t      molblock_ = {};
+        //! The topology, pointing to the members above
+        gmx_mtop_t          mtop_ = {};
+        //! The input parameters
+        t_inputrec          ir_;
+        //! The interaction constants, only the cut-off distances are used
+        interaction_const_t ic_ = {};
+};
+
+TEST_F(DynamicPruningSetupTest, PrunesWithLongListUpdateInterval)
+{
+    setNstlist(40);
+
+    NbnxnListParameters listParams = setupPruning(TRUE);
+
+    EXPECT_TRUE(listParams.useDynamicPruning);
+    EXPECT_EQ(ic_.rlist, listParams.rlistOuter);
+    EXPECT_GT(listParams.nstlistPrune, 1);
+    EXPECT_LT(listParams.nstlistPrune, ir_.nstlist);
+    /* The inner list has the buffer for the pruning interval */
+    EXPECT_LT(listParams.rlistInner, listParams.rlistOuter);
+    EXPECT_GE(listParams.rlistInner, c_cutoff);
+    EXPECT_EQ(computeRlist(listParams.nstlistPrune), listParams.rlistInner);
+}
+
+TEST_F(DynamicPruningSetupTest, UsesSingleListWithShortListUpdateInterval)
+{
+    setNstlist(2);
+
+    checkSingleList(setupPruning(TRUE));
+}
+
+TEST_F(DynamicPruningSetupTest, UsesSingleListWithGpuLists)
+{
+    setNstlist(40);
+
+    checkSingleList(setupPruning(FALSE));
+}
+
+TEST_F(DynamicPruningSetupTest, UsesSingleListWithoutThermostat)
+{
+    setNstlist(40);
+    /* Without a thermostat the buffer is not determined from the
+     * tolerance, so we have no estimate for the inner list buffer.
+     */
+    ir_.etc = etcNO;
+
+    checkSingleList(setupPruning(TRUE));
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
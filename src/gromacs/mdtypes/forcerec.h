@@ -327,6 +327,19 @@ struct t_forcerec {
     void             *f_novirsum_xdummy;
 #endif
 
+    /* Multiple time-stepping for the PME mesh: the mesh forces are
+     * computed every pmeMtsFactor steps and applied with weight pmeMtsFactor.
+     */
+    int               pmeMtsFactor;
+    /* Whether the PME mesh part is computed in the current step */
+    gmx_bool          bDoPmeMesh;
+#ifdef __cplusplus
+    /* The unweighted mesh forces, only used with pmeMtsFactor > 1 */
+    PaddedRVecVector *forceBufferPmeMts;
+#else
+    void             *forceBufferPmeMts_dummy;
+#endif
+
     /* Long-range forces and virial for PPPM/PME/Ewald */
     struct gmx_pme_t *pmedata;
     int               ljpme_combination_rule;
@@ -1,7 +1,7 @@
 /*
  * This file is part of the GROMACS molecular simulation package.
  *
- * Copyright (c) 2014,2015, by the GROMACS development team, led by
+ * Copyright (c) 2014,2015,2017, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -42,6 +42,7 @@
 #define GMX_SIMD_HAVE_LOADU                     0
 #define GMX_SIMD_HAVE_STOREU                    0
 #define GMX_SIMD_HAVE_LOGICAL                   0
+#define GMX_SIMD_HAVE_BOOL_FROM_BITS            0
 #define GMX_SIMD_HAVE_FMA                       1
 #define GMX_SIMD_HAVE_FINT32_EXTRACT            0
 #define GMX_SIMD_HAVE_FINT32_LOGICAL            0
@@ -1,7 +1,7 @@
 /*
  * This file is part of the GROMACS molecular simulation package.
  *
- * Copyright (c) 2014,2015, by the GROMACS development team, led by
+ * Copyright (c) 2014,2015,2017, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -91,6 +91,9 @@ namespace gmx
 //! \brief 1 if SIMD impl has logical operations on floating-point data, otherwise 0
 #define GMX_SIMD_HAVE_LOGICAL                                    1
 
+//! \brief 1 if SIMD booleans can be created from the bits of an integer, otherwise 0
+#define GMX_SIMD_HAVE_BOOL_FROM_BITS                             1
+
 //! \brief Support for extracting integers from \ref gmx::SimdFInt32 (1/0 for present/absent)
 #define GMX_SIMD_HAVE_FINT32_EXTRACT                             1
 
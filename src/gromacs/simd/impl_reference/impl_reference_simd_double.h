@@ -1,7 +1,7 @@
 /*
  * This file is part of the GROMACS molecular simulation package.
  *
- * Copyright (c) 2014,2015,2016, by the GROMACS development team, led by
+ * Copyright (c) 2014,2015,2016,2017, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -1074,6 +1074,27 @@ anyTrue(SimdDBool a)
     return res;
 }
 
+/*! \brief Create a SIMD boolean from the bits of an integer.
+ *
+ * Available if \ref GMX_SIMD_HAVE_BOOL_FROM_BITS is 1.
+ *
+ * \param bits Integer where bit i (counting from the least significant bit)
+ *             sets element i of the result. Bits beyond the SIMD width
+ *             are ignored.
+ * \return Boolean where element i is true if bit i of bits is set.
+ */
+static inline SimdDBool gmx_simdcall
+boolFromBitsD(std::uint32_t bits)
+{
+    SimdDBool         res;
+
+    for (std::size_t i = 0; i < res.simdInternal_.size(); i++)
+    {
+        res.simdInternal_[i] = (((bits >> i) & 1U) != 0);
+    }
+    return res;
+}
+
 /*! \brief Select from double precision SIMD variable where boolean is true.
  *
  * \param a Floating-point variable to select from
@@ -1,7 +1,7 @@
 /*
  * This file is part of the GROMACS molecular simulation package.
  *
- * Copyright (c) 2014,2015,2016, by the GROMACS development team, led by
+ * Copyright (c) 2014,2015,2016,2017, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -1069,6 +1069,27 @@ anyTrue(SimdFBool a)
     return res;
 }
 
+/*! \brief Create a SIMD boolean from the bits of an integer.
+ *
+ * Available if \ref GMX_SIMD_HAVE_BOOL_FROM_BITS is 1.
+ *
+ * \param bits Integer where bit i (counting from the least significant bit)
+ *             sets element i of the result. Bits beyond the SIMD width
+ *             are ignored.
+ * \return Boolean where element i is true if bit i of bits is set.
+ */
+static inline SimdFBool gmx_simdcall
+boolFromBitsF(std::uint32_t bits)
+{
+    SimdFBool         res;
+
+    for (std::size_t i = 0; i < res.simdInternal_.size(); i++)
+    {
+        res.simdInternal_[i] = (((bits >> i) & 1U) != 0);
+    }
+    return res;
+}
+
 /*! \brief Select from single precision SIMD variable where boolean is true.
  *
  * \param a Floating-point variable to select from
@@ -43,6 +43,7 @@
 #define GMX_SIMD_HAVE_LOADU                     1
 #define GMX_SIMD_HAVE_STOREU                    1
 #define GMX_SIMD_HAVE_LOGICAL                   1
+#define GMX_SIMD_HAVE_BOOL_FROM_BITS            0
 #define GMX_SIMD_HAVE_FMA                       1
 #define GMX_SIMD_HAVE_FINT32_EXTRACT            1
 #define GMX_SIMD_HAVE_FINT32_LOGICAL            1
@@ -1,7 +1,7 @@
 /*
  * This file is part of the GROMACS molecular simulation package.
  *
- * Copyright (c) 2014,2015,2016, by the GROMACS development team, led by
+ * Copyright (c) 2014,2015,2016,2017, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -55,6 +55,7 @@
 #define GMX_SIMD_HAVE_LOADU                        1
 #define GMX_SIMD_HAVE_STOREU                       1
 #define GMX_SIMD_HAVE_LOGICAL                      1
+#define GMX_SIMD_HAVE_BOOL_FROM_BITS               1
 #define GMX_SIMD_HAVE_FMA                          1
 #define GMX_SIMD_HAVE_FRACTION                     0
 #define GMX_SIMD_HAVE_FINT32                       1
@@ -1,7 +1,7 @@
 /*
  * This file is part of the GROMACS molecular simulation package.
  *
- * Copyright (c) 2014,2015,2016, by the GROMACS development team, led by
+ * Copyright (c) 2014,2015,2016,2017, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -475,6 +475,14 @@ anyTrue(SimdDBool a)
     return ( avx512Mask2Int(a.simdInternal_) != 0);
 }
 
+static inline SimdDBool gmx_simdcall
+boolFromBitsD(std::uint32_t bits)
+{
+    return {
+               static_cast<__mmask8>(bits)
+    };
+}
+
 static inline SimdDouble gmx_simdcall
 selectByMask(SimdDouble a, SimdDBool m)
 {
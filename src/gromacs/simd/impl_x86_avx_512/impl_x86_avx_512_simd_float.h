@@ -478,6 +478,14 @@ anyTrue(SimdFBool a)
     return ( avx512Mask2Int(a.simdInternal_) != 0);
 }
 
+static inline SimdFBool gmx_simdcall
+boolFromBitsF(std::uint32_t bits)
+{
+    return {
+               static_cast<__mmask16>(bits)
+    };
+}
+
 static inline SimdFloat gmx_simdcall
 selectByMask(SimdFloat a, SimdFBool m)
 {
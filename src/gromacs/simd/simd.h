@@ -803,6 +803,59 @@ setZero()
 {
     return {};
 }
+
+
+class SimdBoolFromBitsProxyInternal;
+
+static inline const SimdBoolFromBitsProxyInternal gmx_simdcall
+boolFromBits(std::uint32_t bits);
+
+/*! \libinternal \brief Proxy object to enable boolFromBits() for SIMD booleans.
+ *
+ * This object is returned by boolFromBits(), and depending on what type you
+ * assign the result to the conversion method will call the right low-level
+ * function.
+ */
+class SimdBoolFromBitsProxyInternal
+{
+    public:
+#if GMX_SIMD_HAVE_FLOAT && GMX_SIMD_HAVE_BOOL_FROM_BITS
+        //!\brief Conversion method that will execute boolFromBits() for SimdFBool
+        operator SimdFBool() const { return boolFromBitsF(bits_); }
+#endif
+#if GMX_SIMD_HAVE_DOUBLE && GMX_SIMD_HAVE_BOOL_FROM_BITS
+        //!\brief Conversion method that will execute boolFromBits() for SimdDBool
+        operator SimdDBool() const { return boolFromBitsD(bits_); }
+#endif
+    private:
+        //! \brief Private constructor can only be called from boolFromBits()
+        SimdBoolFromBitsProxyInternal(std::uint32_t bits) : bits_(bits) {}
+
+        friend const SimdBoolFromBitsProxyInternal gmx_simdcall
+        boolFromBits(std::uint32_t bits);
+
+        const std::uint32_t bits_; //!< The bits to set the boolean elements from
+
+        GMX_DISALLOW_COPY_AND_ASSIGN(SimdBoolFromBitsProxyInternal);
+};
+
+/*! \brief Proxy object to create a SIMD boolean from the bits of an integer
+ *
+ * Available if \ref GMX_SIMD_HAVE_BOOL_FROM_BITS is 1.
+ *
+ * \param bits Integer where bit i (counting from the least significant bit)
+ *             sets element i of the boolean. Bits beyond the SIMD width
+ *             are ignored.
+ * \return Proxy object that will call the actual function for either
+ *         SimdFBool or SimdDBool when you assign the result.
+ */
+static inline const SimdBoolFromBitsProxyInternal gmx_simdcall
+boolFromBits(std::uint32_t bits)
+{
+    return {
+               bits
+    };
+}
 //! \}  end of name-group proxy objects
 
 }      // namespace gmx
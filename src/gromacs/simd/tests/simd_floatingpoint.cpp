@@ -1,7 +1,7 @@
 /*
  * This file is part of the GROMACS molecular simulation package.
  *
- * Copyright (c) 2014,2015,2016, by the GROMACS development team, led by
+ * Copyright (c) 2014,2015,2016,2017, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -35,6 +35,9 @@
 #include "gmxpre.h"
 
 #include <cmath>
+#include <cstdint>
+
+#include <vector>
 
 #include "gromacs/math/utilities.h"
 #include "gromacs/simd/simd.h"
@@ -422,6 +425,36 @@ TEST_F(SimdFloatingpointTest, anyTrueB)
     EXPECT_FALSE(anyTrue(eq));
 }
 
+#if GMX_SIMD_HAVE_BOOL_FROM_BITS
+TEST_F(SimdFloatingpointTest, boolFromBits)
+{
+    std::vector<real> ref(GMX_SIMD_REAL_WIDTH);
+    std::uint32_t     bits = 0;
+
+    // Set every third element, starting with the second
+    for (int i = 0; i < GMX_SIMD_REAL_WIDTH; i++)
+    {
+        if (i % 3 == 1)
+        {
+            bits  |= (1U << i);
+            ref[i] = 1;
+        }
+        else
+        {
+            ref[i] = 0;
+        }
+    }
+    // Bits beyond the SIMD width should be ignored
+    bits |= (1U << GMX_SIMD_REAL_WIDTH);
+
+    SimdBool b = boolFromBits(bits);
+    GMX_EXPECT_SIMD_REAL_EQ(vector2SimdReal(ref), selectByMask(SimdReal(1.0), b));
+
+    b = boolFromBits(0);
+    EXPECT_FALSE(anyTrue(b));
+}
+#endif
+
 TEST_F(SimdFloatingpointTest, blend)
 {
     SimdBool lt   = rSimd_5_7_9 < rSimd_7_8_9;
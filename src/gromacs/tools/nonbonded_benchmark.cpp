@@ -0,0 +1,461 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2017, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+#include "gmxpre.h"
+
+#include "nonbonded_benchmark.h"
+
+#include <cstdio>
+
+#include <algorithm>
+#include <vector>
+
+#include "gromacs/commandline/pargs.h"
+#include "gromacs/fileio/tpxio.h"
+#include "gromacs/gmxlib/network.h"
+#include "gromacs/gmxlib/nrnb.h"
+#include "gromacs/hardware/detecthardware.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/mdlib/force.h"
+#include "gromacs/mdlib/force_flags.h"
+#include "gromacs/mdlib/forcerec.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
+#include "gromacs/mdlib/mdatoms.h"
+#include "gromacs/mdlib/nb_verlet.h"
+#include "gromacs/mdlib/nbnxn_atomdata.h"
+#include "gromacs/mdlib/nbnxn_grid.h"
+#include "gromacs/mdlib/nbnxn_search.h"
+#include "gromacs/mdlib/nbnxn_simd.h"
+#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref.h"
+#include "gromacs/mdlib/nbnxn_kernels/simd_2xnn/nbnxn_kernel_simd_2xnn.h"
+#include "gromacs/mdlib/nbnxn_kernels/simd_4xn/nbnxn_kernel_simd_4xn.h"
+#include "gromacs/mdrunutility/mdmodules.h"
+#include "gromacs/mdtypes/commrec.h"
+#include "gromacs/mdtypes/fcdata.h"
+#include "gromacs/mdtypes/forcerec.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/mdtypes/interaction_const.h"
+#include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/mdtypes/mdatom.h"
+#include "gromacs/mdtypes/state.h"
+#include "gromacs/pbcutil/pbc.h"
+#include "gromacs/timing/cyclecounter.h"
+#include "gromacs/timing/walltime_accounting.h"
+#include "gromacs/topology/mtop_util.h"
+#include "gromacs/topology/topology.h"
+#include "gromacs/utility/arraysize.h"
+#include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/logger.h"
+#include "gromacs/utility/smalloc.h"
+
+/* The kernel flavours we time for each cluster layout */
+enum {
+    ebenchF, ebenchVF, ebenchVgrpF, ebenchNR
+};
+
+static const char *bench_flavour_name[ebenchNR] = { "F", "VF", "VgrpF" };
+
+/* Returns a short name for the cluster layout of kernel_type */
+static const char *bench_layout_name(int kernel_type)
+{
+    switch (kernel_type)
+    {
+        case nbnxnk4x4_PlainC:    return "plain-C";
+        case nbnxnk4xN_SIMD_4xN:  return "SIMD 4xN";
+        case nbnxnk4xN_SIMD_2xNN: return "SIMD 2xNN";
+        default: gmx_incons("Invalid nonbonded kernel type passed!");
+    }
+}
+
+/* The grid, atom data and pair list for one cluster layout */
+typedef struct {
+    int                  kernel_type; /* The nbnxn kernel type, enum in nb_verlet.h  */
+    nbnxn_search_t       nbs;         /* The grid and search data                   */
+    nbnxn_atomdata_t    *nbat;        /* The atom data in nbnxn layout              */
+    nbnxn_pairlist_set_t nbl_list;    /* The pair lists, one per thread             */
+    gmx_int64_t          nlistpair;   /* The number of atom pairs in the list       */
+    gmx_int64_t          ncutpair;    /* The number of pairs within the cut-off     */
+} bench_layout_t;
+
+/* Counts the atom pairs in the pair lists and the pairs among those
+ * that interact, i.e. are not excluded and are within distance rc.
+ */
+static void count_pairs(bench_layout_t *bl,
+                        const rvec *x, const rvec *shift_vec, real rc)
+{
+    const int *a;
+    int        na;
+    real       rc2;
+
+    nbnxn_get_atomorder(bl->nbs, &a, &na);
+
+    rc2           = rc*rc;
+    bl->nlistpair = 0;
+    bl->ncutpair  = 0;
+    for (int th = 0; th < bl->nbl_list.nnbl; th++)
+    {
+        const nbnxn_pairlist_t *nbl = bl->nbl_list.nbl[th];
+
+        for (int i = 0; i < nbl->nci; i++)
+        {
+            const nbnxn_ci_t *ciEntry = &nbl->ci[i];
+            const real       *shift   = shift_vec[ciEntry->shift & NBNXN_CI_SHIFT];
+
+            bl->nlistpair += (ciEntry->cj_ind_end - ciEntry->cj_ind_start)*nbl->na_ci*nbl->na_cj;
+
+            for (int cjind = ciEntry->cj_ind_start; cjind < ciEntry->cj_ind_end; cjind++)
+            {
+                const nbnxn_cj_t *cjEntry = &nbl->cj[cjind];
+
+                for (int ii = 0; ii < nbl->na_ci; ii++)
+                {
+                    int ai = a[ciEntry->ci*nbl->na_ci + ii];
+                    if (ai < 0)
+                    {
+                        continue;
+                    }
+                    for (int jj = 0; jj < nbl->na_cj; jj++)
+                    {
+                        int aj = a[cjEntry->cj*nbl->na_cj + jj];
+                        if (aj >= 0 &&
+                            ((cjEntry->excl >> (ii*nbl->na_cj + jj)) & 1))
+                        {
+                            rvec dx;
+
+                            rvec_add(x[ai], shift, dx);
+                            rvec_dec(dx, x[aj]);
+                            if (norm2(dx) < rc2)
+                            {
+                                bl->ncutpair++;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/* Puts the atoms on the grid for kernel_type and makes the pair list */
+static void init_layout(bench_layout_t *bl, int kernel_type,
+                        const t_inputrec *ir, const t_forcerec *fr,
+                        const t_mdatoms *mdatoms, const gmx_localtop_t *top,
+                        matrix box, int natoms, rvec *x, int nthreads)
+{
+    NbnxnListParameters listParams;
+    rvec                vzero, box_diag;
+    t_nrnb              nrnb;
+
+    bl->kernel_type = kernel_type;
+
+    nbnxn_init_search(&bl->nbs, nullptr, nullptr, FALSE, nthreads);
+    nbnxn_init_pairlist_set(&bl->nbl_list, TRUE, FALSE, nullptr, nullptr);
+
+    bl->nbat = init_nbnxn_atomdata_cpu(fr, ir, kernel_type);
+
+    clear_rvec(vzero);
+    box_diag[XX] = box[XX][XX];
+    box_diag[YY] = box[YY][YY];
+    box_diag[ZZ] = box[ZZ][ZZ];
+    nbnxn_put_on_grid(bl->nbs, ir->ePBC, box, 0, vzero, box_diag,
+                      0, natoms, -1, fr->cginfo, x,
+                      0, nullptr, kernel_type, bl->nbat);
+
+    nbnxn_atomdata_set(bl->nbat, eatAll, bl->nbs, mdatoms, fr->cginfo);
+    nbnxn_atomdata_copy_shiftvec(FALSE, fr->shift_vec, bl->nbat);
+
+    /* We time the kernels on the full, unpruned list */
+    listParams                   = fr->nbv->listParams;
+    listParams.useDynamicPruning = FALSE;
+    listParams.rlistInner        = listParams.rlistOuter;
+
+    init_nrnb(&nrnb);
+    nbnxn_make_pairlist(bl->nbs, bl->nbat, &top->excls, &listParams, 0,
+                        &bl->nbl_list, eintLocal, kernel_type, 0, &nrnb);
+
+    count_pairs(bl, x, fr->shift_vec, std::max(fr->ic->rcoulomb, fr->ic->rvdw));
+}
+
+/* Runs one kernel flavour niter times, returns the wall time in seconds
+ * and the cycle count in *cycles.
+ */
+static double time_kernel(bench_layout_t *bl, const t_forcerec *fr,
+                          int ewald_excl, int flavour, int niter,
+                          gmx_cycles_t *cycles)
+{
+    nbnxn_atomdata_t *nbat = bl->nbat;
+    int               ngener2, force_flags;
+    double            t0;
+    gmx_cycles_t      c0;
+
+    ngener2 = nbat->nenergrp*nbat->nenergrp;
+    std::vector<real> Vc(ngener2), Vvdw(ngener2);
+    std::vector<real> fshift(SHIFTS*DIM);
+
+    force_flags = GMX_FORCE_FORCES;
+    if (flavour != ebenchF)
+    {
+        force_flags |= GMX_FORCE_ENERGY | GMX_FORCE_VIRIAL;
+    }
+
+    /* The kernels select the energy-group flavour with out->nV,
+     * with energy groups present we override it for plain VF.
+     */
+    std::vector<int> nV(nbat->nout);
+    for (int t = 0; t < nbat->nout; t++)
+    {
+        nV[t] = nbat->out[t].nV;
+        if (flavour == ebenchVF)
+        {
+            nbat->out[t].nV = 1;
+        }
+    }
+
+    /* The first call is for warming up caches and is not timed */
+    t0 = 0;
+    c0 = 0;
+    for (int iter = -1; iter < niter; iter++)
+    {
+        if (iter == 0)
+        {
+            t0 = gmx_gettime();
+            c0 = gmx_cycles_read();
+        }
+
+        switch (bl->kernel_type)
+        {
+            case nbnxnk4x4_PlainC:
+                nbnxn_kernel_ref(&bl->nbl_list, nbat, fr->ic, fr->shift_vec,
+                                 force_flags, enbvClearFYes,
+                                 fshift.data(), Vc.data(), Vvdw.data());
+                break;
+#ifdef GMX_NBNXN_SIMD_4XN
+            case nbnxnk4xN_SIMD_4xN:
+                nbnxn_kernel_simd_4xn(&bl->nbl_list, nbat, fr->ic, ewald_excl,
+                                      fr->shift_vec, force_flags, enbvClearFYes,
+                                      fshift.data(), Vc.data(), Vvdw.data());
+                break;
+#endif
+#ifdef GMX_NBNXN_SIMD_2XNN
+            case nbnxnk4xN_SIMD_2xNN:
+                nbnxn_kernel_simd_2xnn(&bl->nbl_list, nbat, fr->ic, ewald_excl,
+                                       fr->shift_vec, force_flags, enbvClearFYes,
+                                       fshift.data(), Vc.data(), Vvdw.data());
+                break;
+#endif
+            default:
+                gmx_incons("Invalid nonbonded kernel type passed!");
+        }
+    }
+    *cycles = gmx_cycles_read() - c0;
+
+    for (int t = 0; t < nbat->nout; t++)
+    {
+        nbat->out[t].nV = nV[t];
+    }
+
+    return gmx_gettime() - t0;
+}
+
+int gmx_nonbonded_benchmark(int argc, char *argv[])
+{
+    const char       *desc[] = {
+        "[THISMODULE] times the Verlet cut-off scheme non-bonded kernels",
+        "on the system in a run input file without running [TT]mdrun[tt].",
+        "The atoms are put on the grid and the pair list is constructed",
+        "once for each available cluster layout (plain-C reference,",
+        "SIMD 4xN and SIMD 2xNN), after which each kernel flavour",
+        "is called [TT]-iter[tt] times:",
+        "forces only (F), forces and energies (VF) and, with multiple",
+        "energy groups, forces and energy-group pair energies (VgrpF).",
+        "With Ewald electrostatics the SIMD kernels are timed both with",
+        "tabulated and with analytical Ewald correction.[PAR]",
+        "The pair list is built without dynamic pruning with the",
+        "buffered cut-off used by [TT]mdrun[tt].",
+        "Reported are the time per kernel call, the time per atom pair",
+        "within the cut-off and the number of such pairs computed per",
+        "CPU cycle. The pair-list efficiency is the fraction of the",
+        "atom pairs in the cluster pair list that are within the cut-off",
+        "and not excluded.[PAR]",
+        "Use [TT]-nt[tt] to set the number of OpenMP threads;",
+        "for comparing kernels and compilers a single thread gives",
+        "the most reproducible numbers."
+    };
+    t_filenm          fnm[] = {
+        { efTPR, nullptr, nullptr, ffREAD }
+    };
+#define NFILE asize(fnm)
+
+    static int        niter    = 100;
+    static int        nthreads = 1;
+    t_pargs           pa[]     = {
+        { "-iter", FALSE, etINT, {&niter},
+          "Number of timed calls of each kernel" },
+        { "-nt",   FALSE, etINT, {&nthreads},
+          "Number of OpenMP threads, 0 is guess" }
+    };
+    gmx_output_env_t *oenv;
+
+    if (!parse_common_args(&argc, argv, 0, NFILE, fnm, asize(pa), pa,
+                           asize(desc), desc, 0, nullptr, &oenv))
+    {
+        return 0;
+    }
+    if (niter < 1)
+    {
+        gmx_fatal(FARGS, "The number of iterations should be at least 1");
+    }
+
+    t_inputrec        irInstance;
+    t_inputrec       *ir = &irInstance;
+    t_state           state;
+    gmx_mtop_t        mtop;
+
+    read_tpx_state(ftp2fn(efTPR, NFILE, fnm), ir, &state, &mtop);
+    if (ir->cutoff_scheme != ecutsVERLET)
+    {
+        gmx_fatal(FARGS, "The non-bonded benchmark only supports cutoff-scheme = %s",
+                  ecutscheme_names[ecutsVERLET]);
+    }
+
+    gmx::MDLogger     mdlog;
+    t_commrec        *cr = init_commrec();
+    gmx_init_intranode_counters(cr);
+
+    gmx_hw_info_t    *hwinfo = gmx_detect_hardware(mdlog, cr, FALSE);
+    gmx_omp_nthreads_init(mdlog, cr, hwinfo->nthreads_hw_avail,
+                          nthreads, nthreads, FALSE, TRUE);
+    nthreads = gmx_omp_nthreads_get(emntNonbonded);
+
+    gmx::MDModules    mdModules;
+    mdModules.assignOptionsToModules(*ir->params, nullptr);
+
+    int               natoms = mtop.natoms;
+    rvec             *x      = as_rvec_array(state.x.data());
+    put_atoms_in_box(ir->ePBC, state.box, natoms, x);
+
+    t_forcerec       *fr = mk_forcerec();
+    t_fcdata         *fcd;
+    fr->hwinfo = hwinfo;
+    snew(fr->gpu_opt, 1);
+    snew(fcd, 1);
+    init_forcerec(nullptr, mdlog, fr, fcd, mdModules.forceProvider(),
+                  ir, &mtop, cr, state.box,
+                  nullptr, nullptr, nullptr, "cpu", FALSE, -1);
+    calc_shifts(state.box, fr->shift_vec);
+
+    t_mdatoms        *mdatoms = init_mdatoms(nullptr, &mtop, ir->efep != efepNO);
+    atoms2md(&mtop, ir, -1, nullptr, natoms, mdatoms);
+
+    gmx_localtop_t   *top = gmx_mtop_generate_local_top(&mtop, ir->efep != efepNO);
+
+    std::vector<int>  kernel_types;
+    kernel_types.push_back(nbnxnk4x4_PlainC);
+    if (nbnxn_simd_supported(mdlog, ir))
+    {
+#ifdef GMX_NBNXN_SIMD_4XN
+        kernel_types.push_back(nbnxnk4xN_SIMD_4xN);
+#endif
+#ifdef GMX_NBNXN_SIMD_2XNN
+        kernel_types.push_back(nbnxnk4xN_SIMD_2xNN);
+#endif
+    }
+
+    bool              bEwald = EEL_PME_EWALD(fr->ic->eeltype);
+
+    printf("\nSystem: %d atoms, rlist %.3f nm, cut-off %.3f nm, %d energy group%s, %d thread%s, %d iterations\n",
+           natoms, fr->nbv->listParams.rlistOuter,
+           std::max(fr->ic->rcoulomb, fr->ic->rvdw),
+           ir->opts.ngener, ir->opts.ngener > 1 ? "s" : "",
+           nthreads, nthreads > 1 ? "s" : "", niter);
+    printf("Pairs are atom pairs within the cut-off, cycles are %s\n\n",
+           gmx_cycles_have_counter() ? "CPU cycles of the master thread" : "not available");
+    printf("%-10s %-7s %-7s %-10s %12s %10s %10s %10s %12s\n",
+           "layout", "cluster", "flavour", "Ewald", "list pairs", "efficiency",
+           "ms/call", "ns/pair", "pairs/cycle");
+
+    for (int kernel_type : kernel_types)
+    {
+        bench_layout_t bl;
+
+        init_layout(&bl, kernel_type, ir, fr, mdatoms, top,
+                    state.box, natoms, x, nthreads);
+
+        /* The plain-C kernel has no Ewald correction choice */
+        int nexcl = (bEwald && kernel_type != nbnxnk4x4_PlainC) ? 2 : 1;
+
+        for (int e = 0; e < nexcl; e++)
+        {
+            int         ewald_excl = (e == 0 ? ewaldexclTable : ewaldexclAnalytical);
+            const char *excl_name  = (!bEwald ? "-" :
+                                      (ewald_excl == ewaldexclTable ? "tabulated" : "analytical"));
+
+            for (int flavour = 0; flavour < ebenchNR; flavour++)
+            {
+                gmx_cycles_t cycles;
+                double       time;
+
+                if (flavour == ebenchVgrpF && ir->opts.ngener == 1)
+                {
+                    continue;
+                }
+
+                time = time_kernel(&bl, fr, ewald_excl, flavour, niter, &cycles);
+
+                double npair = static_cast<double>(bl.ncutpair)*niter;
+                printf("%-10s %dx%-5d %-7s %-10s %12" GMX_PRId64 " %10.3f %10.3f %10.4f",
+                       bench_layout_name(kernel_type),
+                       bl.nbl_list.nbl[0]->na_ci, bl.nbl_list.nbl[0]->na_cj,
+                       bench_flavour_name[flavour], excl_name,
+                       bl.nlistpair,
+                       bl.nlistpair > 0 ? bl.ncutpair/static_cast<double>(bl.nlistpair) : 0,
+                       time*1e3/niter,
+                       npair > 0 ? time*1e9/npair : 0);
+                if (gmx_cycles_have_counter() && cycles > 0)
+                {
+                    printf(" %12.4f\n", npair/cycles);
+                }
+                else
+                {
+                    printf(" %12s\n", "-");
+                }
+            }
+        }
+    }
+    printf("\n");
+
+    gmx_hardware_info_free(hwinfo);
+
+    return 0;
+}
@@ -1,7 +1,7 @@
 /*
  * This file is part of the GROMACS molecular simulation package.
  *
- * Copyright (c) 2013,2014, by the GROMACS development team, led by
+ * Copyright (c) 2017, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -32,23 +32,14 @@
  * To help us fund GROMACS development, we humbly ask that you cite
  * the research papers on the package. Check out http://www.gromacs.org.
  */
+#ifndef GMX_TOOLS_NONBONDED_BENCHMARK_H
+#define GMX_TOOLS_NONBONDED_BENCHMARK_H
 
-
-/* This file includes all required (non-)energy flavors of the kernel
- * outer and inner loops, given a Coulomb and VdW treatment.
+/*! \brief Implements gmx nonbonded-benchmark
+ *
+ * \param[in] argc  argc value passed to main().
+ * \param[in] argv  argv array passed to main().
  */
+int gmx_nonbonded_benchmark(int argc, char *argv[]);
 
-/* Include the force only kernels */
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_outer.h"
-
-/* Include the force+energy kernels */
-#define CALC_ENERGIES
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_outer.h"
-#undef CALC_ENERGIES
-
-/* Include the force+energygroups kernels */
-#define CALC_ENERGIES
-#define ENERGY_GROUPS
-#include "gromacs/mdlib/nbnxn_kernels/nbnxn_kernel_ref_outer.h"
-#undef ENERGY_GROUPS
-#undef CALC_ENERGIES
+#endif
@@ -56,6 +56,7 @@
 #include "gromacs/tools/check.h"
 #include "gromacs/tools/convert_tpr.h"
 #include "gromacs/tools/dump.h"
+#include "gromacs/tools/nonbonded_benchmark.h"
 
 #include "mdrun/mdrun_main.h"
 #include "view/view.h"
@@ -180,6 +181,8 @@ void registerLegacyModules(gmx::CommandLineModuleManager *manager)
     registerModule(manager, &gmx_convert_tpr, "convert-tpr",
                    "Make a modifed run-input file");
     registerObsoleteTool(manager, "tpbconv");
+    registerModule(manager, &gmx_nonbonded_benchmark, "nonbonded-benchmark",
+                   "Time the non-bonded kernels on a run input file");
     registerModule(manager, &gmx_x2top, "x2top",
                    "Generate a primitive topology from coordinates");
 
@@ -376,6 +379,7 @@ void registerLegacyModules(gmx::CommandLineModuleManager *manager)
         group.addModule("grompp");
         group.addModule("mdrun");
         group.addModule("convert-tpr");
+        group.addModule("nonbonded-benchmark");
     }
     {
         gmx::CommandLineModuleGroup group =
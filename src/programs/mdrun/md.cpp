@@ -79,6 +79,7 @@
 #include "gromacs/mdlib/mdsetup.h"
 #include "gromacs/mdlib/nb_verlet.h"
 #include "gromacs/mdlib/nbnxn_gpu_data_mgmt.h"
+#include "gromacs/mdlib/nbnxn_tuning.h"
 #include "gromacs/mdlib/ns.h"
 #include "gromacs/mdlib/shellfc.h"
 #include "gromacs/mdlib/sighandler.h"
@@ -288,6 +289,9 @@ double gmx::do_md(FILE *fplog, t_commrec *cr, const gmx::MDLogger &mdlog,
     gmx_bool              bPMETune         = FALSE;
     gmx_bool              bPMETunePrinting = FALSE;
 
+    /* Non-bonded CPU kernel layout tuning data */
+    NbnxnLayoutTuning *nbnxnLayoutTune = nullptr;
+
     /* Interactive MD */
     gmx_bool          bIMDstep = FALSE;
 
@@ -388,6 +392,10 @@ double gmx::do_md(FILE *fplog, t_commrec *cr, const gmx::MDLogger &mdlog,
     {
         gmx_fatal(FARGS, "Shell particles are not implemented with domain decomposition, use a single rank");
     }
+    if (shellfc && ir->pme_mts_factor > 1)
+    {
+        gmx_fatal(FARGS, "Shell particles and flexible constraints are not supported with pme-mts-factor > 1");
+    }
 
     if (inputrecDeform(ir))
     {
@@ -502,10 +510,20 @@ double gmx::do_md(FILE *fplog, t_commrec *cr, const gmx::MDLogger &mdlog,
     if (bPMETune)
     {
         pme_loadbal_init(&pme_loadbal, cr, mdlog, ir, state->box,
-                         fr->ic, fr->pmedata, use_GPU(fr->nbv),
+                         fr->ic, fr->nbv ? &fr->nbv->listParams : nullptr,
+                         fr->pmedata, use_GPU(fr->nbv),
                          &bPMETunePrinting);
     }
 
+    /* Switching the non-bonded kernel layout changes the summation order,
+     * so, as PME tuning, we do not tune with reruns or reproducibility.
+     */
+    if (fr->cutoff_scheme == ecutsVERLET && !bRerunMD &&
+        !(Flags & MD_REPRODUCIBLE))
+    {
+        nbnxnLayoutTuningInit(&nbnxnLayoutTune, ir, fr);
+    }
+
     if (!ir->bContinuation && !bRerunMD)
     {
         if (state->flags & (1 << estV))
@@ -806,6 +824,16 @@ double gmx::do_md(FILE *fplog, t_commrec *cr, const gmx::MDLogger &mdlog,
                            &bPMETunePrinting);
         }
 
+        if (nbnxnLayoutTuningIsActive(nbnxnLayoutTune) && bNStList)
+        {
+            /* Time the non-bonded kernel layouts, but not during PME tuning */
+            nbnxnLayoutTuningDo(nbnxnLayoutTune, cr,
+                                (bVerbose && MASTER(cr)) ? stderr : nullptr,
+                                fplog,
+                                fr, wcycle, step,
+                                pme_loadbal_is_active(pme_loadbal));
+        }
+
         wallcycle_start(wcycle, ewcSTEP);
 
         if (bRerunMD)
@@ -1832,6 +1860,11 @@ double gmx::do_md(FILE *fplog, t_commrec *cr, const gmx::MDLogger &mdlog,
         pme_loadbal_done(pme_loadbal, fplog, mdlog, use_GPU(fr->nbv));
     }
 
+    if (nbnxnLayoutTune != nullptr)
+    {
+        nbnxnLayoutTuningDone(nbnxnLayoutTune, fplog);
+    }
+
     done_shellfc(fplog, shellfc, step_rel);
 
     if (repl_ex_nst > 0 && MASTER(cr))
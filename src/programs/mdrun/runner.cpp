@@ -52,13 +52,17 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <cctype>
+
 #include <algorithm>
+#include <string>
 
 #include "gromacs/commandline/filenm.h"
 #include "gromacs/domdec/domdec.h"
 #include "gromacs/domdec/domdec_struct.h"
 #include "gromacs/essentialdynamics/edsam.h"
 #include "gromacs/ewald/pme.h"
+#include "gromacs/fft/fft.h"
 #include "gromacs/fileio/checkpoint.h"
 #include "gromacs/fileio/oenv.h"
 #include "gromacs/fileio/tpxio.h"
@@ -85,6 +89,7 @@
 #include "gromacs/mdlib/mdrun.h"
 #include "gromacs/mdlib/minimize.h"
 #include "gromacs/mdlib/nbnxn_search.h"
+#include "gromacs/mdlib/nbnxn_tuning.h"
 #include "gromacs/mdlib/qmmm.h"
 #include "gromacs/mdlib/sighandler.h"
 #include "gromacs/mdlib/sim_util.h"
@@ -106,12 +111,15 @@
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/filestream.h"
+#include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
 #include "gromacs/utility/gmxmpi.h"
 #include "gromacs/utility/logger.h"
 #include "gromacs/utility/loggerbuilder.h"
 #include "gromacs/utility/pleasecite.h"
 #include "gromacs/utility/smalloc.h"
+#include "gromacs/utility/stringutil.h"
+#include "gromacs/utility/sysinfo.h"
 
 #include "deform.h"
 #include "md.h"
@@ -309,6 +317,10 @@ static const int    nbnxnReferenceNstlist = 10;
 const int           nstlist_try[] = { 20, 25, 40 };
 //! Number of elements in the neighborsearch list trials.
 #define NNSTL  sizeof(nstlist_try)/sizeof(nstlist_try[0])
+//! The values to try when switching with dynamic pair-list pruning
+const int           nstlist_try_prune[] = { 20, 25, 40, 50, 80, 100 };
+//! Number of elements in the neighborsearch list trials with dynamic pruning.
+#define NNSTL_PRUNE  sizeof(nstlist_try_prune)/sizeof(nstlist_try_prune[0])
 /* Increase nstlist until the non-bonded cost increases more than listfac_ok,
  * but never more than listfac_max.
  * A standard (protein+)water system at 300K with PME ewald_rtol=1e-5
@@ -333,6 +345,13 @@ static const float  nbnxn_knl_listfac_max   = 1.3;
 static const float  nbnxn_gpu_listfac_ok    = 1.20;
 //! Too high performance ratio beween force calc and neighbor searching
 static const float  nbnxn_gpu_listfac_max   = 1.30;
+/* CPU with dynamic pruning: the force kernels use the inner list, so the
+ * outer list only affects the search and prune cost, not the kernel cost.
+ */
+//! Max OK performance ratio beween force calc and neighbor searching
+static const float  nbnxn_cpu_prune_listfac_ok  = 1.8;
+//! Too high performance ratio beween force calc and neighbor searching
+static const float  nbnxn_cpu_prune_listfac_max = 2.2;
 
 /*! \brief Try to increase nstlist when using the Verlet cut-off scheme */
 static void increase_nstlist(FILE *fp, t_commrec *cr,
@@ -354,6 +373,10 @@ static void increase_nstlist(FILE *fp, t_commrec *cr,
     const char            *dd_err   = "Can not increase nstlist because of domain decomposition limitations";
     char                   buf[STRLEN];
 
+    const gmx_bool         useDynamicPruning = nbnxnDynamicPruningIsSupported(ir, bGPU);
+    const int             *nstlistTry        = (useDynamicPruning ? nstlist_try_prune : nstlist_try);
+    const size_t           numNstlistTry     = (useDynamicPruning ? NNSTL_PRUNE : NNSTL);
+
     if (nstlist_cmdline <= 0)
     {
         if (ir->nstlist == 1)
@@ -364,16 +387,16 @@ static void increase_nstlist(FILE *fp, t_commrec *cr,
             return;
         }
 
-        if (fp != nullptr && bGPU && ir->nstlist < nstlist_try[0])
+        if (fp != nullptr && bGPU && ir->nstlist < nstlistTry[0])
         {
             fprintf(fp, nstl_gpu, ir->nstlist);
         }
         nstlist_ind = 0;
-        while (nstlist_ind < NNSTL && ir->nstlist >= nstlist_try[nstlist_ind])
+        while (nstlist_ind < numNstlistTry && ir->nstlist >= nstlistTry[nstlist_ind])
         {
             nstlist_ind++;
         }
-        if (nstlist_ind == NNSTL)
+        if (nstlist_ind == numNstlistTry)
         {
             /* There are no larger nstlist value to try */
             return;
@@ -418,6 +441,11 @@ static void increase_nstlist(FILE *fp, t_commrec *cr,
         listfac_ok  = nbnxn_gpu_listfac_ok;
         listfac_max = nbnxn_gpu_listfac_max;
     }
+    else if (useDynamicPruning)
+    {
+        listfac_ok  = nbnxn_cpu_prune_listfac_ok;
+        listfac_max = nbnxn_cpu_prune_listfac_max;
+    }
     else if (cpuinfo.feature(gmx::CpuInfo::Feature::X86_Avx512ER))
     {
         listfac_ok  = nbnxn_knl_listfac_ok;
@@ -445,11 +473,8 @@ static void increase_nstlist(FILE *fp, t_commrec *cr,
     /* Allow rlist to make the list a given factor larger than the list
      * would be with the reference value for nstlist (10).
      */
-    nstlist_prev = ir->nstlist;
-    ir->nstlist  = nbnxnReferenceNstlist;
-    calc_verlet_buffer_size(mtop, det(box), ir, -1, &ls, nullptr,
+    calc_verlet_buffer_size(mtop, det(box), ir, nbnxnReferenceNstlist, -1, &ls, nullptr,
                             &rlistWithReferenceNstlist);
-    ir->nstlist  = nstlist_prev;
 
     /* Determine the pair list size increase due to zero interactions */
     rlist_inc = nbnxn_get_rlist_effective_inc(ls.cluster_size_j,
@@ -468,11 +493,11 @@ static void increase_nstlist(FILE *fp, t_commrec *cr,
     {
         if (nstlist_cmdline <= 0)
         {
-            ir->nstlist = nstlist_try[nstlist_ind];
+            ir->nstlist = nstlistTry[nstlist_ind];
         }
 
         /* Set the pair-list buffer size in ir */
-        calc_verlet_buffer_size(mtop, det(box), ir, -1, &ls, nullptr, &rlist_new);
+        calc_verlet_buffer_size(mtop, det(box), ir, ir->nstlist, -1, &ls, nullptr, &rlist_new);
 
         /* Does rlist fit in the box? */
         bBox = (gmx::square(rlist_new) < max_cutoff2(ir->ePBC, box));
@@ -504,7 +529,7 @@ static void increase_nstlist(FILE *fp, t_commrec *cr,
                 /* Increase nstlist */
                 nstlist_prev = ir->nstlist;
                 rlist_prev   = rlist_new;
-                bCont        = (nstlist_ind+1 < NNSTL && rlist_new < rlist_ok);
+                bCont        = (nstlist_ind+1 < numNstlistTry && rlist_new < rlist_ok);
             }
             else
             {
@@ -571,7 +596,7 @@ static void prepare_verlet_scheme(FILE                           *fplog,
          */
         verletbuf_get_list_setup(TRUE, bUseGPU, &ls);
 
-        calc_verlet_buffer_size(mtop, det(box), ir, -1, &ls, nullptr, &rlist_new);
+        calc_verlet_buffer_size(mtop, det(box), ir, ir->nstlist, -1, &ls, nullptr, &rlist_new);
 
         if (rlist_new != ir->rlist)
         {
@@ -677,6 +702,35 @@ static integrator_t *my_integrator(unsigned int ei)
     }
 }
 
+/*! \brief Returns the name of the FFT wisdom file, empty when not used
+ *
+ * Wisdom is only stored when GMX_FFTW_WISDOM_DIR is set. Measured plans
+ * depend on the precision and the CPU model, so these are part of the
+ * file name. The grid sizes and the number of transforms per thread
+ * are stored in the wisdom itself.
+ */
+static std::string fftWisdomFileName(const CpuInfo &cpuInfo)
+{
+    const char *dir = getenv("GMX_FFTW_WISDOM_DIR");
+
+    if (dir == nullptr)
+    {
+        return std::string();
+    }
+
+    std::string cpu = cpuInfo.brandString();
+    for (char &c : cpu)
+    {
+        if (!std::isalnum(static_cast<unsigned char>(c)))
+        {
+            c = '_';
+        }
+    }
+
+    return formatString("%s/fftw-wisdom-%s-%s.txt",
+                        dir, GMX_DOUBLE ? "double" : "single", cpu.c_str());
+}
+
 //! Initializes the logger for mdrun.
 static gmx::LoggerOwner buildLogger(FILE *fplog, const t_commrec *cr)
 {
@@ -1192,6 +1246,27 @@ int mdrunner(gmx_hw_opt_t *hw_opt,
         membed = init_membed(fplog, nfile, fnm, mtop, inputrec, state, cr, &cpt_period);
     }
 
+    /* Read the FFT wisdom of earlier runs before any FFT is planned.
+     * With thread-MPI all ranks share the wisdom of the master rank,
+     * with MPI only the PME ranks do FFTs. The other ranks only
+     * start planning after the next collective call with the master.
+     * With -reprod FFTW plans without measuring, wisdom is not used.
+     */
+    std::string fftWisdomFile;
+#if GMX_LIB_MPI
+    bool        fftWisdomRank = (cr->duty & DUTY_PME);
+#else
+    bool        fftWisdomRank = MASTER(cr);
+#endif
+    if (fftWisdomRank && !(Flags & MD_REPRODUCIBLE))
+    {
+        fftWisdomFile = fftWisdomFileName(*hwinfo->cpuInfo);
+    }
+    if (!fftWisdomFile.empty() && gmx_fft_import_wisdom(fftWisdomFile.c_str()))
+    {
+        GMX_LOG(mdlog.info).appendTextFormatted("Read FFT wisdom from %s", fftWisdomFile.c_str());
+    }
+
     snew(nrnb, 1);
     if (cr->duty & DUTY_PP)
     {
@@ -1423,6 +1498,20 @@ int mdrunner(gmx_hw_opt_t *hw_opt,
                fr ? fr->nbv : nullptr,
                EI_DYNAMICS(inputrec->eI) && !MULTISIM(cr));
 
+    /* Store the wisdom, including plans measured during PME tuning.
+     * Finish_run synchronized all ranks, so all planning is done.
+     * Write to a temporary file first, since other runs might use
+     * the same wisdom file.
+     */
+    if (!fftWisdomFile.empty())
+    {
+        std::string tmpFile = formatString("%s.%d", fftWisdomFile.c_str(), gmx_getpid());
+        if (gmx_fft_export_wisdom(tmpFile.c_str()))
+        {
+            gmx_file_rename(tmpFile.c_str(), fftWisdomFile.c_str());
+        }
+    }
+
     // Free PME data
     if (pmedata)
     {
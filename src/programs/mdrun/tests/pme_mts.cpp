@@ -0,0 +1,167 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2017, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests that multiple time-stepping of the PME mesh forces gives
+ * energies close to those of computing the mesh forces every step
+ *
+ * \ingroup module_mdrun_integration_tests
+ */
+#include "gmxpre.h"
+
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/utility/stringutil.h"
+
+#include "testutils/testasserts.h"
+
+#include "energyreader.h"
+#include "mdruncomparisonfixture.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Test fixture for multiple time-stepping of the PME mesh forces
+class PmeMtsTest : public MdrunComparisonFixture
+{
+    public:
+        using MdrunComparisonFixture::runTest;
+        //! Runs mdrun with pme-mts-factor 1 and 2 and compares the energies
+        virtual void runTest(const CommandLine     &gromppCallerRef,
+                             const char            *simulationName,
+                             const char            *integrator,
+                             const char            *tcoupl,
+                             const char            *pcoupl,
+                             FloatingPointTolerance tolerance);
+        //! Calls grompp and mdrun with \p pmeMtsFactor, returns the name of the energy file
+        std::string runWithFactor(const CommandLine &gromppCallerRef,
+                                  MdpFieldValues     mdpFieldValues,
+                                  const char        *integrator,
+                                  const char        *tcoupl,
+                                  const char        *pcoupl,
+                                  int                pmeMtsFactor);
+};
+
+std::string PmeMtsTest::runWithFactor(const CommandLine &gromppCallerRef,
+                                      MdpFieldValues     mdpFieldValues,
+                                      const char        *integrator,
+                                      const char        *tcoupl,
+                                      const char        *pcoupl,
+                                      int                pmeMtsFactor)
+{
+    std::string name = formatString("mts%d", pmeMtsFactor);
+
+    mdpFieldValues["other"] += formatString("coulombtype    = PME\n"
+                                            "pme-mts-factor = %d\n",
+                                            pmeMtsFactor);
+    prepareMdpFile(mdpFieldValues, integrator, tcoupl, pcoupl);
+
+    runner_.tprFileName_                     = fileManager_.getTemporaryFilePath(name + ".tpr");
+    runner_.fullPrecisionTrajectoryFileName_ = fileManager_.getTemporaryFilePath(name + ".trr");
+    runner_.edrFileName_                     = fileManager_.getTemporaryFilePath(name + ".edr");
+    EXPECT_EQ(0, runner_.callGrompp(gromppCallerRef));
+    EXPECT_EQ(0, runner_.callMdrun());
+
+    return runner_.edrFileName_;
+}
+
+void PmeMtsTest::runTest(const CommandLine     &gromppCallerRef,
+                         const char            *simulationName,
+                         const char            *integrator,
+                         const char            *tcoupl,
+                         const char            *pcoupl,
+                         FloatingPointTolerance tolerance)
+{
+    MdpFieldValues mdpFieldValues = prepareMdpFieldValues(simulationName);
+    runner_.useTopGroAndNdxFromDatabase(simulationName);
+
+    std::string    referenceEdrFileName = runWithFactor(gromppCallerRef, mdpFieldValues,
+                                                        integrator, tcoupl, pcoupl, 1);
+    std::string    mtsEdrFileName       = runWithFactor(gromppCallerRef, mdpFieldValues,
+                                                        integrator, tcoupl, pcoupl, 2);
+
+    /* The energy output steps are mesh steps, so the mesh energy
+     * is computed for the same kind of step in both runs.
+     */
+    auto referenceEnergy = openEnergyFileToReadFields(referenceEdrFileName,
+                                                      { "Coul. recip.", "Potential", "Kinetic En.", "Total Energy" });
+    auto mtsEnergy       = openEnergyFileToReadFields(mtsEdrFileName,
+                                                      { "Coul. recip.", "Potential", "Kinetic En.", "Total Energy" });
+    bool haveInitialEnergy = false;
+    real initialEnergy     = 0;
+    while (referenceEnergy->readNextFrame())
+    {
+        ASSERT_TRUE(mtsEnergy->readNextFrame());
+        EnergyFrame mtsFrame = mtsEnergy->frame();
+        compareFrames(std::make_pair(referenceEnergy->frame(), mtsFrame),
+                      tolerance);
+
+        /* Without thermostat the total energy should be conserved,
+         * to within the fluctuations of the integrator.
+         */
+        if (!haveInitialEnergy)
+        {
+            initialEnergy     = mtsFrame.at("Total Energy");
+            haveInitialEnergy = true;
+        }
+        EXPECT_REAL_EQ_TOL(initialEnergy, mtsFrame.at("Total Energy"), absoluteTolerance(1))
+        << "Total energy is not conserved with pme-mts-factor 2 at " << mtsFrame.getFrameName();
+    }
+    EXPECT_FALSE(mtsEnergy->readNextFrame());
+}
+
+TEST_F(PmeMtsTest, AgreesWithSingleTimeStepInNve)
+{
+    /* Over the few steps of the test, integrating the slowly varying
+     * mesh forces with twice the time step should only change the
+     * energies slightly. The differences of about 5e-4 relative to
+     * the potential energy are due to the trajectories diverging.
+     * Applying the mesh impulse without its weight gives differences
+     * several times larger and a clear energy drift.
+     */
+    runTest("spc216", "md", "no", "no",
+            relativeToleranceAsFloatingPoint(8000, 2e-3));
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx